@@ -22,7 +22,10 @@
 
 #pragma once
 
+#include <atomic>                               // std::atomic parameter.
+
 #include "BitFunnel/Utilities/Random.h"         // RandomReal embedded.
+#include "BitFunnel/Utilities/Stopwatch.h"      // Stopwatch embedded.
 #include "BitFunnel/Chunks/IChunkProcessor.h"   // Base class.
 
 
@@ -127,6 +130,54 @@ namespace BitFunnel
     };
 
 
+    //*************************************************************************
+    //
+    // RateLimitFilter
+    //
+    // IDocumentFilter that keeps every document, but blocks in KeepDocument()
+    // so that documents are admitted at no more than a specified rate. The
+    // nth document is admitted n / documentsPerSecond seconds after the first,
+    // so time lost to a slow document is made up by the ones that follow.
+    //
+    //*************************************************************************
+    class RateLimitFilter : public IDocumentFilter
+    {
+    public:
+        RateLimitFilter(double documentsPerSecond);
+
+        virtual bool KeepDocument(IDocument const & document) override;
+
+    private:
+        const double m_documentsPerSecond;
+
+        // Started by the first call to KeepDocument().
+        Stopwatch m_stopwatch;
+
+        // Tracks the number of documents admitted so far.
+        size_t m_documentCount;
+    };
+
+
+    //*************************************************************************
+    //
+    // CancellationFilter
+    //
+    // IDocumentFilter that keeps documents until a flag owned by the caller
+    // is set. Lets another thread stop an ingestion that is in progress.
+    //
+    //*************************************************************************
+    class CancellationFilter : public IDocumentFilter
+    {
+    public:
+        CancellationFilter(std::atomic<bool> const & cancelled);
+
+        virtual bool KeepDocument(IDocument const & document) override;
+
+    private:
+        std::atomic<bool> const & m_cancelled;
+    };
+
+
     //*************************************************************************
     //
     // NopFilter
@@ -63,6 +63,20 @@ namespace BitFunnel
                 IDocumentFilter & filter,
                 bool cacheDocuments);
 
+        // When (reorderDocuments) is true, documents are buffered a slice at
+        // a time and ingested in an order that places documents with similar
+        // terms at adjacent DocIndexes.
+        std::unique_ptr<IChunkManifestIngestor>
+            CreateChunkManifestIngestor(
+                IFileSystem& fileSystem,
+                IChunkWriterFactory* chunkWriterFactory,
+                std::vector<std::string> const & filePaths,
+                IConfiguration const & config,
+                IIngestor& ingestor,
+                IDocumentFilter & filter,
+                bool cacheDocuments,
+                bool reorderDocuments);
+
 
         std::unique_ptr<IChunkWriterFactory>
             CreateAnnotatingChunkWriterFactory(
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <iosfwd>                   // std::ostream parameter.
 #include <stddef.h>                 // size_t return value.
 #include "BitFunnel/IInterface.h"   // Base class.
 
@@ -46,5 +47,14 @@ namespace BitFunnel
         // NOTE that parameters controlling ingestion are supplied to the
         // constructor of the object that implements IChunkManifestIngestor.
         virtual void IngestChunk(size_t index) const = 0;
+
+        // Ingests any documents that IngestChunk() buffered instead of
+        // ingesting right away, such as those awaiting reordering. Call
+        // once, after the last chunk has been ingested.
+        virtual void Flush() const = 0;
+
+        // Prints statistics gathered while ingesting chunks, such as the
+        // row densities that result from document reordering.
+        virtual void PrintStatistics(std::ostream & out) const = 0;
     };
 }
@@ -39,6 +39,9 @@ namespace BitFunnel
     // allowed in the next shard. The last shard allows all documents with a
     // posting count at least as large as its minimum posting count.
     //
+    // Each shard may also specify the capacity of its slices. Shards without
+    // one derive their capacity from the index's default slice buffer size.
+    //
     //*************************************************************************
     class IShardDefinition : public IInterface
     {
@@ -72,5 +75,14 @@ namespace BitFunnel
 
         // Returns the number of shards in the map.
         virtual ShardId GetShardCount() const = 0;
+
+        // Sets the slice capacity, in documents, for the specified shard. A
+        // capacity of zero means the shard derives its capacity from the
+        // index's default slice buffer size.
+        virtual void SetSliceCapacity(ShardId shard, DocIndex capacity) = 0;
+
+        // Returns the slice capacity for the specified shard, or zero if the
+        // shard uses the default.
+        virtual DocIndex GetSliceCapacity(ShardId shard) const = 0;
     };
 }
@@ -0,0 +1,139 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>                       // std::ostream& parameter.
+#include <random>                       // std::mt19937 parameter.
+#include <stddef.h>                     // size_t parameter.
+#include <string>                       // std::string return value.
+#include <vector>                       // std::vector embedded.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // ZipfianChunks
+    //
+    // Creates chunk files of synthetic documents for benchmarking. Unlike
+    // SyntheticChunks, whose documents are built to make query verification
+    // trivial, ZipfianChunks aims to reproduce the statistical shape of a
+    // real corpus at arbitrary scale.
+    //
+    // Terms are drawn from a vocabulary whose rank-frequency distribution
+    // follows Zipf's law with a configurable exponent. The term with rank r
+    // is spelled as r written in base 26 with the letters 'a' through 'z',
+    // so frequent terms are short, as in natural language, and the vocabulary
+    // never needs to be materialized.
+    //
+    // The number of terms in each stream of a document is drawn from a
+    // log-normal distribution with a configurable mean and standard
+    // deviation.
+    //
+    // Documents are assigned to chunks in contiguous DocId ranges and every
+    // chunk is generated from its own random number generator, seeded from
+    // the corpus seed and the chunk number. WriteChunk() is const and may be
+    // called concurrently for different chunks, and the output is the same
+    // regardless of how many threads generate the corpus or in which order
+    // the chunks are written.
+    //
+    // Samples are computed directly from the output of std::mt19937, whose
+    // sequence the standard fixes, rather than with the std:: distributions,
+    // whose algorithms are implementation-defined. This way a given seed
+    // produces the same corpus with every standard library.
+    //
+    // WriteQueryLog() generates queries over the same vocabulary. The
+    // vocabulary is divided into three bands by cumulative frequency: head
+    // terms account for the first half of all postings, tail terms for the
+    // last tenth and torso terms for the rest. The caller controls the
+    // fraction of query terms drawn from the head and the tail bands.
+    //
+    //*************************************************************************
+    class ZipfianChunks
+    {
+    public:
+        ZipfianChunks(unsigned seed,
+                      size_t vocabularySize,
+                      double zipfExponent,
+                      size_t documentCount,
+                      size_t chunkCount,
+                      size_t streamCount,
+                      double meanTermsPerStream,
+                      double termsPerStreamDeviation);
+
+        size_t GetChunkCount() const;
+        size_t GetDocumentCount() const;
+        std::string GetChunkName(size_t chunkId) const;
+        void WriteChunk(std::ostream& out, size_t chunkId) const;
+
+        // Writes queryCount queries, one per line. The number of terms in
+        // each query is uniformly distributed in [1, 2 * meanTermsPerQuery - 1].
+        void WriteQueryLog(std::ostream& out,
+                           size_t queryCount,
+                           double meanTermsPerQuery,
+                           double headFraction,
+                           double tailFraction) const;
+
+        // Returns the text of the term with the specified frequency rank.
+        // Rank 0 is the most frequent term.
+        static std::string GetTerm(size_t rank);
+
+        // Returns the expected fraction of postings contributed by the term
+        // with the specified rank.
+        double GetTermProbability(size_t rank) const;
+
+    private:
+        void WriteDocument(std::ostream& out,
+                           size_t docId,
+                           std::mt19937& generator) const;
+
+        // Returns a uniformly distributed value in [0, 1).
+        static double SampleReal(std::mt19937& generator);
+
+        // Returns a uniformly distributed value in [begin, end).
+        static size_t SampleInt(std::mt19937& generator,
+                                size_t begin,
+                                size_t end);
+
+        // Returns a log-normally distributed number of terms per stream.
+        double SampleLength(std::mt19937& generator) const;
+
+        size_t SampleRank(std::mt19937& generator) const;
+
+        const unsigned m_seed;
+        const size_t m_documentCount;
+        const size_t m_chunkCount;
+        const size_t m_streamCount;
+
+        // Parameters of the log-normal terms-per-stream distribution.
+        double m_lengthMu;
+        double m_lengthSigma;
+
+        // m_cumulative[r] is the probability that a posting has rank <= r.
+        std::vector<double> m_cumulative;
+
+        // First ranks of the torso and tail bands.
+        size_t m_torsoStart;
+        size_t m_tailStart;
+    };
+}
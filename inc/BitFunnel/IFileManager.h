@@ -82,6 +82,7 @@ namespace BitFunnel
         virtual FileDescriptor0 DocumentHistogram() = 0;
         //virtual FileDescriptor0 L1RankerConfig() = 0;
         virtual FileDescriptor0 Manifest() = 0;
+        virtual FileDescriptor0 PartialStatistics() = 0;
         //virtual FileDescriptor0 Model() = 0;
         //virtual FileDescriptor0 PlanDescriptors() = 0;
         //virtual FileDescriptor0 PostingCounts() = 0;
@@ -113,6 +114,7 @@ namespace BitFunnel
         virtual FileDescriptor1 Correlate(size_t shard) = 0;
         virtual FileDescriptor1 CumulativeTermCounts(size_t shard) = 0;
         virtual FileDescriptor1 DocFreqTable(size_t shard) = 0;
+        virtual FileDescriptor1 PartialDocFreqTable(size_t shard) = 0;
         //virtual FileDescriptor1 DocTable(size_t shard) = 0;
         //virtual FileDescriptor1 ScoreTable(size_t shard) = 0;
         virtual FileDescriptor1 RowDensities(size_t shard) = 0;
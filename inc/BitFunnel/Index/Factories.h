@@ -43,7 +43,10 @@ namespace BitFunnel
     class IFileManager;
     class IFileSystem;
     class IIngestor;
+    class IQueryAdaptiveTreatment;
+    class IQueryProfile;
     class IRecycler;
+    class IRowPlacementOptimizer;
     class IShardCostFunction;
     class IShardDefinition;
     class ISimpleIndex;
@@ -71,6 +74,14 @@ namespace BitFunnel
                                 bool keepTermText,
                                 IFactSet const & facts);
 
+        // Creates an IConfiguration that hashes term text with hashFunction
+        // instead of the default, Term::HashFunction::MurmurHash64A.
+        std::unique_ptr<IConfiguration>
+            CreateConfiguration(size_t maxGramSize,
+                                bool keepTermText,
+                                IFactSet const & facts,
+                                Term::HashFunction hashFunction);
+
         std::unique_ptr<IDocumentDataSchema> CreateDocumentDataSchema();
 
         std::unique_ptr<IDocumentFrequencyTable>
@@ -86,12 +97,34 @@ namespace BitFunnel
 
         std::unique_ptr<IFactSet> CreateFactSet();
 
+        // When collectStatistics is true, each Shard gathers document
+        // frequency and cumulative term count statistics during ingestion.
+        // A non-zero maxStatisticsTerms limits each Shard's statistics to
+        // approximately that many of the most frequent terms.
         std::unique_ptr<IIngestor>
             CreateIngestor(IDocumentDataSchema const & docDataSchema,
                            IRecycler& recycler,
                            ITermTableCollection const & termTables,
                            IShardDefinition const & shardDefinition,
-                           ISliceBufferAllocator& sliceBufferAllocator);
+                           ISliceBufferAllocator& sliceBufferAllocator,
+                           bool collectStatistics,
+                           size_t maxStatisticsTerms);
+
+        std::unique_ptr<IQueryProfile> CreateQueryProfile();
+
+        // Creates a treatment that starts from (base) and adjusts it using
+        // the query frequencies in (queries). Frequently queried terms may
+        // be given additional rows, provided the extra bits per document
+        // stay within (memoryBudget) times the bits per document that (base)
+        // uses for (terms). Terms that are never queried and would have
+        // shared rows are made adhoc. The treatment keeps references to
+        // (base) and (queries).
+        std::unique_ptr<IQueryAdaptiveTreatment>
+            CreateQueryAdaptiveTreatment(ITermTreatment const & base,
+                                         IQueryProfile const & queries,
+                                         IDocumentFrequencyTable const & terms,
+                                         double density,
+                                         double memoryBudget);
 
         std::unique_ptr<IRecycler> CreateRecycler();
 
@@ -101,11 +134,23 @@ namespace BitFunnel
                                     size_t minShardCapacity,
                                     Rank maxRankInUse);
 
+        // Creates an IRowPlacementOptimizer for (termTable). Page counts
+        // assume RowTables with (sliceCapacity) documents per slice.
+        std::unique_ptr<IRowPlacementOptimizer>
+            CreateRowPlacementOptimizer(ITermTable const & termTable,
+                                        DocIndex sliceCapacity);
+
         std::unique_ptr<ISimpleIndex> CreateSimpleIndex(IFileSystem& fileSystem);
 
         std::unique_ptr<ISliceBufferAllocator>
             CreateSliceBufferAllocator(size_t blockSize, size_t blockCount);
 
+        // Creates an allocator with one pool of blockCounts[i] blocks for
+        // each blockSizes[i]. The first block size is the default.
+        std::unique_ptr<ISliceBufferAllocator>
+            CreateSliceBufferAllocator(std::vector<size_t> const & blockSizes,
+                                       std::vector<size_t> const & blockCounts);
+
         std::unique_ptr<ITermTable> CreateTermTable();
         std::unique_ptr<ITermTable> CreateTermTable(std::istream & input);
 
@@ -117,6 +162,20 @@ namespace BitFunnel
                                    IFactSet const & facts,
                                    ITermTable & termTable);
 
+        // Builds (termTable) using up to (threadCount) threads. When
+        // (previous) is not nullptr, explicit terms whose treatment has not
+        // changed keep the rows they were assigned in (previous) and only
+        // new or changed terms are given new rows.
+        std::unique_ptr<ITermTableBuilder>
+            CreateTermTableBuilder(double density,
+                                   double adhocFrequency,
+                                   ITermTreatment const & treatment,
+                                   IDocumentFrequencyTable const & terms,
+                                   IFactSet const & facts,
+                                   ITermTable const * previous,
+                                   ITermTable & termTable,
+                                   size_t threadCount);
+
         std::unique_ptr<ITermTableCollection>
             CreateTermTableCollection();
         std::unique_ptr<ITermTableCollection>
@@ -25,6 +25,8 @@
 
 #include <stddef.h>
 
+#include "BitFunnel/BitFunnelTypes.h"   // DocIndex parameter.
+
 namespace BitFunnel
 {
     class IDocumentDataSchema;
@@ -39,4 +41,11 @@ namespace BitFunnel
     // TODO: this number should get bigger as the corpus gets bigger.
     size_t GetReasonableBlockSize(IDocumentDataSchema const & schema,
                                   ITermTable const & termTable);
+
+    // Returns the page-rounded block size for a slice that holds at least
+    // capacity documents. The capacity is rounded up to a multiple of the
+    // smallest capacity the term table supports.
+    size_t GetBlockSizeForCapacity(IDocumentDataSchema const & schema,
+                                   ITermTable const & termTable,
+                                   DocIndex capacity);
 }
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "BitFunnel/IInterface.h"   // Base class.
+#include "BitFunnel/Term.h"         // Term::HashFunction return value.
 
 
 namespace BitFunnel
@@ -56,5 +57,8 @@ namespace BitFunnel
         // Returns the IFactSet used to configure the TermTable with user
         // defined fact rows.
         virtual IFactSet const & GetFactSet() const = 0;
+
+        // Returns the function used to compute raw hashes of term text.
+        virtual Term::HashFunction GetHashFunction() const = 0;
     };
 }
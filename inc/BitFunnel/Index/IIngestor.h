@@ -36,6 +36,7 @@ namespace BitFunnel
     class IDocument;
     class IDocumentCache;
     class IFileManager;
+    class MetricsRegistry;
     class IRecycler;
     class ITokenManager;
     class IShard;
@@ -68,6 +69,14 @@ namespace BitFunnel
         // TODO: Remove this temporary method.
         virtual void PrintStatistics(std::ostream& out, double time) const = 0;
 
+        // Adds metrics for documents, postings and bytes ingested, Slices
+        // created, recycled, active and awaiting recycling, slice buffer
+        // pool utilization, tokens in flight, and RowIdCache hits and
+        // misses. The metrics read the IIngestor each time the registry is
+        // written, so the registry must not be written after the IIngestor
+        // is destroyed.
+        virtual void RegisterMetrics(MetricsRegistry & registry) const = 0;
+
         // Writes out the following data structions in locations defined by the
         // FileManager:
         //
@@ -79,6 +88,19 @@ namespace BitFunnel
         virtual void WriteStatistics(IFileManager & fileManager,
                                      ITermToText const * termToText) const = 0;
 
+        // Writes statistics for a partition of the corpus in a form that
+        // MergeStatistics() can combine with other partitions:
+        //
+        //   Per IIngester
+        //      DocumentHistogramBuilder
+        //      PartialStatistics (document count and error bound per shard)
+        //   Per Shard
+        //      PartialDocFreqTable (raw counts, ordered by term)
+        //
+        // Throws RecoverableError if the index is not gathering statistics.
+        virtual void WritePartialStatistics(IFileManager & fileManager,
+                                            ITermToText const * termToText) const = 0;
+
 
         virtual void TemporaryReadAllSlices(IFileManager& fileManager) = 0;
 
@@ -145,8 +167,47 @@ namespace BitFunnel
         virtual size_t GetShardCount() const = 0;
         virtual IShard& GetShard(size_t shard) const = 0;
 
+        // Returns the IShardDefinition the index was configured with. Shards
+        // added by AddShard() do not appear in it.
         virtual IShardDefinition const & GetShardDefinition() const = 0;
 
+        //
+        // Online resharding.
+        //
+        // The ingestor routes documents to shards by posting count. Routing
+        // starts out as described by the IShardDefinition, and can be
+        // refined while the index is ingesting and serving queries.
+        //
+
+        // Returns the shard that receives new documents with the specified
+        // posting count.
+        virtual ShardId GetShardForPostingCount(size_t postingCount) const = 0;
+
+        // Uses the histogram of document posting counts ingested so far to
+        // choose a posting count at which to split an existing shard, using
+        // the same cost function as the offline ShardDefinitionBuilder.
+        // Returns zero if no split would reduce the cost.
+        virtual size_t ProposeShardBoundary(double shardOverhead) const = 0;
+
+        // Adds a shard for documents with at least minPostingCount postings,
+        // splitting the posting count range of the shard that currently
+        // receives them. The new shard uses the TermTable and slice buffer
+        // size of the shard it was split from. New documents are routed to
+        // the new shard immediately. Documents already in the index stay
+        // where they are until MigrateDocuments() moves them. Returns the
+        // ShardId of the new shard. Throws if minPostingCount is already a
+        // shard boundary or if the maximum number of shards is in use.
+        virtual ShardId AddShard(size_t minPostingCount) = 0;
+
+        // Moves documents that are not in the shard chosen for them by
+        // GetShardForPostingCount(). Only documents in the IDocumentCache
+        // can be moved, since their postings cannot be recovered from the
+        // index. Each document is ingested into its new shard, then expired
+        // from the old one before the new copy is activated, so a concurrent
+        // query never matches a moving document twice. Returns the number of
+        // documents moved.
+        virtual size_t MigrateDocuments() = 0;
+
         virtual IRecycler& GetRecycler() const = 0;
 
         virtual ITokenManager& GetTokenManager() const = 0;
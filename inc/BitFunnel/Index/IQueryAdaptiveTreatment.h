@@ -0,0 +1,72 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include "BitFunnel/Index/ITermTreatment.h"     // Base class.
+#include "BitFunnel/Term.h"                     // Term::Hash parameter.
+
+
+namespace BitFunnel
+{
+    class IQueryProfile;
+
+    //*************************************************************************
+    //
+    // IQueryAdaptiveTreatment
+    //
+    // An ITermTreatment whose RowConfigurations depend on query frequency as
+    // well as document frequency. Terms that are queried often may be given
+    // private rows, even when they are too rare to fill a row, and higher
+    // rank rows. These cost memory but reduce the number of quadwords read
+    // during matching. Terms that are never queried may be moved to shared
+    // adhoc rows.
+    //
+    // GetTreatment(Term::IdfX10) returns the configuration used for terms
+    // that are not in the query log, including adhoc terms.
+    //
+    // TermTableBuilder uses the per-term methods when it is passed an
+    // IQueryAdaptiveTreatment.
+    //
+    //*************************************************************************
+    class IQueryAdaptiveTreatment : public ITermTreatment
+    {
+    public:
+        using ITermTreatment::GetTreatment;
+
+        // Returns the RowConfiguration for a specific explicit term.
+        virtual RowConfiguration GetTreatment(Term::Hash hash,
+                                              Term::IdfX10 idf) const = 0;
+
+        // Returns true if every row of the term should be private,
+        // regardless of its frequency. A private term has one row at each
+        // rank of its RowConfiguration.
+        virtual bool IsPrivate(Term::Hash hash) const = 0;
+
+        // Returns true if a term that would otherwise be explicit is queried
+        // so rarely that it should share adhoc rows instead.
+        virtual bool IsAdhoc(Term::Hash hash, double frequency) const = 0;
+
+        // Returns the query log statistics used by this treatment.
+        virtual IQueryProfile const & GetQueryProfile() const = 0;
+    };
+}
@@ -0,0 +1,62 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <stddef.h>                 // size_t return value.
+#include <vector>                   // std::vector parameter.
+
+#include "BitFunnel/IInterface.h"   // Base class.
+#include "BitFunnel/Term.h"         // Term::Hash parameter.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // IQueryProfile
+    //
+    // Abstract base class or interface for classes that record the terms of
+    // the queries in a query log. Used by IQueryAdaptiveTreatment to give
+    // rows to terms according to how often they are queried as well as how
+    // often they appear in documents.
+    //
+    //*************************************************************************
+    class IQueryProfile : public IInterface
+    {
+    public:
+        // Records a query with the specified terms. A term that appears
+        // more than once in a query is counted once.
+        virtual void AddQuery(std::vector<Term::Hash> const & terms) = 0;
+
+        // Returns the number of queries recorded.
+        virtual size_t GetQueryCount() const = 0;
+
+        // Returns the fraction of recorded queries that contain the term.
+        virtual double GetQueryFrequency(Term::Hash hash) const = 0;
+
+        // Returns the distinct terms of each recorded query, in the order
+        // the queries were added.
+        virtual std::vector<std::vector<Term::Hash>> const &
+            GetQueries() const = 0;
+    };
+}
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <memory>                   // std::shared_ptr is a parameter.
+#include <stddef.h>                 // size_t return value.
 
 #include "BitFunnel/IInterface.h"
 #include "BitFunnel/NonCopyable.h"
@@ -48,6 +49,10 @@ namespace BitFunnel
         // Recycler takes ownership of the resource.
         virtual void ScheduleRecyling(std::unique_ptr<IRecyclable>& resource) = 0;
 
+        // Returns the number of resources scheduled for recycling that have
+        // not yet been recycled.
+        virtual size_t GetPendingCount() const = 0;
+
         virtual void Shutdown() = 0;
     };
 }
@@ -0,0 +1,64 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>                       // std::ostream parameter.
+#include <vector>                       // std::vector parameter.
+
+#include "BitFunnel/IInterface.h"       // Base class.
+#include "BitFunnel/Index/RowId.h"      // RowId parameter.
+
+
+namespace BitFunnel
+{
+    class ITermTable;
+
+    //*************************************************************************
+    //
+    // IRowPlacementOptimizer
+    //
+    // Renumbers the explicit rows of a TermTable so that rows which are
+    // frequently read by the same query sit next to each other in the
+    // RowTable. Each query then touches fewer distinct pages.
+    //
+    // Usage: call AddQuery() once for each query in a representative query
+    // log, then call Apply() to rewrite the TermTable.
+    //
+    //*************************************************************************
+    class IRowPlacementOptimizer : public IInterface
+    {
+    public:
+        // Records the rows read by one query. Adhoc, system and fact rows
+        // are ignored since their positions are fixed.
+        virtual void AddQuery(std::vector<RowId> const & rows) = 0;
+
+        // Computes a new row order for each rank and applies it to
+        // (termTable), which must be the TermTable passed to the factory or
+        // a copy of it.
+        virtual void Apply(ITermTable & termTable) = 0;
+
+        // Prints the number of distinct pages per query before and after
+        // Apply().
+        virtual void Print(std::ostream& output) const = 0;
+    };
+}
@@ -23,7 +23,9 @@
 #pragma once
 
 #include <cstddef>                      // ptrdiff_t return value.
+#include <functional>                   // std::function parameter.
 #include <iosfwd>                       // std::ostream parameter.
+#include <vector>                       // std::vector parameter.
 #include "BitFunnel/BitFunnelTypes.h"   // DocIndex return value.
 #include "BitFunnel/IInterface.h"       // Base class.
 #include "BitFunnel/Index/RowId.h"      // RowId parameter.
@@ -34,6 +36,7 @@ namespace BitFunnel
 {
     class DocumentHandle;
     class IFileManager;
+    class ITermTable;
     class ITermToText;
 
     class IShard : public IInterface
@@ -49,6 +52,9 @@ namespace BitFunnel
         // Return the size of the slice buffer in bytes.
         virtual size_t GetSliceBufferSize() const = 0;
 
+        // Returns the TermTable that maps terms to rows in this shard.
+        virtual ITermTable const & GetTermTable() const = 0;
+
         // Returns a vector of slice buffers for this shard.  The callers needs
         // to obtain a Token from ITokenManager to protect the pointer to the
         // list of slice buffers, as well as the buffers themselves.
@@ -57,6 +63,12 @@ namespace BitFunnel
         // Returns the offset of the row in the slice buffer in a shard.
         virtual ptrdiff_t GetRowOffset(RowId rowId) const = 0;
 
+        // Returns the position of the row's summary bit, in bits from the
+        // start of the slice buffer. The bit is set in a slice once any bit
+        // in the row has been set there, so a query can skip slices where
+        // one of its required rows is still empty.
+        virtual ptrdiff_t GetRowSummaryBitOffset(RowId rowId) const = 0;
+
         virtual void TemporaryWriteDocumentFrequencyTable(
             std::ostream& out,
             ITermToText const * termToText) const = 0;
@@ -91,10 +103,25 @@ namespace BitFunnel
         // recycling. Be sure to release iterator when finished.
         virtual std::unique_ptr<const_iterator> GetIterator() = 0;
 
+        // Callback for ForEachActive(). Receives a batch of DocumentHandles
+        // for active documents. The DocumentHandles are only valid for the
+        // duration of the call.
+        typedef std::function<void(std::vector<DocumentHandle> const &)>
+            ActiveDocumentCallback;
+
+        // Invokes callback with successive batches of up to batchSize
+        // DocumentHandles, covering every document currently active in the
+        // shard. This is the fast path for full shard scans. It holds a
+        // Token for the duration of the call, so callback should not block
+        // for long periods of time.
+        virtual void ForEachActive(ActiveDocumentCallback const & callback,
+                                   size_t batchSize) = 0;
+
         // Returns an std::vector containing the bit densities for each row in
         // the RowTable with the specified rank. Bit densities are computed
         // over all slices, for those columns that correspond to active
-        // documents.
+        // documents. At rank > 0, a column is considered active if any of
+        // the rank 0 documents it covers is active.
         virtual std::vector<double>
             GetDensities(Rank rank) const = 0;
     };
@@ -88,10 +88,27 @@ namespace BitFunnel
         virtual void SetTermTableCollection(
             std::unique_ptr<ITermTableCollection> termTables) = 0;
 
+        // Limits the memory used to gather document frequency statistics.
+        // When maxTerms is non-zero, each shard counts approximately the
+        // maxTerms most frequent terms exactly and drops or estimates the
+        // rest. The default, zero, counts every term exactly.
+        virtual void SetMaxStatisticsTerms(size_t maxTerms) = 0;
+
+        // Limits the memory used to gather document frequency statistics by
+        // a target error rather than a term count. The count of any term is
+        // overestimated by at most about maxPostingError times the number of
+        // postings ingested by its shard, not the number of documents. The
+        // resulting document frequency error is therefore about
+        // maxPostingError times the mean postings per document. Smaller
+        // values use more memory. maxPostingError must be in (0, 1].
+        virtual void SetMaxStatisticsPostingError(double maxPostingError) = 0;
+
         virtual void ConfigureForStatistics(char const * directory,
                                             size_t gramSize,
                                             bool generateTermToText) = 0;
 
+        // Note that an index configured for serving does not gather document
+        // frequency statistics during ingestion.
         virtual void ConfigureForServing(char const * directory,
                                          size_t gramSize,
                                          bool generateTermToText) = 0;
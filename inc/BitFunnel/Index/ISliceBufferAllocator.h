@@ -67,5 +67,13 @@ namespace BitFunnel
         // one for each shard. At this point this method may not be applicable
         // and can be removed.
         virtual size_t GetSliceBufferSize() const = 0;
+
+        // Returns the number of buffers currently allocated and not yet
+        // released.
+        virtual size_t GetInUseBuffersCount() const = 0;
+
+        // Returns the number of buffers in the pool, or 0 if the allocator
+        // has no fixed pool.
+        virtual size_t GetTotalBuffersCount() const = 0;
     };
 }
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <iosfwd>                                   // std::ostream parameter.
+#include <vector>                                   // std::vector parameter.
 
 #include "BitFunnel/IInterface.h"                   // Base class.
 #include "BitFunnel/Index/PackedRowIdSequence.h"    // PackedRowIdSequence return value.
@@ -119,6 +120,25 @@ namespace BitFunnel
         // facts, if applicable.
         virtual size_t GetTotalRowCount(Rank rank) const = 0;
 
+        // Returns the number of adhoc rows at (rank). Adhoc rows occupy the
+        // lowest RowIndex values and the explicit rows follow them, so this
+        // is also the offset Seal() added to each explicit RowIndex.
+        virtual size_t GetAdhocRowCount(Rank rank) const = 0;
+
+        // Returns the number of explicit rows at (rank) that belong to
+        // terms. This excludes the rows reserved for system terms and facts.
+        // These rows occupy the absolute RowIndex values starting at
+        // GetAdhocRowCount(rank).
+        virtual size_t GetExplicitRowCount(Rank rank) const = 0;
+
+        // Renumbers the explicit term rows at (rank) of a sealed TermTable.
+        // The row at offset i from the start of the explicit rows moves to
+        // offset mapping[i]. The mapping must be a permutation of
+        // [0, GetExplicitRowCount(rank)). Throws RecoverableError if it is
+        // not or if the TermTable does not own its image.
+        virtual void PermuteExplicitRows(Rank rank,
+                                         std::vector<RowIndex> const & mapping) = 0;
+
         // Returns the number of bytes of Row data required to store each
         // document using this TermTable.
         virtual double GetBytesPerDocument(Rank rank) const = 0;
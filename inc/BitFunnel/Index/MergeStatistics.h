@@ -0,0 +1,55 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <vector>   // std::vector parameter.
+
+
+namespace BitFunnel
+{
+    class IFileManager;
+
+    //*************************************************************************
+    //
+    // MergeStatistics
+    //
+    // Combines the partial statistics written by
+    // IIngestor::WritePartialStatistics() for several partitions of a corpus
+    // into the DocFreqTable, CumulativeTermCounts, DocumentHistogram and
+    // TermToText files that a single StatisticsBuilder run over the entire
+    // corpus would have produced.
+    //
+    // The PartialDocFreqTable files are ordered by term, so each shard is
+    // merged in a single streaming k-way pass that holds one row per
+    // partition in memory. Documents in partition i are numbered after all
+    // of the documents in partitions 0..i-1 when computing the Cumulative
+    // Term Counts.
+    //
+    // Every partition must have the same number of shards. Throws
+    // RecoverableError if the partitions are inconsistent.
+    //
+    //*************************************************************************
+    void MergeStatistics(std::vector<IFileManager*> const & partitions,
+                         IFileManager & output);
+}
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <memory>                   // Uses shared_ptr<T>
+#include <stddef.h>                 // size_t return value.
 
 #include "BitFunnel/NonCopyable.h"
 
@@ -159,6 +160,10 @@ namespace BitFunnel
         // and can be used to check for completion status of this tracker.
         virtual const std::shared_ptr<ITokenTracker> StartTracker() = 0;
 
+        // Returns the number of tokens that have been issued and not yet
+        // returned.
+        virtual size_t GetInFlightTokenCount() const = 0;
+
         // Performs shutdown of the TokenManager. This waits for all of the
         // tokens in existence to be returned. Users of the TokenManager must
         // call Shutdown() before destroying the object.
@@ -0,0 +1,132 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>                       // std::ostream parameter.
+#include <map>                          // std::map embedded.
+#include <stddef.h>                     // size_t embedded.
+#include <stdint.h>                     // uint64_t parameter.
+#include <vector>                       // std::vector embedded.
+
+#include "BitFunnel/BitFunnelTypes.h"   // ShardId embedded.
+#include "BitFunnel/Index/RowId.h"      // RowId embedded.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // ExecutionProfile
+    //
+    // Execution profile of a single query, gathered by the ByteCodeInterpreter
+    // for 'explain analyze'. For each row in the plan's RowSet the profile
+    // records the quadwords loaded, how often the accumulator was zero after
+    // the load and the fraction of loaded bits that were set. It also records
+    // how often each Jz instruction short-circuited the remainder of the
+    // plan, and the time spent matching each shard and each slice.
+    //
+    // The query engine calls StartShard() before matching each shard and
+    // FinishShard() after. The interpreter calls the Record methods.
+    //
+    //*************************************************************************
+    class ExecutionProfile
+    {
+    public:
+        struct RowStatistics
+        {
+            ShardId m_shard;
+            size_t m_row;               // Position in the RowSet.
+            RowId m_physicalRow;
+            size_t m_quadwordCount;
+            size_t m_zeroCount;         // Loads that left a zero accumulator.
+            size_t m_bitCount;          // Set bits in the loaded quadwords.
+
+            double GetDensity() const;
+        };
+
+        struct JumpStatistics
+        {
+            size_t m_instruction;       // Position in the byte code.
+            size_t m_row;               // Row loaded just before the jump.
+            size_t m_executedCount;
+            size_t m_firedCount;
+        };
+
+        struct SliceStatistics
+        {
+            ShardId m_shard;
+            size_t m_slice;             // Position among the scanned slices.
+            double m_seconds;
+            size_t m_quadwordCount;
+            size_t m_matchCount;
+        };
+
+        struct ShardStatistics
+        {
+            ShardId m_shard;
+            size_t m_sliceCount;
+            size_t m_scannedSliceCount; // Slices left by the summary filter.
+            double m_seconds;
+            size_t m_matchCount;
+        };
+
+        ExecutionProfile();
+
+        void SetInitialRank(Rank rank);
+
+        // physicalRows[i] is the physical row for RowSet row i in the shard.
+        void StartShard(ShardId shard,
+                        size_t sliceCount,
+                        size_t scannedSliceCount,
+                        std::vector<RowId> const & physicalRows);
+        void FinishShard(double seconds, size_t matchCount);
+
+        void RecordRowLoad(size_t row, uint64_t value, uint64_t accumulator);
+        void RecordJz(size_t instruction, size_t row, bool fired);
+        void RecordSlice(size_t slice, double seconds, size_t matchCount);
+
+        Rank GetInitialRank() const;
+        std::vector<RowStatistics> const & GetRows() const;
+        std::vector<JumpStatistics> GetJumps() const;
+        std::vector<SliceStatistics> const & GetSlices() const;
+        std::vector<ShardStatistics> const & GetShards() const;
+
+        // Writes the profile as a human readable report. Times are in
+        // microseconds.
+        void Print(std::ostream& out) const;
+
+    private:
+        Rank m_initialRank;
+
+        // Index into m_rows of row 0 for the current shard.
+        size_t m_shardRowStart;
+
+        // Quadwords loaded since the last call to RecordSlice().
+        size_t m_sliceQuadwordCount;
+
+        std::vector<RowStatistics> m_rows;
+        std::map<size_t, JumpStatistics> m_jumps;
+        std::vector<SliceStatistics> m_slices;
+        std::vector<ShardStatistics> m_shards;
+    };
+}
@@ -24,6 +24,7 @@
 
 #include <ostream>                          // std::ostream methods inlined.
 
+#include "BitFunnel/Utilities/HardwareCounters.h"  // HardwareCounters::Counter.
 #include "BitFunnel/Utilities/Stopwatch.h"  // Stopwatch embedded.
 
 
@@ -40,6 +41,19 @@ namespace BitFunnel
     public:
         class Data;
 
+        inline QueryInstrumentation()
+          : m_hardwareCounters(nullptr)
+        {
+        }
+
+        // Samples the specified counters around the matching phase and
+        // records their values in the Data. The counters must belong to the
+        // thread that runs the query. Pass nullptr to disable sampling.
+        inline void SetHardwareCounters(HardwareCounters* counters)
+        {
+            m_hardwareCounters = counters;
+        }
+
         inline void QuerySucceeded()
         {
             m_data.m_succeeded = true;
@@ -78,11 +92,33 @@ namespace BitFunnel
         inline void FinishPlanning()
         {
             m_data.m_planningTime = m_stopwatch.ElapsedTime() - m_data.m_parsingTime;
+
+            if (m_hardwareCounters != nullptr)
+            {
+                m_hardwareCounters->Start();
+            }
         }
 
         inline void FinishMatching()
         {
-            m_data.m_matchingTime = m_stopwatch.ElapsedTime() - m_data.m_planningTime;
+            // Read the clock before stopping the counters, so that the
+            // matching time does not include the cost of reading them.
+            const double elapsedTime = m_stopwatch.ElapsedTime();
+
+            if (m_hardwareCounters != nullptr)
+            {
+                m_hardwareCounters->Stop();
+                for (size_t i = 0; i < HardwareCounters::CounterCount; ++i)
+                {
+                    auto counter = static_cast<HardwareCounters::Counter>(i);
+                    m_data.m_hasHardwareCounter[i] =
+                        m_hardwareCounters->IsAvailable(counter);
+                    m_data.m_hardwareCounters[i] =
+                        m_hardwareCounters->GetValue(counter);
+                }
+            }
+
+            m_data.m_matchingTime = elapsedTime - m_data.m_planningTime;
         }
 
         inline Data & GetData()
@@ -103,6 +139,11 @@ namespace BitFunnel
                 m_planningTime(0.0),
                 m_matchingTime(0.0)
             {
+                for (size_t i = 0; i < HardwareCounters::CounterCount; ++i)
+                {
+                    m_hasHardwareCounter[i] = false;
+                    m_hardwareCounters[i] = 0;
+                }
             }
 
             Data & operator=(Data const & other)
@@ -115,6 +156,11 @@ namespace BitFunnel
                 m_parsingTime = other.m_parsingTime;
                 m_planningTime = other.m_planningTime;
                 m_matchingTime = other.m_matchingTime;
+                for (size_t i = 0; i < HardwareCounters::CounterCount; ++i)
+                {
+                    m_hasHardwareCounter[i] = other.m_hasHardwareCounter[i];
+                    m_hardwareCounters[i] = other.m_hardwareCounters[i];
+                }
                 return *this;
             }
 
@@ -158,6 +204,17 @@ namespace BitFunnel
                 return m_matchingTime;
             }
 
+            // Returns true if the counter was sampled during matching.
+            inline bool HasHardwareCounter(HardwareCounters::Counter counter)
+            {
+                return m_hasHardwareCounter[counter];
+            }
+
+            inline uint64_t GetHardwareCounter(HardwareCounters::Counter counter)
+            {
+                return m_hardwareCounters[counter];
+            }
+
             static void FormatHeader(CsvTsv::CsvTableFormatter & formatter);
             void Format(CsvTsv::CsvTableFormatter & formatter) const;
 
@@ -172,9 +229,12 @@ namespace BitFunnel
             double m_parsingTime;
             double m_planningTime;
             double m_matchingTime;
+            bool m_hasHardwareCounter[HardwareCounters::CounterCount];
+            uint64_t m_hardwareCounters[HardwareCounters::CounterCount];
         };
 
     private:
+        HardwareCounters* m_hardwareCounters;
         Stopwatch m_stopwatch;
         Data m_data;
     };
@@ -0,0 +1,53 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <vector>                       // std::vector parameter.
+
+#include "BitFunnel/Index/RowId.h"      // RowId template parameter.
+#include "BitFunnel/Term.h"             // Term template parameter.
+
+
+namespace BitFunnel
+{
+    class IConfiguration;
+    class ITermTable;
+    class TermMatchNode;
+
+    // Appends to (terms) every Term that a query with match tree (tree)
+    // looks up in the TermTable. Phrases contribute each of their n-grams,
+    // in the same way as TermMatchTreeConverter. Fact nodes are skipped.
+    // Terms are appended in tree order and may repeat.
+    void GetQueryTerms(TermMatchNode const & tree,
+                       IConfiguration const & configuration,
+                       std::vector<Term>& terms);
+
+    // Appends to (rows) every RowId that a query with match tree (tree)
+    // reads from (termTable). Phrases contribute the rows of each of their
+    // n-grams, in the same way as TermMatchTreeConverter. Fact nodes are
+    // skipped. RowIds are appended in tree order and may repeat.
+    void GetQueryRows(TermMatchNode const & tree,
+                      IConfiguration const & configuration,
+                      ITermTable const & termTable,
+                      std::vector<RowId>& rows);
+}
@@ -24,10 +24,14 @@
 
 #include <vector>       // std::vector parameter
 
+#include "BitFunnel/Plan/QueryInstrumentation.h"    // QueryInstrumentation::Data return value.
+#include "BitFunnel/Utilities/LatencyHistogram.h"   // LatencyHistogram member.
+
 
 namespace BitFunnel
 {
     class ISimpleIndex;
+    class ExecutionProfile;
 
     class QueryRunner
     {
@@ -42,10 +46,26 @@ namespace BitFunnel
                        double elapsedTime,
                        double parsingTime,
                        double planningTime,
-                       double matchingTime);
+                       double matchingTime,
+                       LatencyHistogram const & parsingHistogram,
+                       LatencyHistogram const & planningHistogram,
+                       LatencyHistogram const & matchingHistogram,
+                       LatencyHistogram const & totalHistogram);
 
+            // Prints the aggregate statistics followed by a table of
+            // per-query latency percentiles for each pipeline stage.
             void Print(std::ostream& out) const;
 
+            // Returns the number of queries processed per second of
+            // elapsed time.
+            double GetQueriesPerSecond() const;
+
+            size_t GetProcessedCount() const;
+
+            // Returns the distribution of parse, plan and match time for
+            // successful queries.
+            LatencyHistogram const & GetTotalHistogram() const;
+
         private:
             const size_t m_threadCount;
             const size_t m_uniqueQueryCount;
@@ -55,6 +75,56 @@ namespace BitFunnel
             double m_parsingLatency;
             double m_planningLatency;
             double m_matchingLatency;
+
+            // Distributions of per-query latencies for successful queries.
+            LatencyHistogram m_parsingHistogram;
+            LatencyHistogram m_planningHistogram;
+            LatencyHistogram m_matchingHistogram;
+            LatencyHistogram m_totalHistogram;
+        };
+
+
+        // How RunOpenLoop() spaces request arrivals.
+        enum ArrivalProcess
+        {
+            // Exponentially distributed inter-arrival times.
+            PoissonArrivals,
+
+            // Evenly spaced arrivals.
+            FixedRateArrivals
+        };
+
+
+        // Results of one open loop run at a single offered load.
+        class LoadStatistics
+        {
+        public:
+            LoadStatistics(double targetQps,
+                           size_t offeredCount,
+                           size_t processedCount,
+                           double elapsedTime,
+                           LatencyHistogram const & responseTime,
+                           LatencyHistogram const & serviceTime);
+
+            // Prints the column headings for a table of PrintRow() output.
+            static void PrintHeader(std::ostream& out);
+
+            // Prints one row of a latency versus load table: target and
+            // achieved QPS, mean service time and response time percentiles,
+            // in microseconds.
+            void PrintRow(std::ostream& out) const;
+
+            double GetQueriesPerSecond() const;
+            size_t GetProcessedCount() const;
+            LatencyHistogram const & GetResponseTimeHistogram() const;
+
+        private:
+            double m_targetQps;
+            size_t m_offeredCount;
+            size_t m_processedCount;
+            double m_elapsedTime;
+            LatencyHistogram m_responseTime;
+            LatencyHistogram m_serviceTime;
         };
 
 
@@ -62,7 +132,17 @@ namespace BitFunnel
             char const * query,
             ISimpleIndex const & index,
             bool useNativeCode,
-            bool countCacheLines);
+            bool countCacheLines,
+            bool countHardwareEvents);
+
+        // Runs a single query in the ByteCodeInterpreter, recording the per
+        // row, per Jz, per shard and per slice profile for 'explain
+        // analyze'. The interpreter performs the same row loads as the native
+        // matcher, but its times are only comparable with each other.
+        static QueryInstrumentation::Data Explain(
+            char const * query,
+            ISimpleIndex const & index,
+            ExecutionProfile & profile);
 
         static Statistics Run(ISimpleIndex const & index,
                               char const * outputDir,
@@ -70,6 +150,39 @@ namespace BitFunnel
                               std::vector<std::string> const & queries,
                               size_t iterations,
                               bool useNativeCode,
-                              bool countCacheLines);
+                              bool countCacheLines,
+                              bool countHardwareEvents);
+
+        // Runs queries open loop. Unlike Run(), which issues each query as
+        // soon as a thread is free, RunOpenLoop() schedules arrivals at
+        // targetQps for duration seconds, independent of completions.
+        // Arrivals wait in a queue of at most queueCapacity requests in
+        // front of threadCount worker threads. Response times are measured
+        // from each request's scheduled arrival time, so queueing delay is
+        // included and coordinated omission is avoided. Queries are issued
+        // in log order, wrapping as needed.
+        static LoadStatistics RunOpenLoop(ISimpleIndex const & index,
+                                          size_t threadCount,
+                                          std::vector<std::string> const & queries,
+                                          double targetQps,
+                                          double duration,
+                                          ArrivalProcess arrivals,
+                                          size_t queueCapacity,
+                                          bool useNativeCode);
+
+        // As above, but sizes each worker's ResultsBuffer for
+        // maxResultCount documents instead of the index's current document
+        // count. Use this overload when documents are ingested during the
+        // run, with maxResultCount covering every document that may be
+        // added before the run ends.
+        static LoadStatistics RunOpenLoop(ISimpleIndex const & index,
+                                          size_t threadCount,
+                                          std::vector<std::string> const & queries,
+                                          double targetQps,
+                                          double duration,
+                                          ArrivalProcess arrivals,
+                                          size_t queueCapacity,
+                                          bool useNativeCode,
+                                          size_t maxResultCount);
     };
 }
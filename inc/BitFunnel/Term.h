@@ -74,6 +74,16 @@ namespace BitFunnel
         // body stream, etc.).
         typedef uint8_t StreamId;
 
+        // Functions that may be used to compute a term's raw hash from its
+        // text. MurmurHash64A is the default, so term tables and statistics
+        // built before the choice existed remain valid. The same function
+        // must be used to build and to serve an index.
+        enum class HashFunction
+        {
+            MurmurHash64A,
+            XXHash64
+        };
+
 
         // Number of bits required to represent a GramSize.
         static const GramSize c_log2MaxGramSize = 3;
@@ -178,7 +188,28 @@ namespace BitFunnel
                                        StreamId stream);
 
         // Computes the raw hash (based on term characters only) for the specified term text.
+        // The first form uses HashFunction::MurmurHash64A.
         static Hash ComputeRawHash(const char* text);
+        static Hash ComputeRawHash(const char* text, HashFunction function);
+
+        // Computes the raw hashes of count terms at once, writing them to
+        // hashes. The results are identical to calling ComputeRawHash() on
+        // each text, but MurmurHash64A hashes are computed four at a time.
+        // The first form uses HashFunction::MurmurHash64A.
+        static void ComputeRawHashes(char const * const * texts,
+                                     size_t const * lengths,
+                                     size_t count,
+                                     Hash* hashes);
+        static void ComputeRawHashes(char const * const * texts,
+                                     size_t const * lengths,
+                                     size_t count,
+                                     HashFunction function,
+                                     Hash* hashes);
+
+        // Returns the raw hash of the ngram formed by appending a term with
+        // raw hash termHash to an ngram with raw hash ngramHash. This is the
+        // combining step used by AddTerm().
+        static Hash ExtendNGramHash(Hash ngramHash, Hash termHash);
 
         // Hasher for std::unordered_set.
         // Definition is inlined for use by template.
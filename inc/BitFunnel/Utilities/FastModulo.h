@@ -0,0 +1,170 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <stdint.h>     // uint64_t member.
+
+#ifdef _MSC_VER
+#include <intrin.h>     // __umulh().
+#endif
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // FastModulo computes x / d and x % d for a fixed 64-bit divisor d using
+    // a multiply and shift in place of the hardware divide instruction.
+    //
+    // The reciprocal is computed once by the constructor, so FastModulo is
+    // intended for divisors that are set up once and then used many times,
+    // e.g. the number of adhoc rows at each rank in a TermTable. The results
+    // are exactly equal to x / d and x % d for all 64-bit values of x.
+    //
+    // The algorithm is the round-up method of Granlund and Montgomery, as
+    // popularized by libdivide. Divisors that are powers of two reduce to a
+    // shift.
+    //
+    //*************************************************************************
+    class FastModulo
+    {
+    public:
+        // Constructs a FastModulo for the divisor 1.
+        FastModulo()
+          : FastModulo(1)
+        {
+        }
+
+
+        // Constructs a FastModulo for divisor, which must not be zero.
+        explicit FastModulo(uint64_t divisor)
+          : m_divisor(divisor),
+            m_magic(0),
+            m_shift(0),
+            m_add(false)
+        {
+            unsigned log2Divisor = 0;
+            while ((divisor >> log2Divisor) > 1)
+            {
+                ++log2Divisor;
+            }
+            m_shift = log2Divisor;
+
+            if ((divisor & (divisor - 1)) != 0)
+            {
+                // magic = floor(2^(64 + log2Divisor) / divisor) + 1, with
+                // one extra bit of precision where the shorter magic number
+                // would round incorrectly.
+                uint64_t remainder;
+                uint64_t magic = Divide128(1ull << log2Divisor,
+                                           0,
+                                           divisor,
+                                           remainder);
+                const uint64_t e = divisor - remainder;
+                if (e >= (1ull << log2Divisor))
+                {
+                    magic += magic;
+                    const uint64_t twiceRemainder = remainder + remainder;
+                    if (twiceRemainder >= divisor || twiceRemainder < remainder)
+                    {
+                        magic += 1;
+                    }
+                    m_add = true;
+                }
+                m_magic = magic + 1;
+            }
+        }
+
+
+        uint64_t Divide(uint64_t x) const
+        {
+            if (m_magic == 0)
+            {
+                return x >> m_shift;
+            }
+
+            const uint64_t q = MultiplyHigh(m_magic, x);
+            if (m_add)
+            {
+                return (((x - q) >> 1) + q) >> m_shift;
+            }
+            return q >> m_shift;
+        }
+
+
+        uint64_t Modulo(uint64_t x) const
+        {
+            return x - Divide(x) * m_divisor;
+        }
+
+
+        uint64_t GetDivisor() const
+        {
+            return m_divisor;
+        }
+
+    private:
+        // Returns the high 64 bits of the 128-bit product a * b.
+        static uint64_t MultiplyHigh(uint64_t a, uint64_t b)
+        {
+#ifdef _MSC_VER
+            return __umulh(a, b);
+#else
+            return static_cast<uint64_t>(
+                (static_cast<unsigned __int128>(a) * b) >> 64);
+#endif
+        }
+
+
+        // Divides the 128-bit value (high, low) by divisor, using restoring
+        // long division. Requires high < divisor, so that the quotient fits
+        // in 64 bits. Only used by the constructor.
+        static uint64_t Divide128(uint64_t high,
+                                  uint64_t low,
+                                  uint64_t divisor,
+                                  uint64_t& remainder)
+        {
+            uint64_t r = high;
+            uint64_t q = 0;
+            for (int bit = 63; bit >= 0; --bit)
+            {
+                const bool carry = (r >> 63) != 0;
+                r = (r << 1) | ((low >> bit) & 1);
+                q <<= 1;
+                if (carry || r >= divisor)
+                {
+                    r -= divisor;
+                    q |= 1;
+                }
+            }
+            remainder = r;
+            return q;
+        }
+
+        uint64_t m_divisor;
+        uint64_t m_magic;
+        unsigned m_shift;
+        bool m_add;
+    };
+}
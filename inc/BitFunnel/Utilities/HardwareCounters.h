@@ -0,0 +1,92 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>                  // uint64_t member.
+
+#include "BitFunnel/NonCopyable.h"  // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // HardwareCounters
+    //
+    // Reads CPU performance monitoring counters for the calling thread. On
+    // Linux the counters are opened as a single perf_event_open() group so
+    // that they are scheduled onto the PMU together and can be read with one
+    // system call. Only user-mode events of the thread that constructed the
+    // HardwareCounters are counted, so each thread needs its own instance.
+    //
+    // Counters that the host does not support, or that it does not permit
+    // (e.g. perf_event_paranoid, containers, virtual machines without a
+    // virtual PMU), are reported as unavailable rather than treated as an
+    // error. On platforms without perf_event_open() no counters are
+    // available.
+    //
+    //*************************************************************************
+    class HardwareCounters : public NonCopyable
+    {
+    public:
+        enum Counter
+        {
+            Cycles,
+            Instructions,
+            LastLevelCacheMisses,
+            DataTlbMisses,
+            BranchMisses,
+            CounterCount
+        };
+
+        HardwareCounters();
+        ~HardwareCounters();
+
+        // Returns true if at least one counter could be opened.
+        bool IsAvailable() const;
+
+        // Returns true if the specified counter could be opened.
+        bool IsAvailable(Counter counter) const;
+
+        // Zeroes and enables the counters.
+        void Start();
+
+        // Disables the counters and captures their values.
+        void Stop();
+
+        // Returns the number of events counted between the most recent calls
+        // to Start() and Stop(). Returns 0 for unavailable counters.
+        uint64_t GetValue(Counter counter) const;
+
+        // Returns the name used for the counter in reports.
+        static char const * GetName(Counter counter);
+
+    private:
+        // Index of the group leader in m_fileDescriptors, or -1 if no
+        // counters are available.
+        int m_leader;
+        int m_fileDescriptors[CounterCount];
+        uint64_t m_values[CounterCount];
+    };
+}
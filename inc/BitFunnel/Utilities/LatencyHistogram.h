@@ -0,0 +1,112 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <cstdint>      // uint64_t member.
+#include <iosfwd>       // std::ostream parameter.
+#include <vector>       // std::vector member.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // LatencyHistogram
+    //
+    // Log-linear histogram of latencies in the style of HdrHistogram. Values
+    // are recorded with nanosecond resolution into buckets whose width grows
+    // with the magnitude of the value, so that every recorded value is
+    // represented with a relative error of less than 1%, regardless of
+    // whether it is a microsecond or a minute.
+    //
+    // Record() is not thread safe. The intended pattern is for each thread
+    // to fill its own histogram without synchronization and for the owner to
+    // Merge() them once the threads have finished.
+    //
+    //*************************************************************************
+    class LatencyHistogram
+    {
+    public:
+        LatencyHistogram();
+
+        // Records a latency, specified in seconds. Negative values are
+        // recorded as zero and values beyond the largest trackable value
+        // are clamped to it.
+        void Record(double seconds);
+
+        // Adds all of the values recorded in other to this histogram.
+        void Merge(LatencyHistogram const & other);
+
+        // Returns the number of values recorded.
+        uint64_t GetCount() const;
+
+        // Returns the largest value recorded, in seconds.
+        double GetMax() const;
+
+        // Returns the mean of the values recorded, in seconds.
+        double GetMean() const;
+
+        // Returns the sum of the values recorded, in seconds.
+        double GetSum() const;
+
+        // Returns the number of recorded values known to be less than or
+        // equal to the specified number of seconds. Values in the bucket
+        // that straddles the limit are not counted, so the result may be low
+        // by the values within 1% of the limit.
+        uint64_t GetCountAtOrBelow(double seconds) const;
+
+        // Returns the smallest value, in seconds, such that at least the
+        // specified percentage of recorded values are less than or equal
+        // to it. Returns 0 if the histogram is empty.
+        double GetPercentile(double percentile) const;
+
+        // Writes a table of the common tail percentiles for each of the
+        // histograms, one column per histogram. Values are written in
+        // microseconds.
+        static void WritePercentiles(
+            std::ostream& out,
+            std::vector<char const *> const & names,
+            std::vector<LatencyHistogram const *> const & histograms);
+
+    private:
+        static size_t GetBucket(uint64_t nanoseconds);
+        static uint64_t GetHighestEquivalentValue(size_t bucket);
+
+        // Each power of two is split into 2^(c_subBucketBits - 1) linear
+        // buckets, giving a worst case relative error of 2^-(c_subBucketBits-1).
+        static const unsigned c_subBucketBits = 8;
+        static const size_t c_subBucketHalfCount = 1ull << (c_subBucketBits - 1);
+
+        // Values up to 2^c_maxValueBits nanoseconds (about 18 minutes) are
+        // tracked precisely.
+        static const unsigned c_maxValueBits = 40;
+        static const size_t c_bucketCount =
+            (c_maxValueBits - c_subBucketBits + 2) * c_subBucketHalfCount;
+
+        std::vector<uint64_t> m_counts;
+        uint64_t m_totalCount;
+        uint64_t m_maxValue;
+        double m_sum;
+    };
+}
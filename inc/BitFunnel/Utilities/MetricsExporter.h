@@ -0,0 +1,90 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>                   // std::atomic member.
+#include <condition_variable>       // std::condition_variable member.
+#include <mutex>                    // std::mutex member.
+#include <stddef.h>                 // size_t return value.
+#include <string>                   // std::string member.
+#include <thread>                   // std::thread member.
+
+#include "BitFunnel/NonCopyable.h"  // Base class.
+
+
+namespace BitFunnel
+{
+    class MetricsRegistry;
+
+    //*************************************************************************
+    //
+    // MetricsExporter
+    //
+    // Writes a MetricsRegistry to a local file every intervalSeconds from a
+    // background thread, e.g. for the node exporter's textfile collector.
+    // Each snapshot is written to <path>.tmp and then renamed over <path>
+    // so that a scraper never reads a partially written file.
+    //
+    // The file is written with the standard library rather than an
+    // IFileSystem since its consumer is outside the process.
+    //
+    // The registry must outlive the MetricsExporter. The destructor writes a
+    // final snapshot and stops the thread.
+    //
+    //*************************************************************************
+    class MetricsExporter : public NonCopyable
+    {
+    public:
+        MetricsExporter(MetricsRegistry const & registry,
+                        char const * path,
+                        double intervalSeconds);
+        ~MetricsExporter();
+
+        // Writes a snapshot immediately. Returns false if the file could
+        // not be written.
+        bool WriteSnapshot();
+
+        size_t GetSnapshotCount() const;
+        size_t GetFailureCount() const;
+
+    private:
+        void ThreadEntry();
+
+        MetricsRegistry const & m_registry;
+        const std::string m_path;
+        const double m_intervalSeconds;
+
+        std::atomic<size_t> m_snapshotCount;
+        std::atomic<size_t> m_failureCount;
+
+        // Serializes snapshots from the thread and from WriteSnapshot().
+        std::mutex m_writeLock;
+
+        std::mutex m_lock;
+        std::condition_variable m_condition;
+        bool m_stopping;
+
+        std::thread m_thread;
+    };
+}
@@ -0,0 +1,153 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>                                   // std::atomic member.
+#include <functional>                               // std::function parameter.
+#include <iosfwd>                                   // std::ostream parameter.
+#include <map>                                      // std::map member.
+#include <memory>                                   // std::unique_ptr member.
+#include <mutex>                                    // std::mutex member.
+#include <stdint.h>                                 // uint64_t member.
+#include <string>                                   // std::string key.
+
+#include "BitFunnel/NonCopyable.h"                  // Base class.
+#include "BitFunnel/Utilities/LatencyHistogram.h"   // LatencyHistogram member.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // MetricsRegistry
+    //
+    // Named counters, gauges and latency histograms for a long running
+    // index, written out in the Prometheus text exposition format.
+    //
+    // Metrics come in two flavors. Counter, Gauge and Histogram objects are
+    // updated by the code that observes the events, e.g. a query thread
+    // recording its latency. Function metrics, added with AddCounter() and
+    // AddGauge(), are read from their owner each time the registry is
+    // written, e.g. the number of documents an IIngestor has ingested.
+    // The owner of a function metric must outlive every call to Write().
+    //
+    // Counters are cumulative totals. Rates such as documents ingested or
+    // queries processed per second are left to the consumer, e.g.
+    // Prometheus' rate() function.
+    //
+    // Metric names must match [a-zA-Z_:][a-zA-Z0-9_:]*. Requesting an
+    // existing name returns the existing metric if it has the same type and
+    // throws a RecoverableError otherwise. Adding a function metric with an
+    // existing name replaces the function.
+    //
+    // This class is thread safe.
+    //
+    //*************************************************************************
+    class MetricsRegistry : public NonCopyable
+    {
+    public:
+        class Counter : public NonCopyable
+        {
+        public:
+            Counter();
+
+            void Increment();
+            void Increment(uint64_t count);
+
+            uint64_t GetValue() const;
+
+        private:
+            std::atomic<uint64_t> m_value;
+        };
+
+
+        class Gauge : public NonCopyable
+        {
+        public:
+            Gauge();
+
+            void Set(double value);
+
+            double GetValue() const;
+
+        private:
+            std::atomic<double> m_value;
+        };
+
+
+        // Histogram of durations in seconds. Written as a Prometheus
+        // histogram with buckets from 10us to 10s.
+        class Histogram : public NonCopyable
+        {
+        public:
+            void Observe(double seconds);
+
+            // Adds every value recorded in histogram.
+            void Merge(LatencyHistogram const & histogram);
+
+            LatencyHistogram GetSnapshot() const;
+
+        private:
+            mutable std::mutex m_lock;
+            LatencyHistogram m_histogram;
+        };
+
+
+        MetricsRegistry();
+        ~MetricsRegistry();
+
+        Counter& GetCounter(char const * name, char const * help);
+        Gauge& GetGauge(char const * name, char const * help);
+        Histogram& GetHistogram(char const * name, char const * help);
+
+        void AddCounter(char const * name,
+                        char const * help,
+                        std::function<double()> const & value);
+        void AddGauge(char const * name,
+                      char const * help,
+                      std::function<double()> const & value);
+
+        // Writes every metric, in name order, in the Prometheus text
+        // exposition format.
+        void Write(std::ostream& output) const;
+
+    private:
+        enum Type
+        {
+            CounterType,
+            GaugeType,
+            HistogramType,
+            CounterFunctionType,
+            GaugeFunctionType
+        };
+
+        class Metric;
+
+        // Must be called with m_lock held.
+        Metric& GetMetric(char const * name, char const * help, Type type);
+
+        mutable std::mutex m_lock;
+        std::map<std::string, std::unique_ptr<Metric>> m_metrics;
+    };
+}
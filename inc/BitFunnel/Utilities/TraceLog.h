@@ -0,0 +1,118 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <iosfwd>                   // std::ostream parameter.
+#include <stddef.h>                 // size_t return value.
+
+#include "BitFunnel/NonCopyable.h"  // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // TraceLog
+    //
+    // Process-wide timeline of begin and end events used to see how the
+    // ingestion threads, the Recycler thread and the query threads overlap
+    // in time. Each thread records into its own fixed size ring buffer of
+    // timestamped events, so recording takes no locks and never allocates
+    // after a thread's first event. When a thread's buffer fills, its oldest
+    // events are overwritten.
+    //
+    // When a thread exits, its buffer goes to a free list and is reused by
+    // the next thread to record, so memory is bounded by the peak number of
+    // threads recording at once rather than by the number of threads ever
+    // created. Events from the exited thread remain in the buffer, on the
+    // same track as the new thread's, until they are overwritten.
+    //
+    // Tracing is disabled by default. While disabled, Begin() and End() cost
+    // a single relaxed atomic load.
+    //
+    // Category and name must be string literals (or otherwise outlive the
+    // TraceLog) that need no escaping in JSON, since only their addresses
+    // are recorded.
+    //
+    // Events are written out in the Chrome trace event format, which can be
+    // loaded into chrome://tracing or https://ui.perfetto.dev. Each traced
+    // thread appears as its own track.
+    //
+    //*************************************************************************
+    class TraceLog
+    {
+    public:
+        static void Enable();
+        static void Disable();
+        static bool IsEnabled();
+
+        // Records the start and end of a span on the calling thread.
+        static void Begin(char const * category, char const * name);
+        static void End(char const * category, char const * name);
+
+        // Discards all events recorded so far.
+        static void Clear();
+
+        // Returns the number of events that WriteChromeTrace() would write.
+        static size_t GetEventCount();
+
+        // Returns the number of per-thread buffers allocated so far.
+        static size_t GetBufferCount();
+
+        // Writes the retained events of every thread as a Chrome trace event
+        // JSON object. Events recorded concurrently with the call may or may
+        // not be included.
+        static void WriteChromeTrace(std::ostream& output);
+    };
+
+
+    //*************************************************************************
+    //
+    // TraceScope
+    //
+    // Records a TraceLog span covering the lifetime of the TraceScope. The
+    // end event is only recorded if the begin event was, so enabling or
+    // disabling tracing inside a scope does not leave an unmatched event.
+    //
+    // End() closes the span early, for spans that end before the objects
+    // they construct go out of scope. The destructor still closes the span
+    // if an exception is thrown before End() is reached.
+    //
+    //*************************************************************************
+    class TraceScope : public NonCopyable
+    {
+    public:
+        TraceScope(char const * category, char const * name);
+        ~TraceScope();
+
+        // Records the end event now rather than in the destructor. Calls
+        // after the first have no effect.
+        void End();
+
+    private:
+        char const * m_category;
+        char const * m_name;
+        bool m_enabled;
+    };
+}
@@ -87,4 +87,16 @@ namespace BitFunnel
                     processor);
 
     }
+
+
+    void BuiltinChunkManifest::Flush() const
+    {
+        // BuiltinChunkManifest ingests every document in IngestChunk().
+    }
+
+
+    void BuiltinChunkManifest::PrintStatistics(std::ostream & /*out*/) const
+    {
+        // BuiltinChunkManifest does not gather any statistics.
+    }
 }
@@ -50,6 +50,10 @@ namespace BitFunnel
 
         virtual void IngestChunk(size_t index) const override;
 
+        virtual void Flush() const override;
+
+        virtual void PrintStatistics(std::ostream & out) const override;
+
     private:
 
         //
@@ -27,6 +27,7 @@
 #include "BitFunnel/Index/IDocumentCache.h"
 #include "BitFunnel/Index/IIngestor.h"
 #include "ChunkIngestor.h"
+#include "DocumentReorderer.h"
 
 
 namespace BitFunnel
@@ -45,7 +46,24 @@ namespace BitFunnel
         m_ingestor(ingestor),
         m_cacheDocuments(cacheDocuments),
         m_filter(filter),
-        m_chunkWriter(chunkWriter)
+        m_chunkWriter(chunkWriter),
+        m_reorderBuffer(nullptr)
+    {
+    }
+
+
+    ChunkIngestor::ChunkIngestor(IConfiguration const & config,
+                                 IIngestor& ingestor,
+                                 bool cacheDocuments,
+                                 IDocumentFilter & filter,
+                                 IChunkWriter * chunkWriter,
+                                 DocumentReorderBuffer * reorderBuffer)
+      : m_config(config),
+        m_ingestor(ingestor),
+        m_cacheDocuments(cacheDocuments),
+        m_filter(filter),
+        m_chunkWriter(chunkWriter),
+        m_reorderBuffer(reorderBuffer)
     {
     }
 
@@ -91,6 +109,12 @@ namespace BitFunnel
                 // If we have an IChunkWriter, write the current document.
                 m_chunkWriter->Write(*m_currentDocument, start, length);
             }
+            else if (m_reorderBuffer != nullptr)
+            {
+                // Otherwise, if reordering, buffer the document until
+                // its shard has a slice's worth.
+                m_reorderBuffer->Add(std::move(m_currentDocument));
+            }
             else
             {
                 // Otherwise, ingest the current document.
@@ -31,6 +31,7 @@
 
 namespace BitFunnel
 {
+    class DocumentReorderBuffer;
     class IConfiguration;
     class IIngestor;
 
@@ -44,6 +45,17 @@ namespace BitFunnel
                       IDocumentFilter & filter,
                       IChunkWriter * chunkWriter);
 
+        // When reorderBuffer is not nullptr, documents are passed to it
+        // instead of being ingested directly. It ingests them a slice's
+        // worth at a time, in an order that places similar documents at
+        // adjacent DocIndexes.
+        ChunkIngestor(IConfiguration const & configuration,
+                      IIngestor& ingestor,
+                      bool cacheDocuments,
+                      IDocumentFilter & filter,
+                      IChunkWriter * chunkWriter,
+                      DocumentReorderBuffer * reorderBuffer);
+
         //
         // IChunkProcessor methods.
         //
@@ -66,6 +78,7 @@ namespace BitFunnel
         bool m_cacheDocuments;
         IDocumentFilter & m_filter;         // TODO: What about multi-threaded access?
         IChunkWriter * m_chunkWriter;
+        DocumentReorderBuffer * m_reorderBuffer;
 
         //
         // Other members
@@ -29,9 +29,11 @@
 #include "BitFunnel/Configuration/IFileSystem.h"
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Utilities/TraceLog.h"
 #include "ChunkIngestor.h"
 #include "ChunkManifestIngestor.h"
 #include "ChunkReader.h"
+#include "DocumentReorderer.h"
 
 
 namespace BitFunnel
@@ -53,7 +55,31 @@ namespace BitFunnel
                                       config,
                                       ingestor,
                                       filter,
-                                      cacheDocuments));
+                                      cacheDocuments,
+                                      false));
+    }
+
+
+    std::unique_ptr<IChunkManifestIngestor>
+        Factories::CreateChunkManifestIngestor(
+            IFileSystem& fileSystem,
+            IChunkWriterFactory* chunkWriterFactory,
+            std::vector<std::string> const & filePaths,
+            IConfiguration const & config,
+            IIngestor& ingestor,
+            IDocumentFilter & filter,
+            bool cacheDocuments,
+            bool reorderDocuments)
+    {
+        return std::unique_ptr<IChunkManifestIngestor>(
+            new ChunkManifestIngestor(fileSystem,
+                                      chunkWriterFactory,
+                                      filePaths,
+                                      config,
+                                      ingestor,
+                                      filter,
+                                      cacheDocuments,
+                                      reorderDocuments));
     }
 
 
@@ -64,14 +90,23 @@ namespace BitFunnel
         IConfiguration const & config,
         IIngestor& ingestor,
         IDocumentFilter & filter,
-        bool cacheDocuments)
+        bool cacheDocuments,
+        bool reorderDocuments)
       : m_fileSystem(fileSystem),
         m_chunkWriterFactory(chunkWriterFactory),
         m_filePaths(filePaths),
         m_configuration(config),
         m_ingestor(ingestor),
         m_filter(filter),
-        m_cacheDocuments(cacheDocuments)
+        m_cacheDocuments(cacheDocuments),
+        m_reorderBuffer(reorderDocuments ?
+                        new DocumentReorderBuffer(ingestor, cacheDocuments) :
+                        nullptr)
+    {
+    }
+
+
+    ChunkManifestIngestor::~ChunkManifestIngestor()
     {
     }
 
@@ -93,31 +128,37 @@ namespace BitFunnel
         // TODO: this library method should not print to std::cout.
         std::cout << "  " << m_filePaths[index] << std::endl;
 
-        auto input = m_fileSystem.OpenForRead(m_filePaths[index].c_str(),
-                                              std::ios::binary);
-
-        if (input->fail())
+        std::vector<char> chunkData;
         {
-            std::stringstream message;
-            message << "Failed to open chunk file '"
-                    << m_filePaths[index]
-                    << "'";
-            throw FatalError(message.str());
-        }
+            TraceScope trace("ingest", "ChunkLoad");
+
+            auto input = m_fileSystem.OpenForRead(m_filePaths[index].c_str(),
+                                                  std::ios::binary);
+
+            if (input->fail())
+            {
+                std::stringstream message;
+                message << "Failed to open chunk file '"
+                        << m_filePaths[index]
+                        << "'";
+                throw FatalError(message.str());
+            }
 
-        input->seekg(0, input->end);
-        auto length = input->tellg();
-        input->seekg(0, input->beg);
+            input->seekg(0, input->end);
+            auto length = input->tellg();
+            input->seekg(0, input->beg);
 
-        std::vector<char> chunkData;
-        chunkData.reserve(static_cast<size_t>(length) + 1ull);
-        chunkData.insert(chunkData.begin(),
-                         (std::istreambuf_iterator<char>(*input)),
-                          std::istreambuf_iterator<char>());
+            chunkData.reserve(static_cast<size_t>(length) + 1ull);
+            chunkData.insert(chunkData.begin(),
+                             (std::istreambuf_iterator<char>(*input)),
+                              std::istreambuf_iterator<char>());
+        }
 
         {
             // Block scopes IChunkWriter.
             // IChunkWriter's destructor zero-terminates its output and closes its stream.
+            TraceScope trace("ingest", "ChunkParse");
+
             std::unique_ptr<IChunkWriter> chunkWriter;
             if (m_chunkWriterFactory != nullptr) {
                 chunkWriter = m_chunkWriterFactory->CreateChunkWriter(index);
@@ -127,11 +168,30 @@ namespace BitFunnel
                                     m_ingestor,
                                     m_cacheDocuments,
                                     m_filter,
-                                    chunkWriter.get());     // TODO: consider std::move chunkwriter to processor.
+                                    chunkWriter.get(),      // TODO: consider std::move chunkwriter to processor.
+                                    m_reorderBuffer.get());
 
             ChunkReader(&chunkData[0],
                         &chunkData[0] + chunkData.size(),
                         processor);
         }
     }
+
+
+    void ChunkManifestIngestor::Flush() const
+    {
+        if (m_reorderBuffer != nullptr)
+        {
+            m_reorderBuffer->Flush();
+        }
+    }
+
+
+    void ChunkManifestIngestor::PrintStatistics(std::ostream & out) const
+    {
+        if (m_reorderBuffer != nullptr)
+        {
+            m_reorderBuffer->PrintStatistics(out);
+        }
+    }
 }
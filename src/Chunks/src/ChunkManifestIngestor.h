@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <memory>   // std::unique_ptr member.
 #include <vector>   // std::vector parameter.
 #include <string>   // Template parameter.
 
@@ -30,6 +31,7 @@
 
 namespace BitFunnel
 {
+    class DocumentReorderBuffer;
     class IConfiguration;
     class IChunkWriterFactory;
     class IDocumentFilter;
@@ -80,13 +82,21 @@ namespace BitFunnel
         //      the `verify one` and `verify log` commands in the
         //      BitFunnel repl.
         //
+        //   reorderDocuments:
+        //      If true, documents are buffered a slice at a time and
+        //      ingested in an order that places documents with similar
+        //      terms at adjacent DocIndexes. See DocumentReorderer.
+        //
         ChunkManifestIngestor(IFileSystem & fileSystem,
                               IChunkWriterFactory* chunkWriterFactory,
                               std::vector<std::string> const & filePaths,
                               IConfiguration const & config,
                               IIngestor & ingestor,
                               IDocumentFilter & filter,
-                              bool cacheDocuments);
+                              bool cacheDocuments,
+                              bool reorderDocuments);
+
+        ~ChunkManifestIngestor();
 
         //
         // IChunkManifestIngestor methods
@@ -96,6 +106,10 @@ namespace BitFunnel
 
         virtual void IngestChunk(size_t index) const override;
 
+        virtual void Flush() const override;
+
+        virtual void PrintStatistics(std::ostream & out) const override;
+
     private:
 
         //
@@ -109,5 +123,13 @@ namespace BitFunnel
         IIngestor& m_ingestor;
         IDocumentFilter & m_filter;
         bool m_cacheDocuments;
+
+        //
+        // Other members
+        //
+
+        // Shared by the ChunkIngestors on all threads. nullptr when
+        // documents are not being reordered.
+        std::unique_ptr<DocumentReorderBuffer> m_reorderBuffer;
     };
 }
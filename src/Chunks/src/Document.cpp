@@ -21,7 +21,8 @@
 // THE SOFTWARE.
 
 
-#include <new>
+#include <algorithm>
+#include <string.h>
 
 #include "BitFunnel/Chunks/Factories.h"
 #include "BitFunnel/Exceptions.h"
@@ -56,6 +57,15 @@ namespace BitFunnel
     }
 
 
+    void Document::GetPostingHashes(std::vector<Term::Hash> & hashes) const
+    {
+        for (auto const & posting : m_postings)
+        {
+            hashes.push_back(posting.GetRawHash());
+        }
+    }
+
+
     size_t Document::GetPostingCount() const
     {
         return m_postings.size();
@@ -95,9 +105,6 @@ namespace BitFunnel
             m_streamIsOpen = true;
 
             m_currentStreamId = id;
-
-            // Reset ring buffer just in case.
-            m_ringBuffer.Reset();
         }
     }
 
@@ -110,19 +117,10 @@ namespace BitFunnel
         }
         else
         {
-            // TODO: This is placeholder code that computes the term count.
-            // TODO: Make it compute the unique posting count.
-
-            // TODO: should we use the dfThreshold parameter instead of the fixed value?
-            new(m_ringBuffer.PushBack()) Term(termText,
-                                              m_currentStreamId,
-                                              m_configuration);
-
-            if (m_ringBuffer.GetCount() == m_maxGramSize)
-            {
-                ProcessNGrams();
-                m_ringBuffer.PopFront();
-            }
+            const size_t length = strlen(termText);
+            m_termOffsets.push_back(m_termText.size());
+            m_termLengths.push_back(length);
+            m_termText.insert(m_termText.end(), termText, termText + length + 1);
         }
     }
 
@@ -136,9 +134,7 @@ namespace BitFunnel
         else
         {
             m_streamIsOpen = false;
-
-            // Process ngrams at end of document.
-            PurgeRingBuffer();
+            ProcessStream();
         }
     }
 
@@ -146,31 +142,87 @@ namespace BitFunnel
     void Document::CloseDocument(size_t sourceByteSize)
     {
         m_sourceByteSize = sourceByteSize;
+
+        // Some callers never close their last stream. Generate its postings
+        // here so that they are not lost.
+        if (m_streamIsOpen)
+        {
+            ProcessStream();
+        }
     }
 
 
-    void Document::ProcessNGrams()
+    void Document::ProcessStream()
     {
-        const size_t count = m_ringBuffer.GetCount();
-        LogAssertB(count > 0, "Count must be greater than 0.");
+        if (m_configuration.KeepTermText())
+        {
+            ProcessStreamWithText();
+        }
+        else
+        {
+            ProcessStreamHashes();
+        }
+
+        m_termText.clear();
+        m_termOffsets.clear();
+        m_termLengths.clear();
+    }
+
 
-        // Process each of the higher order n-grams.
-        Term term(m_ringBuffer[0]);
-        AddPosting(term);
-        for (size_t n = 1; n < count; ++n)
+    void Document::ProcessStreamHashes()
+    {
+        const size_t count = m_termOffsets.size();
+
+        m_termPointers.resize(count);
+        for (size_t i = 0; i < count; ++i)
         {
-            term.AddTerm(m_ringBuffer[n], m_configuration);
-            AddPosting(term);
+            m_termPointers[i] = m_termText.data() + m_termOffsets[i];
+        }
+
+        m_termHashes.resize(count);
+        Term::ComputeRawHashes(m_termPointers.data(),
+                               m_termLengths.data(),
+                               count,
+                               m_configuration.GetHashFunction(),
+                               m_termHashes.data());
+
+        // Build each ngram's hash incrementally from the unigram hashes.
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t end = (std::min)(count, i + m_maxGramSize);
+
+            Term::Hash hash = m_termHashes[i];
+            AddPosting(Term(hash, m_currentStreamId, 1));
+            for (size_t j = i + 1; j < end; ++j)
+            {
+                hash = Term::ExtendNGramHash(hash, m_termHashes[j]);
+                AddPosting(Term(hash,
+                                m_currentStreamId,
+                                static_cast<Term::GramSize>(j - i + 1)));
+            }
         }
     }
 
 
-    void Document::PurgeRingBuffer()
+    void Document::ProcessStreamWithText()
     {
-        while (!m_ringBuffer.IsEmpty())
+        const size_t count = m_termOffsets.size();
+        for (size_t i = 0; i < count; ++i)
         {
-            ProcessNGrams();
-            m_ringBuffer.PopFront();
+            const size_t end = (std::min)(count, i + m_maxGramSize);
+
+            Term term(m_termText.data() + m_termOffsets[i],
+                      m_currentStreamId,
+                      m_configuration);
+            AddPosting(term);
+            for (size_t j = i + 1; j < end; ++j)
+            {
+                term.AddTerm(Term(m_termText.data() + m_termOffsets[j],
+                                  m_currentStreamId,
+                                  m_configuration),
+                             m_configuration);
+                AddPosting(term);
+            }
         }
     }
 
@@ -23,10 +23,10 @@
 #pragma once
 
 #include <unordered_set>                    // TODO: Remove this temporary include.
+#include <vector>                           // std::vector member.
 
 #include "BitFunnel/BitFunnelTypes.h"       // DocId parameter.
 #include "BitFunnel/Index/IDocument.h"      // Inherits from IDocument.
-#include "BitFunnel/Utilities/RingBuffer.h" // RingBuffer member.
 #include "BitFunnel/Term.h"                 // Term template parameter.
 
 
@@ -45,6 +45,11 @@ namespace BitFunnel
         // document. The id could be supplied by another system.
         DocId GetDocId() const;
 
+        // Appends the raw hash of each of the document's postings to hashes.
+        // Used to compute similarity signatures when reordering documents
+        // before ingestion.
+        void GetPostingHashes(std::vector<Term::Hash> & hashes) const;
+
         //
         // IDocument methods
         //
@@ -69,24 +74,32 @@ namespace BitFunnel
         // AddTerm() will add terms to this stream.
         virtual void OpenStream(Term::StreamId id) override;
 
-        // Adds a term to the currently opened stream.
+        // Adds a term to the currently opened stream. The term's text is
+        // buffered until CloseStream().
         virtual void AddTerm(char const * term) override;
 
-        // Closes the current stream.
+        // Closes the current stream. Hashes all of the stream's terms in a
+        // batch and generates its ngram postings.
         virtual void CloseStream() override;
 
         // CloseDocument() should be called once all terms have been added.
         virtual void CloseDocument(size_t sourceByteSize) override;
 
     private:
-        // Invoke AddPosting() for each ngram starting at the front of
-        // m_ringBuffer. This includes ngrams with lengths 1 to
-        // IConfiguration::GetMaxGramSize.
-        void ProcessNGrams();
+        // Invoke AddPosting() for each ngram in the terms buffered for the
+        // current stream and then empty the buffer. This includes ngrams
+        // with lengths 1 to IConfiguration::GetMaxGramSize starting at each
+        // position.
+        void ProcessStream();
+
+        // Generates the postings by hashing the stream's terms in a batch
+        // and building ngram hashes incrementally from the unigram hashes.
+        void ProcessStreamHashes();
 
-        // Invoke AddPosting() for each ngram starting at each position in
-        // m_ringBuffer.
-        void PurgeRingBuffer();
+        // Slower version of ProcessStreamHashes() that constructs each Term
+        // from its text so that the IConfiguration's TermToText is
+        // maintained.
+        void ProcessStreamWithText();
 
         // Add term to the set of terms used to create postings in a
         // call to Ingest().
@@ -110,9 +123,14 @@ namespace BitFunnel
 
         size_t m_sourceByteSize;
 
-        // Ring buffer used to generate ngram postings.
-        static const size_t c_ringBufferSize = Term::c_log2MaxGramSize + 1;
-        RingBuffer<Term, c_ringBufferSize> m_ringBuffer;
+        // Terms added to the current stream. Text for all terms is stored
+        // back to back, zero terminated, in m_termText. These buffers are
+        // reused from stream to stream.
+        std::vector<char> m_termText;
+        std::vector<size_t> m_termOffsets;
+        std::vector<size_t> m_termLengths;
+        std::vector<char const *> m_termPointers;
+        std::vector<Term::Hash> m_termHashes;
 
 
         //
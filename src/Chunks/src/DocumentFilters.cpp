@@ -21,6 +21,9 @@
 // THE SOFTWARE.
 
 
+#include <chrono>
+#include <thread>
+
 #include "BitFunnel/Chunks/DocumentFilters.h"
 #include "BitFunnel/Index/IDocument.h"
 
@@ -112,6 +115,56 @@ namespace BitFunnel
     }
 
 
+    //*************************************************************************
+    //
+    // RateLimitFilter
+    //
+    //*************************************************************************
+    RateLimitFilter::RateLimitFilter(double documentsPerSecond)
+      : m_documentsPerSecond(documentsPerSecond),
+        m_documentCount(0)
+    {
+    }
+
+
+    bool RateLimitFilter::KeepDocument(IDocument const & /*document*/)
+    {
+        if (m_documentCount == 0)
+        {
+            m_stopwatch.Reset();
+        }
+        else
+        {
+            const double scheduled = m_documentCount / m_documentsPerSecond;
+            const double remaining = scheduled - m_stopwatch.ElapsedTime();
+            if (remaining > 0.0)
+            {
+                std::this_thread::sleep_for(
+                    std::chrono::duration<double>(remaining));
+            }
+        }
+        ++m_documentCount;
+        return true;
+    }
+
+
+    //*************************************************************************
+    //
+    // CancellationFilter
+    //
+    //*************************************************************************
+    CancellationFilter::CancellationFilter(std::atomic<bool> const & cancelled)
+      : m_cancelled(cancelled)
+    {
+    }
+
+
+    bool CancellationFilter::KeepDocument(IDocument const & /*document*/)
+    {
+        return !m_cancelled.load();
+    }
+
+
     //*************************************************************************
     //
     // NopFilter
@@ -0,0 +1,323 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>            // std::stable_sort.
+#include <iomanip>              // std::setprecision.
+#include <limits>               // std::numeric_limits.
+#include <ostream>              // std::ostream.
+#include <unordered_map>        // std::unordered_map embedded.
+
+#include "BitFunnel/Index/IDocumentCache.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IShard.h"
+#include "DocumentReorderer.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // DocumentReorderer
+    //
+    //*************************************************************************
+
+    // Declare storage for static const members.
+    const size_t DocumentReorderer::c_signatureSize;
+
+
+    static uint64_t MixHash(uint64_t hash, size_t function)
+    {
+        // SplitMix64 finalizer applied to the hash offset by a per-function
+        // constant. Each value of function yields an independent-looking
+        // permutation of the hash space.
+        uint64_t x = hash + (function + 1) * 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+
+    DocumentReorderer::Signature
+        DocumentReorderer::GetSignature(Document const & document)
+    {
+        Signature signature;
+        signature.fill(std::numeric_limits<uint64_t>::max());
+
+        std::vector<Term::Hash> hashes;
+        document.GetPostingHashes(hashes);
+
+        for (auto hash : hashes)
+        {
+            for (size_t i = 0; i < c_signatureSize; ++i)
+            {
+                signature[i] = (std::min)(signature[i], MixHash(hash, i));
+            }
+        }
+
+        return signature;
+    }
+
+
+    void DocumentReorderer::Reorder(DocumentList & documents)
+    {
+        std::vector<std::pair<Signature, size_t>> order;
+        order.reserve(documents.size());
+        for (size_t i = 0; i < documents.size(); ++i)
+        {
+            order.push_back(std::make_pair(GetSignature(*documents[i]), i));
+        }
+
+        std::stable_sort(order.begin(), order.end(),
+                         [](std::pair<Signature, size_t> const & a,
+                            std::pair<Signature, size_t> const & b)
+        {
+            return a.first < b.first;
+        });
+
+        DocumentList reordered;
+        reordered.reserve(documents.size());
+        for (auto const & entry : order)
+        {
+            reordered.push_back(std::move(documents[entry.second]));
+        }
+
+        documents.swap(reordered);
+    }
+
+
+    void DocumentReorderer::CountRankBits(DocumentList const & documents,
+                                          Rank rank,
+                                          size_t & setBits,
+                                          size_t & totalBits)
+    {
+        // Maps each term to the last group of 2^rank documents in which it
+        // was seen. Documents are visited in order, so a term contributes a
+        // new bit each time its group changes.
+        std::unordered_map<Term::Hash, size_t> lastGroup;
+        std::vector<Term::Hash> hashes;
+
+        setBits = 0;
+        for (size_t i = 0; i < documents.size(); ++i)
+        {
+            size_t group = i >> rank;
+
+            hashes.clear();
+            documents[i]->GetPostingHashes(hashes);
+            for (auto hash : hashes)
+            {
+                auto it = lastGroup.find(hash);
+                if (it == lastGroup.end())
+                {
+                    lastGroup.insert(std::make_pair(hash, group));
+                    ++setBits;
+                }
+                else if (it->second != group)
+                {
+                    it->second = group;
+                    ++setBits;
+                }
+            }
+        }
+
+        size_t groupSize = static_cast<size_t>(1) << rank;
+        size_t groupCount = (documents.size() + groupSize - 1) / groupSize;
+        totalBits = lastGroup.size() * groupCount;
+    }
+
+
+    //*************************************************************************
+    //
+    // DocumentReorderBuffer
+    //
+    //*************************************************************************
+
+    // Declare storage for static const members.
+    const size_t DocumentReorderBuffer::c_reportedRankCount;
+
+    static const Rank c_reportedRanks[DocumentReorderBuffer::c_reportedRankCount] = { 3, 6 };
+
+
+    DocumentReorderBuffer::DocumentReorderBuffer(IIngestor & ingestor,
+                                                 bool cacheDocuments)
+      : m_ingestor(ingestor),
+        m_cacheDocuments(cacheDocuments),
+        m_batchCount(0),
+        m_documentCount(0)
+    {
+        for (size_t i = 0; i < c_reportedRankCount; ++i)
+        {
+            m_setBitsBefore[i] = 0;
+            m_setBitsAfter[i] = 0;
+            m_totalBits[i] = 0;
+        }
+    }
+
+
+    void DocumentReorderBuffer::Add(std::unique_ptr<Document> document)
+    {
+        const ShardId shard =
+            m_ingestor.GetShardForPostingCount(document->GetPostingCount());
+        const DocIndex capacity =
+            m_ingestor.GetShard(shard).GetSliceCapacity();
+
+        // Take a full batch out of the buffer, so that other threads can
+        // keep buffering while it is reordered and ingested.
+        DocumentReorderer::DocumentList batch;
+        {
+            ShardBuffer & buffer = m_shards[shard];
+            std::lock_guard<std::mutex> lock(buffer.m_bufferLock);
+            buffer.m_documents.push_back(std::move(document));
+            if (buffer.m_documents.size() >= capacity)
+            {
+                batch.swap(buffer.m_documents);
+            }
+        }
+
+        IngestBatch(shard, batch);
+    }
+
+
+    void DocumentReorderBuffer::Flush()
+    {
+        for (ShardId shard = 0; shard < c_maxShardIdCount; ++shard)
+        {
+            DocumentReorderer::DocumentList batch;
+            {
+                ShardBuffer & buffer = m_shards[shard];
+                std::lock_guard<std::mutex> lock(buffer.m_bufferLock);
+                batch.swap(buffer.m_documents);
+            }
+
+            IngestBatch(shard, batch);
+        }
+    }
+
+
+    void DocumentReorderBuffer::IngestBatch(
+        ShardId shard,
+        DocumentReorderer::DocumentList & documents)
+    {
+        if (documents.empty())
+        {
+            return;
+        }
+
+        size_t setBitsBefore[c_reportedRankCount];
+        size_t setBitsAfter[c_reportedRankCount];
+        size_t totalBits[c_reportedRankCount];
+        for (size_t i = 0; i < c_reportedRankCount; ++i)
+        {
+            DocumentReorderer::CountRankBits(documents,
+                                             c_reportedRanks[i],
+                                             setBitsBefore[i],
+                                             totalBits[i]);
+        }
+
+        DocumentReorderer::Reorder(documents);
+
+        // Reordering does not change the set of terms or the number of
+        // groups, so totalBits is the same both times.
+        for (size_t i = 0; i < c_reportedRankCount; ++i)
+        {
+            DocumentReorderer::CountRankBits(documents,
+                                             c_reportedRanks[i],
+                                             setBitsAfter[i],
+                                             totalBits[i]);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_shards[shard].m_ingestLock);
+            for (auto & document : documents)
+            {
+                const DocId id = document->GetDocId();
+                m_ingestor.Add(id, *document);
+                if (m_cacheDocuments)
+                {
+                    m_ingestor.GetDocumentCache().Add(std::move(document), id);
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_statisticsLock);
+        ++m_batchCount;
+        m_documentCount += documents.size();
+        for (size_t i = 0; i < c_reportedRankCount; ++i)
+        {
+            m_setBitsBefore[i] += setBitsBefore[i];
+            m_setBitsAfter[i] += setBitsAfter[i];
+            m_totalBits[i] += totalBits[i];
+        }
+    }
+
+
+    void DocumentReorderBuffer::PrintStatistics(std::ostream & out) const
+    {
+        std::lock_guard<std::mutex> lock(m_statisticsLock);
+
+        out << "Document reordering:" << std::endl
+            << "  Batches: " << m_batchCount << std::endl
+            << "  Documents: " << m_documentCount << std::endl;
+
+        // Restore the caller's formatting afterwards.
+        const std::ios_base::fmtflags flags = out.flags();
+        const std::streamsize precision = out.precision();
+
+        out << "  Estimated row densities (before, after):" << std::endl;
+        for (size_t i = 0; i < c_reportedRankCount; ++i)
+        {
+            if (m_totalBits[i] > 0)
+            {
+                const double total = static_cast<double>(m_totalBits[i]);
+                out << "    Rank " << c_reportedRanks[i] << ": "
+                    << std::fixed << std::setprecision(4)
+                    << m_setBitsBefore[i] / total << ", "
+                    << m_setBitsAfter[i] / total << std::endl;
+            }
+        }
+
+        out << "  Mean row densities:" << std::endl;
+
+        for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+        {
+            double sum = 0.0;
+            size_t rowCount = 0;
+            for (size_t shard = 0; shard < m_ingestor.GetShardCount(); ++shard)
+            {
+                for (auto density : m_ingestor.GetShard(shard).GetDensities(rank))
+                {
+                    sum += density;
+                    ++rowCount;
+                }
+            }
+
+            if (rowCount > 0)
+            {
+                out << "    Rank " << rank << ": "
+                    << std::fixed << std::setprecision(4)
+                    << sum / rowCount << std::endl;
+            }
+        }
+
+        out.flags(flags);
+        out.precision(precision);
+    }
+}
@@ -0,0 +1,152 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <array>                        // std::array member.
+#include <iosfwd>                       // std::ostream parameter.
+#include <memory>                       // std::unique_ptr template parameter.
+#include <mutex>                        // std::mutex member.
+#include <vector>                       // std::vector parameter.
+
+#include "BitFunnel/BitFunnelTypes.h"   // Rank parameter, c_maxShardIdCount.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+#include "Document.h"                   // Document template parameter.
+
+
+namespace BitFunnel
+{
+    class IIngestor;
+
+
+    //*************************************************************************
+    //
+    // DocumentReorderer
+    //
+    // Permutes a slice's worth of documents so that documents with similar
+    // terms will be assigned adjacent DocIndexes. Each bit in a rank r row
+    // covers 2^r consecutive documents, so clustering documents that share
+    // terms reduces the number of bits set in higher rank rows.
+    //
+    // Similarity is approximated by a MinHash signature over the raw hashes
+    // of each document's postings. Sorting by signature places documents
+    // with matching signatures, and therefore high expected Jaccard
+    // similarity, next to each other.
+    //
+    //*************************************************************************
+    class DocumentReorderer
+    {
+    public:
+        typedef std::vector<std::unique_ptr<Document>> DocumentList;
+
+        // Number of MinHash values in each document's signature.
+        static const size_t c_signatureSize = 4;
+
+        typedef std::array<uint64_t, c_signatureSize> Signature;
+
+        // Sorts documents by their MinHash signatures. The sort is stable,
+        // so documents with identical signatures retain their arrival
+        // order.
+        static void Reorder(DocumentList & documents);
+
+        // Computes the MinHash signature of a single document.
+        static Signature GetSignature(Document const & document);
+
+        // Estimates the density of rank `rank` rows for documents placed at
+        // consecutive DocIndexes in the order given. The estimate assumes
+        // each term has a private row: setBits counts the (term, group of
+        // 2^rank documents) pairs where the term appears in the group, and
+        // totalBits is the number of terms times the number of groups.
+        static void CountRankBits(DocumentList const & documents,
+                                  Rank rank,
+                                  size_t & setBits,
+                                  size_t & totalBits);
+    };
+
+
+    //*************************************************************************
+    //
+    // DocumentReorderBuffer
+    //
+    // Buffers documents per shard until a shard has a slice's worth, then
+    // reorders them with DocumentReorderer and ingests them. A single
+    // DocumentReorderBuffer is shared by the ChunkIngestors on all threads,
+    // so a batch can span chunk files. Each batch is ingested under a
+    // per-shard lock, so batches from different threads do not interleave
+    // within a slice.
+    //
+    //*************************************************************************
+    class DocumentReorderBuffer : public NonCopyable
+    {
+    public:
+        DocumentReorderBuffer(IIngestor & ingestor, bool cacheDocuments);
+
+        // Buffers a document for the shard that will hold it. Ingests the
+        // shard's buffered documents once they fill a slice.
+        void Add(std::unique_ptr<Document> document);
+
+        // Reorders and ingests the documents remaining in every shard's
+        // buffer. Call once all documents have been added.
+        void Flush();
+
+        // Prints the number of reordered batches and documents. Then prints
+        // the rank 3 and rank 6 row densities estimated by
+        // DocumentReorderer::CountRankBits() for every batch before and
+        // after it was reordered. Finally prints the mean row density at
+        // each rank, as measured in the index.
+        void PrintStatistics(std::ostream & out) const;
+
+        // Number of ranks whose estimated densities are reported.
+        static const size_t c_reportedRankCount = 2;
+
+    private:
+        struct ShardBuffer
+        {
+            // Protects m_documents.
+            std::mutex m_bufferLock;
+            DocumentReorderer::DocumentList m_documents;
+
+            // Held while a batch is ingested into the shard.
+            std::mutex m_ingestLock;
+        };
+
+        // Reorders and ingests a batch of documents for a shard.
+        void IngestBatch(ShardId shard,
+                         DocumentReorderer::DocumentList & documents);
+
+        IIngestor & m_ingestor;
+        const bool m_cacheDocuments;
+
+        std::array<ShardBuffer, c_maxShardIdCount> m_shards;
+
+        // Protects the statistics below.
+        mutable std::mutex m_statisticsLock;
+        size_t m_batchCount;
+        size_t m_documentCount;
+
+        // CountRankBits() totals for each reported rank, summed over all
+        // batches.
+        size_t m_setBitsBefore[c_reportedRankCount];
+        size_t m_setBitsAfter[c_reportedRankCount];
+        size_t m_totalBits[c_reportedRankCount];
+    };
+}
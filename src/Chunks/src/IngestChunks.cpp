@@ -20,6 +20,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include "BitFunnel/Chunks/IChunkManifestIngestor.h"
 #include "BitFunnel/Index/IngestChunks.h"
 #include "ChunkEnumerator.h"
 
@@ -32,5 +33,6 @@ namespace BitFunnel
         ChunkEnumerator chunkEnumerator(manifest, threadCount);
 
         chunkEnumerator.WaitForCompletion();
+        manifest.Flush();
     }
 }
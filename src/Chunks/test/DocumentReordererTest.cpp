@@ -0,0 +1,176 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IShard.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "Document.h"
+#include "DocumentReorderer.h"
+
+
+namespace BitFunnel
+{
+    // Creates a document containing words prefix0 .. prefix(wordCount - 1).
+    static std::unique_ptr<Document> CreateDocument(IConfiguration const & config,
+                                                    DocId id,
+                                                    char const * prefix,
+                                                    size_t wordCount)
+    {
+        std::unique_ptr<Document> document(new Document(config, id));
+        document->OpenStream(0);
+        for (size_t i = 0; i < wordCount; ++i)
+        {
+            std::string word = prefix + std::to_string(i);
+            document->AddTerm(word.c_str());
+        }
+        document->CloseStream();
+        document->CloseDocument(0);
+        return document;
+    }
+
+
+    TEST(DocumentReorderer, ClustersSimilarDocuments)
+    {
+        const size_t documentCount = 16;
+        const size_t wordCount = 20;
+
+        auto facts = Factories::CreateFactSet();
+        auto config = Factories::CreateConfiguration(1, false, *facts);
+
+        // Alternate between documents drawn from two disjoint vocabularies.
+        DocumentReorderer::DocumentList documents;
+        for (DocId id = 0; id < documentCount; ++id)
+        {
+            documents.push_back(
+                CreateDocument(*config, id, (id % 2 == 0) ? "a" : "b", wordCount));
+        }
+
+        // In arrival order, every group of 8 documents contains every term.
+        size_t setBits;
+        size_t totalBits;
+        DocumentReorderer::CountRankBits(documents, 3, setBits, totalBits);
+        EXPECT_EQ(2 * wordCount * 2, setBits);
+        EXPECT_EQ(2 * wordCount * 2, totalBits);
+
+        DocumentReorderer::Reorder(documents);
+        ASSERT_EQ(documentCount, documents.size());
+
+        // Documents from each vocabulary are now contiguous and, since their
+        // signatures are identical, retain their arrival order.
+        for (size_t i = 1; i < documentCount; ++i)
+        {
+            DocId previous = documents[i - 1]->GetDocId();
+            DocId current = documents[i]->GetDocId();
+            if (i == documentCount / 2)
+            {
+                EXPECT_NE(previous % 2, current % 2);
+            }
+            else
+            {
+                EXPECT_EQ(previous % 2, current % 2);
+                EXPECT_EQ(previous + 2, current);
+            }
+        }
+
+        // Each term now appears in just one group of 8 documents.
+        DocumentReorderer::CountRankBits(documents, 3, setBits, totalBits);
+        EXPECT_EQ(2 * wordCount, setBits);
+        EXPECT_EQ(2 * wordCount * 2, totalBits);
+
+        // At rank 0 the order does not matter.
+        DocumentReorderer::CountRankBits(documents, 0, setBits, totalBits);
+        EXPECT_EQ(documentCount * wordCount, setBits);
+    }
+
+
+    TEST(DocumentReorderBuffer, IngestsFullSlices)
+    {
+        auto fileSystem = Factories::CreateRAMFileSystem();
+        auto index = Factories::CreateSimpleIndex(*fileSystem);
+        index->ConfigureAsMock(1, false);
+        index->StartIndex();
+
+        IIngestor & ingestor = index->GetIngestor();
+        const DocIndex capacity = ingestor.GetShard(0).GetSliceCapacity();
+        const DocId documentCount = capacity + capacity / 2;
+
+        DocumentReorderBuffer buffer(ingestor, true);
+        for (DocId id = 0; id < documentCount; ++id)
+        {
+            buffer.Add(CreateDocument(index->GetConfiguration(),
+                                      id,
+                                      (id % 2 == 0) ? "a" : "b",
+                                      4));
+            EXPECT_EQ((id + 1) / capacity * capacity,
+                      ingestor.GetDocumentCount());
+        }
+
+        // The partial batch is only ingested when the buffer is flushed.
+        buffer.Flush();
+        EXPECT_EQ(documentCount, ingestor.GetDocumentCount());
+        for (DocId id = 0; id < documentCount; ++id)
+        {
+            EXPECT_TRUE(ingestor.Contains(id));
+        }
+
+        std::stringstream output;
+        buffer.PrintStatistics(output);
+
+        std::stringstream expected;
+        expected << "Document reordering:\n"
+                 << "  Batches: 2\n"
+                 << "  Documents: " << documentCount << "\n"
+                 << "  Estimated row densities (before, after):\n";
+        EXPECT_EQ(expected.str(),
+                  output.str().substr(0, expected.str().size()));
+
+        // The documents alternate between two words, so sorting them
+        // halves the rank 3 and rank 6 densities.
+        output.seekg(static_cast<std::streamoff>(expected.str().size()));
+        const Rank ranks[] = { 3, 6 };
+        for (auto rank : ranks)
+        {
+            std::string label;
+            Rank reportedRank;
+            char colon;
+            char comma;
+            double before;
+            double after;
+            output >> label >> reportedRank >> colon >> before >> comma >> after;
+            EXPECT_EQ("Rank", label);
+            EXPECT_EQ(rank, reportedRank);
+            EXPECT_GT(before, 0.0);
+            EXPECT_LT(after, before);
+        }
+    }
+}
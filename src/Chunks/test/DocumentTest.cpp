@@ -21,6 +21,9 @@
 // THE SOFTWARE.
 
 #include <array>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -130,4 +133,65 @@ namespace BitFunnel
         Term unexpected("unexpected", streamId, *config);
         EXPECT_FALSE(d.Contains(unexpected));
     }
+
+
+    // Verifies that the batched hashing path generates exactly the ngram
+    // postings that would be formed with Term::AddTerm().
+    static void VerifyBatchedNGrams(bool keepTermText,
+                                    Term::HashFunction hashFunction)
+    {
+        const Term::StreamId streamId = 2;
+        const size_t gramSize = 4;
+
+        auto facts = Factories::CreateFactSet();
+        auto config =
+            Factories::CreateConfiguration(gramSize,
+                                           keepTermText,
+                                           *facts,
+                                           hashFunction);
+        Document d(*config, 0);
+
+        // Words of varied lengths with repeats, so some ngrams recur.
+        std::vector<std::string> words;
+        for (size_t i = 0; i < 57; ++i)
+        {
+            words.push_back(std::string((i * 7) % 19 + 1,
+                                        static_cast<char>('a' + (i * 5) % 11)));
+        }
+
+        d.OpenStream(streamId);
+        for (auto const & word : words)
+        {
+            d.AddTerm(word.c_str());
+        }
+        d.CloseStream();
+        d.CloseDocument(0);
+
+        std::unordered_set<Term, Term::Hasher> expected;
+        for (size_t i = 0; i < words.size(); ++i)
+        {
+            Term term(words[i].c_str(), streamId, *config);
+            expected.insert(term);
+            for (size_t j = i + 1; j < words.size() && j < i + gramSize; ++j)
+            {
+                term.AddTerm(Term(words[j].c_str(), streamId, *config), *config);
+                expected.insert(term);
+            }
+        }
+
+        EXPECT_EQ(expected.size(), d.GetPostingCount());
+        for (auto term : expected)
+        {
+            EXPECT_TRUE(d.Contains(term));
+        }
+    }
+
+
+    TEST(Document, BatchedNGrams)
+    {
+        VerifyBatchedNGrams(false, Term::HashFunction::MurmurHash64A);
+        VerifyBatchedNGrams(true, Term::HashFunction::MurmurHash64A);
+        VerifyBatchedNGrams(false, Term::HashFunction::XXHash64);
+        VerifyBatchedNGrams(true, Term::HashFunction::XXHash64);
+    }
 }
@@ -83,6 +83,14 @@ namespace BitFunnel
                                             indexDirectory,
                                             "Manifest",
                                             ".txt" )),
+          m_partialDocFreqTable(new ParameterizedFile1(fileSystem,
+                                                       statisticsDirectory,
+                                                       "PartialDocFreqTable",
+                                                       ".csv")),
+          m_partialStatistics(new ParameterizedFile0(fileSystem,
+                                                     statisticsDirectory,
+                                                     "PartialStatistics",
+                                                     ".csv")),
           m_queryLog(new ParameterizedFile0(fileSystem,
                                             statisticsDirectory,
                                             "QueryLog",
@@ -152,6 +160,12 @@ namespace BitFunnel
     }
 
 
+    FileDescriptor0 FileManager::PartialStatistics()
+    {
+        return FileDescriptor0(*m_partialStatistics);
+    }
+
+
     FileDescriptor0 FileManager::QueryLog()
     {
         return FileDescriptor0(*m_queryLog);
@@ -234,6 +248,12 @@ namespace BitFunnel
     }
 
 
+    FileDescriptor1 FileManager::PartialDocFreqTable(size_t shard)
+    {
+        return FileDescriptor1(*m_partialDocFreqTable, shard);
+    }
+
+
     FileDescriptor1 FileManager::RowDensities(size_t shard)
     {
         return FileDescriptor1(*m_rowDensities, shard);
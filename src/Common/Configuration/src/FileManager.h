@@ -52,6 +52,7 @@ namespace BitFunnel
         virtual FileDescriptor0 DocumentHistogram() override;
         //virtual FileDescriptor0 L1RankerConfig() override;
         virtual FileDescriptor0 Manifest() override;
+        virtual FileDescriptor0 PartialStatistics() override;
         //virtual FileDescriptor0 Model() override;
         //virtual FileDescriptor0 PlanDescriptors() override;
         //virtual FileDescriptor0 PostingCounts() override;
@@ -79,6 +80,7 @@ namespace BitFunnel
         virtual FileDescriptor1 Correlate(size_t shard) override;
         virtual FileDescriptor1 CumulativeTermCounts(size_t shard) override;
         virtual FileDescriptor1 DocFreqTable(size_t shard) override;
+        virtual FileDescriptor1 PartialDocFreqTable(size_t shard) override;
         //virtual FileDescriptor1 DocTable(size_t shard) override;
         //virtual FileDescriptor1 ScoreTable(size_t shard) override;
         virtual FileDescriptor1 RowDensities(size_t shard) override;
@@ -99,6 +101,8 @@ namespace BitFunnel
         std::unique_ptr<IParameterizedFile0> m_indexSliceMain;
         std::unique_ptr<IParameterizedFile2> m_indexSlice;
         std::unique_ptr<IParameterizedFile0> m_manifest;
+        std::unique_ptr<IParameterizedFile1> m_partialDocFreqTable;
+        std::unique_ptr<IParameterizedFile0> m_partialStatistics;
         std::unique_ptr<IParameterizedFile0> m_queryLog;
         std::unique_ptr<IParameterizedFile0> m_queryPipelineStatistics;
         std::unique_ptr<IParameterizedFile0> m_querySummaryStatistics;
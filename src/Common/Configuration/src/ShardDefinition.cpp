@@ -20,6 +20,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
 #include <istream>
 #include <ostream>
 #include <limits>
@@ -114,11 +115,18 @@ namespace BitFunnel
         CsvTsv::InputColumn<double>
             density("Density",
                     "Target density for RowTables in the shard.");
+        // SliceCapacity is optional. Files written before it was introduced
+        // don't have it.
+        CsvTsv::InputColumn<size_t>
+            sliceCapacity("SliceCapacity",
+                          "Slice capacity in documents (0 for the default).",
+                          0);
 
         CsvTsv::CsvTableParser parser(input);
         CsvTsv::TableReader reader(parser);
         reader.DefineColumn(minPostings);
         reader.DefineColumn(density);
+        reader.DefineColumn(sliceCapacity);
 
         reader.ReadPrologue();
         while (!reader.AtEOF())
@@ -126,6 +134,8 @@ namespace BitFunnel
             reader.ReadDataRow();
 
             AddShard(minPostings, density);
+            SetSliceCapacity(GetShard(minPostings),
+                             static_cast<DocIndex>(sliceCapacity));
         }
         reader.ReadEpilogue();
     }
@@ -139,17 +149,32 @@ namespace BitFunnel
         CsvTsv::OutputColumn<double>
             density("Density",
                     "Target density for RowTables in the shard.");
+        CsvTsv::OutputColumn<size_t>
+            sliceCapacity("SliceCapacity",
+                          "Slice capacity in documents (0 for the default).");
 
         CsvTsv::CsvTableFormatter formatter(output);
         CsvTsv::TableWriter writer(formatter);
         writer.DefineColumn(minPostings);
         writer.DefineColumn(density);
 
+        // Only write the SliceCapacity column when some shard uses it, so
+        // that definitions without per-shard capacities keep their format.
+        const bool hasSliceCapacities =
+            std::any_of(m_sliceCapacities.begin(),
+                        m_sliceCapacities.end(),
+                        [](DocIndex capacity) { return capacity != 0; });
+        if (hasSliceCapacities)
+        {
+            writer.DefineColumn(sliceCapacity);
+        }
+
         writer.WritePrologue();
         for (unsigned i = 0; i < m_shards.size(); ++i)
         {
             minPostings = m_shards[i].first;
             density = m_shards[i].second;
+            sliceCapacity = m_sliceCapacities[i];
 
             writer.WriteDataRow();
         }
@@ -166,11 +191,13 @@ namespace BitFunnel
             << "First shard must have minPostingCount of zero.";
 
         m_shards.push_back(std::make_pair(minPostingCount, density));
+        m_sliceCapacities.push_back(0);
         size_t i = m_shards.size() - 1;
 
         while (i > 0 && m_shards[i].first < m_shards[i - 1].first)
         {
             std::swap(m_shards[i], m_shards[i - 1]);
+            std::swap(m_sliceCapacities[i], m_sliceCapacities[i - 1]);
             --i;
         }
     }
@@ -215,4 +242,20 @@ namespace BitFunnel
     {
         return static_cast<ShardId>(m_shards.size());
     }
+
+
+    void ShardDefinition::SetSliceCapacity(ShardId shard, DocIndex capacity)
+    {
+        CHECK_LT(shard, m_sliceCapacities.size())
+            << "ShardId out of range.";
+        m_sliceCapacities[shard] = capacity;
+    }
+
+
+    DocIndex ShardDefinition::GetSliceCapacity(ShardId shard) const
+    {
+        CHECK_LT(shard, m_sliceCapacities.size())
+            << "ShardId out of range.";
+        return m_sliceCapacities[shard];
+    }
 }
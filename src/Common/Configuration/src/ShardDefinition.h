@@ -71,7 +71,19 @@ namespace BitFunnel
         // Returns the number of shards in the map.
         virtual ShardId GetShardCount() const override;
 
+        // Sets the slice capacity, in documents, for the specified shard. A
+        // capacity of zero means the shard derives its capacity from the
+        // index's default slice buffer size.
+        virtual void SetSliceCapacity(ShardId shard, DocIndex capacity) override;
+
+        // Returns the slice capacity for the specified shard, or zero if the
+        // shard uses the default.
+        virtual DocIndex GetSliceCapacity(ShardId shard) const override;
+
     private:
         std::vector<std::pair<size_t, double>> m_shards;
+
+        // Slice capacity for each shard, parallel to m_shards.
+        std::vector<DocIndex> m_sliceCapacities;
     };
 }
@@ -105,5 +105,38 @@ namespace BitFunnel
                  EXPECT_EQ(s1.GetMaxPostingCount(i), s2.GetMaxPostingCount(i));
              }
          }
+
+
+         TEST(ShardDefinition, SliceCapacity)
+         {
+             ShardDefinition s1;
+             s1.AddShard(0, 0.15);
+             s1.AddShard(500, 0.15);
+
+             // Definitions without slice capacities keep the original
+             // format.
+             std::stringstream original;
+             s1.Write(original);
+             EXPECT_EQ(original.str().find("SliceCapacity"), std::string::npos);
+
+             s1.SetSliceCapacity(1, 8192);
+             s1.AddShard(400, 0.15);
+
+             // Adding a shard moves capacities along with their shards.
+             EXPECT_EQ(s1.GetSliceCapacity(0), 0u);
+             EXPECT_EQ(s1.GetSliceCapacity(1), 0u);
+             EXPECT_EQ(s1.GetSliceCapacity(2), 8192u);
+
+             std::stringstream stream;
+             s1.Write(stream);
+             ShardDefinition s2(stream);
+
+             ASSERT_EQ(s1.GetShardCount(), s2.GetShardCount());
+             for (ShardId i = 0; i < s1.GetShardCount(); ++i)
+             {
+                 EXPECT_EQ(s1.GetMinPostingCount(i), s2.GetMinPostingCount(i));
+                 EXPECT_EQ(s1.GetSliceCapacity(i), s2.GetSliceCapacity(i));
+             }
+         }
     }
 }
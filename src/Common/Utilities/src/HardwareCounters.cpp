@@ -0,0 +1,208 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>      // memset.
+
+#include "BitFunnel/Utilities/HardwareCounters.h"
+#include "LoggerInterfaces/Check.h"
+
+
+namespace BitFunnel
+{
+#ifdef __linux__
+    static int OpenCounter(uint32_t type, uint64_t config, int groupLeader)
+    {
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = type;
+        attributes.config = config;
+        attributes.read_format = PERF_FORMAT_GROUP;
+
+        // Start disabled and count only user-mode events so that the
+        // counters are usable at the default perf_event_paranoid level.
+        attributes.disabled = (groupLeader == -1) ? 1 : 0;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        // Count the calling thread on any CPU.
+        return static_cast<int>(syscall(__NR_perf_event_open,
+                                        &attributes,
+                                        0,
+                                        -1,
+                                        groupLeader,
+                                        0));
+    }
+#endif
+
+
+    HardwareCounters::HardwareCounters()
+        : m_leader(-1)
+    {
+        for (size_t i = 0; i < CounterCount; ++i)
+        {
+            m_fileDescriptors[i] = -1;
+            m_values[i] = 0;
+        }
+
+#ifdef __linux__
+        const uint32_t c_types[CounterCount] =
+        {
+            PERF_TYPE_HARDWARE,
+            PERF_TYPE_HARDWARE,
+            PERF_TYPE_HARDWARE,
+            PERF_TYPE_HW_CACHE,
+            PERF_TYPE_HARDWARE
+        };
+
+        const uint64_t c_configs[CounterCount] =
+        {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_CACHE_DTLB |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_BRANCH_MISSES
+        };
+
+        for (int i = 0; i < CounterCount; ++i)
+        {
+            const int leaderFd =
+                (m_leader == -1) ? -1 : m_fileDescriptors[m_leader];
+            const int fd = OpenCounter(c_types[i], c_configs[i], leaderFd);
+            if (fd != -1)
+            {
+                m_fileDescriptors[i] = fd;
+                if (m_leader == -1)
+                {
+                    m_leader = i;
+                }
+            }
+        }
+#endif
+    }
+
+
+    HardwareCounters::~HardwareCounters()
+    {
+#ifdef __linux__
+        // Close the group leader last.
+        for (int i = CounterCount - 1; i >= 0; --i)
+        {
+            if (m_fileDescriptors[i] != -1)
+            {
+                close(m_fileDescriptors[i]);
+            }
+        }
+#endif
+    }
+
+
+    bool HardwareCounters::IsAvailable() const
+    {
+        return m_leader != -1;
+    }
+
+
+    bool HardwareCounters::IsAvailable(Counter counter) const
+    {
+        return m_fileDescriptors[counter] != -1;
+    }
+
+
+    void HardwareCounters::Start()
+    {
+#ifdef __linux__
+        if (m_leader != -1)
+        {
+            const int fd = m_fileDescriptors[m_leader];
+            ioctl(fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+
+    void HardwareCounters::Stop()
+    {
+#ifdef __linux__
+        if (m_leader != -1)
+        {
+            const int fd = m_fileDescriptors[m_leader];
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+            // With PERF_FORMAT_GROUP, a read of the leader returns the
+            // number of events followed by one value per event, in the
+            // order the events were added to the group.
+            uint64_t buffer[1 + CounterCount];
+            const ssize_t bytes = read(fd, buffer, sizeof(buffer));
+            if (bytes < static_cast<ssize_t>(sizeof(uint64_t)))
+            {
+                return;
+            }
+
+            const uint64_t count = buffer[0];
+            uint64_t next = 0;
+            for (int i = 0; i < CounterCount && next < count; ++i)
+            {
+                if (m_fileDescriptors[i] != -1)
+                {
+                    m_values[i] = buffer[1 + next];
+                    ++next;
+                }
+            }
+        }
+#endif
+    }
+
+
+    uint64_t HardwareCounters::GetValue(Counter counter) const
+    {
+        return m_values[counter];
+    }
+
+
+    char const * HardwareCounters::GetName(Counter counter)
+    {
+        static char const * const c_names[CounterCount] =
+        {
+            "cycles",
+            "instructions",
+            "llcMisses",
+            "dtlbMisses",
+            "branchMisses"
+        };
+
+        CHECK_LT(counter, CounterCount)
+            << "Invalid hardware counter.";
+        return c_names[counter];
+    }
+}
@@ -0,0 +1,220 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>    // std::max.
+#include <cmath>        // std::ceil.
+#include <iomanip>      // std::setw.
+#include <ostream>
+
+#include "BitFunnel/Utilities/LatencyHistogram.h"
+#include "LoggerInterfaces/Check.h"
+
+
+namespace BitFunnel
+{
+    LatencyHistogram::LatencyHistogram()
+      : m_counts(c_bucketCount, 0),
+        m_totalCount(0),
+        m_maxValue(0),
+        m_sum(0.0)
+    {
+    }
+
+
+    void LatencyHistogram::Record(double seconds)
+    {
+        const uint64_t c_maxValue = (1ull << c_maxValueBits) - 1;
+        const double nanoseconds = seconds * 1e9;
+
+        uint64_t value = 0;
+        if (nanoseconds >= static_cast<double>(c_maxValue))
+        {
+            value = c_maxValue;
+        }
+        else if (nanoseconds > 0.0)
+        {
+            value = static_cast<uint64_t>(nanoseconds + 0.5);
+        }
+
+        ++m_counts[GetBucket(value)];
+        ++m_totalCount;
+        m_maxValue = (std::max)(m_maxValue, value);
+        m_sum += static_cast<double>(value);
+    }
+
+
+    void LatencyHistogram::Merge(LatencyHistogram const & other)
+    {
+        for (size_t i = 0; i < c_bucketCount; ++i)
+        {
+            m_counts[i] += other.m_counts[i];
+        }
+        m_totalCount += other.m_totalCount;
+        m_maxValue = (std::max)(m_maxValue, other.m_maxValue);
+        m_sum += other.m_sum;
+    }
+
+
+    uint64_t LatencyHistogram::GetCount() const
+    {
+        return m_totalCount;
+    }
+
+
+    double LatencyHistogram::GetMax() const
+    {
+        return m_maxValue * 1e-9;
+    }
+
+
+    double LatencyHistogram::GetMean() const
+    {
+        return (m_totalCount == 0) ? 0.0 : m_sum / m_totalCount * 1e-9;
+    }
+
+
+    double LatencyHistogram::GetSum() const
+    {
+        return m_sum * 1e-9;
+    }
+
+
+    uint64_t LatencyHistogram::GetCountAtOrBelow(double seconds) const
+    {
+        const double nanoseconds = seconds * 1e9;
+
+        uint64_t count = 0;
+        for (size_t i = 0; i < c_bucketCount; ++i)
+        {
+            if (static_cast<double>(GetHighestEquivalentValue(i)) > nanoseconds)
+            {
+                break;
+            }
+            count += m_counts[i];
+        }
+
+        return count;
+    }
+
+
+    double LatencyHistogram::GetPercentile(double percentile) const
+    {
+        CHECK_GE(percentile, 0.0)
+            << "Percentile must be in the range [0, 100].";
+        CHECK_LE(percentile, 100.0)
+            << "Percentile must be in the range [0, 100].";
+
+        if (m_totalCount == 0)
+        {
+            return 0.0;
+        }
+
+        // Rank of the target value, counting from 1.
+        uint64_t target =
+            static_cast<uint64_t>(std::ceil(percentile / 100.0 * m_totalCount));
+        target = (std::max)(target, static_cast<uint64_t>(1));
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < c_bucketCount; ++i)
+        {
+            seen += m_counts[i];
+            if (seen >= target)
+            {
+                // Report the top of the bucket, but never more than the
+                // largest value actually observed.
+                const uint64_t value =
+                    (std::min)(GetHighestEquivalentValue(i), m_maxValue);
+                return value * 1e-9;
+            }
+        }
+
+        return GetMax();
+    }
+
+
+    void LatencyHistogram::WritePercentiles(
+        std::ostream& out,
+        std::vector<char const *> const & names,
+        std::vector<LatencyHistogram const *> const & histograms)
+    {
+        CHECK_EQ(names.size(), histograms.size())
+            << "Each histogram requires a name.";
+
+        const double c_percentiles[] = { 50.0, 90.0, 99.0, 99.9, 99.99 };
+        const int c_width = 12;
+
+        out << std::setw(c_width) << "percentile";
+        for (auto name : names)
+        {
+            out << std::setw(c_width) << name;
+        }
+        out << std::endl;
+
+        for (auto percentile : c_percentiles)
+        {
+            out << std::setw(c_width) << percentile;
+            for (auto histogram : histograms)
+            {
+                out << std::setw(c_width)
+                    << histogram->GetPercentile(percentile) * 1e6;
+            }
+            out << std::endl;
+        }
+
+        out << std::setw(c_width) << "max";
+        for (auto histogram : histograms)
+        {
+            out << std::setw(c_width) << histogram->GetMax() * 1e6;
+        }
+        out << std::endl;
+    }
+
+
+    size_t LatencyHistogram::GetBucket(uint64_t nanoseconds)
+    {
+        // Values below 2^c_subBucketBits each get their own bucket. Above
+        // that, a value with its most significant bit at position
+        // c_subBucketBits - 1 + shift lands in one of c_subBucketHalfCount
+        // buckets of width 2^shift.
+        unsigned shift = 0;
+        while ((nanoseconds >> shift) >= (2 * c_subBucketHalfCount))
+        {
+            ++shift;
+        }
+
+        return shift * c_subBucketHalfCount + (nanoseconds >> shift);
+    }
+
+
+    uint64_t LatencyHistogram::GetHighestEquivalentValue(size_t bucket)
+    {
+        if (bucket < 2 * c_subBucketHalfCount)
+        {
+            return bucket;
+        }
+
+        const size_t shift = bucket / c_subBucketHalfCount - 1;
+        const uint64_t subBucket = bucket - shift * c_subBucketHalfCount;
+        return ((subBucket + 1) << shift) - 1;
+    }
+}
@@ -0,0 +1,137 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <chrono>
+#include <cstdio>       // std::rename, std::remove.
+#include <fstream>
+
+#include "BitFunnel/Utilities/MetricsExporter.h"
+#include "BitFunnel/Utilities/MetricsRegistry.h"
+#include "LoggerInterfaces/Check.h"
+
+
+namespace BitFunnel
+{
+    MetricsExporter::MetricsExporter(MetricsRegistry const & registry,
+                                     char const * path,
+                                     double intervalSeconds)
+      : m_registry(registry),
+        m_path(path),
+        m_intervalSeconds(intervalSeconds),
+        m_snapshotCount(0),
+        m_failureCount(0),
+        m_stopping(false)
+    {
+        CHECK_GT(intervalSeconds, 0.0)
+            << "MetricsExporter interval must be positive.";
+
+        m_thread = std::thread(&MetricsExporter::ThreadEntry, this);
+    }
+
+
+    MetricsExporter::~MetricsExporter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stopping = true;
+        }
+        m_condition.notify_one();
+        m_thread.join();
+
+        WriteSnapshot();
+    }
+
+
+    bool MetricsExporter::WriteSnapshot()
+    {
+        std::lock_guard<std::mutex> lock(m_writeLock);
+
+        const std::string temp = m_path + ".tmp";
+        bool succeeded = false;
+        {
+            std::ofstream output(temp.c_str());
+            if (output.is_open())
+            {
+                m_registry.Write(output);
+                output.close();
+                succeeded = !output.fail();
+            }
+        }
+
+#ifdef _MSC_VER
+        // Windows' rename() will not replace an existing file.
+        if (succeeded)
+        {
+            std::remove(m_path.c_str());
+        }
+#endif
+        if (succeeded)
+        {
+            succeeded = (std::rename(temp.c_str(), m_path.c_str()) == 0);
+        }
+
+        if (succeeded)
+        {
+            ++m_snapshotCount;
+        }
+        else
+        {
+            ++m_failureCount;
+        }
+        return succeeded;
+    }
+
+
+    size_t MetricsExporter::GetSnapshotCount() const
+    {
+        return m_snapshotCount;
+    }
+
+
+    size_t MetricsExporter::GetFailureCount() const
+    {
+        return m_failureCount;
+    }
+
+
+    void MetricsExporter::ThreadEntry()
+    {
+        const auto interval =
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(m_intervalSeconds));
+        auto next = std::chrono::steady_clock::now();
+
+        for (;;)
+        {
+            WriteSnapshot();
+
+            next += interval;
+            std::unique_lock<std::mutex> lock(m_lock);
+            if (m_condition.wait_until(lock, next, [this] { return m_stopping; }))
+            {
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,362 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <iomanip>      // std::setprecision.
+#include <ostream>
+#include <sstream>
+#include <string>       // std::stod.
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Utilities/MetricsRegistry.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // MetricsRegistry::Counter
+    //
+    //*************************************************************************
+    MetricsRegistry::Counter::Counter()
+      : m_value(0)
+    {
+    }
+
+
+    void MetricsRegistry::Counter::Increment()
+    {
+        Increment(1);
+    }
+
+
+    void MetricsRegistry::Counter::Increment(uint64_t count)
+    {
+        m_value.fetch_add(count, std::memory_order_relaxed);
+    }
+
+
+    uint64_t MetricsRegistry::Counter::GetValue() const
+    {
+        return m_value.load(std::memory_order_relaxed);
+    }
+
+
+    //*************************************************************************
+    //
+    // MetricsRegistry::Gauge
+    //
+    //*************************************************************************
+    MetricsRegistry::Gauge::Gauge()
+      : m_value(0.0)
+    {
+    }
+
+
+    void MetricsRegistry::Gauge::Set(double value)
+    {
+        m_value.store(value, std::memory_order_relaxed);
+    }
+
+
+    double MetricsRegistry::Gauge::GetValue() const
+    {
+        return m_value.load(std::memory_order_relaxed);
+    }
+
+
+    //*************************************************************************
+    //
+    // MetricsRegistry::Histogram
+    //
+    //*************************************************************************
+    void MetricsRegistry::Histogram::Observe(double seconds)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_histogram.Record(seconds);
+    }
+
+
+    void MetricsRegistry::Histogram::Merge(LatencyHistogram const & histogram)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_histogram.Merge(histogram);
+    }
+
+
+    LatencyHistogram MetricsRegistry::Histogram::GetSnapshot() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_histogram;
+    }
+
+
+    //*************************************************************************
+    //
+    // MetricsRegistry::Metric
+    //
+    //*************************************************************************
+    class MetricsRegistry::Metric : public NonCopyable
+    {
+    public:
+        Metric(char const * help, Type type)
+          : m_help(help),
+            m_type(type)
+        {
+            switch (type)
+            {
+            case CounterType:
+                m_counter.reset(new Counter());
+                break;
+            case GaugeType:
+                m_gauge.reset(new Gauge());
+                break;
+            case HistogramType:
+                m_histogram.reset(new Histogram());
+                break;
+            default:
+                break;
+            }
+        }
+
+        std::string m_help;
+        Type m_type;
+        std::unique_ptr<Counter> m_counter;
+        std::unique_ptr<Gauge> m_gauge;
+        std::unique_ptr<Histogram> m_histogram;
+        std::function<double()> m_function;
+    };
+
+
+    //*************************************************************************
+    //
+    // MetricsRegistry
+    //
+    //*************************************************************************
+    MetricsRegistry::MetricsRegistry()
+    {
+    }
+
+
+    MetricsRegistry::~MetricsRegistry()
+    {
+    }
+
+
+    MetricsRegistry::Counter& MetricsRegistry::GetCounter(char const * name,
+                                                          char const * help)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return *GetMetric(name, help, CounterType).m_counter;
+    }
+
+
+    MetricsRegistry::Gauge& MetricsRegistry::GetGauge(char const * name,
+                                                      char const * help)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return *GetMetric(name, help, GaugeType).m_gauge;
+    }
+
+
+    MetricsRegistry::Histogram& MetricsRegistry::GetHistogram(char const * name,
+                                                              char const * help)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return *GetMetric(name, help, HistogramType).m_histogram;
+    }
+
+
+    void MetricsRegistry::AddCounter(char const * name,
+                                     char const * help,
+                                     std::function<double()> const & value)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        GetMetric(name, help, CounterFunctionType).m_function = value;
+    }
+
+
+    void MetricsRegistry::AddGauge(char const * name,
+                                   char const * help,
+                                   std::function<double()> const & value)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        GetMetric(name, help, GaugeFunctionType).m_function = value;
+    }
+
+
+    static bool IsValidName(char const * name)
+    {
+        if (*name == 0)
+        {
+            return false;
+        }
+        for (char const * p = name; *p != 0; ++p)
+        {
+            const char c = *p;
+            const bool isLetter = (c >= 'a' && c <= 'z') ||
+                                  (c >= 'A' && c <= 'Z') ||
+                                  c == '_' ||
+                                  c == ':';
+            const bool isDigit = (c >= '0' && c <= '9');
+            if (!isLetter && !(isDigit && p != name))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+
+    MetricsRegistry::Metric& MetricsRegistry::GetMetric(char const * name,
+                                                        char const * help,
+                                                        Type type)
+    {
+        if (!IsValidName(name))
+        {
+            std::stringstream message;
+            message << "MetricsRegistry: invalid metric name '" << name << "'.";
+            throw RecoverableError(message.str());
+        }
+
+        auto it = m_metrics.find(name);
+        if (it == m_metrics.end())
+        {
+            it = m_metrics.insert(
+                std::make_pair(std::string(name),
+                               std::unique_ptr<Metric>(new Metric(help, type)))).first;
+        }
+        else if (it->second->m_type != type)
+        {
+            std::stringstream message;
+            message << "MetricsRegistry: metric '"
+                    << name
+                    << "' was registered with a different type.";
+            throw RecoverableError(message.str());
+        }
+
+        return *it->second;
+    }
+
+
+    // Writes text escaped as required for # HELP lines.
+    static void WriteHelp(std::ostream& output, std::string const & help)
+    {
+        for (auto c : help)
+        {
+            if (c == '\\')
+            {
+                output << "\\\\";
+            }
+            else if (c == '\n')
+            {
+                output << "\\n";
+            }
+            else
+            {
+                output << c;
+            }
+        }
+    }
+
+
+    void MetricsRegistry::Write(std::ostream& output) const
+    {
+        // Upper bounds, in seconds, of the histogram buckets.
+        static char const * const c_bounds[] = {
+            "1e-05", "2.5e-05", "5e-05",
+            "0.0001", "0.00025", "0.0005",
+            "0.001", "0.0025", "0.005",
+            "0.01", "0.025", "0.05",
+            "0.1", "0.25", "0.5",
+            "1", "2.5", "5", "10"
+        };
+
+        const auto flags = output.flags();
+        const auto precision = output.precision();
+        // Callers may have left the stream in fixed or scientific mode.
+        output.unsetf(std::ios_base::floatfield);
+        output << std::setprecision(15);
+
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (auto const & entry : m_metrics)
+        {
+            std::string const & name = entry.first;
+            Metric const & metric = *entry.second;
+
+            output << "# HELP " << name << " ";
+            WriteHelp(output, metric.m_help);
+            output << std::endl;
+
+            output << "# TYPE " << name << " ";
+            switch (metric.m_type)
+            {
+            case CounterType:
+            case CounterFunctionType:
+                output << "counter";
+                break;
+            case GaugeType:
+            case GaugeFunctionType:
+                output << "gauge";
+                break;
+            case HistogramType:
+                output << "histogram";
+                break;
+            }
+            output << std::endl;
+
+            switch (metric.m_type)
+            {
+            case CounterType:
+                output << name << " " << metric.m_counter->GetValue() << std::endl;
+                break;
+            case GaugeType:
+                output << name << " " << metric.m_gauge->GetValue() << std::endl;
+                break;
+            case CounterFunctionType:
+            case GaugeFunctionType:
+                output << name << " " << metric.m_function() << std::endl;
+                break;
+            case HistogramType:
+                {
+                    const LatencyHistogram histogram =
+                        metric.m_histogram->GetSnapshot();
+                    for (auto bound : c_bounds)
+                    {
+                        output << name << "_bucket{le=\"" << bound << "\"} "
+                               << histogram.GetCountAtOrBelow(std::stod(bound))
+                               << std::endl;
+                    }
+                    output << name << "_bucket{le=\"+Inf\"} "
+                           << histogram.GetCount() << std::endl;
+                    output << name << "_sum " << histogram.GetSum() << std::endl;
+                    output << name << "_count " << histogram.GetCount() << std::endl;
+                }
+                break;
+            }
+        }
+
+        output.flags(flags);
+        output.precision(precision);
+    }
+}
@@ -5,6 +5,9 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>     // memcpy.
+
+#include "MurmurHash2.h"
 
 #if defined(_MSC_VER)
 #include <sal.h>
@@ -24,24 +27,36 @@ namespace BitFunnel
     // and endian-ness issues if used across multiple platforms.
     //*************************************************************************
 
-    // 64-bit hash for 64-bit platforms
-    uint64_t MurmurHash64A(const void *key, size_t len, unsigned seed)
+    static const uint64_t c_m = 0xc6a4a7935bd1e995;
+    static const int c_r = 47;
+
+
+    static uint64_t MixBlock(uint64_t h, const unsigned char *block)
+    {
+        uint64_t k;
+        memcpy(&k, block, sizeof(k));
+        k *= c_m;
+        k ^= k >> c_r;
+        k *= c_m;
+        h ^= k;
+        h *= c_m;
+        return h;
+    }
+
+
+    // Continues MurmurHash64A from hash state h, after the first
+    // blocksDone 8-byte blocks of key have been mixed in.
+    static uint64_t MurmurHash64AResume(uint64_t h,
+                                        const unsigned char *key,
+                                        size_t len,
+                                        size_t blocksDone)
     {
-        const uint64_t m = 0xc6a4a7935bd1e995;
-        const int r = 47;
-        uint64_t h = seed ^ (len * m);
-        const uint64_t *data = static_cast<const uint64_t *>(key);
-        const uint64_t *end = data + (len / 8);
-        while (data != end)
+        const size_t blocks = len / 8;
+        for (size_t b = blocksDone; b < blocks; ++b)
         {
-            uint64_t k = *data++;
-            k *= m;
-            k ^= k >> r;
-            k *= m;
-            h ^= k;
-            h *= m;
+            h = MixBlock(h, key + b * 8);
         }
-        const unsigned char *data2 = reinterpret_cast<const unsigned char *>(data);
+        const unsigned char *data2 = key + blocks * 8;
 
         switch(len &7)
         {
@@ -58,12 +73,56 @@ namespace BitFunnel
         case 2: h ^= uint64_t(data2[1]) << 8;
             BITFUNNEL_FALLTHROUGH;
         case 1: h ^= uint64_t(data2[0]);
-            h *= m;
+            h *= c_m;
         }
         ;
-        h ^= h >> r;
-        h *= m;
-        h ^= h >> r;
+        h ^= h >> c_r;
+        h *= c_m;
+        h ^= h >> c_r;
         return h;
     }
+
+
+    // 64-bit hash for 64-bit platforms
+    uint64_t MurmurHash64A(const void *key, size_t len, unsigned seed)
+    {
+        return MurmurHash64AResume(seed ^ (len * c_m),
+                                   static_cast<const unsigned char *>(key),
+                                   len,
+                                   0);
+    }
+
+
+    void MurmurHash64Ax4(const void * const keys[4],
+                         const size_t lens[4],
+                         unsigned seed,
+                         uint64_t hashes[4])
+    {
+        const unsigned char *data[4];
+        uint64_t h[4];
+        size_t commonBlocks = lens[0] / 8;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            data[i] = static_cast<const unsigned char *>(keys[i]);
+            h[i] = seed ^ (lens[i] * c_m);
+            if (lens[i] / 8 < commonBlocks)
+            {
+                commonBlocks = lens[i] / 8;
+            }
+        }
+
+        // Mix the blocks common to all four keys in lockstep.
+        for (size_t b = 0; b < commonBlocks; ++b)
+        {
+            h[0] = MixBlock(h[0], data[0] + b * 8);
+            h[1] = MixBlock(h[1], data[1] + b * 8);
+            h[2] = MixBlock(h[2], data[2] + b * 8);
+            h[3] = MixBlock(h[3], data[3] + b * 8);
+        }
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            hashes[i] = MurmurHash64AResume(h[i], data[i], lens[i], commonBlocks);
+        }
+    }
 }
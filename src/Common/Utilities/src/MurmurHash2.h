@@ -12,4 +12,12 @@ namespace BitFunnel
 {
     // 64-bit hash for 64-bit platforms
     uint64_t MurmurHash64A(const void *key, size_t len, unsigned seed);
+
+    // Computes MurmurHash64A for four keys at once. The results are identical
+    // to four calls to MurmurHash64A. The main loops of the four hashes are
+    // interleaved so that their multiply chains overlap in the pipeline.
+    void MurmurHash64Ax4(const void * const keys[4],
+                         const size_t lens[4],
+                         unsigned seed,
+                         uint64_t hashes[4]);
 }
@@ -81,6 +81,12 @@ namespace BitFunnel
     }
 
 
+    size_t TokenManager::GetInFlightTokenCount() const
+    {
+        return static_cast<size_t>(m_tokensInFlight.load());
+    }
+
+
     void TokenManager::Shutdown()
     {
         // LogAssertB(!m_isShuttingDown, "Multiple shutdowns seen.\n");
@@ -62,6 +62,7 @@ namespace BitFunnel
 
         virtual Token RequestToken() override;
         virtual const std::shared_ptr<ITokenTracker> StartTracker() override;
+        virtual size_t GetInFlightTokenCount() const override;
         virtual void Shutdown() override;
 
     private:
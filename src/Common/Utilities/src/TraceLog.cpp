@@ -0,0 +1,428 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <algorithm>    // std::sort.
+#include <atomic>
+#include <chrono>
+#include <iomanip>      // std::setprecision.
+#include <memory>       // std::unique_ptr.
+#include <mutex>
+#include <ostream>
+#include <stdint.h>     // uint64_t.
+#include <vector>
+
+#include "BitFunnel/Utilities/TraceLog.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // TraceBuffer
+    //
+    // Single writer ring buffer of trace events owned by one thread. The
+    // fields of each event are atomics so that WriteChromeTrace() may read a
+    // buffer while its thread is still writing. The writer publishes an
+    // event by incrementing m_writeCount after filling in its slot. A reader
+    // discards any event whose slot may have been reused while it was being
+    // copied.
+    //
+    //*************************************************************************
+    class TraceBuffer
+    {
+    public:
+        struct Event
+        {
+            char const * m_category;
+            char const * m_name;
+            uint64_t m_nanoseconds;
+            size_t m_thread;
+            bool m_begin;
+        };
+
+        TraceBuffer(size_t thread)
+          : m_thread(thread),
+            m_writeCount(0),
+            m_clearCount(0)
+        {
+        }
+
+
+        void Record(char const * category, char const * name, bool begin)
+        {
+            const uint64_t count = m_writeCount.load(std::memory_order_relaxed);
+            Slot & slot = m_slots[count & c_slotMask];
+
+            // Relaxed stores compile to ordinary stores. The release store
+            // of m_writeCount orders them before the event is published.
+            slot.m_category.store(category, std::memory_order_relaxed);
+            slot.m_name.store(name, std::memory_order_relaxed);
+            slot.m_nanoseconds.store(Now(), std::memory_order_relaxed);
+            slot.m_begin.store(begin, std::memory_order_relaxed);
+
+            m_writeCount.store(count + 1, std::memory_order_release);
+        }
+
+
+        // Must be called with the registry lock held.
+        void Clear()
+        {
+            m_clearCount = m_writeCount.load(std::memory_order_acquire);
+        }
+
+
+        // Must be called with the registry lock held.
+        void Read(std::vector<Event>& events) const
+        {
+            const uint64_t end = m_writeCount.load(std::memory_order_acquire);
+            const uint64_t start = FirstRetained(end);
+
+            const size_t first = events.size();
+            for (uint64_t i = start; i < end; ++i)
+            {
+                Slot const & slot = m_slots[i & c_slotMask];
+                Event event;
+                event.m_category = slot.m_category.load(std::memory_order_relaxed);
+                event.m_name = slot.m_name.load(std::memory_order_relaxed);
+                event.m_nanoseconds = slot.m_nanoseconds.load(std::memory_order_relaxed);
+                event.m_begin = slot.m_begin.load(std::memory_order_relaxed);
+                event.m_thread = m_thread;
+                events.push_back(event);
+            }
+
+            // The writer may have wrapped around onto slots that were copied
+            // above. Drop events from slots that could have been reused.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t after = m_writeCount.load(std::memory_order_relaxed);
+            const uint64_t valid = FirstRetained(after);
+            if (valid > start)
+            {
+                const size_t overwritten =
+                    static_cast<size_t>((std::min)(valid, end) - start);
+                events.erase(events.begin() + static_cast<ptrdiff_t>(first),
+                             events.begin() + static_cast<ptrdiff_t>(first + overwritten));
+            }
+        }
+
+
+        static uint64_t Now()
+        {
+            using namespace std::chrono;
+            return static_cast<uint64_t>(
+                duration_cast<nanoseconds>(
+                    steady_clock::now().time_since_epoch()).count());
+        }
+
+    private:
+        uint64_t FirstRetained(uint64_t writeCount) const
+        {
+            const uint64_t oldest =
+                (writeCount > c_slotCount) ? writeCount - c_slotCount : 0;
+            return (std::max)(oldest, m_clearCount);
+        }
+
+        struct Slot
+        {
+            std::atomic<char const *> m_category;
+            std::atomic<char const *> m_name;
+            std::atomic<uint64_t> m_nanoseconds;
+            std::atomic<bool> m_begin;
+        };
+
+        static const size_t c_log2SlotCount = 15;
+        static const size_t c_slotCount = 1ull << c_log2SlotCount;
+        static const size_t c_slotMask = c_slotCount - 1;
+
+        const size_t m_thread;
+        std::atomic<uint64_t> m_writeCount;
+        uint64_t m_clearCount;
+        Slot m_slots[c_slotCount];
+    };
+
+
+    //*************************************************************************
+    //
+    // TraceRegistry
+    //
+    // Owns the TraceBuffer of every thread that has recorded an event. A
+    // thread's buffer is returned to the free list when the thread exits,
+    // but keeps its events so that short lived threads, such as ingestion
+    // workers, still appear in the trace.
+    //
+    //*************************************************************************
+    class TraceRegistry
+    {
+    public:
+        TraceRegistry()
+          : m_enabled(false)
+        {
+        }
+
+
+        TraceBuffer& AcquireBuffer()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (!m_freeBuffers.empty())
+            {
+                TraceBuffer* buffer = m_freeBuffers.back();
+                m_freeBuffers.pop_back();
+                return *buffer;
+            }
+            m_buffers.emplace_back(new TraceBuffer(m_buffers.size() + 1));
+            return *m_buffers.back();
+        }
+
+
+        void ReleaseBuffer(TraceBuffer& buffer)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_freeBuffers.push_back(&buffer);
+        }
+
+
+        size_t GetBufferCount() const
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            return m_buffers.size();
+        }
+
+
+        void Clear()
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            for (auto & buffer : m_buffers)
+            {
+                buffer->Clear();
+            }
+        }
+
+
+        std::vector<TraceBuffer::Event> Read() const
+        {
+            std::vector<TraceBuffer::Event> events;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                for (auto & buffer : m_buffers)
+                {
+                    buffer->Read(events);
+                }
+            }
+
+            std::stable_sort(events.begin(),
+                             events.end(),
+                             [](TraceBuffer::Event const & a,
+                                TraceBuffer::Event const & b)
+                             {
+                                 return a.m_nanoseconds < b.m_nanoseconds;
+                             });
+            return events;
+        }
+
+
+        std::atomic<bool> m_enabled;
+
+    private:
+        mutable std::mutex m_lock;
+        std::vector<std::unique_ptr<TraceBuffer>> m_buffers;
+        std::vector<TraceBuffer*> m_freeBuffers;
+    };
+
+
+    static TraceRegistry& GetRegistry()
+    {
+        static TraceRegistry registry;
+        return registry;
+    }
+
+
+    //*************************************************************************
+    //
+    // ThreadTraceBuffer
+    //
+    // Holds the calling thread's TraceBuffer, acquiring it on first use and
+    // returning it to the registry when the thread exits.
+    //
+    //*************************************************************************
+    class ThreadTraceBuffer : public NonCopyable
+    {
+    public:
+        ThreadTraceBuffer()
+          : m_buffer(nullptr)
+        {
+        }
+
+
+        ~ThreadTraceBuffer()
+        {
+            if (m_buffer != nullptr)
+            {
+                GetRegistry().ReleaseBuffer(*m_buffer);
+            }
+        }
+
+
+        TraceBuffer& Get()
+        {
+            if (m_buffer == nullptr)
+            {
+                m_buffer = &GetRegistry().AcquireBuffer();
+            }
+            return *m_buffer;
+        }
+
+    private:
+        TraceBuffer* m_buffer;
+    };
+
+
+    static void Record(char const * category, char const * name, bool begin)
+    {
+        static thread_local ThreadTraceBuffer buffer;
+        buffer.Get().Record(category, name, begin);
+    }
+
+
+    //*************************************************************************
+    //
+    // TraceLog
+    //
+    //*************************************************************************
+    void TraceLog::Enable()
+    {
+        GetRegistry().m_enabled.store(true, std::memory_order_relaxed);
+    }
+
+
+    void TraceLog::Disable()
+    {
+        GetRegistry().m_enabled.store(false, std::memory_order_relaxed);
+    }
+
+
+    bool TraceLog::IsEnabled()
+    {
+        return GetRegistry().m_enabled.load(std::memory_order_relaxed);
+    }
+
+
+    void TraceLog::Begin(char const * category, char const * name)
+    {
+        if (IsEnabled())
+        {
+            Record(category, name, true);
+        }
+    }
+
+
+    void TraceLog::End(char const * category, char const * name)
+    {
+        if (IsEnabled())
+        {
+            Record(category, name, false);
+        }
+    }
+
+
+    void TraceLog::Clear()
+    {
+        GetRegistry().Clear();
+    }
+
+
+    size_t TraceLog::GetEventCount()
+    {
+        return GetRegistry().Read().size();
+    }
+
+
+    size_t TraceLog::GetBufferCount()
+    {
+        return GetRegistry().GetBufferCount();
+    }
+
+
+    void TraceLog::WriteChromeTrace(std::ostream& output)
+    {
+        auto events = GetRegistry().Read();
+
+        // Timestamps are in microseconds relative to the first event.
+        const uint64_t origin = events.empty() ? 0 : events.front().m_nanoseconds;
+
+        const auto flags = output.flags();
+        const auto precision = output.precision();
+        output << std::fixed << std::setprecision(3);
+
+        output << "{\"traceEvents\":[";
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            auto const & event = events[i];
+            output
+                << ((i == 0) ? "\n" : ",\n")
+                << "{\"name\":\"" << event.m_name << "\""
+                << ",\"cat\":\"" << event.m_category << "\""
+                << ",\"ph\":\"" << (event.m_begin ? "B" : "E") << "\""
+                << ",\"ts\":" << (event.m_nanoseconds - origin) / 1000.0
+                << ",\"pid\":1"
+                << ",\"tid\":" << event.m_thread
+                << "}";
+        }
+        output << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+
+        output.flags(flags);
+        output.precision(precision);
+    }
+
+
+    //*************************************************************************
+    //
+    // TraceScope
+    //
+    //*************************************************************************
+    TraceScope::TraceScope(char const * category, char const * name)
+      : m_category(category),
+        m_name(name),
+        m_enabled(TraceLog::IsEnabled())
+    {
+        if (m_enabled)
+        {
+            Record(m_category, m_name, true);
+        }
+    }
+
+
+    TraceScope::~TraceScope()
+    {
+        End();
+    }
+
+
+    void TraceScope::End()
+    {
+        if (m_enabled)
+        {
+            Record(m_category, m_name, false);
+            m_enabled = false;
+        }
+    }
+}
@@ -0,0 +1,145 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <string.h>     // memcpy.
+
+#include "XXHash64.h"
+
+
+namespace BitFunnel
+{
+    static const uint64_t c_prime1 = 0x9E3779B185EBCA87ull;
+    static const uint64_t c_prime2 = 0xC2B2AE3D27D4EB4Full;
+    static const uint64_t c_prime3 = 0x165667B19E3779F9ull;
+    static const uint64_t c_prime4 = 0x85EBCA77C2B2AE63ull;
+    static const uint64_t c_prime5 = 0x27D4EB2F165667C5ull;
+
+
+    static uint64_t RotateLeft(uint64_t x, int r)
+    {
+        return (x << r) | (x >> (64 - r));
+    }
+
+
+    static uint64_t Read64(const unsigned char * p)
+    {
+        uint64_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+
+    static uint32_t Read32(const unsigned char * p)
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+
+    static uint64_t Round(uint64_t accumulator, uint64_t input)
+    {
+        accumulator += input * c_prime2;
+        accumulator = RotateLeft(accumulator, 31);
+        return accumulator * c_prime1;
+    }
+
+
+    static uint64_t MergeRound(uint64_t accumulator, uint64_t value)
+    {
+        accumulator ^= Round(0, value);
+        return accumulator * c_prime1 + c_prime4;
+    }
+
+
+    // Like MurmurHash64A, this reads words in native byte order and so
+    // assumes a little-endian platform.
+    uint64_t XXHash64(const void * key, size_t len, uint64_t seed)
+    {
+        const unsigned char * p = static_cast<const unsigned char *>(key);
+        const unsigned char * const end = p + len;
+        uint64_t h;
+
+        if (len >= 32)
+        {
+            // Four independent lanes, each consuming eight bytes per stripe.
+            const unsigned char * const limit = end - 32;
+            uint64_t v1 = seed + c_prime1 + c_prime2;
+            uint64_t v2 = seed + c_prime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - c_prime1;
+
+            do
+            {
+                v1 = Round(v1, Read64(p));
+                v2 = Round(v2, Read64(p + 8));
+                v3 = Round(v3, Read64(p + 16));
+                v4 = Round(v4, Read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            h = RotateLeft(v1, 1) + RotateLeft(v2, 7) +
+                RotateLeft(v3, 12) + RotateLeft(v4, 18);
+            h = MergeRound(h, v1);
+            h = MergeRound(h, v2);
+            h = MergeRound(h, v3);
+            h = MergeRound(h, v4);
+        }
+        else
+        {
+            h = seed + c_prime5;
+        }
+
+        h += static_cast<uint64_t>(len);
+
+        while (p + 8 <= end)
+        {
+            h ^= Round(0, Read64(p));
+            h = RotateLeft(h, 27) * c_prime1 + c_prime4;
+            p += 8;
+        }
+
+        if (p + 4 <= end)
+        {
+            h ^= static_cast<uint64_t>(Read32(p)) * c_prime1;
+            h = RotateLeft(h, 23) * c_prime2 + c_prime3;
+            p += 4;
+        }
+
+        while (p < end)
+        {
+            h ^= static_cast<uint64_t>(*p) * c_prime5;
+            h = RotateLeft(h, 11) * c_prime1;
+            ++p;
+        }
+
+        // Final avalanche.
+        h ^= h >> 33;
+        h *= c_prime2;
+        h ^= h >> 29;
+        h *= c_prime3;
+        h ^= h >> 32;
+
+        return h;
+    }
+}
@@ -0,0 +1,96 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Utilities/FastModulo.h"
+
+
+namespace BitFunnel
+{
+    namespace FastModuloTest
+    {
+        static void VerifyDivisor(uint64_t divisor,
+                                  std::vector<uint64_t> const & dividends)
+        {
+            FastModulo modulo(divisor);
+            EXPECT_EQ(divisor, modulo.GetDivisor());
+            for (auto x : dividends)
+            {
+                ASSERT_EQ(x / divisor, modulo.Divide(x))
+                    << x << " / " << divisor;
+                ASSERT_EQ(x % divisor, modulo.Modulo(x))
+                    << x << " % " << divisor;
+            }
+        }
+
+
+        TEST(FastModulo, MatchesHardwareDivide)
+        {
+            std::mt19937_64 random(12345);
+
+            std::vector<uint64_t> dividends = {
+                0ull, 1ull, 2ull, 3ull, 63ull, 64ull, 65ull,
+                0xffffffffull, 0x100000000ull,
+                0x7fffffffffffffffull, 0x8000000000000000ull,
+                0xfffffffffffffffeull, 0xffffffffffffffffull
+            };
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                dividends.push_back(random());
+            }
+
+            // Small divisors, including every power of two and the values
+            // on either side of it.
+            for (uint64_t d = 1; d < 1000; ++d)
+            {
+                VerifyDivisor(d, dividends);
+            }
+            for (unsigned bit = 1; bit < 64; ++bit)
+            {
+                VerifyDivisor((1ull << bit) - 1, dividends);
+                VerifyDivisor(1ull << bit, dividends);
+                VerifyDivisor((1ull << bit) + 1, dividends);
+            }
+            VerifyDivisor(0xffffffffffffffffull, dividends);
+
+            // Random divisors of every magnitude.
+            for (size_t i = 0; i < 1000; ++i)
+            {
+                VerifyDivisor((random() >> (i % 64)) | 1, dividends);
+            }
+        }
+
+
+        TEST(FastModulo, Default)
+        {
+            FastModulo modulo;
+            EXPECT_EQ(1u, modulo.GetDivisor());
+            EXPECT_EQ(0u, modulo.Modulo(12345));
+            EXPECT_EQ(12345u, modulo.Divide(12345));
+        }
+    }
+}
@@ -0,0 +1,87 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cstring>  // strlen.
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Utilities/HardwareCounters.h"
+
+
+namespace BitFunnel
+{
+    namespace HardwareCountersTest
+    {
+        TEST(HardwareCounters, Names)
+        {
+            for (size_t i = 0; i < HardwareCounters::CounterCount; ++i)
+            {
+                auto counter = static_cast<HardwareCounters::Counter>(i);
+                ASSERT_NE(HardwareCounters::GetName(counter), nullptr);
+                EXPECT_GT(strlen(HardwareCounters::GetName(counter)), 0u);
+            }
+        }
+
+
+        TEST(HardwareCounters, StartStop)
+        {
+            // Many build and test hosts forbid perf events, so this test
+            // only checks counts when the host provides them. In either case
+            // Start() and Stop() must be safe to call.
+            HardwareCounters counters;
+
+            bool anyAvailable = false;
+            for (size_t i = 0; i < HardwareCounters::CounterCount; ++i)
+            {
+                auto counter = static_cast<HardwareCounters::Counter>(i);
+                anyAvailable = anyAvailable || counters.IsAvailable(counter);
+            }
+            EXPECT_EQ(anyAvailable, counters.IsAvailable());
+
+            const size_t c_iterations = 100000;
+            volatile size_t sum = 0;
+
+            counters.Start();
+            for (size_t i = 0; i < c_iterations; ++i)
+            {
+                sum = sum + i;
+            }
+            counters.Stop();
+
+            for (size_t i = 0; i < HardwareCounters::CounterCount; ++i)
+            {
+                auto counter = static_cast<HardwareCounters::Counter>(i);
+                if (!counters.IsAvailable(counter))
+                {
+                    EXPECT_EQ(counters.GetValue(counter), 0u);
+                }
+            }
+
+            if (counters.IsAvailable(HardwareCounters::Instructions))
+            {
+                EXPECT_GE(counters.GetValue(HardwareCounters::Instructions),
+                          c_iterations);
+            }
+        }
+    }
+}
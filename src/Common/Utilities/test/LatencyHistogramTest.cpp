@@ -0,0 +1,100 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Utilities/LatencyHistogram.h"
+
+
+namespace BitFunnel
+{
+    namespace LatencyHistogramTest
+    {
+        TEST(LatencyHistogram, Empty)
+        {
+            LatencyHistogram histogram;
+            EXPECT_EQ(histogram.GetCount(), 0u);
+            EXPECT_EQ(histogram.GetPercentile(50.0), 0.0);
+            EXPECT_EQ(histogram.GetMax(), 0.0);
+            EXPECT_EQ(histogram.GetMean(), 0.0);
+        }
+
+
+        TEST(LatencyHistogram, Percentiles)
+        {
+            // Record 1us, 2us, ..., 10000us.
+            LatencyHistogram histogram;
+            const size_t c_count = 10000;
+            for (size_t i = 1; i <= c_count; ++i)
+            {
+                histogram.Record(i * 1e-6);
+            }
+
+            EXPECT_EQ(histogram.GetCount(), c_count);
+            EXPECT_NEAR(histogram.GetMax(), 10000e-6, 1e-9);
+            EXPECT_NEAR(histogram.GetMean(), 5000.5e-6, 5000.5e-6 * 0.01);
+
+            const double c_percentiles[] = { 1.0, 50.0, 90.0, 99.0, 99.9, 100.0 };
+            for (auto percentile : c_percentiles)
+            {
+                const double expected = percentile * 100e-6;
+                const double observed = histogram.GetPercentile(percentile);
+                EXPECT_GE(observed, expected * 0.99);
+                EXPECT_LE(observed, expected * 1.01);
+            }
+        }
+
+
+        TEST(LatencyHistogram, WideRange)
+        {
+            // Values spanning nanoseconds to minutes must all be kept to
+            // within 1% relative error.
+            const double c_values[] = { 1e-9, 37e-9, 255e-9, 1e-6, 3.3e-3, 1.7, 600.0 };
+            for (auto value : c_values)
+            {
+                LatencyHistogram histogram;
+                histogram.Record(value);
+                EXPECT_GE(histogram.GetPercentile(50.0), value * 0.99);
+                EXPECT_LE(histogram.GetPercentile(50.0), value * 1.01);
+            }
+        }
+
+
+        TEST(LatencyHistogram, Merge)
+        {
+            LatencyHistogram low;
+            LatencyHistogram high;
+            for (size_t i = 0; i < 99; ++i)
+            {
+                low.Record(1e-3);
+            }
+            high.Record(1.0);
+
+            low.Merge(high);
+            EXPECT_EQ(low.GetCount(), 100u);
+            EXPECT_NEAR(low.GetPercentile(99.0), 1e-3, 1e-5);
+            EXPECT_NEAR(low.GetPercentile(99.9), 1.0, 1e-2);
+            EXPECT_NEAR(low.GetMax(), 1.0, 1e-9);
+        }
+    }
+}
@@ -0,0 +1,164 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Utilities/MetricsExporter.h"
+#include "BitFunnel/Utilities/MetricsRegistry.h"
+
+
+namespace BitFunnel
+{
+    namespace MetricsRegistryTest
+    {
+        static std::string Write(MetricsRegistry const & registry)
+        {
+            std::stringstream output;
+            registry.Write(output);
+            return output.str();
+        }
+
+
+        TEST(MetricsRegistry, CounterAndGauge)
+        {
+            MetricsRegistry registry;
+
+            auto & counter = registry.GetCounter("requests_total", "Requests.");
+            counter.Increment();
+            counter.Increment(4);
+            EXPECT_EQ(5u, counter.GetValue());
+
+            // Same name and type returns the same metric.
+            EXPECT_EQ(&counter,
+                      &registry.GetCounter("requests_total", "Requests."));
+
+            registry.GetGauge("temperature", "Temperature.").Set(2.5);
+
+            const std::string expected =
+                "# HELP requests_total Requests.\n"
+                "# TYPE requests_total counter\n"
+                "requests_total 5\n"
+                "# HELP temperature Temperature.\n"
+                "# TYPE temperature gauge\n"
+                "temperature 2.5\n";
+            EXPECT_EQ(expected, Write(registry));
+        }
+
+
+        TEST(MetricsRegistry, FunctionMetrics)
+        {
+            MetricsRegistry registry;
+
+            double value = 1;
+            registry.AddGauge("value", "A value.", [&value]() { return value; });
+            registry.AddCounter("total", "A total.", []() { return 7.0; });
+
+            EXPECT_NE(std::string::npos, Write(registry).find("\nvalue 1\n"));
+            value = 3;
+            std::string output = Write(registry);
+            EXPECT_NE(std::string::npos, output.find("\nvalue 3\n"));
+            EXPECT_NE(std::string::npos, output.find("# TYPE total counter\ntotal 7\n"));
+        }
+
+
+        TEST(MetricsRegistry, Histogram)
+        {
+            MetricsRegistry registry;
+
+            auto & histogram = registry.GetHistogram("latency_seconds", "Latency.");
+            histogram.Observe(0.001);
+
+            LatencyHistogram other;
+            other.Record(2.0);
+            histogram.Merge(other);
+
+            const std::string output = Write(registry);
+            EXPECT_NE(std::string::npos,
+                      output.find("# TYPE latency_seconds histogram\n"));
+            EXPECT_NE(std::string::npos,
+                      output.find("latency_seconds_bucket{le=\"1e-05\"} 0\n"));
+            EXPECT_NE(std::string::npos,
+                      output.find("latency_seconds_bucket{le=\"0.01\"} 1\n"));
+            EXPECT_NE(std::string::npos,
+                      output.find("latency_seconds_bucket{le=\"10\"} 2\n"));
+            EXPECT_NE(std::string::npos,
+                      output.find("latency_seconds_bucket{le=\"+Inf\"} 2\n"));
+            EXPECT_NE(std::string::npos,
+                      output.find("latency_seconds_count 2\n"));
+        }
+
+
+        TEST(MetricsRegistry, Errors)
+        {
+            MetricsRegistry registry;
+            registry.GetCounter("name", "Help.");
+
+            EXPECT_THROW(registry.GetGauge("name", "Help."), RecoverableError);
+            EXPECT_THROW(registry.GetCounter("1name", "Help."), RecoverableError);
+            EXPECT_THROW(registry.GetCounter("a-name", "Help."), RecoverableError);
+        }
+
+
+        TEST(MetricsRegistry, HelpEscaping)
+        {
+            MetricsRegistry registry;
+            registry.GetCounter("name", "Back\\slash\nnewline.");
+            EXPECT_NE(std::string::npos,
+                      Write(registry).find("# HELP name Back\\\\slash\\nnewline.\n"));
+        }
+
+
+        TEST(MetricsExporter, WritesFile)
+        {
+            char const * path = "MetricsExporterTest.prom";
+            MetricsRegistry registry;
+            registry.GetCounter("exported_total", "Exported.").Increment(3);
+
+            {
+                // The background thread may or may not have written its
+                // first snapshot yet.
+                MetricsExporter exporter(registry, path, 3600);
+                EXPECT_TRUE(exporter.WriteSnapshot());
+                EXPECT_GE(exporter.GetSnapshotCount(), 1u);
+                EXPECT_EQ(0u, exporter.GetFailureCount());
+                registry.GetCounter("exported_total", "Exported.").Increment();
+            }
+
+            std::ifstream input(path);
+            ASSERT_TRUE(input.good());
+            std::stringstream contents;
+            contents << input.rdbuf();
+            input.close();
+            std::remove(path);
+
+            EXPECT_NE(std::string::npos,
+                      contents.str().find("\nexported_total 4\n"));
+        }
+    }
+}
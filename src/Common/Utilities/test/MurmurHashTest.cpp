@@ -20,6 +20,9 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <random>
+#include <vector>
+
 #include "MurmurHash2.h"
 #include "gtest/gtest.h"
 
@@ -37,5 +40,38 @@ namespace BitFunnel
             // like FarmHash or SipHash.
 
         }
+
+
+        //*********************************************************************
+        TEST(MurmurHashTest, FourWayMatchesSingle)
+        {
+            std::mt19937 random(1234);
+            std::vector<char> text(64);
+            for (auto & c : text)
+            {
+                c = static_cast<char>('a' + random() % 26);
+            }
+
+            // Exercise every combination of block count and tail length,
+            // with keys of different lengths in the same batch.
+            for (size_t len = 0; len < 40; ++len)
+            {
+                void const * keys[4];
+                size_t lens[4];
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    keys[i] = text.data() + i;
+                    lens[i] = (len + i * 7) % 41;
+                }
+
+                uint64_t hashes[4];
+                MurmurHash64Ax4(keys, lens, 123456789, hashes);
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    EXPECT_EQ(MurmurHash64A(keys[i], lens[i], 123456789),
+                              hashes[i]);
+                }
+            }
+        }
     }
 }
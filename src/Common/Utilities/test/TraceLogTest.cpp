@@ -0,0 +1,218 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <atomic>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Utilities/TraceLog.h"
+
+
+namespace BitFunnel
+{
+    namespace TraceLogTest
+    {
+        // Returns the number of occurrences of pattern in text.
+        static size_t Count(std::string const & text, char const * pattern)
+        {
+            size_t count = 0;
+            const std::string p(pattern);
+            for (size_t pos = text.find(p);
+                 pos != std::string::npos;
+                 pos = text.find(p, pos + p.size()))
+            {
+                ++count;
+            }
+            return count;
+        }
+
+
+        TEST(TraceLog, Disabled)
+        {
+            TraceLog::Disable();
+            TraceLog::Clear();
+
+            {
+                TraceScope scope("test", "Disabled");
+                TraceLog::Begin("test", "Disabled");
+                TraceLog::End("test", "Disabled");
+            }
+
+            EXPECT_EQ(0u, TraceLog::GetEventCount());
+        }
+
+
+        TEST(TraceLog, ChromeTrace)
+        {
+            TraceLog::Clear();
+            TraceLog::Enable();
+
+            const size_t c_threadCount = 4;
+            const size_t c_spanCount = 100;
+
+            // No thread exits until every thread has recorded, so that none
+            // reuses the buffer of a thread that has already exited.
+            std::atomic<size_t> finished(0);
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < c_threadCount; ++t)
+            {
+                threads.emplace_back([&finished]()
+                {
+                    for (size_t i = 0; i < c_spanCount; ++i)
+                    {
+                        TraceScope outer("test", "Outer");
+                        TraceScope inner("test", "Inner");
+                    }
+                    ++finished;
+                    while (finished.load() < c_threadCount) {}
+                });
+            }
+            for (auto & thread : threads)
+            {
+                thread.join();
+            }
+
+            TraceLog::Disable();
+
+            EXPECT_EQ(c_threadCount * c_spanCount * 4, TraceLog::GetEventCount());
+
+            std::stringstream output;
+            TraceLog::WriteChromeTrace(output);
+            const std::string json = output.str();
+
+            EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+            EXPECT_EQ(c_threadCount * c_spanCount * 2,
+                      Count(json, "\"ph\":\"B\""));
+            EXPECT_EQ(c_threadCount * c_spanCount * 2,
+                      Count(json, "\"ph\":\"E\""));
+            EXPECT_EQ(c_threadCount * c_spanCount * 2,
+                      Count(json, "\"name\":\"Inner\""));
+
+            // Each thread gets its own track.
+            std::set<std::string> tids;
+            for (size_t pos = json.find("\"tid\":");
+                 pos != std::string::npos;
+                 pos = json.find("\"tid\":", pos + 1))
+            {
+                tids.insert(json.substr(pos, json.find('}', pos) - pos));
+            }
+            EXPECT_EQ(c_threadCount, tids.size());
+
+            TraceLog::Clear();
+            EXPECT_EQ(0u, TraceLog::GetEventCount());
+        }
+
+
+        TEST(TraceLog, ScopeEnd)
+        {
+            TraceLog::Clear();
+            TraceLog::Enable();
+
+            std::thread thread([]()
+            {
+                // A span closed early with End() and one closed by the
+                // destructor while an exception unwinds.
+                TraceScope closed("test", "Closed");
+                closed.End();
+                closed.End();
+                try
+                {
+                    TraceScope thrown("test", "Thrown");
+                    throw std::runtime_error("unwind");
+                }
+                catch (std::runtime_error const &)
+                {
+                }
+            });
+            thread.join();
+
+            TraceLog::Disable();
+
+            std::stringstream output;
+            TraceLog::WriteChromeTrace(output);
+            const std::string json = output.str();
+            EXPECT_EQ(2u, Count(json, "\"ph\":\"B\""));
+            EXPECT_EQ(2u, Count(json, "\"ph\":\"E\""));
+
+            TraceLog::Clear();
+        }
+
+
+        TEST(TraceLog, ThreadExit)
+        {
+            TraceLog::Clear();
+            TraceLog::Enable();
+
+            // Threads that run one after another share a single buffer.
+            const size_t c_threadCount = 50;
+            std::thread first([]() { TraceScope scope("test", "ThreadExit"); });
+            first.join();
+            const size_t bufferCount = TraceLog::GetBufferCount();
+            for (size_t t = 1; t < c_threadCount; ++t)
+            {
+                std::thread thread([]() { TraceScope scope("test", "ThreadExit"); });
+                thread.join();
+            }
+
+            TraceLog::Disable();
+
+            EXPECT_EQ(bufferCount, TraceLog::GetBufferCount());
+            EXPECT_EQ(c_threadCount * 2, TraceLog::GetEventCount());
+
+            TraceLog::Clear();
+        }
+
+
+        TEST(TraceLog, Wraparound)
+        {
+            TraceLog::Clear();
+            TraceLog::Enable();
+
+            // Record far more events than a thread's buffer holds. Only the
+            // most recent events are kept.
+            const size_t c_spanCount = 100000;
+            std::thread thread([]()
+            {
+                for (size_t i = 0; i < c_spanCount; ++i)
+                {
+                    TraceScope scope("test", "Wraparound");
+                }
+            });
+            thread.join();
+
+            TraceLog::Disable();
+
+            const size_t count = TraceLog::GetEventCount();
+            EXPECT_GT(count, 0u);
+            EXPECT_LT(count, c_spanCount * 2);
+
+            TraceLog::Clear();
+        }
+    }
+}
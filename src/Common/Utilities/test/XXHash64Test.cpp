@@ -0,0 +1,60 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "XXHash64.h"
+
+
+namespace BitFunnel
+{
+    namespace XXHash64Test
+    {
+        static uint64_t Hash(std::string const & text, uint64_t seed)
+        {
+            return XXHash64(text.c_str(), text.size(), seed);
+        }
+
+
+        //*********************************************************************
+        TEST(XXHash64Test, ReferenceValues)
+        {
+            // Values from the reference implementation. The last key is
+            // long enough to use the four-lane main loop.
+            EXPECT_EQ(0xEF46DB3751D8E999ull, Hash("", 0));
+            EXPECT_EQ(0xD24EC4F1A98C6E5Bull, Hash("a", 0));
+            EXPECT_EQ(0x44BC2CF5AD770999ull, Hash("abc", 0));
+            EXPECT_EQ(0xFBCEA83C8A378BF1ull,
+                      Hash("Nobody inspects the spammish repetition", 0));
+        }
+
+
+        //*********************************************************************
+        TEST(XXHash64Test, Seed)
+        {
+            EXPECT_NE(Hash("abc", 0), Hash("abc", 1));
+        }
+    }
+}
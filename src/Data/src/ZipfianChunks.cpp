@@ -0,0 +1,329 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <sstream>
+
+#include "BitFunnel/Data/ZipfianChunks.h"
+#include "LoggerInterfaces/Check.h"
+
+
+namespace BitFunnel
+{
+    // Fractions of the postings mass at which the torso and tail bands of
+    // the vocabulary begin.
+    static const double c_torsoMass = 0.5;
+    static const double c_tailMass = 0.9;
+
+    static const double c_pi = 3.14159265358979323846;
+
+
+    ZipfianChunks::ZipfianChunks(unsigned seed,
+                                 size_t vocabularySize,
+                                 double zipfExponent,
+                                 size_t documentCount,
+                                 size_t chunkCount,
+                                 size_t streamCount,
+                                 double meanTermsPerStream,
+                                 double termsPerStreamDeviation)
+        : m_seed(seed),
+          m_documentCount(documentCount),
+          m_chunkCount(chunkCount),
+          m_streamCount(streamCount)
+    {
+        CHECK_GT(vocabularySize, 0u)
+            << "Vocabulary must contain at least one term.";
+        CHECK_GE(zipfExponent, 0.0)
+            << "Zipf exponent must not be negative.";
+        CHECK_GT(chunkCount, 0u)
+            << "Corpus must have at least one chunk.";
+        CHECK_GT(streamCount, 0u)
+            << "Documents must have at least one stream.";
+        CHECK_LE(streamCount, 256u)
+            << "Stream ids are limited to two hex digits.";
+        CHECK_GE(meanTermsPerStream, 1.0)
+            << "Streams must average at least one term.";
+        CHECK_GE(termsPerStreamDeviation, 0.0)
+            << "Terms per stream deviation must not be negative.";
+
+        // Convert the mean and standard deviation of the stream length into
+        // the parameters of the underlying normal distribution.
+        const double ratio = termsPerStreamDeviation / meanTermsPerStream;
+        m_lengthSigma = std::sqrt(std::log(1.0 + ratio * ratio));
+        m_lengthMu = std::log(meanTermsPerStream)
+            - 0.5 * m_lengthSigma * m_lengthSigma;
+
+        m_cumulative.reserve(vocabularySize);
+        double total = 0.0;
+        for (size_t rank = 0; rank < vocabularySize; ++rank)
+        {
+            total += std::pow(static_cast<double>(rank + 1), -zipfExponent);
+            m_cumulative.push_back(total);
+        }
+        for (auto & value : m_cumulative)
+        {
+            value /= total;
+        }
+        // Guard against rounding so that every sample finds a rank.
+        m_cumulative.back() = 1.0;
+
+        m_torsoStart = static_cast<size_t>(
+            std::lower_bound(m_cumulative.begin(),
+                             m_cumulative.end(),
+                             c_torsoMass) - m_cumulative.begin()) + 1;
+        m_tailStart = static_cast<size_t>(
+            std::lower_bound(m_cumulative.begin(),
+                             m_cumulative.end(),
+                             c_tailMass) - m_cumulative.begin()) + 1;
+        // The head always holds at least the most frequent term. The torso
+        // and tail may be empty for very small or very skewed vocabularies.
+        m_torsoStart = (std::min)(m_torsoStart, vocabularySize);
+        m_tailStart = (std::min)((std::max)(m_tailStart, m_torsoStart),
+                                 vocabularySize);
+    }
+
+
+    size_t ZipfianChunks::GetChunkCount() const
+    {
+        return m_chunkCount;
+    }
+
+
+    size_t ZipfianChunks::GetDocumentCount() const
+    {
+        return m_documentCount;
+    }
+
+
+    std::string ZipfianChunks::GetChunkName(size_t chunkId) const
+    {
+        std::stringstream name;
+        name << "zipf" << chunkId << ".chunk";
+        return name.str();
+    }
+
+
+    void ZipfianChunks::WriteChunk(std::ostream& out, size_t chunkId) const
+    {
+        CHECK_LT(chunkId, m_chunkCount)
+            << "Chunk id out of range.";
+
+        std::seed_seq sequence { m_seed, static_cast<unsigned>(chunkId) };
+        std::mt19937 generator(sequence);
+
+        const size_t start = chunkId * m_documentCount / m_chunkCount;
+        const size_t end = (chunkId + 1) * m_documentCount / m_chunkCount;
+        for (size_t docId = start; docId < end; ++docId)
+        {
+            WriteDocument(out, docId, generator);
+        }
+
+        // End chunk.
+        out << static_cast<char>(0);
+    }
+
+
+    void ZipfianChunks::WriteDocument(std::ostream& out,
+                                      size_t docId,
+                                      std::mt19937& generator) const
+    {
+        static const char c_hexDigits[] = "0123456789abcdef";
+
+        // Documents are assembled in a buffer and written with a single call
+        // because formatted output of individual terms dominates the cost of
+        // generating large corpora.
+        std::string buffer;
+
+        for (int shift = 60; shift >= 0; shift -= 4)
+        {
+            buffer.push_back(c_hexDigits[(docId >> shift) & 0xf]);
+        }
+        buffer.push_back(0);
+
+        for (size_t stream = 0; stream < m_streamCount; ++stream)
+        {
+            buffer.push_back(c_hexDigits[(stream >> 4) & 0xf]);
+            buffer.push_back(c_hexDigits[stream & 0xf]);
+            buffer.push_back(0);
+
+            const size_t termCount = (std::max)(
+                static_cast<size_t>(std::llround(SampleLength(generator))),
+                static_cast<size_t>(1));
+            for (size_t i = 0; i < termCount; ++i)
+            {
+                buffer.append(GetTerm(SampleRank(generator)));
+                buffer.push_back(0);
+            }
+
+            // End stream.
+            buffer.push_back(0);
+        }
+
+        // End document.
+        buffer.push_back(0);
+
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    }
+
+
+    void ZipfianChunks::WriteQueryLog(std::ostream& out,
+                                      size_t queryCount,
+                                      double meanTermsPerQuery,
+                                      double headFraction,
+                                      double tailFraction) const
+    {
+        CHECK_GE(meanTermsPerQuery, 1.0)
+            << "Queries must average at least one term.";
+        CHECK_GE(headFraction, 0.0)
+            << "Head fraction must not be negative.";
+        CHECK_GE(tailFraction, 0.0)
+            << "Tail fraction must not be negative.";
+        CHECK_LE(headFraction + tailFraction, 1.0)
+            << "Head and tail fractions must not exceed 1.";
+
+        // The query log uses a seed sequence of a different length than any
+        // chunk so that its terms are independent of the documents.
+        std::seed_seq sequence { m_seed, 0u, 0u };
+        std::mt19937 generator(sequence);
+
+        const size_t maxTerms =
+            static_cast<size_t>(std::llround(2.0 * meanTermsPerQuery - 1.0));
+        auto pick = [&generator](size_t begin, size_t end)
+        {
+            return SampleInt(generator, begin, end);
+        };
+        const bool hasTorso = m_tailStart > m_torsoStart;
+        const bool hasTail = m_cumulative.size() > m_tailStart;
+
+        for (size_t query = 0; query < queryCount; ++query)
+        {
+            const size_t count = SampleInt(generator, 1, maxTerms + 1);
+            std::vector<size_t> ranks;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const double x = SampleReal(generator);
+                size_t rank;
+                if (x >= 1.0 - tailFraction && hasTail)
+                {
+                    rank = pick(m_tailStart, m_cumulative.size());
+                }
+                else if (x >= headFraction && x < 1.0 - tailFraction && hasTorso)
+                {
+                    rank = pick(m_torsoStart, m_tailStart);
+                }
+                else
+                {
+                    // Empty bands fall back to the head.
+                    rank = pick(0, m_torsoStart);
+                }
+
+                // Repeated terms add nothing to a conjunction, so small
+                // vocabularies may yield queries with fewer than count terms.
+                if (std::find(ranks.begin(), ranks.end(), rank) == ranks.end())
+                {
+                    ranks.push_back(rank);
+                }
+            }
+
+            for (size_t i = 0; i < ranks.size(); ++i)
+            {
+                if (i > 0)
+                {
+                    out << ' ';
+                }
+                out << GetTerm(ranks[i]);
+            }
+            out << std::endl;
+        }
+    }
+
+
+    std::string ZipfianChunks::GetTerm(size_t rank)
+    {
+        // Bijective base 26, so that every rank has a distinct spelling:
+        // 0 => "a", 25 => "z", 26 => "aa".
+        std::string term;
+        size_t n = rank + 1;
+        while (n > 0)
+        {
+            --n;
+            term.push_back(static_cast<char>('a' + n % 26));
+            n /= 26;
+        }
+        std::reverse(term.begin(), term.end());
+        return term;
+    }
+
+
+    double ZipfianChunks::GetTermProbability(size_t rank) const
+    {
+        CHECK_LT(rank, m_cumulative.size())
+            << "Rank out of range.";
+        return (rank == 0) ?
+            m_cumulative[0] :
+            m_cumulative[rank] - m_cumulative[rank - 1];
+    }
+
+
+    double ZipfianChunks::SampleReal(std::mt19937& generator)
+    {
+        // 53 random bits, as in the reference mt19937 genrand_res53().
+        const double a = static_cast<double>(generator() >> 5);
+        const double b = static_cast<double>(generator() >> 6);
+        return (a * 67108864.0 + b) / 9007199254740992.0;
+    }
+
+
+    size_t ZipfianChunks::SampleInt(std::mt19937& generator,
+                                    size_t begin,
+                                    size_t end)
+    {
+        const size_t range = end - begin;
+        const size_t offset =
+            static_cast<size_t>(SampleReal(generator) * static_cast<double>(range));
+        return begin + (std::min)(offset, range - 1);
+    }
+
+
+    double ZipfianChunks::SampleLength(std::mt19937& generator) const
+    {
+        // Box-Muller transform of two uniform samples into a standard normal
+        // sample. 1 - u lies in (0, 1], so the logarithm is finite.
+        const double u = SampleReal(generator);
+        const double v = SampleReal(generator);
+        const double normal =
+            std::sqrt(-2.0 * std::log(1.0 - u)) * std::cos(2.0 * c_pi * v);
+        return std::exp(m_lengthMu + m_lengthSigma * normal);
+    }
+
+
+    size_t ZipfianChunks::SampleRank(std::mt19937& generator) const
+    {
+        // Inverse of the cumulative rank distribution.
+        const double x = SampleReal(generator);
+        return static_cast<size_t>(
+            std::upper_bound(m_cumulative.begin(), m_cumulative.end(), x)
+            - m_cumulative.begin());
+    }
+}
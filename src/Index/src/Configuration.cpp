@@ -38,11 +38,37 @@ namespace BitFunnel
     }
 
 
+    std::unique_ptr<IConfiguration>
+        Factories::CreateConfiguration(size_t maxGramSize,
+                                       bool keepTermText,
+                                       IFactSet const & facts,
+                                       Term::HashFunction hashFunction)
+    {
+        return std::unique_ptr<IConfiguration>(new Configuration(maxGramSize,
+                                                                 keepTermText,
+                                                                 facts,
+                                                                 hashFunction));
+    }
+
+
     Configuration::Configuration(size_t maxGramSize,
                                  bool keepTermText,
                                  IFactSet const & facts)
+      : Configuration(maxGramSize,
+                      keepTermText,
+                      facts,
+                      Term::HashFunction::MurmurHash64A)
+    {
+    }
+
+
+    Configuration::Configuration(size_t maxGramSize,
+                                 bool keepTermText,
+                                 IFactSet const & facts,
+                                 Term::HashFunction hashFunction)
       : m_maxGramSize(maxGramSize),
-        m_facts(facts)
+        m_facts(facts),
+        m_hashFunction(hashFunction)
     {
         if (keepTermText)
         {
@@ -73,4 +99,10 @@ namespace BitFunnel
     {
         return m_facts;
     }
+
+
+    Term::HashFunction Configuration::GetHashFunction() const
+    {
+        return m_hashFunction;
+    }
 }
@@ -37,6 +37,11 @@ namespace BitFunnel
                       bool keepTermText,
                       IFactSet const & facts);
 
+        Configuration(size_t maxGramSize,
+                      bool keepTermText,
+                      IFactSet const & facts,
+                      Term::HashFunction hashFunction);
+
         // Returns the maximum ngram size to be indexed.
         virtual size_t GetMaxGramSize() const override;
 
@@ -53,9 +58,13 @@ namespace BitFunnel
         // defined fact rows.
         virtual IFactSet const & GetFactSet() const override;
 
+        // Returns the function used to compute raw hashes of term text.
+        virtual Term::HashFunction GetHashFunction() const override;
+
     private:
         size_t m_maxGramSize;
         std::unique_ptr<ITermToText> m_termToText;
         IFactSet const & m_facts;
+        const Term::HashFunction m_hashFunction;
     };
 }
@@ -21,26 +21,410 @@
 // THE SOFTWARE.
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <vector>
 
+#include "BitFunnel/Exceptions.h"
+#include "CsvTsv/Csv.h"
 #include "DocumentFrequencyTable.h"
 #include "DocumentFrequencyTableBuilder.h"
 
 
 namespace BitFunnel
 {
+    //*************************************************************************
+    //
+    // TermCountTable
+    //
+    // Open addressed hash table, with linear probing, from Term to the number
+    // of documents containing the term. Also records the first document in
+    // which each term appeared, which is used to compute the Cumulative Term
+    // Count table.
+    //
+    // Each table records OnTerm() and OnDocumentEnter() calls from a single
+    // thread, so no synchronization is required. Documents are identified by
+    // the thread-local ordinal of the document being ingested. The
+    // m_documents vector maps these ordinals to global sequence numbers.
+    //
+    // When maxTerms is non-zero, the table is a Space-Saving style sketch
+    // that never holds more than maxTerms entries. Once the table is full,
+    // the half of the entries with the lowest counts are evicted. m_floor is
+    // an upper bound on the true count of any term not in the table. A term
+    // (re)inserted after an eviction starts with a count of m_floor + 1 and
+    // an error of m_floor, so for every entry
+    //     m_count - m_error <= true count <= m_count.
+    // Terms that were never evicted have m_error == 0 and an exact count.
+    //
+    // Every entry present at an eviction has a count of at least the
+    // previous m_floor, so the counts evicted always cover the m_floor
+    // credited to the entries inserted since the last eviction. The sum of
+    // the retained counts therefore never exceeds N, the number of OnTerm()
+    // calls, and since each of the maxTerms / 2 retained entries has a count
+    // of at least the new m_floor,
+    //     m_floor <= N / (maxTerms / 2).
+    //
+    //*************************************************************************
+    class TermCountTable : NonCopyable
+    {
+    public:
+        struct Entry
+        {
+            Term::Hash m_rawHash;
+            size_t m_count;
+            size_t m_firstDocument;
+            size_t m_error;
+            Term::StreamId m_stream;
+            Term::GramSize m_gramSize;
+            bool m_used;
+        };
+
+        TermCountTable(size_t capacity, size_t maxTerms)
+          : m_maxTerms(maxTerms),
+            m_size(0),
+            m_floor(0),
+            m_postingCount(0)
+        {
+            if (m_maxTerms != 0)
+            {
+                capacity = std::min(capacity, m_maxTerms);
+            }
+
+            // Size the table so that capacity entries fit below the maximum
+            // load factor of one half.
+            size_t slots = 16;
+            while (slots < 2 * capacity)
+            {
+                slots <<= 1;
+            }
+            m_entries.resize(slots, Entry());
+        }
+
+
+        void OnTerm(Term const & term)
+        {
+            ++m_postingCount;
+            Entry& entry = Find(term.GetRawHash(),
+                                term.GetStream(),
+                                term.GetGramSize());
+            if (!entry.m_used)
+            {
+                entry.m_rawHash = term.GetRawHash();
+                entry.m_stream = term.GetStream();
+                entry.m_gramSize = term.GetGramSize();
+                entry.m_used = true;
+                entry.m_count = m_floor + 1;
+                entry.m_error = m_floor;
+                entry.m_firstDocument = m_documents.size();
+                OnInsert();
+                if (m_maxTerms != 0 && m_size > m_maxTerms)
+                {
+                    Prune(m_maxTerms / 2);
+                }
+            }
+            else
+            {
+                ++entry.m_count;
+            }
+        }
+
+
+        void OnDocumentEnter(size_t sequenceNumber)
+        {
+            m_documents.push_back(sequenceNumber);
+        }
+
+
+        // Adds the counts from other into this table. The first document
+        // for each term in other is translated from other's thread-local
+        // ordinals to global sequence numbers. Terms recorded after the last
+        // OnDocumentEnter() on the other thread are assigned documentCount.
+        //
+        // Sketches are combined as mergeable summaries: a term missing from
+        // one table may have occurred up to that table's m_floor times, so
+        // its count and error are raised by that amount. The combined table
+        // may exceed maxTerms until Trim() is called.
+        void Combine(TermCountTable const & other, size_t documentCount)
+        {
+            // Provisionally assume every term here is missing from other.
+            // The credit is reversed below for terms found in other.
+            if (other.m_floor != 0)
+            {
+                for (auto & entry : m_entries)
+                {
+                    if (entry.m_used)
+                    {
+                        entry.m_count += other.m_floor;
+                        entry.m_error += other.m_floor;
+                    }
+                }
+            }
+
+            for (auto const & source : other.m_entries)
+            {
+                if (!source.m_used)
+                {
+                    continue;
+                }
+
+                const size_t firstDocument =
+                    (source.m_firstDocument < other.m_documents.size()) ?
+                    other.m_documents[source.m_firstDocument] :
+                    documentCount;
+
+                Entry& entry = Find(source.m_rawHash,
+                                    source.m_stream,
+                                    source.m_gramSize);
+                if (!entry.m_used)
+                {
+                    entry = source;
+                    entry.m_count += m_floor;
+                    entry.m_error += m_floor;
+                    entry.m_firstDocument = firstDocument;
+                    OnInsert();
+                }
+                else
+                {
+                    entry.m_count += source.m_count - other.m_floor;
+                    entry.m_error += source.m_error - other.m_floor;
+                    entry.m_firstDocument =
+                        std::min(entry.m_firstDocument, firstDocument);
+                }
+            }
+
+            m_floor += other.m_floor;
+            m_postingCount += other.m_postingCount;
+        }
+
+
+        // Evicts entries until the table respects its maxTerms bound.
+        void Trim()
+        {
+            if (m_maxTerms != 0 && m_size > m_maxTerms)
+            {
+                Prune(m_maxTerms);
+            }
+        }
+
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+
+        // Returns an upper bound on the count of any term that is not in
+        // the table, and therefore on the error of any count in the table.
+        size_t GetFloor() const
+        {
+            return m_floor;
+        }
+
+
+        // Returns the number of OnTerm() calls recorded by this table and
+        // any tables combined into it.
+        size_t GetPostingCount() const
+        {
+            return m_postingCount;
+        }
+
+
+        std::vector<Entry> const & GetEntries() const
+        {
+            return m_entries;
+        }
+
+    private:
+        Entry& Find(Term::Hash rawHash,
+                    Term::StreamId stream,
+                    Term::GramSize gramSize)
+        {
+            // Raw hashes are already well distributed. Fold in the stream
+            // and gram size so that the same text in different streams or
+            // phrases lands in different slots.
+            const size_t mask = m_entries.size() - 1;
+            size_t slot = (rawHash ^
+                           ((static_cast<uint64_t>(stream) << 8 | gramSize) *
+                            0x9E3779B97F4A7C15ull)) & mask;
+
+            for (;;)
+            {
+                Entry& entry = m_entries[slot];
+                if (!entry.m_used ||
+                    (entry.m_rawHash == rawHash &&
+                     entry.m_stream == stream &&
+                     entry.m_gramSize == gramSize))
+                {
+                    return entry;
+                }
+                slot = (slot + 1) & mask;
+            }
+        }
+
+
+        void OnInsert()
+        {
+            ++m_size;
+            if (m_size * 2 > m_entries.size())
+            {
+                Rehash(m_entries.size() * 2);
+            }
+        }
+
+
+        // Evicts the entries with the lowest counts, retaining at most
+        // target entries. Raises m_floor to the largest evicted count.
+        void Prune(size_t target)
+        {
+            target = std::max(target, static_cast<size_t>(1));
+
+            std::vector<size_t> counts;
+            counts.reserve(m_size);
+            for (auto const & entry : m_entries)
+            {
+                if (entry.m_used)
+                {
+                    counts.push_back(entry.m_count);
+                }
+            }
+
+            if (counts.size() <= target)
+            {
+                return;
+            }
+
+            // Evict every entry with a count at or below the cutoff. Ties at
+            // the cutoff are evicted too, so fewer than target entries may
+            // remain.
+            auto cutoff = counts.begin() + (counts.size() - target - 1);
+            std::nth_element(counts.begin(), cutoff, counts.end());
+            const size_t maxEvicted = *cutoff;
+
+            size_t size = 0;
+            for (auto & entry : m_entries)
+            {
+                if (entry.m_used)
+                {
+                    if (entry.m_count <= maxEvicted)
+                    {
+                        entry.m_used = false;
+                    }
+                    else
+                    {
+                        ++size;
+                    }
+                }
+            }
+            m_size = size;
+            m_floor = std::max(m_floor, maxEvicted);
+
+            // Deleting from a linearly probed table breaks probe chains, so
+            // reinsert the survivors.
+            Rehash(m_entries.size());
+        }
+
+
+        void Rehash(size_t slots)
+        {
+            std::vector<Entry> old(slots, Entry());
+            old.swap(m_entries);
+
+            for (auto const & source : old)
+            {
+                if (source.m_used)
+                {
+                    Find(source.m_rawHash,
+                         source.m_stream,
+                         source.m_gramSize) = source;
+                }
+            }
+        }
+
+        // Maximum number of entries, or 0 for an exact, unbounded table.
+        const size_t m_maxTerms;
+
+        size_t m_size;
+        std::vector<Entry> m_entries;
+
+        // Upper bound on the count of any term not in the table.
+        size_t m_floor;
+
+        size_t m_postingCount;
+
+        // Global sequence numbers of the documents recorded on this thread.
+        std::vector<size_t> m_documents;
+    };
+
+
+    //*************************************************************************
+    //
+    // DocumentFrequencyTableBuilder
+    //
+    //*************************************************************************
+    DocumentFrequencyTableBuilder::DocumentFrequencyTableBuilder(size_t initialCapacity,
+                                                                 size_t maxTerms)
+      : m_initialCapacity(initialCapacity),
+        m_maxTerms(maxTerms),
+        m_documentCount(0)
+    {
+    }
+
+
+    DocumentFrequencyTableBuilder::~DocumentFrequencyTableBuilder()
+    {
+    }
+
+
+    size_t DocumentFrequencyTableBuilder::GetMaxTermsForPostingError(double maxPostingError)
+    {
+        if (!(maxPostingError > 0.0 && maxPostingError <= 1.0))
+        {
+            RecoverableError error("DocumentFrequencyTableBuilder: maxPostingError must be in (0, 1].");
+            throw error;
+        }
+
+        // Eviction keeps maxTerms / 2 entries, so m_floor <= 2N / maxTerms.
+        return 2 * static_cast<size_t>(std::ceil(1.0 / maxPostingError));
+    }
+
+
+    TermCountTable& DocumentFrequencyTableBuilder::GetThreadTable()
+    {
+        return m_tables.Get(m_initialCapacity, m_maxTerms);
+    }
+
+
     void DocumentFrequencyTableBuilder::OnDocumentEnter()
     {
-        std::lock_guard<std::mutex> lock(m_lock);
-        m_cumulativeTermCounts.push_back(m_termCounts.size());
+        GetThreadTable().OnDocumentEnter(m_documentCount++);
     }
 
 
     void DocumentFrequencyTableBuilder::OnTerm(Term t)
     {
-        std::lock_guard<std::mutex> lock(m_lock);
-        ++m_termCounts[t];
+        GetThreadTable().OnTerm(t);
+    }
+
+
+    std::unique_ptr<TermCountTable> DocumentFrequencyTableBuilder::Merge() const
+    {
+        size_t capacity = 0;
+        m_tables.ForEach([&](TermCountTable const & table)
+        {
+            capacity = std::max(capacity, table.size());
+        });
+
+        // Combine() never evicts, so the merged sketch is trimmed back to
+        // its bound once all of the tables have been added.
+        std::unique_ptr<TermCountTable> merged(
+            new TermCountTable(capacity, m_maxTerms));
+        m_tables.ForEach([&](TermCountTable const & table)
+        {
+            merged->Combine(table, m_documentCount);
+        });
+        merged->Trim();
+
+        return merged;
     }
 
 
@@ -49,35 +433,163 @@ namespace BitFunnel
                                                          double truncateBelowFrequency,
                                                          ITermToText const * termToText) const
     {
+        auto merged = Merge();
+
         DocumentFrequencyTable table;
 
         // For each term count record, compute the document frequency then
         // add to entries if frequency is above threshold.
-        for (auto const & entry : m_termCounts)
+        for (auto const & entry : merged->GetEntries())
         {
-            double frequency = static_cast<double>(entry.second) / m_cumulativeTermCounts.size();
+            if (!entry.m_used)
+            {
+                continue;
+            }
+
+            double frequency = static_cast<double>(entry.m_count) / m_documentCount;
             if (frequency >= truncateBelowFrequency)
             {
-                table.AddEntry(DocumentFrequencyTable::Entry(entry.first, frequency));
+                Term term(entry.m_rawHash, entry.m_stream, entry.m_gramSize);
+                table.AddEntry(DocumentFrequencyTable::Entry(term, frequency));
             }
         }
 
         table.Write(output, termToText);
 
         std::cout << "Raw DocumentFrequencyTable count: "
-                  << m_termCounts.size()
+                  << merged->size()
                   << std::endl
                   << "Saved DocumentFrequencyTable count: "
                   << table.size()
                   << std::endl;
+
+        if (m_maxTerms != 0 && m_documentCount != 0)
+        {
+            // The count error is bounded relative to postings, but the table
+            // holds document frequencies, so report the bound in both units.
+            const double error = static_cast<double>(merged->GetFloor());
+            std::cout << "Sketch document frequency error bound: "
+                      << error / m_documentCount
+                      << std::endl;
+            if (merged->GetPostingCount() != 0)
+            {
+                std::cout << "Sketch posting error bound: "
+                          << error / merged->GetPostingCount()
+                          << std::endl;
+            }
+        }
     }
 
 
     void DocumentFrequencyTableBuilder::WriteCumulativeTermCounts(std::ostream& output) const
     {
-        for (size_t i = 0; i < m_cumulativeTermCounts.size(); ++i)
+        auto merged = Merge();
+
+        // Histogram of the number of terms that first appeared in each
+        // document. The running sum gives the number of unique terms seen
+        // once each document has been recorded.
+        const size_t documentCount = m_documentCount;
+        std::vector<size_t> newTerms(documentCount, 0);
+        for (auto const & entry : merged->GetEntries())
         {
-            output << i << "," << m_cumulativeTermCounts[i] << std::endl;
+            if (entry.m_used && entry.m_firstDocument < documentCount)
+            {
+                ++newTerms[entry.m_firstDocument];
+            }
         }
+
+        size_t uniqueTerms = 0;
+        for (size_t i = 0; i < documentCount; ++i)
+        {
+            uniqueTerms += newTerms[i];
+            output << i << "," << uniqueTerms << std::endl;
+        }
+    }
+
+
+    size_t DocumentFrequencyTableBuilder::WritePartialCounts(std::ostream& output) const
+    {
+        auto merged = Merge();
+
+        std::vector<TermCountTable::Entry> entries;
+        entries.reserve(merged->size());
+        for (auto const & entry : merged->GetEntries())
+        {
+            if (entry.m_used)
+            {
+                entries.push_back(entry);
+            }
+        }
+
+        struct
+        {
+            bool operator() (TermCountTable::Entry const & a,
+                             TermCountTable::Entry const & b)
+            {
+                if (a.m_rawHash != b.m_rawHash)
+                {
+                    return a.m_rawHash < b.m_rawHash;
+                }
+                if (a.m_gramSize != b.m_gramSize)
+                {
+                    return a.m_gramSize < b.m_gramSize;
+                }
+                return a.m_stream < b.m_stream;
+            }
+        } compare;
+
+        std::sort(entries.begin(), entries.end(), compare);
+
+        CsvTsv::CsvTableFormatter formatter(output);
+        CsvTsv::TableWriter writer(formatter);
+
+        CsvTsv::OutputColumn<Term::Hash> hash(
+            "hash",
+            "Term's raw hash.");
+        hash.SetHexMode(true);
+
+        // NOTE: Cannot use OutputColumn<Term::GramSize> or
+        // OutputColumn<Term::StreamId> because OutputColumn does not
+        // implement a specialization for char.
+        CsvTsv::OutputColumn<unsigned> gramSize(
+            "gramSize",
+            "Term's gram size.");
+        CsvTsv::OutputColumn<unsigned> streamId(
+            "streamId",
+            "Term's stream id.");
+        CsvTsv::OutputColumn<uint64_t> count(
+            "count",
+            "Number of documents containing the term.");
+        CsvTsv::OutputColumn<uint64_t> first(
+            "first",
+            "Sequence number of the first document containing the term.");
+
+        writer.DefineColumn(hash);
+        writer.DefineColumn(gramSize);
+        writer.DefineColumn(streamId);
+        writer.DefineColumn(count);
+        writer.DefineColumn(first);
+
+        writer.WritePrologue();
+
+        for (auto const & entry : entries)
+        {
+            hash = entry.m_rawHash;
+            gramSize = entry.m_gramSize;
+            streamId = entry.m_stream;
+            count = entry.m_count;
+            first = entry.m_firstDocument;
+            writer.WriteDataRow();
+        }
+
+        writer.WriteEpilogue();
+
+        return merged->GetFloor();
+    }
+
+
+    size_t DocumentFrequencyTableBuilder::GetDocumentCount() const
+    {
+        return m_documentCount;
     }
 }
@@ -22,17 +22,20 @@
 
 #pragma once
 
+#include <atomic>           // std::atomic member.
 #include <iosfwd>           // std::ostream parameter.
-#include <mutex>            // std::mutex embedded.
-#include <unordered_map>    // std::unordered_map member.
-#include <vector>           // std::vector member.
+#include <memory>           // std::unique_ptr template.
+#include <stddef.h>         // size_t member.
 
-#include "BitFunnel/Term.h" // Term and Term::Hasher template parameters.
+#include "BitFunnel/NonCopyable.h"  // Base class.
+#include "BitFunnel/Term.h"         // Term parameter.
+#include "PerThreadObjects.h"       // PerThreadObjects member.
 
 
 namespace BitFunnel
 {
     class ITermToText;
+    class TermCountTable;
 
     //*************************************************************************
     //
@@ -52,15 +55,38 @@ namespace BitFunnel
     // DocumentFrequencyTableBuilder through a sequence of calls to
     // OnDocumentEnter() and OnTerm().
     //
-    // OnDocumentEnter() should be called once for each document. Then OnTerm()
-    // is called once for each unique term in the document. OnDocumentEnter()
-    // should not be called again until all terms in the current document have
-    // been recorded via calls to OnTerm().
+    // OnTerm() is called once for each unique term in the document. Then
+    // OnDocumentEnter() is called once, on the same thread, to record the
+    // completed document.
+    //
+    // Each thread that calls OnTerm() records counts in its own TermCountTable,
+    // so ingestion threads never contend on a lock. The per-thread tables are
+    // merged when the statistics are written.
+    //
+    // By default every term is counted exactly, so memory grows with the
+    // number of distinct terms in the corpus. When maxTerms is non-zero, each
+    // table is a bounded heavy-hitters sketch holding at most maxTerms terms.
+    // Frequent terms are still counted exactly. Terms in the long tail are
+    // either dropped or have frequencies that may be overestimated by at most
+    // the error bound printed by WriteFrequencies(). Within a single table
+    // the count error is at most 2 / maxTerms times the number of postings
+    // recorded, and GetMaxTermsForPostingError() picks maxTerms for a target
+    // posting error. In this mode the Cumulative Term Count table only
+    // reflects the retained terms.
     //
     //*************************************************************************
-    class DocumentFrequencyTableBuilder
+    class DocumentFrequencyTableBuilder : NonCopyable
     {
     public:
+        // Constructs a DocumentFrequencyTableBuilder. Each per-thread table
+        // is initially sized to hold initialCapacity distinct terms without
+        // growing. A non-zero maxTerms bounds the number of terms each table
+        // may hold (see above).
+        DocumentFrequencyTableBuilder(size_t initialCapacity = c_defaultCapacity,
+                                      size_t maxTerms = 0);
+
+        ~DocumentFrequencyTableBuilder();
+
         // This method is threadsafe in the presense of multiple writers
         // (ie. callers to OnDocumentEnter() and OnTerm()).
         void OnDocumentEnter();
@@ -97,9 +123,58 @@ namespace BitFunnel
         // (ie. callers to OnDocumentEnter() and OnTerm()).
         void WriteCumulativeTermCounts(std::ostream& output) const;
 
+        // Writes the raw term counts to a stream in a form that can be
+        // combined with the counts from other corpus partitions by
+        // MergeStatistics(). The file format is .csv with the columns
+        //    hash (16 digit hexidecimal)
+        //    gramSize
+        //    streamId
+        //    count (number of documents containing the term)
+        //    first (sequence number of the first document containing the
+        //           term)
+        // Entries are ordered by increasing (hash, gramSize, streamId) so
+        // that partitions can be merged in a single streaming pass.
+        //
+        // Returns an upper bound on the count of any term that was dropped
+        // by the sketch. This is zero when counts are exact.
+        //
+        // This method is not threadsafe in the presense of writers.
+        // (ie. callers to OnDocumentEnter() and OnTerm()).
+        size_t WritePartialCounts(std::ostream& output) const;
+
+        // Returns the number of calls to OnDocumentEnter().
+        size_t GetDocumentCount() const;
+
+        // Returns the smallest maxTerms for which the count of any term in a
+        // per-thread table is overestimated by at most maxPostingError times
+        // the number of OnTerm() calls (postings) recorded in that table.
+        // maxPostingError must be in (0, 1].
+        static size_t GetMaxTermsForPostingError(double maxPostingError);
+
+        // Default number of distinct terms each per-thread table can hold
+        // before it must grow.
+        static const size_t c_defaultCapacity = 1 << 16;
+
     private:
-        std::mutex m_lock;
-        std::vector<size_t> m_cumulativeTermCounts;
-        std::unordered_map<Term, size_t, Term::Hasher> m_termCounts;
+        // Returns the TermCountTable owned by the calling thread, creating
+        // it on first use.
+        TermCountTable& GetThreadTable();
+
+        // Combines the per-thread tables into a single table whose first
+        // document values are global document sequence numbers.
+        std::unique_ptr<TermCountTable> Merge() const;
+
+        const size_t m_initialCapacity;
+
+        // Maximum number of terms per table, or 0 for exact counts.
+        const size_t m_maxTerms;
+
+        // Number of calls to OnDocumentEnter(). Also supplies the global
+        // sequence number for each document.
+        std::atomic<size_t> m_documentCount;
+
+        // One TermCountTable per thread that calls OnTerm() or
+        // OnDocumentEnter().
+        PerThreadObjects<TermCountTable> m_tables;
     };
 }
@@ -33,12 +33,19 @@ namespace BitFunnel
 
 
     void DocumentHistogramBuilder::AddDocument(size_t postingCount)
+    {
+        AddDocuments(postingCount, 1);
+    }
+
+
+    void DocumentHistogramBuilder::AddDocuments(size_t postingCount,
+                                                size_t documentCount)
     {
         {
             const std::lock_guard<std::mutex> lock(m_lock);
-            ++m_hist[postingCount];
+            m_hist[postingCount] += documentCount;
         }
-        m_totalCount += postingCount;
+        m_totalCount += postingCount * documentCount;
     }
 
 
@@ -83,6 +90,7 @@ namespace BitFunnel
         writer.DefineColumn(numDocs);
         writer.WritePrologue();
 
+        const std::lock_guard<std::mutex> lock(m_lock);
         for (const auto & kvPairs : m_hist)
         {
             postingCount = kvPairs.first;
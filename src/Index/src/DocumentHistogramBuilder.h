@@ -44,12 +44,17 @@ namespace BitFunnel
         // AddDocument is thread safe with multiple writers.
         void AddDocument(size_t postingCount);
 
+        // Records documentCount documents with the same posting count. Used
+        // to combine histograms. Thread safe with multiple writers.
+        void AddDocuments(size_t postingCount, size_t documentCount);
+
         size_t GetPostingCount() const;
 
         // GetValue is thread safe with multiple readers and writers.
         size_t GetValue(size_t postingCount) const;
 
-        // Persists the contents of the histogram to a stream, not thread-safe
+        // Persists the contents of the histogram to a stream. Thread safe
+        // with multiple readers and writers.
         void Write(std::ostream& output) const;
 
 
@@ -69,6 +69,26 @@ namespace BitFunnel
     }
 
 
+    void DocumentMap::Replace(DocumentHandleInternal handle)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        DocId id = handle.GetDocId();
+
+        auto it = m_docIdToDocHandle.find(id);
+        if (it == m_docIdToDocHandle.end())
+        {
+            std::stringstream message;
+            message << "DocumentMap::Replace(): DocId " << id << " not found.";
+
+            RecoverableError error(message.str());
+            throw error;
+        }
+
+        it->second = handle;
+    }
+
+
     bool DocumentMap::Delete(DocId id)
     {
         std::lock_guard<std::mutex> lock(m_lock);
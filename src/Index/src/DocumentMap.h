@@ -51,6 +51,11 @@ namespace BitFunnel
         // reference.
         DocumentHandleInternal Find(DocId id, bool& isFound) const;
 
+        // Replaces the entry for value's DocId with value, as a single
+        // operation, so that concurrent calls to Find() always find the
+        // DocId. Throws if the map does not contain an entry for the DocId.
+        void Replace(DocumentHandleInternal value);
+
         // Deletes an entry which corresponds to the given DocId. If no such entry
         // exists, the request is ignored and the function returns false.
         // Returns true otherwise.
@@ -52,4 +52,20 @@ namespace BitFunnel
         size_t minimumFunctionalSize = GetMinimumBlockSize(schema, termTable);
         return RoundUp<size_t>(minimumFunctionalSize, c_bytesPerPage);
     }
+
+
+    size_t GetBlockSizeForCapacity(IDocumentDataSchema const & schema,
+                                   ITermTable const & termTable,
+                                   DocIndex capacity)
+    {
+        const DocIndex quantum =
+            Row::DocumentsInRank0Row(1, termTable.GetMaxRankUsed());
+        const DocIndex rounded = RoundUp<DocIndex>(capacity, quantum);
+
+        const size_t size = Shard::InitializeDescriptors(nullptr,
+                                                         rounded,
+                                                         schema,
+                                                         termTable);
+        return RoundUp<size_t>(size, c_bytesPerPage);
+    }
 }
@@ -20,18 +20,28 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
 #include <iostream>  // TODO: remove.
+#include <sstream>
 
 #include "BitFunnel/Configuration/IShardDefinition.h"
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/IFileManager.h"
 #include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/Helpers.h"
 #include "BitFunnel/Index/IDocument.h"
+#include "BitFunnel/Index/IDocumentHistogram.h"
 #include "BitFunnel/Index/IRecycler.h"
+#include "BitFunnel/Index/IShardCostFunction.h"
 #include "BitFunnel/Index/ISliceBufferAllocator.h"
+#include "BitFunnel/Index/ITermTable.h"
 #include "BitFunnel/Index/ITermTableCollection.h"
+#include "BitFunnel/Index/ShardDefinitionBuilder.h"
 #include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/MetricsRegistry.h"
 #include "BitFunnel/Utilities/StreamUtilities.h"
+#include "BitFunnel/Utilities/TraceLog.h"
+#include "CsvTsv/Csv.h"
 #include "DocumentHandleInternal.h"
 #include "Ingestor.h"
 #include "LoggerInterfaces/Logging.h"
@@ -45,13 +55,17 @@ namespace BitFunnel
                               IRecycler& recycler,
                               ITermTableCollection const & termTables,
                               IShardDefinition const & shardDefinition,
-                              ISliceBufferAllocator& sliceBufferAllocator)
+                              ISliceBufferAllocator& sliceBufferAllocator,
+                              bool collectStatistics,
+                              size_t maxStatisticsTerms)
     {
         return std::unique_ptr<IIngestor>(new Ingestor(docDataSchema,
                                                        recycler,
                                                        termTables,
                                                        shardDefinition,
-                                                       sliceBufferAllocator));
+                                                       sliceBufferAllocator,
+                                                       collectStatistics,
+                                                       maxStatisticsTerms));
     }
 
 
@@ -59,9 +73,14 @@ namespace BitFunnel
                        IRecycler& recycler,
                        ITermTableCollection const & termTables,
                        IShardDefinition const & shardDefinition,
-                       ISliceBufferAllocator& sliceBufferAllocator)
-        : m_recycler(recycler),
+                       ISliceBufferAllocator& sliceBufferAllocator,
+                       bool collectStatistics,
+                       size_t maxStatisticsTerms)
+        : m_docDataSchema(docDataSchema),
+          m_recycler(recycler),
           m_shardDefinition(shardDefinition),
+          m_collectStatistics(collectStatistics),
+          m_maxStatisticsTerms(maxStatisticsTerms),
           // TODO: This member is now redundant (with m_documentMap).
           // But see issue 389. Because of that issue, m_documentCount is not
           // always equal to m_documentMap.size().
@@ -69,9 +88,13 @@ namespace BitFunnel
           m_totalSourceByteSize(0),
           m_documentMap(new DocumentMap()),
           m_documentCache(new DocumentCache()),
+          m_shardCount(0),
+          m_routes(nullptr),
           m_tokenManager(Factories::CreateTokenManager()),
           m_sliceBufferAllocator(sliceBufferAllocator)
     {
+        std::unique_ptr<ShardRoutes> routes(new ShardRoutes());
+
         // Create shards based on shard definition in m_shardDefinition..
         for (ShardId shardId = 0; shardId < m_shardDefinition.GetShardCount(); ++shardId)
         {
@@ -86,16 +109,62 @@ namespace BitFunnel
                 std::cout << " (larger)" << std::endl;
             }
 
-            m_shards.push_back(
-                std::unique_ptr<Shard>(
-                    new Shard(shardId,
-                              GetRecycler(),
-                              GetTokenManager(),
-                              termTables.GetTermTable(shardId),
-                              docDataSchema,
-                              m_sliceBufferAllocator,
-                              m_sliceBufferAllocator.GetSliceBufferSize())));
+            // Shards with a slice capacity in the ShardDefinition size their
+            // buffers for it. The others use the allocator's default size.
+            const DocIndex capacity = m_shardDefinition.GetSliceCapacity(shardId);
+            const size_t sliceBufferSize = (capacity == 0) ?
+                m_sliceBufferAllocator.GetSliceBufferSize() :
+                GetBlockSizeForCapacity(docDataSchema,
+                                        termTables.GetTermTable(shardId),
+                                        capacity);
+
+            m_shards[shardId].reset(
+                CreateShard(shardId,
+                            termTables.GetTermTable(shardId),
+                            sliceBufferSize));
+
+            // The first shard also receives documents below its minimum
+            // posting count, as it does in IShardDefinition::GetShard().
+            const size_t minPostingCount = (shardId == 0) ?
+                0 :
+                m_shardDefinition.GetMinPostingCount(shardId);
+            routes->push_back({ minPostingCount, shardId });
         }
+
+        m_shardCount = m_shardDefinition.GetShardCount();
+        m_routes = routes.get();
+        m_routeHistory.push_back(std::move(routes));
+    }
+
+
+    Shard* Ingestor::CreateShard(ShardId shardId,
+                                 ITermTable const & termTable,
+                                 size_t sliceBufferSize) const
+    {
+        return new Shard(shardId,
+                         GetRecycler(),
+                         GetTokenManager(),
+                         termTable,
+                         m_docDataSchema,
+                         m_sliceBufferAllocator,
+                         sliceBufferSize,
+                         m_collectStatistics,
+                         m_maxStatisticsTerms);
+    }
+
+
+    size_t Ingestor::GetMinPostingCount(ShardId shard) const
+    {
+        for (auto const & route : *m_routes.load())
+        {
+            if (route.m_shard == shard)
+            {
+                return route.m_minPostingCount;
+            }
+        }
+
+        RecoverableError error("Ingestor::GetMinPostingCount(): shard has no route.");
+        throw error;
     }
 
 
@@ -108,7 +177,8 @@ namespace BitFunnel
     void Ingestor::PrintStatistics(std::ostream& out,
                                    double time) const
     {
-        out << "Shard count:" << m_shards.size() << std::endl
+        const size_t shardCount = GetShardCount();
+        out << "Shard count:" << shardCount << std::endl
             << "Document count: " << m_documentCount << std::endl
             << "Bytes/Document: "
             << static_cast<double>(m_totalSourceByteSize) / m_documentCount
@@ -116,6 +186,23 @@ namespace BitFunnel
             << "Total bytes read: " << m_totalSourceByteSize << std::endl
             << "Posting count: " << m_histogram.GetPostingCount() << std::endl;
 
+        size_t cacheHits = 0;
+        size_t cacheMisses = 0;
+        for (size_t shard = 0; shard < shardCount; ++shard)
+        {
+            size_t hits;
+            size_t misses;
+            m_shards[shard]->GetRowIdCacheCounts(hits, misses);
+            cacheHits += hits;
+            cacheMisses += misses;
+        }
+        if (cacheHits + cacheMisses > 0)
+        {
+            out << "Row cache hit rate: "
+                << static_cast<double>(cacheHits) / (cacheHits + cacheMisses)
+                << std::endl;
+        }
+
         if (time > 0)
         {
             out << "Total ingestion time: " << time << std::endl;
@@ -128,6 +215,113 @@ namespace BitFunnel
     }
 
 
+    void Ingestor::RegisterMetrics(MetricsRegistry & registry) const
+    {
+        // Entries below m_shardCount may be read while AddShard() adds
+        // another.
+        auto sumOverShards = [this](size_t (*value)(Shard const &))
+        {
+            size_t sum = 0;
+            const size_t shardCount = GetShardCount();
+            for (size_t shard = 0; shard < shardCount; ++shard)
+            {
+                sum += value(*m_shards[shard]);
+            }
+            return static_cast<double>(sum);
+        };
+
+        auto createdSlices = [](Shard const & shard)
+        {
+            return shard.GetCreatedSliceCount();
+        };
+        auto recycledSlices = [](Shard const & shard)
+        {
+            return shard.GetRecycledSliceCount();
+        };
+        auto cacheHits = [](Shard const & shard)
+        {
+            size_t hits;
+            size_t misses;
+            shard.GetRowIdCacheCounts(hits, misses);
+            return hits;
+        };
+        auto cacheMisses = [](Shard const & shard)
+        {
+            size_t hits;
+            size_t misses;
+            shard.GetRowIdCacheCounts(hits, misses);
+            return misses;
+        };
+
+        registry.AddCounter(
+            "bitfunnel_documents_ingested_total",
+            "Documents added to the index.",
+            [this]() { return static_cast<double>(m_documentCount); });
+        registry.AddCounter(
+            "bitfunnel_postings_ingested_total",
+            "Postings in the documents added to the index.",
+            [this]() { return static_cast<double>(m_histogram.GetPostingCount()); });
+        registry.AddCounter(
+            "bitfunnel_source_bytes_ingested_total",
+            "Source bytes of the documents added to the index.",
+            [this]() { return static_cast<double>(m_totalSourceByteSize); });
+        registry.AddGauge(
+            "bitfunnel_shards",
+            "Shards in the index.",
+            [this]() { return static_cast<double>(m_shardCount); });
+
+        registry.AddCounter(
+            "bitfunnel_slices_created_total",
+            "Slices allocated by all shards.",
+            [=]() { return sumOverShards(createdSlices); });
+        registry.AddCounter(
+            "bitfunnel_slices_recycled_total",
+            "Slices removed from all shards for recycling.",
+            [=]() { return sumOverShards(recycledSlices); });
+        registry.AddGauge(
+            "bitfunnel_slices_active",
+            "Slices currently in all shards.",
+            [=]() { return sumOverShards(createdSlices) - sumOverShards(recycledSlices); });
+        registry.AddGauge(
+            "bitfunnel_recycler_pending",
+            "Slices and slice lists waiting for the Recycler.",
+            [this]() { return static_cast<double>(m_recycler.GetPendingCount()); });
+
+        registry.AddGauge(
+            "bitfunnel_slice_buffers_in_use",
+            "Slice buffers allocated from the pool.",
+            [this]() { return static_cast<double>(m_sliceBufferAllocator.GetInUseBuffersCount()); });
+        registry.AddGauge(
+            "bitfunnel_slice_buffers_total",
+            "Slice buffers in the pool, or 0 if the pool is unbounded.",
+            [this]() { return static_cast<double>(m_sliceBufferAllocator.GetTotalBuffersCount()); });
+        registry.AddGauge(
+            "bitfunnel_slice_buffer_pool_utilization",
+            "Fraction of the slice buffer pool in use.",
+            [this]()
+            {
+                const size_t total = m_sliceBufferAllocator.GetTotalBuffersCount();
+                return (total == 0) ?
+                    0.0 :
+                    static_cast<double>(m_sliceBufferAllocator.GetInUseBuffersCount()) / total;
+            });
+
+        registry.AddGauge(
+            "bitfunnel_tokens_in_flight",
+            "Tokens held by queries and other readers of slice lists.",
+            [this]() { return static_cast<double>(m_tokenManager->GetInFlightTokenCount()); });
+
+        registry.AddCounter(
+            "bitfunnel_row_cache_hits_total",
+            "Term to row lookups during ingestion served by a RowIdCache.",
+            [=]() { return sumOverShards(cacheHits); });
+        registry.AddCounter(
+            "bitfunnel_row_cache_misses_total",
+            "Term to row lookups during ingestion that missed the RowIdCache.",
+            [=]() { return sumOverShards(cacheMisses); });
+    }
+
+
     void Ingestor::WriteStatistics(IFileManager & fileManager,
                                    ITermToText const * termToText) const
     {
@@ -142,7 +336,8 @@ namespace BitFunnel
             m_histogram.Write(*out);
         }
 
-        for (size_t shard = 0; shard < m_shards.size(); ++shard)
+        const size_t shardCount = GetShardCount();
+        for (size_t shard = 0; shard < shardCount; ++shard)
         {
             {
                 auto out = fileManager.CumulativeTermCounts(shard).OpenForWrite();
@@ -156,6 +351,62 @@ namespace BitFunnel
     }
 
 
+    void Ingestor::WritePartialStatistics(IFileManager & fileManager,
+                                          ITermToText const * termToText) const
+    {
+        if (termToText != nullptr)
+        {
+            auto out = fileManager.TermToText().OpenForWrite();
+            termToText->Write(*out);
+        }
+
+        {
+            auto out = fileManager.DocumentHistogram().OpenForWrite();
+            m_histogram.Write(*out);
+        }
+
+        auto summary = fileManager.PartialStatistics().OpenForWrite();
+        CsvTsv::CsvTableFormatter formatter(*summary);
+        CsvTsv::TableWriter writer(formatter);
+
+        CsvTsv::OutputColumn<uint64_t> shardColumn(
+            "shard",
+            "Shard id.");
+        CsvTsv::OutputColumn<uint64_t> documents(
+            "documents",
+            "Number of documents ingested into the shard.");
+        CsvTsv::OutputColumn<uint64_t> maxError(
+            "maxError",
+            "Upper bound on the count of any term missing from the shard's "
+            "PartialDocFreqTable.");
+
+        writer.DefineColumn(shardColumn);
+        writer.DefineColumn(documents);
+        writer.DefineColumn(maxError);
+        writer.WritePrologue();
+
+        const size_t shardCount = GetShardCount();
+        for (size_t shard = 0; shard < shardCount; ++shard)
+        {
+            DocumentFrequencyTableBuilder const * builder =
+                m_shards[shard]->GetDocumentFrequencyTableBuilder();
+            if (builder == nullptr)
+            {
+                RecoverableError error("Ingestor::WritePartialStatistics(): index is not gathering statistics.");
+                throw error;
+            }
+
+            auto out = fileManager.PartialDocFreqTable(shard).OpenForWrite();
+            shardColumn = shard;
+            maxError = builder->WritePartialCounts(*out);
+            documents = builder->GetDocumentCount();
+            writer.WriteDataRow();
+        }
+
+        writer.WriteEpilogue();
+    }
+
+
     void Ingestor::TemporaryReadAllSlices(IFileManager& fileManager)
     {
         // Recover ingestor-wide values from IndexSliceMain file
@@ -167,14 +418,40 @@ namespace BitFunnel
         m_totalSourceByteSize = StreamUtilities::ReadField<size_t>(*input);
         auto shardSize = StreamUtilities::ReadField<size_t>(*input);
         auto sliceBufferSize = StreamUtilities::ReadField<size_t>(*input);
-        if (shardSize != m_shards.size() || sliceBufferSize != m_sliceBufferAllocator.GetSliceBufferSize())
+        if (shardSize < GetShardCount() ||
+            shardSize > c_maxShardIdCount ||
+            sliceBufferSize != m_sliceBufferAllocator.GetSliceBufferSize())
         {
             RecoverableError error("Ingestor::TemporaryReadAllSlices(): Saved slices don't match index format.");
             throw error;
         }
 
+        // Recover the shards added by AddShard(). Each shard's minimum
+        // posting count is saved in shard order, so replaying AddShard()
+        // in that order rebuilds the same routes.
+        std::vector<size_t> minPostingCounts(shardSize);
+        for (size_t i = 0; i < shardSize; ++i)
+        {
+            minPostingCounts[i] = StreamUtilities::ReadField<size_t>(*input);
+        }
+
+        const size_t shardCount = GetShardCount();
+        for (size_t i = 0; i < shardCount; ++i)
+        {
+            if (minPostingCounts[i] != GetMinPostingCount(static_cast<ShardId>(i)))
+            {
+                RecoverableError error("Ingestor::TemporaryReadAllSlices(): Saved shard routes don't match index.");
+                throw error;
+            }
+        }
+
+        for (size_t i = shardCount; i < shardSize; ++i)
+        {
+            AddShard(minPostingCounts[i]);
+        }
+
         // Load each shard's slices
-        for (size_t i = 0; i < m_shards.size(); ++i)
+        for (size_t i = 0; i < shardSize; ++i)
         {
             auto nbrSlices = StreamUtilities::ReadField<size_t>(*input);
             m_shards[i]->TemporaryReadAllSlices(fileManager, nbrSlices);
@@ -189,11 +466,21 @@ namespace BitFunnel
         auto output = sliceFileMain.OpenForWrite();
         StreamUtilities::WriteField<size_t>(*output, m_documentCount);
         StreamUtilities::WriteField<size_t>(*output, m_totalSourceByteSize);
-        StreamUtilities::WriteField<size_t>(*output, m_shards.size());
+        const size_t shardCount = GetShardCount();
+        StreamUtilities::WriteField<size_t>(*output, shardCount);
         StreamUtilities::WriteField<size_t>(*output, m_sliceBufferAllocator.GetSliceBufferSize());
 
+        // Save each shard's route so that shards added by AddShard() can be
+        // recovered.
+        for (size_t i = 0; i < shardCount; ++i)
+        {
+            StreamUtilities::WriteField<size_t>(
+                *output,
+                GetMinPostingCount(static_cast<ShardId>(i)));
+        }
+
         // Save each shard's slices
-        for (size_t i = 0; i < m_shards.size(); ++i)
+        for (size_t i = 0; i < shardCount; ++i)
         {
             StreamUtilities::WriteField<size_t>(*output, m_shards[i]->GetSliceBuffers().size());
             m_shards[i]->TemporaryWriteAllSlices(fileManager);
@@ -209,6 +496,8 @@ namespace BitFunnel
 
     void Ingestor::Add(DocId id, IDocument const & document)
     {
+        TraceScope trace("ingest", "Document");
+
         ++m_documentCount;
         m_totalSourceByteSize += document.GetSourceByteSize();
 
@@ -216,7 +505,7 @@ namespace BitFunnel
         m_histogram.AddDocument(document.GetPostingCount());
 
         // Choose correct shard and then allocate handle.
-        ShardId shardId = m_shardDefinition.GetShard(document.GetPostingCount());
+        ShardId shardId = GetShardForPostingCount(document.GetPostingCount());
         DocumentHandleInternal handle = m_shards[shardId]->AllocateDocument(id);
 
         // std::cout
@@ -277,7 +566,7 @@ namespace BitFunnel
 
     size_t Ingestor::GetShardCount() const
     {
-        return m_shards.size();
+        return m_shardCount.load(std::memory_order_acquire);
     }
 
 
@@ -293,6 +582,178 @@ namespace BitFunnel
     }
 
 
+    ShardId Ingestor::GetShardForPostingCount(size_t postingCount) const
+    {
+        ShardRoutes const & routes = *m_routes.load();
+
+        // Find the last route whose minimum is at most postingCount. The
+        // first route's minimum is zero, so there always is one.
+        auto it = std::upper_bound(routes.begin(),
+                                   routes.end(),
+                                   postingCount,
+                                   [](size_t count, ShardRoute const & route)
+                                   {
+                                       return count < route.m_minPostingCount;
+                                   });
+        return (it - 1)->m_shard;
+    }
+
+
+    size_t Ingestor::ProposeShardBoundary(double shardOverhead) const
+    {
+        const ShardId shardCount = static_cast<ShardId>(GetShardCount());
+        if (shardCount >= c_maxShardIdCount)
+        {
+            return 0;
+        }
+
+        // Take a snapshot of the live histogram.
+        std::stringstream snapshot;
+        m_histogram.Write(snapshot);
+        auto histogram = Factories::CreateDocumentHistogram(snapshot);
+        if (histogram->GetEntryCount() == 0)
+        {
+            return 0;
+        }
+
+        Rank maxRankInUse = 0;
+        for (ShardId shard = 0; shard < shardCount; ++shard)
+        {
+            maxRankInUse = (std::max)(maxRankInUse,
+                                      m_shards[shard]->GetTermTable().GetMaxRankUsed());
+        }
+
+        const size_t c_minShardCapacity = 1;
+        auto costFunction =
+            Factories::CreateShardCostFunction(*histogram,
+                                               shardOverhead,
+                                               c_minShardCapacity,
+                                               maxRankInUse);
+        auto proposal =
+            ShardDefinitionBuilder::CreateShardDefinition(*costFunction,
+                                                          shardCount + 1);
+
+        // Return the first boundary in the best definition with one more
+        // shard that is not already a boundary.
+        ShardRoutes const & routes = *m_routes.load();
+        for (ShardId shard = 1; shard < proposal->GetShardCount(); ++shard)
+        {
+            const size_t boundary = proposal->GetMinPostingCount(shard);
+            auto existing = std::find_if(routes.begin(),
+                                         routes.end(),
+                                         [boundary](ShardRoute const & route)
+                                         {
+                                             return route.m_minPostingCount == boundary;
+                                         });
+            if (existing == routes.end())
+            {
+                return boundary;
+            }
+        }
+
+        return 0;
+    }
+
+
+    ShardId Ingestor::AddShard(size_t minPostingCount)
+    {
+        std::lock_guard<std::mutex> lock(m_reshardLock);
+
+        const ShardId shardId = m_shardCount;
+        if (shardId >= c_maxShardIdCount)
+        {
+            RecoverableError error("Ingestor::AddShard(): maximum shard count reached.");
+            throw error;
+        }
+
+        ShardRoutes const & routes = *m_routes.load();
+        for (auto const & route : routes)
+        {
+            if (route.m_minPostingCount == minPostingCount)
+            {
+                RecoverableError error("Ingestor::AddShard(): posting count is already a shard boundary.");
+                throw error;
+            }
+        }
+
+        // Construct the shard before publishing it. Readers only look at
+        // entries below m_shardCount, so they never see the new entry
+        // before it is complete.
+        Shard const & parent = *m_shards[GetShardForPostingCount(minPostingCount)];
+        m_shards[shardId].reset(
+            CreateShard(shardId,
+                        parent.GetTermTable(),
+                        parent.GetSliceBufferSize()));
+        m_shardCount.store(shardId + 1, std::memory_order_release);
+
+        std::unique_ptr<ShardRoutes> newRoutes(new ShardRoutes(routes));
+        auto it = std::upper_bound(newRoutes->begin(),
+                                   newRoutes->end(),
+                                   minPostingCount,
+                                   [](size_t count, ShardRoute const & route)
+                                   {
+                                       return count < route.m_minPostingCount;
+                                   });
+        newRoutes->insert(it, { minPostingCount, shardId });
+        m_routes = newRoutes.get();
+        m_routeHistory.push_back(std::move(newRoutes));
+
+        return shardId;
+    }
+
+
+    size_t Ingestor::MigrateDocuments()
+    {
+        std::lock_guard<std::mutex> lock(m_reshardLock);
+
+        size_t movedCount = 0;
+        for (auto entry : *m_documentCache)
+        {
+            IDocument const & document = entry.first;
+            const DocId id = entry.second;
+            const ShardId target =
+                GetShardForPostingCount(document.GetPostingCount());
+
+            bool isFound;
+            const DocumentHandleInternal current =
+                m_documentMap->Find(id, isFound);
+            if (!isFound || current.GetShardId() == target)
+            {
+                continue;
+            }
+
+            // Ingest the new copy without activating it, so that queries
+            // never match both copies.
+            DocumentHandleInternal handle =
+                m_shards[target]->AllocateDocument(id);
+            document.Ingest(handle);
+            handle.GetSlice().CommitDocument();
+
+            {
+                const Token token = m_tokenManager->RequestToken();
+                std::lock_guard<std::mutex> deleteLock(m_deleteDocumentLock);
+
+                // The document may have been deleted while it was copied.
+                DocumentHandleInternal latest = m_documentMap->Find(id, isFound);
+                if (isFound && latest.GetShardId() == current.GetShardId())
+                {
+                    // Hide the old copy before the new one becomes visible.
+                    latest.Expire();
+                    handle.Activate();
+                    m_documentMap->Replace(handle);
+                    ++movedCount;
+                }
+                else
+                {
+                    handle.Expire();
+                }
+            }
+        }
+
+        return movedCount;
+    }
+
+
     ITokenManager& Ingestor::GetTokenManager() const
     {
         return *m_tokenManager;
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <array>                            // std::array member.
 #include <atomic>                           // std::atomic member.
 #include <memory>                           // std::unique_ptr embedded.
 #include <mutex>                            // std::mutex member.
@@ -43,6 +44,7 @@ namespace BitFunnel
     class IDocumentDataSchema;
     class IShardDefinition;
     class ISliceBufferAllocator;
+    class ITermTable;
     class ITermTableCollection;
 
 
@@ -53,7 +55,9 @@ namespace BitFunnel
                  IRecycler& recycle,
                  ITermTableCollection const & termTables,
                  IShardDefinition const & shardDefinition,
-                 ISliceBufferAllocator& sliceBufferAllocator);
+                 ISliceBufferAllocator& sliceBufferAllocator,
+                 bool collectStatistics,
+                 size_t maxStatisticsTerms);
 
         virtual ~Ingestor();
 
@@ -61,6 +65,8 @@ namespace BitFunnel
         virtual void PrintStatistics(std::ostream& out,
                                      double time) const override;
 
+        virtual void RegisterMetrics(MetricsRegistry & registry) const override;
+
         // Writes out the following data structions in locations defined by the
         // FileManager:
         //
@@ -72,6 +78,9 @@ namespace BitFunnel
         virtual void WriteStatistics(IFileManager & fileManager,
                                      ITermToText const * termToText) const override;
 
+        virtual void WritePartialStatistics(IFileManager & fileManager,
+                                            ITermToText const * termToText) const override;
+
         virtual void TemporaryReadAllSlices(IFileManager& fileManager) override;
 
         virtual void TemporaryWriteAllSlices(IFileManager& fileManager) const override;
@@ -136,6 +145,14 @@ namespace BitFunnel
 
         virtual IShardDefinition const & GetShardDefinition() const override;
 
+        //
+        // Online resharding.
+        //
+        virtual ShardId GetShardForPostingCount(size_t postingCount) const override;
+        virtual size_t ProposeShardBoundary(double shardOverhead) const override;
+        virtual ShardId AddShard(size_t minPostingCount) override;
+        virtual size_t MigrateDocuments() override;
+
         virtual IRecycler& GetRecycler() const override;
 
         virtual ITokenManager& GetTokenManager() const override;
@@ -165,8 +182,27 @@ namespace BitFunnel
         virtual void ExpireGroup(GroupId groupId) override;
 
     private:
+        // Routes documents with at least m_minPostingCount postings, and
+        // fewer than the next route's m_minPostingCount, to m_shard.
+        struct ShardRoute
+        {
+            size_t m_minPostingCount;
+            ShardId m_shard;
+        };
+        typedef std::vector<ShardRoute> ShardRoutes;
+
+        Shard* CreateShard(ShardId shardId,
+                           ITermTable const & termTable,
+                           size_t sliceBufferSize) const;
+
+        // Returns the smallest posting count routed to the given shard.
+        size_t GetMinPostingCount(ShardId shard) const;
+
+        IDocumentDataSchema const & m_docDataSchema;
         IRecycler& m_recycler;
         IShardDefinition const & m_shardDefinition;
+        const bool m_collectStatistics;
+        const size_t m_maxStatisticsTerms;
 
         // TODO: Replace these tempoary statistics variables with document
         // length hash table and term frequency tables.
@@ -181,7 +217,21 @@ namespace BitFunnel
 
         std::unique_ptr<DocumentCache> m_documentCache;
 
-        std::vector<std::unique_ptr<Shard>> m_shards;
+        // Shards can be added while queries read m_shards, so it has a
+        // fixed size. AddShard() constructs a shard before it publishes the
+        // new m_shardCount with release semantics, so readers that acquire
+        // m_shardCount see fully constructed entries below it.
+        std::array<std::unique_ptr<Shard>, c_maxShardIdCount> m_shards;
+        std::atomic<size_t> m_shardCount;
+
+        // Add() reads the current routes without a lock. AddShard() publishes
+        // a new copy and keeps the old ones alive until the Ingestor is
+        // destroyed, since there can be at most c_maxShardIdCount of them.
+        std::atomic<ShardRoutes const *> m_routes;
+        std::vector<std::unique_ptr<ShardRoutes const>> m_routeHistory;
+
+        // Serializes AddShard() and MigrateDocuments().
+        std::mutex m_reshardLock;
 
         // TokenManager which distributes tokens for thread synchronization.
         std::unique_ptr<ITokenManager> m_tokenManager;
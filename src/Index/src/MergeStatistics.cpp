@@ -0,0 +1,407 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <queue>
+#include <vector>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/MergeStatistics.h"
+#include "BitFunnel/NonCopyable.h"
+#include "BitFunnel/Term.h"
+#include "CsvTsv/Csv.h"
+#include "DocumentFrequencyTable.h"
+#include "DocumentHistogram.h"
+#include "DocumentHistogramBuilder.h"
+#include "TermToText.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // ShardSummary
+    //
+    // One row of a PartialStatistics file.
+    //
+    //*************************************************************************
+    struct ShardSummary
+    {
+        size_t m_documentCount;
+        size_t m_maxError;
+    };
+
+
+    static std::vector<ShardSummary> ReadShardSummaries(IFileManager & fileManager)
+    {
+        auto input = fileManager.PartialStatistics().OpenForRead();
+
+        CsvTsv::CsvTableParser parser(*input);
+        CsvTsv::TableReader reader(parser);
+
+        CsvTsv::InputColumn<uint64_t> shard(
+            "shard",
+            "Shard id.");
+        CsvTsv::InputColumn<uint64_t> documents(
+            "documents",
+            "Number of documents ingested into the shard.");
+        CsvTsv::InputColumn<uint64_t> maxError(
+            "maxError",
+            "Upper bound on the count of any term missing from the shard's "
+            "PartialDocFreqTable.");
+
+        reader.DefineColumn(shard);
+        reader.DefineColumn(documents);
+        reader.DefineColumn(maxError);
+
+        reader.ReadPrologue();
+
+        std::vector<ShardSummary> summaries;
+        while (!reader.AtEOF())
+        {
+            reader.ReadDataRow();
+
+            if (shard != summaries.size())
+            {
+                RecoverableError error("MergeStatistics: PartialStatistics shards out of order.");
+                throw error;
+            }
+
+            ShardSummary summary;
+            summary.m_documentCount = documents;
+            summary.m_maxError = maxError;
+            summaries.push_back(summary);
+        }
+
+        reader.ReadEpilogue();
+
+        return summaries;
+    }
+
+
+    //*************************************************************************
+    //
+    // PartialCountReader
+    //
+    // Cursor over the rows of a PartialDocFreqTable. Verifies that the rows
+    // are in the order required by the streaming merge.
+    //
+    //*************************************************************************
+    class PartialCountReader : NonCopyable
+    {
+    public:
+        PartialCountReader(std::unique_ptr<std::istream> input,
+                           size_t partition)
+          : m_partition(partition),
+            m_input(std::move(input)),
+            m_parser(*m_input),
+            m_reader(m_parser),
+            m_hash("hash", "Term's raw hash."),
+            m_gramSize("gramSize", "Term's gram size."),
+            m_streamId("streamId", "Term's stream id."),
+            m_count("count", "Number of documents containing the term."),
+            m_first("first", "Sequence number of the first document containing the term."),
+            m_hasTerm(false),
+            m_term(0, 0, 0)
+        {
+            m_hash.SetHexMode(true);
+
+            m_reader.DefineColumn(m_hash);
+            m_reader.DefineColumn(m_gramSize);
+            m_reader.DefineColumn(m_streamId);
+            m_reader.DefineColumn(m_count);
+            m_reader.DefineColumn(m_first);
+
+            m_reader.ReadPrologue();
+        }
+
+
+        // Reads the next row. Returns false at the end of the table.
+        bool Advance()
+        {
+            if (m_reader.AtEOF())
+            {
+                m_reader.ReadEpilogue();
+                return false;
+            }
+
+            m_reader.ReadDataRow();
+
+            Term term(m_hash,
+                      static_cast<Term::StreamId>(m_streamId.GetValue()),
+                      static_cast<Term::GramSize>(m_gramSize.GetValue()));
+
+            if (m_hasTerm && !Precedes(m_term, term))
+            {
+                RecoverableError error("MergeStatistics: PartialDocFreqTable is not sorted by term.");
+                throw error;
+            }
+
+            m_term = term;
+            m_hasTerm = true;
+
+            return true;
+        }
+
+
+        // Orders terms by (hash, gramSize, streamId), the order of rows in a
+        // PartialDocFreqTable.
+        static bool Precedes(Term const & a, Term const & b)
+        {
+            if (a.GetRawHash() != b.GetRawHash())
+            {
+                return a.GetRawHash() < b.GetRawHash();
+            }
+            if (a.GetGramSize() != b.GetGramSize())
+            {
+                return a.GetGramSize() < b.GetGramSize();
+            }
+            return a.GetStream() < b.GetStream();
+        }
+
+
+        size_t GetPartition() const
+        {
+            return m_partition;
+        }
+
+
+        Term const & GetTerm() const
+        {
+            return m_term;
+        }
+
+
+        size_t GetCount() const
+        {
+            return m_count;
+        }
+
+
+        size_t GetFirstDocument() const
+        {
+            return m_first;
+        }
+
+    private:
+        const size_t m_partition;
+
+        std::unique_ptr<std::istream> m_input;
+        CsvTsv::CsvTableParser m_parser;
+        CsvTsv::TableReader m_reader;
+
+        CsvTsv::InputColumn<Term::Hash> m_hash;
+        CsvTsv::InputColumn<unsigned> m_gramSize;
+        CsvTsv::InputColumn<unsigned> m_streamId;
+        CsvTsv::InputColumn<uint64_t> m_count;
+        CsvTsv::InputColumn<uint64_t> m_first;
+
+        bool m_hasTerm;
+        Term m_term;
+    };
+
+
+    // Orders a std::priority_queue of readers so that the reader with the
+    // smallest current term is on top.
+    struct LaterTerm
+    {
+        bool operator() (PartialCountReader const * a,
+                         PartialCountReader const * b) const
+        {
+            return PartialCountReader::Precedes(b->GetTerm(), a->GetTerm());
+        }
+    };
+
+
+    static void MergeShard(std::vector<IFileManager*> const & partitions,
+                           std::vector<std::vector<ShardSummary>> const & summaries,
+                           size_t shard,
+                           ITermToText const * termToText,
+                           IFileManager & output)
+    {
+        // Documents in each partition are numbered after the documents in
+        // all earlier partitions. A term missing from a partition may have
+        // occurred up to that partition's maxError times.
+        std::vector<size_t> offsets;
+        size_t documentCount = 0;
+        size_t totalError = 0;
+        for (auto const & summary : summaries)
+        {
+            offsets.push_back(documentCount);
+            documentCount += summary[shard].m_documentCount;
+            totalError += summary[shard].m_maxError;
+        }
+
+        std::vector<std::unique_ptr<PartialCountReader>> readers;
+        std::priority_queue<PartialCountReader*,
+                            std::vector<PartialCountReader*>,
+                            LaterTerm> queue;
+        for (size_t p = 0; p < partitions.size(); ++p)
+        {
+            readers.emplace_back(
+                new PartialCountReader(
+                    partitions[p]->PartialDocFreqTable(shard).OpenForRead(),
+                    p));
+            if (readers.back()->Advance())
+            {
+                queue.push(readers.back().get());
+            }
+        }
+
+        DocumentFrequencyTable table;
+        std::vector<size_t> newTerms(documentCount, 0);
+
+        while (!queue.empty())
+        {
+            const Term term = queue.top()->GetTerm();
+            size_t count = 0;
+            size_t missingError = totalError;
+            size_t firstDocument = documentCount;
+
+            // NOTE: Term::operator==() ignores the stream, so compare with
+            // the same ordering used to sort the partial tables.
+            while (!queue.empty() &&
+                   !PartialCountReader::Precedes(term, queue.top()->GetTerm()))
+            {
+                PartialCountReader* reader = queue.top();
+                queue.pop();
+
+                const size_t p = reader->GetPartition();
+                count += reader->GetCount();
+                missingError -= summaries[p][shard].m_maxError;
+                if (reader->GetFirstDocument() < summaries[p][shard].m_documentCount)
+                {
+                    firstDocument =
+                        std::min(firstDocument,
+                                 offsets[p] + reader->GetFirstDocument());
+                }
+
+                if (reader->Advance())
+                {
+                    queue.push(reader);
+                }
+            }
+            count += missingError;
+
+            if (documentCount > 0)
+            {
+                double frequency = static_cast<double>(count) / documentCount;
+                table.AddEntry(DocumentFrequencyTable::Entry(term, frequency));
+            }
+
+            if (firstDocument < documentCount)
+            {
+                ++newTerms[firstDocument];
+            }
+        }
+
+        {
+            auto out = output.DocFreqTable(shard).OpenForWrite();
+            table.Write(*out, termToText);
+        }
+
+        {
+            auto out = output.CumulativeTermCounts(shard).OpenForWrite();
+            size_t uniqueTerms = 0;
+            for (size_t i = 0; i < documentCount; ++i)
+            {
+                uniqueTerms += newTerms[i];
+                *out << i << "," << uniqueTerms << std::endl;
+            }
+        }
+    }
+
+
+    void MergeStatistics(std::vector<IFileManager*> const & partitions,
+                         IFileManager & output)
+    {
+        if (partitions.empty())
+        {
+            RecoverableError error("MergeStatistics: no partitions to merge.");
+            throw error;
+        }
+
+        std::vector<std::vector<ShardSummary>> summaries;
+        for (auto partition : partitions)
+        {
+            summaries.push_back(ReadShardSummaries(*partition));
+            if (summaries.back().size() != summaries.front().size())
+            {
+                RecoverableError error("MergeStatistics: partitions have different shard counts.");
+                throw error;
+            }
+        }
+
+        // Term text is optional. Merge whatever text the partitions have.
+        std::unique_ptr<TermToText> termToText;
+        for (auto partition : partitions)
+        {
+            if (partition->TermToText().Exists())
+            {
+                if (termToText.get() == nullptr)
+                {
+                    termToText.reset(new TermToText());
+                }
+                auto input = partition->TermToText().OpenForRead();
+                termToText->AddTerms(*input);
+            }
+        }
+
+        if (termToText.get() != nullptr)
+        {
+            auto out = output.TermToText().OpenForWrite();
+            termToText->Write(*out);
+        }
+
+        {
+            DocumentHistogramBuilder histogram;
+            for (auto partition : partitions)
+            {
+                auto input = partition->DocumentHistogram().OpenForRead();
+                DocumentHistogram partial(*input);
+                for (size_t i = 0; i < partial.GetEntryCount(); ++i)
+                {
+                    histogram.AddDocuments(
+                        partial.GetPostingCount(i),
+                        static_cast<size_t>(partial.GetDocumentCount(i)));
+                }
+            }
+
+            auto out = output.DocumentHistogram().OpenForWrite();
+            histogram.Write(*out);
+        }
+
+        for (size_t shard = 0; shard < summaries.front().size(); ++shard)
+        {
+            MergeShard(partitions,
+                       summaries,
+                       shard,
+                       termToText.get(),
+                       output);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <array>
+#include <atomic>
+
+#include "PerThreadObjects.h"
+
+
+namespace BitFunnel
+{
+    struct ThreadObjectEntry
+    {
+        size_t m_ownerId;
+        void* m_object;
+    };
+
+    // Sized to hold the objects of a modest number of owners, typically one
+    // per Shard, without collisions.
+    static const size_t c_threadObjectTableSize = 16;
+
+    static thread_local std::array<ThreadObjectEntry, c_threadObjectTableSize>
+        t_threadObjects;
+
+    // Owner ids start at 1 so that the zero-initialized table never matches.
+    static std::atomic<size_t> s_nextOwnerId(1);
+
+
+    PerThreadObjectsBase::PerThreadObjectsBase()
+      : m_ownerId(s_nextOwnerId++)
+    {
+    }
+
+
+    void* PerThreadObjectsBase::GetCached() const
+    {
+        ThreadObjectEntry const & entry =
+            t_threadObjects[m_ownerId % c_threadObjectTableSize];
+        return (entry.m_ownerId == m_ownerId) ? entry.m_object : nullptr;
+    }
+
+
+    void PerThreadObjectsBase::SetCached(void* object) const
+    {
+        ThreadObjectEntry & entry =
+            t_threadObjects[m_ownerId % c_threadObjectTableSize];
+        entry.m_ownerId = m_ownerId;
+        entry.m_object = object;
+    }
+}
@@ -0,0 +1,143 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <memory>                       // std::unique_ptr member.
+#include <mutex>                        // std::mutex member.
+#include <stddef.h>                     // size_t member.
+#include <thread>                       // std::thread::id member.
+#include <utility>                      // std::pair member.
+#include <vector>                       // std::vector member.
+
+#include "BitFunnel/NonCopyable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // PerThreadObjectsBase
+    //
+    // Non-template part of PerThreadObjects<T>. Each thread keeps a small
+    // direct-mapped table from owner id to the owner's object for that
+    // thread. Owner ids are unique across all PerThreadObjects in the process
+    // and are never reused, so a stale entry can't alias a new owner.
+    //
+    //*************************************************************************
+    class PerThreadObjectsBase : public NonCopyable
+    {
+    protected:
+        PerThreadObjectsBase();
+
+        // Returns the calling thread's object for this owner if it is in the
+        // thread's table. Otherwise returns nullptr.
+        void* GetCached() const;
+
+        // Records object as the calling thread's object for this owner.
+        void SetCached(void* object) const;
+
+    private:
+        const size_t m_ownerId;
+    };
+
+
+    //*************************************************************************
+    //
+    // PerThreadObjects<T>
+    //
+    // Holds one T for each thread that calls Get(), so that threads can
+    // update their own T without locking. The lock is only taken when a
+    // thread's object is missing from its thread local table, which happens
+    // on the thread's first call and when owners collide in the table.
+    //
+    //*************************************************************************
+    template <typename T>
+    class PerThreadObjects : public PerThreadObjectsBase
+    {
+    public:
+        // Returns the calling thread's T, constructing it from args on the
+        // thread's first call.
+        template <typename... ARGS>
+        T& Get(ARGS const &... args);
+
+        // Calls action(T const &) for each thread's T.
+        template <typename ACTION>
+        void ForEach(ACTION action) const;
+
+    private:
+        // Protects m_objects.
+        mutable std::mutex m_lock;
+        std::vector<std::pair<std::thread::id, std::unique_ptr<T>>> m_objects;
+    };
+
+
+    template <typename T>
+    template <typename... ARGS>
+    T& PerThreadObjects<T>::Get(ARGS const &... args)
+    {
+        void* cached = GetCached();
+        if (cached != nullptr)
+        {
+            return *static_cast<T*>(cached);
+        }
+
+        T* object = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            const std::thread::id threadId = std::this_thread::get_id();
+            for (auto const & entry : m_objects)
+            {
+                if (entry.first == threadId)
+                {
+                    object = entry.second.get();
+                    break;
+                }
+            }
+
+            if (object == nullptr)
+            {
+                m_objects.emplace_back(threadId,
+                                       std::unique_ptr<T>(new T(args...)));
+                object = m_objects.back().second.get();
+            }
+        }
+
+        SetCached(object);
+
+        return *object;
+    }
+
+
+    template <typename T>
+    template <typename ACTION>
+    void PerThreadObjects<T>::ForEach(ACTION action) const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (auto const & entry : m_objects)
+        {
+            action(static_cast<T const &>(*entry.second));
+        }
+    }
+}
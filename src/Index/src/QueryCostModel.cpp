@@ -0,0 +1,115 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <math.h>
+
+#include "BitFunnel/Term.h"
+#include "QueryCostModel.h"
+
+
+namespace BitFunnel
+{
+    QueryCostModel::QueryCostModel(double density)
+      : m_density(density)
+    {
+    }
+
+
+    void QueryCostModel::AddTerm(double frequency,
+                                 RowConfiguration configuration,
+                                 bool isPrivate)
+    {
+        for (auto entry : configuration)
+        {
+            const Rank rank = entry.GetRank();
+            const double signal = Term::FrequencyAtRank(frequency, rank);
+            const bool privateRow = isPrivate || (signal >= m_density);
+
+            // All of a private term's rows at a rank are the same row.
+            const RowIndex count = privateRow ? 1 : entry.GetRowCount();
+            const double bitDensity =
+                privateRow ? (std::min)(signal, 1.0) : m_density;
+
+            for (RowIndex i = 0; i < count; ++i)
+            {
+                m_rows.push_back(std::make_pair(rank, bitDensity));
+            }
+        }
+    }
+
+
+    void QueryCostModel::Reset()
+    {
+        m_rows.clear();
+    }
+
+
+    double QueryCostModel::GetExpectedQuadwords() const
+    {
+        std::vector<std::pair<Rank, double>> rows(m_rows);
+        std::sort(rows.begin(), rows.end(),
+                  [](std::pair<Rank, double> const & a,
+                     std::pair<Rank, double> const & b)
+        {
+            // Highest rank first, then sparsest row first.
+            return (a.first != b.first) ? (a.first > b.first)
+                                        : (a.second < b.second);
+        });
+
+        double quadwords = 0.0;
+        double pQuadwordRead = 1.0;
+        double accumulatedDensity = 1.0;
+        for (auto const & row : rows)
+        {
+            quadwords += pQuadwordRead / (1ull << row.first);
+            accumulatedDensity *= row.second;
+            pQuadwordRead = 1.0 - pow(1.0 - accumulatedDensity, 64);
+        }
+
+        return quadwords;
+    }
+
+
+    double QueryCostModel::GetBitsPerDocument(double density,
+                                              double frequency,
+                                              RowConfiguration configuration,
+                                              bool isPrivate)
+    {
+        double bits = 0.0;
+        for (auto entry : configuration)
+        {
+            const Rank rank = entry.GetRank();
+            const double signal = Term::FrequencyAtRank(frequency, rank);
+            const double fanout = static_cast<double>(1ull << rank);
+            if (isPrivate || signal >= density)
+            {
+                bits += 1.0 / fanout;
+            }
+            else
+            {
+                bits += entry.GetRowCount() * signal / density / fanout;
+            }
+        }
+        return bits;
+    }
+}
@@ -0,0 +1,84 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <utility>                              // std::pair template parameter.
+#include <vector>                               // std::vector member.
+
+#include "BitFunnel/BitFunnelTypes.h"           // Rank template parameter.
+#include "BitFunnel/Index/ITermTreatment.h"     // RowConfiguration parameter.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // QueryCostModel
+    //
+    // Estimates the cost of matching a conjunction of terms, given each
+    // term's document frequency and RowConfiguration. The model follows the
+    // one used by TreatmentOptimal: rows are intersected from the highest
+    // rank down, the first row is always read, and each later row at rank r
+    // is read with probability equal to the chance that the accumulated
+    // quadword is non-zero, at a cost of 1 / 2^r quadwords per 64 documents.
+    //
+    // Terms are assumed to be independent. A row at rank r has a bit
+    // density equal to the term's frequency at rank r if the row is private
+    // and equal to the target density if the row is shared. As in
+    // TermTableBuilder, a row is private if the term's frequency at its rank
+    // reaches the target density, or if the term is forced to be private.
+    //
+    //*************************************************************************
+    class QueryCostModel
+    {
+    public:
+        QueryCostModel(double density);
+
+        // Adds the rows of a term with the given document frequency. When
+        // isPrivate is true, the term has one private row at each rank of
+        // its configuration, regardless of its frequency.
+        void AddTerm(double frequency,
+                     RowConfiguration configuration,
+                     bool isPrivate = false);
+
+        // Removes all terms.
+        void Reset();
+
+        // Returns the expected number of quadwords read per 64 documents.
+        double GetExpectedQuadwords() const;
+
+        // Returns the number of row bits per document used to represent a
+        // term with the given frequency and configuration. A shared row
+        // contributes the fraction of the row that the term occupies.
+        static double GetBitsPerDocument(double density,
+                                         double frequency,
+                                         RowConfiguration configuration,
+                                         bool isPrivate = false);
+
+    private:
+        double m_density;
+
+        // (Rank, bit density) of each row.
+        std::vector<std::pair<Rank, double>> m_rows;
+    };
+}
@@ -0,0 +1,86 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+
+#include "BitFunnel/Index/Factories.h"
+#include "QueryProfile.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<IQueryProfile> Factories::CreateQueryProfile()
+    {
+        return std::unique_ptr<IQueryProfile>(new QueryProfile());
+    }
+
+
+    //*************************************************************************
+    //
+    // QueryProfile
+    //
+    //*************************************************************************
+    QueryProfile::QueryProfile()
+    {
+    }
+
+
+    void QueryProfile::AddQuery(std::vector<Term::Hash> const & terms)
+    {
+        std::vector<Term::Hash> distinct(terms);
+        std::sort(distinct.begin(), distinct.end());
+        distinct.erase(std::unique(distinct.begin(), distinct.end()),
+                       distinct.end());
+
+        for (auto hash : distinct)
+        {
+            ++m_counts[hash];
+        }
+
+        m_queries.push_back(std::move(distinct));
+    }
+
+
+    size_t QueryProfile::GetQueryCount() const
+    {
+        return m_queries.size();
+    }
+
+
+    double QueryProfile::GetQueryFrequency(Term::Hash hash) const
+    {
+        auto it = m_counts.find(hash);
+        if (it == m_counts.end())
+        {
+            return 0.0;
+        }
+
+        return static_cast<double>(it->second) / m_queries.size();
+    }
+
+
+    std::vector<std::vector<Term::Hash>> const &
+        QueryProfile::GetQueries() const
+    {
+        return m_queries;
+    }
+}
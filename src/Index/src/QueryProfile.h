@@ -0,0 +1,57 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <unordered_map>                    // std::unordered_map member.
+#include <vector>                           // std::vector member.
+
+#include "BitFunnel/Index/IQueryProfile.h"  // Base class.
+
+
+namespace BitFunnel
+{
+    class QueryProfile : public IQueryProfile
+    {
+    public:
+        QueryProfile();
+
+        //
+        // IQueryProfile methods.
+        //
+
+        virtual void AddQuery(std::vector<Term::Hash> const & terms) override;
+
+        virtual size_t GetQueryCount() const override;
+
+        virtual double GetQueryFrequency(Term::Hash hash) const override;
+
+        virtual std::vector<std::vector<Term::Hash>> const &
+            GetQueries() const override;
+
+    private:
+        std::vector<std::vector<Term::Hash>> m_queries;
+
+        // Number of queries containing each term.
+        std::unordered_map<Term::Hash, size_t> m_counts;
+    };
+}
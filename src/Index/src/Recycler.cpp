@@ -23,6 +23,7 @@
 
 #include "BitFunnel/Index/Factories.h"
 #include "BitFunnel/Index/Token.h"
+#include "BitFunnel/Utilities/TraceLog.h"
 #include "LoggerInterfaces/Logging.h"
 #include "Recycler.h"
 #include "Slice.h"
@@ -45,7 +46,8 @@ namespace BitFunnel
     Recycler::Recycler()
         : m_queue (std::unique_ptr<BlockingQueue<IRecyclable*>>
                    (new BlockingQueue<IRecyclable*>(100))),
-          m_shutdown (false)
+          m_shutdown (false),
+          m_pendingCount(0)
     {
     }
 
@@ -69,19 +71,31 @@ namespace BitFunnel
                 break;
             }
             LogAssertB(item, "null IRecycable item.");
+
+            // Includes the wait for outstanding tokens, so long spans here
+            // show queries holding up recycling.
+            TraceScope trace("recycler", "Recycle");
             item->Recycle();
             delete item;
+            --m_pendingCount;
         }
     }
 
     void Recycler::ScheduleRecyling(std::unique_ptr<IRecyclable>& resource)
     {
         auto ptr = resource.release();
+        ++m_pendingCount;
         LogAssertB(m_queue->TryEnqueue(ptr),
                    "ScheduleRecycling called on queue that's shutting down.");
     }
 
 
+    size_t Recycler::GetPendingCount() const
+    {
+        return m_pendingCount;
+    }
+
+
     void Recycler::Shutdown()
     {
         m_queue->Shutdown();
@@ -112,11 +112,18 @@ namespace BitFunnel
         // Recycler takes ownership of the resource.
         virtual void
             ScheduleRecyling(std::unique_ptr<IRecyclable>& resource) override;
+
+        virtual size_t GetPendingCount() const override;
+
     private:
         // TODO: we should log of this queue fills to the point of blocking on
         // enqueue. That's an unexpected condition.
         std::unique_ptr<BlockingQueue<IRecyclable*>> m_queue;
 
         std::atomic<bool> m_shutdown;
+
+        // Resources scheduled but not yet recycled, including the one the
+        // Run() thread is currently working on.
+        std::atomic<size_t> m_pendingCount;
     };
 }
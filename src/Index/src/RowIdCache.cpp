@@ -0,0 +1,110 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "RowIdCache.h"
+
+
+namespace BitFunnel
+{
+    RowIdCache::RowIdCache(size_t capacity)
+      : m_shift(64),
+        m_hits(0),
+        m_misses(0)
+    {
+        size_t slotCount = 1;
+        while (slotCount < capacity || slotCount < 2)
+        {
+            slotCount *= 2;
+            --m_shift;
+        }
+
+        Entry empty = {};
+        empty.m_valid = false;
+        m_entries.resize(slotCount, empty);
+    }
+
+
+    RowIdCache::Entry const * RowIdCache::Find(Term const & term)
+    {
+        Entry const & entry = GetSlot(term.GetRawHash());
+        if (entry.m_valid &&
+            entry.m_hash == term.GetRawHash() &&
+            entry.m_stream == term.GetStream() &&
+            entry.m_gramSize == term.GetGramSize())
+        {
+            m_hits.store(m_hits.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+            return &entry;
+        }
+
+        m_misses.store(m_misses.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+        return nullptr;
+    }
+
+
+    void RowIdCache::Insert(Term const & term,
+                            Rank const * ranks,
+                            RowIndex const * rows,
+                            ptrdiff_t const * offsets,
+                            size_t rowCount)
+    {
+        if (rowCount > c_maxRowsPerEntry)
+        {
+            return;
+        }
+
+        Entry& entry = GetSlot(term.GetRawHash());
+        entry.m_hash = term.GetRawHash();
+        entry.m_stream = term.GetStream();
+        entry.m_gramSize = term.GetGramSize();
+        entry.m_valid = true;
+        entry.m_rowCount = static_cast<uint8_t>(rowCount);
+        for (size_t i = 0; i < rowCount; ++i)
+        {
+            entry.m_ranks[i] = static_cast<uint8_t>(ranks[i]);
+            entry.m_rows[i] = rows[i];
+            entry.m_offsets[i] = offsets[i];
+        }
+    }
+
+
+    size_t RowIdCache::GetHitCount() const
+    {
+        return m_hits.load(std::memory_order_relaxed);
+    }
+
+
+    size_t RowIdCache::GetMissCount() const
+    {
+        return m_misses.load(std::memory_order_relaxed);
+    }
+
+
+    RowIdCache::Entry& RowIdCache::GetSlot(Term::Hash hash)
+    {
+        // Fibonacci hashing, so that small and sequential hashes still
+        // spread across the cache.
+        return m_entries[(hash * 0x9E3779B97F4A7C15ull) >> m_shift];
+    }
+}
@@ -0,0 +1,104 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <atomic>                       // std::atomic member.
+#include <stddef.h>                     // ptrdiff_t, size_t members.
+#include <vector>                       // std::vector member.
+
+#include "BitFunnel/BitFunnelTypes.h"   // Rank member.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+#include "BitFunnel/Term.h"             // Term parameter.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // RowIdCache is a bounded, direct-mapped cache from a term's
+    // (raw hash, stream, gram size) to the expanded list of rows the term
+    // sets during ingestion. Each row is recorded as its rank, its index and
+    // the byte offset of the row within a slice buffer, so that a cache hit goes
+    // straight to the bit writes without consulting the TermTable or
+    // regenerating adhoc RowIds.
+    //
+    // Each RowIdCache belongs to a single Shard and is used by a single
+    // ingestion thread, so lookups take no locks. The hit and miss counters
+    // may be read from other threads.
+    //
+    //*************************************************************************
+    class RowIdCache : NonCopyable
+    {
+    public:
+        // Terms with more rows than this are not cached.
+        static const size_t c_maxRowsPerEntry = 6;
+
+        // Default number of entries. Must be a power of two.
+        static const size_t c_defaultCapacity = 4096;
+
+        struct Entry
+        {
+            Term::Hash m_hash;
+            Term::StreamId m_stream;
+            Term::GramSize m_gramSize;
+            bool m_valid;
+            uint8_t m_rowCount;
+            uint8_t m_ranks[c_maxRowsPerEntry];
+            RowIndex m_rows[c_maxRowsPerEntry];
+            ptrdiff_t m_offsets[c_maxRowsPerEntry];
+        };
+
+        // Constructs an empty cache with capacity entries, rounded up to a
+        // power of two.
+        RowIdCache(size_t capacity = c_defaultCapacity);
+
+        // Returns the entry for term or nullptr if term is not in the cache.
+        // Updates the hit and miss counts.
+        Entry const * Find(Term const & term);
+
+        // Records the rows for term, replacing whatever entry previously
+        // occupied its slot. Terms with more than c_maxRowsPerEntry rows are
+        // ignored.
+        void Insert(Term const & term,
+                    Rank const * ranks,
+                    RowIndex const * rows,
+                    ptrdiff_t const * offsets,
+                    size_t rowCount);
+
+        size_t GetHitCount() const;
+        size_t GetMissCount() const;
+
+    private:
+        Entry& GetSlot(Term::Hash hash);
+
+        std::vector<Entry> m_entries;
+        unsigned m_shift;
+
+        // Only the owning thread writes these counters, so they are updated
+        // with relaxed loads and stores rather than read-modify-write
+        // operations.
+        std::atomic<size_t> m_hits;
+        std::atomic<size_t> m_misses;
+    };
+}
@@ -0,0 +1,328 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/ITermTable.h"
+#include "BitFunnel/Index/Row.h"
+#include "RowPlacementOptimizer.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<IRowPlacementOptimizer>
+        Factories::CreateRowPlacementOptimizer(ITermTable const & termTable,
+                                               DocIndex sliceCapacity)
+    {
+        return std::unique_ptr<IRowPlacementOptimizer>(
+            new RowPlacementOptimizer(termTable, sliceCapacity));
+    }
+
+
+    RowPlacementOptimizer::RowPlacementOptimizer(ITermTable const & termTable,
+                                                 DocIndex sliceCapacity)
+      : m_applied(false)
+    {
+        const Rank maxRank = termTable.GetMaxRankUsed();
+        const DocIndex capacity = Row::DocumentsInRank0Row(sliceCapacity, maxRank);
+
+        for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+        {
+            m_firstRow[rank] = static_cast<RowIndex>(termTable.GetAdhocRowCount(rank));
+            m_rowCount[rank] = static_cast<RowIndex>(termTable.GetExplicitRowCount(rank));
+
+            m_rowsPerPage[rank] = 1;
+            if (rank <= maxRank)
+            {
+                const size_t bytesInRow = Row::BytesInRow(capacity, rank, maxRank);
+                m_rowsPerPage[rank] =
+                    (std::max)(static_cast<size_t>(1), c_bytesPerPage / bytesInRow);
+            }
+        }
+    }
+
+
+    void RowPlacementOptimizer::AddQuery(std::vector<RowId> const & rows)
+    {
+        for (auto row : rows)
+        {
+            RowIndex offset;
+            if (TryGetOffset(row, offset))
+            {
+                m_queryRows.push_back(RowId(row.GetRank(), offset));
+            }
+        }
+        m_queryEnds.push_back(m_queryRows.size());
+    }
+
+
+    void RowPlacementOptimizer::Apply(ITermTable & termTable)
+    {
+        for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+        {
+            if (termTable.GetExplicitRowCount(rank) != m_rowCount[rank] ||
+                termTable.GetAdhocRowCount(rank) != m_firstRow[rank])
+            {
+                RecoverableError error("RowPlacementOptimizer::Apply: TermTable does not match.");
+                throw error;
+            }
+        }
+
+        for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+        {
+            m_mappings[rank] = ComputeMapping(rank);
+            if (m_rowCount[rank] > 0)
+            {
+                termTable.PermuteExplicitRows(rank, m_mappings[rank]);
+            }
+        }
+        m_applied = true;
+    }
+
+
+    void RowPlacementOptimizer::Print(std::ostream& output) const
+    {
+        output << "Queries: " << m_queryEnds.size() << std::endl;
+        output << "Explicit rows read: " << m_queryRows.size() << std::endl;
+        output << "Rows per page:";
+        for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+        {
+            output << " " << m_rowsPerPage[rank];
+        }
+        output << std::endl;
+        output << "Mean pages per query before: " << GetMeanPagesBefore() << std::endl;
+        if (m_applied)
+        {
+            output << "Mean pages per query after: " << GetMeanPagesAfter() << std::endl;
+        }
+    }
+
+
+    std::vector<RowIndex> const & RowPlacementOptimizer::GetMapping(Rank rank) const
+    {
+        return m_mappings[rank];
+    }
+
+
+    double RowPlacementOptimizer::GetMeanPagesBefore() const
+    {
+        return GetMeanPages(false);
+    }
+
+
+    double RowPlacementOptimizer::GetMeanPagesAfter() const
+    {
+        return GetMeanPages(m_applied);
+    }
+
+
+    std::vector<RowIndex> RowPlacementOptimizer::ComputeMapping(Rank rank) const
+    {
+        const RowIndex rowCount = m_rowCount[rank];
+
+        // Gather per-row heat and pairwise affinity for this rank.
+        std::vector<size_t> heat(rowCount, 0);
+        std::unordered_map<RowIndex, std::unordered_map<RowIndex, size_t>> affinity;
+
+        std::vector<RowIndex> rows;
+        size_t start = 0;
+        for (auto end : m_queryEnds)
+        {
+            rows.clear();
+            for (size_t i = start; i < end; ++i)
+            {
+                if (m_queryRows[i].GetRank() == rank)
+                {
+                    rows.push_back(m_queryRows[i].GetIndex());
+                }
+            }
+            start = end;
+
+            std::sort(rows.begin(), rows.end());
+            rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+            for (auto row : rows)
+            {
+                ++heat[row];
+            }
+
+            if (rows.size() <= c_maxRowsForAffinity)
+            {
+                for (size_t i = 0; i < rows.size(); ++i)
+                {
+                    for (size_t j = i + 1; j < rows.size(); ++j)
+                    {
+                        ++affinity[rows[i]][rows[j]];
+                        ++affinity[rows[j]][rows[i]];
+                    }
+                }
+            }
+        }
+
+        // Rows that are read, hottest first.
+        std::vector<RowIndex> hot;
+        for (RowIndex row = 0; row < rowCount; ++row)
+        {
+            if (heat[row] > 0)
+            {
+                hot.push_back(row);
+            }
+        }
+        std::stable_sort(hot.begin(),
+                         hot.end(),
+                         [&heat](RowIndex a, RowIndex b)
+                         {
+                             return heat[a] > heat[b];
+                         });
+
+        // Place rows a page at a time. A run needs at least two rows for
+        // adjacency to matter, even when a row is larger than a page.
+        const size_t groupSize = (std::max)(static_cast<size_t>(2),
+                                            m_rowsPerPage[rank]);
+        std::vector<bool> placed(rowCount, false);
+        std::vector<RowIndex> order;
+        order.reserve(rowCount);
+        std::unordered_map<RowIndex, size_t> score;
+        size_t nextHot = 0;
+
+        while (order.size() < hot.size())
+        {
+            RowIndex row = 0;
+            if (score.empty())
+            {
+                while (placed[hot[nextHot]])
+                {
+                    ++nextHot;
+                }
+                row = hot[nextHot];
+            }
+            else
+            {
+                auto best = score.begin();
+                for (auto it = score.begin(); it != score.end(); ++it)
+                {
+                    if (it->second > best->second ||
+                        (it->second == best->second &&
+                         (heat[it->first] > heat[best->first] ||
+                          (heat[it->first] == heat[best->first] &&
+                           it->first < best->first))))
+                    {
+                        best = it;
+                    }
+                }
+                row = best->first;
+            }
+
+            placed[row] = true;
+            order.push_back(row);
+            score.erase(row);
+
+            // Start a fresh page, seeded with the neighbors of the last row
+            // so that consecutive pages stay related.
+            if (order.size() % groupSize == 0)
+            {
+                score.clear();
+            }
+
+            auto neighbors = affinity.find(row);
+            if (neighbors != affinity.end())
+            {
+                for (auto const & neighbor : neighbors->second)
+                {
+                    if (!placed[neighbor.first])
+                    {
+                        score[neighbor.first] += neighbor.second;
+                    }
+                }
+            }
+        }
+
+        for (RowIndex row = 0; row < rowCount; ++row)
+        {
+            if (!placed[row])
+            {
+                order.push_back(row);
+            }
+        }
+
+        std::vector<RowIndex> mapping(rowCount);
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            mapping[order[i]] = static_cast<RowIndex>(i);
+        }
+
+        return mapping;
+    }
+
+
+    double RowPlacementOptimizer::GetMeanPages(bool useMapping) const
+    {
+        if (m_queryEnds.empty())
+        {
+            return 0.0;
+        }
+
+        size_t totalPages = 0;
+        std::unordered_set<uint64_t> pages;
+        size_t start = 0;
+        for (auto end : m_queryEnds)
+        {
+            pages.clear();
+            for (size_t i = start; i < end; ++i)
+            {
+                const Rank rank = m_queryRows[i].GetRank();
+                RowIndex offset = m_queryRows[i].GetIndex();
+                if (useMapping)
+                {
+                    offset = m_mappings[rank][offset];
+                }
+                const uint64_t page = offset / m_rowsPerPage[rank];
+                pages.insert((page << 3) | rank);
+            }
+            totalPages += pages.size();
+            start = end;
+        }
+
+        return static_cast<double>(totalPages) / m_queryEnds.size();
+    }
+
+
+    bool RowPlacementOptimizer::TryGetOffset(RowId row, RowIndex& offset) const
+    {
+        const Rank rank = row.GetRank();
+        if (row.IsAdhoc() ||
+            row.GetIndex() < m_firstRow[rank] ||
+            row.GetIndex() >= m_firstRow[rank] + m_rowCount[rank])
+        {
+            return false;
+        }
+
+        offset = row.GetIndex() - m_firstRow[rank];
+        return true;
+    }
+}
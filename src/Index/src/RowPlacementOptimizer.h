@@ -0,0 +1,98 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <array>                                        // std::array member.
+#include <iosfwd>                                       // std::ostream parameter.
+#include <vector>                                       // std::vector member.
+
+#include "BitFunnel/BitFunnelTypes.h"                   // Rank, DocIndex parameter.
+#include "BitFunnel/Index/IRowPlacementOptimizer.h"     // Base class.
+#include "BitFunnel/Index/RowId.h"                      // RowIndex member.
+
+
+namespace BitFunnel
+{
+    class ITermTable;
+
+    //*************************************************************************
+    //
+    // RowPlacementOptimizer
+    //
+    // Greedy co-access placement. For each rank, rows are ordered one page at
+    // a time. A page is grown by repeatedly appending the unplaced row that
+    // shares the most queries with the rows already on the page. When no row
+    // has any affinity to the page, the most frequently read unplaced row
+    // starts the next run. Rows that no query reads keep their relative
+    // order after all of the rows that are read.
+    //
+    //*************************************************************************
+    class RowPlacementOptimizer : public IRowPlacementOptimizer
+    {
+    public:
+        RowPlacementOptimizer(ITermTable const & termTable,
+                              DocIndex sliceCapacity);
+
+        //
+        // IRowPlacementOptimizer methods.
+        //
+        virtual void AddQuery(std::vector<RowId> const & rows) override;
+        virtual void Apply(ITermTable & termTable) override;
+        virtual void Print(std::ostream& output) const override;
+
+        // Returns the new offset of each explicit row at (rank), computed by
+        // Apply(). Exposed for unit tests.
+        std::vector<RowIndex> const & GetMapping(Rank rank) const;
+
+        // Returns the mean number of distinct pages of explicit rows read
+        // per query, using the original row order or the order chosen by
+        // Apply().
+        double GetMeanPagesBefore() const;
+        double GetMeanPagesAfter() const;
+
+    private:
+        // Queries with more rows than this at a single rank contribute to
+        // row heat but not to pairwise affinity, to bound the quadratic cost.
+        static const size_t c_maxRowsForAffinity = 256;
+
+        std::vector<RowIndex> ComputeMapping(Rank rank) const;
+        double GetMeanPages(bool useMapping) const;
+
+        // Offset of a RowId from the first explicit row at its rank.
+        // Returns false if the row is not a movable explicit row.
+        bool TryGetOffset(RowId row, RowIndex& offset) const;
+
+        std::array<RowIndex, c_maxRankValue + 1> m_firstRow;
+        std::array<RowIndex, c_maxRankValue + 1> m_rowCount;
+        std::array<size_t, c_maxRankValue + 1> m_rowsPerPage;
+
+        // Explicit rows read by each query, as offsets from the first
+        // explicit row. Query i's rows are
+        // [m_queryEnds[i - 1], m_queryEnds[i]).
+        std::vector<RowId> m_queryRows;
+        std::vector<size_t> m_queryEnds;
+
+        bool m_applied;
+        std::array<std::vector<RowIndex>, c_maxRankValue + 1> m_mappings;
+    };
+}
@@ -284,45 +284,50 @@ namespace BitFunnel
             auto out = outFileManager->ColumnDensities(shardId).OpenForWrite();
             Column::WriteHeader(*out);
 
-            auto itPtr = shard.GetIterator();
-            auto & it = *itPtr;
-
-            for (; !it.AtEnd(); ++it)
+            auto analyzeBatch = [&](std::vector<DocumentHandle> const & documents)
             {
-                const DocumentHandleInternal handle(*it);
-                const DocId docId = handle.GetDocId();
-                Slice const & slice = handle.GetSlice();
+                for (auto const & document : documents)
+                {
+                    const DocumentHandleInternal handle(document);
+                    const DocId docId = handle.GetDocId();
+                    Slice const & slice = handle.GetSlice();
 
-                // TODO: handle.GetPostingCount() instead of 0
-                Column column(docId, shardId, 0);
+                    // TODO: handle.GetPostingCount() instead of 0
+                    Column column(docId, shardId, 0);
 
-                void const * buffer = slice.GetSliceBuffer();
-                const DocIndex docIndex = handle.GetIndex();
+                    void const * buffer = slice.GetSliceBuffer();
+                    const DocIndex docIndex = handle.GetIndex();
 
-                for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
-                {
-                    RowTableDescriptor rowTable = slice.GetRowTable(rank);
-
-                    size_t bitCount = 0;
-                    const size_t rowCount = rowTable.GetRowCount();
-                    for (RowIndex row = 0; row < rowCount; ++row)
+                    for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
                     {
-                        if (rowTable.GetBit(buffer, row, docIndex) != 0)
+                        RowTableDescriptor rowTable = slice.GetRowTable(rank);
+
+                        size_t bitCount = 0;
+                        const size_t rowCount = rowTable.GetRowCount();
+                        for (RowIndex row = 0; row < rowCount; ++row)
                         {
-                            ++bitCount;
+                            if (rowTable.GetBit(buffer, row, docIndex) != 0)
+                            {
+                                ++bitCount;
+                            }
                         }
-                    }
 
-                    column.SetCount(rank, bitCount);
+                        column.SetCount(rank, bitCount);
+
+                        double density =
+                            (rowCount == 0) ? 0.0 : static_cast<double>(bitCount) / rowCount;
+                        column.SetDensity(rank, density);
+                        accumulators[rank].Record(density);
+                    }
 
-                    double density =
-                        (rowCount == 0) ? 0.0 : static_cast<double>(bitCount) / rowCount;
-                    column.SetDensity(rank, density);
-                    accumulators[rank].Record(density);
+                    column.Write(*out);
                 }
+            };
 
-                column.Write(*out);
-            }
+            // Visit active documents a batch at a time. ForEachActive()
+            // skips over runs of inactive columns a quadword at a time.
+            const size_t c_batchSize = 1024;
+            shard.ForEachActive(analyzeBatch, c_batchSize);
 
             //
             // Generate document summary by rank for shard
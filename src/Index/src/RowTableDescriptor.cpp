@@ -40,12 +40,14 @@ namespace BitFunnel
                                            RowIndex rowCount,
                                            Rank rank,
                                            Rank maxRank,
-                                           ptrdiff_t rowTableBufferOffset)
+                                           ptrdiff_t rowTableBufferOffset,
+                                           ptrdiff_t summaryOffset)
         : m_capacity(capacity),
           m_rowCount(rowCount),
           m_rank(rank),
           m_maxRank(maxRank),
           m_bufferOffset(rowTableBufferOffset),
+          m_summaryOffset(summaryOffset),
           m_bytesPerRow(Row::BytesInRow(capacity, rank, maxRank))
     {
         // Make sure capacity is properly rounded already.
@@ -56,6 +58,8 @@ namespace BitFunnel
         // // Make sure offset of this RowTable is properly aligned.
         CHECK_EQ(rowTableBufferOffset % static_cast<ptrdiff_t>(c_rowTableByteAlignment), 0)
             << "incorrect buffer alignment.";
+        CHECK_EQ(summaryOffset % static_cast<ptrdiff_t>(sizeof(uint64_t)), 0)
+            << "incorrect summary alignment.";
     }
 
 
@@ -65,6 +69,7 @@ namespace BitFunnel
           m_rank(other.m_rank),
           m_maxRank(other.m_maxRank),
           m_bufferOffset(other.m_bufferOffset),
+          m_summaryOffset(other.m_summaryOffset),
           m_bytesPerRow(other.m_bytesPerRow)
     {
     }
@@ -78,6 +83,9 @@ namespace BitFunnel
         memset(rowTableBuffer,
                0,
                GetBufferSize(m_capacity, m_rowCount, m_rank, m_maxRank));
+        memset(reinterpret_cast<char*>(sliceBuffer) + m_summaryOffset,
+               0,
+               GetSummaryBufferSize(m_rowCount));
 
         // The "match-all" row needs to be initialized differently.
         RowIdSequence rows(ITermTable::GetMatchAllTerm(), termTable);
@@ -105,6 +113,7 @@ namespace BitFunnel
             // Fill up the match-all row with all ones.
             uint64_t * rowData = GetRowData(sliceBuffer, row.GetIndex());
             memset(rowData, 0xFF, m_bytesPerRow);
+            SetSummaryBit(sliceBuffer, row.GetIndex());
         }
     }
 
@@ -115,6 +124,12 @@ namespace BitFunnel
     }
 
 
+    size_t RowTableDescriptor::GetQuadwordsPerRow() const
+    {
+        return m_bytesPerRow / sizeof(uint64_t);
+    }
+
+
     uint64_t RowTableDescriptor::GetBit(void const * sliceBuffer,
                                         RowIndex rowIndex,
                                         DocIndex docIndex) const
@@ -140,7 +155,21 @@ namespace BitFunnel
     {
         CHECK_LT(rowIndex, m_rowCount)
             << "rowIndex out of range.";
-        uint64_t* const row = GetRowData(sliceBuffer, rowIndex);
+        SetBitAtOffset(sliceBuffer, rowIndex, GetRowOffset(rowIndex), docIndex);
+    }
+
+
+    void RowTableDescriptor::SetBitAtOffset(void* sliceBuffer,
+                                            RowIndex rowIndex,
+                                            ptrdiff_t rowOffset,
+                                            DocIndex docIndex) const
+    {
+        // Update the summary before the row so that a query never sees a
+        // set bit in a row whose summary is still clear.
+        SetSummaryBit(sliceBuffer, rowIndex);
+
+        uint64_t* const row = reinterpret_cast<uint64_t*>(
+            reinterpret_cast<char*>(sliceBuffer) + rowOffset);
         const size_t offset = QwordPositionFromDocIndex(docIndex);
         uint64_t bitPos = docIndex & 0x3F;
 
@@ -157,6 +186,16 @@ namespace BitFunnel
     }
 
 
+    bool RowTableDescriptor::IsRowEmpty(void const * sliceBuffer,
+                                        RowIndex rowIndex) const
+    {
+        const ptrdiff_t bit = GetSummaryBitOffset(rowIndex);
+        uint64_t const * summary =
+            reinterpret_cast<uint64_t const *>(sliceBuffer) + (bit >> 6);
+        return (*summary & (1ull << (bit & 0x3F))) == 0;
+    }
+
+
     void RowTableDescriptor::ClearBit(void* sliceBuffer,
                                       RowIndex rowIndex,
                                       DocIndex docIndex) const
@@ -184,6 +223,19 @@ namespace BitFunnel
     }
 
 
+    ptrdiff_t RowTableDescriptor::GetSummaryBitOffset(RowIndex rowIndex) const
+    {
+        return m_summaryOffset * 8 + static_cast<ptrdiff_t>(rowIndex);
+    }
+
+
+    /* static */
+    size_t RowTableDescriptor::GetSummaryBufferSize(RowIndex rowCount)
+    {
+        return (rowCount + 63) / 64 * sizeof(uint64_t);
+    }
+
+
     /* static */
     size_t RowTableDescriptor::GetBufferSize(DocIndex capacity,
                                              RowIndex rowCount,
@@ -221,6 +273,26 @@ namespace BitFunnel
     }
 
 
+    void RowTableDescriptor::SetSummaryBit(void* sliceBuffer,
+                                           RowIndex rowIndex) const
+    {
+        uint64_t* const summary = reinterpret_cast<uint64_t*>(
+            reinterpret_cast<char*>(sliceBuffer) + m_summaryOffset) + (rowIndex >> 6);
+        uint64_t bitPos = rowIndex & 0x3F;
+
+        // Most postings go to rows that already have bits in this slice, so
+        // test before paying for the locked instruction.
+        if ((*summary & (1ull << bitPos)) == 0)
+        {
+#ifdef _MSC_VER
+            _interlockedbittestandset64(reinterpret_cast<long long *>(summary), bitPos);
+#else
+            asm("lock btsq %1, %0" : "+m" (*summary) : "r" (bitPos));
+#endif
+        }
+    }
+
+
     size_t RowTableDescriptor::QwordPositionFromDocIndex(DocIndex docIndex) const
     {
         LogAssertB(docIndex < m_capacity, "docIndex out of range");
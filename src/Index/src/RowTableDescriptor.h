@@ -42,6 +42,11 @@ namespace BitFunnel
     // and is able to perform bit operations over that data.
     // See Slice.h for more info about the layout of the data buffer.
     //
+    // Each RowTable also owns a row summary in the slice buffer: one bit per
+    // row which is set the first time any bit in the row is set. Queries use
+    // the summary to skip slices where a required row has no set bits. The
+    // summary is conservative - ClearBit() does not reset it.
+    //
     // All methods except Initialize are thread safe. Initialize method is not
     // thread-safe with respect to calling *Bit methods at the same time.
     //
@@ -52,12 +57,14 @@ namespace BitFunnel
         // Constructs a RowTableDescriptor with given dimensions.
         // rowTableBufferOffset represents the offset where this RowTable's
         // data starts within a larger slice buffer which is passed to other
-        // methods.
+        // methods. summaryOffset is the quadword aligned offset of the row
+        // summary within the same slice buffer.
         RowTableDescriptor(DocIndex capacity,
                            RowIndex rowCount,
                            Rank rank,
                            Rank maxRank,
-                           ptrdiff_t bufferOffset);
+                           ptrdiff_t bufferOffset,
+                           ptrdiff_t summaryOffset);
 
         // Copy constructor from another RowTableDescriptor. Required so that
         // RowTableDescriptor can be used in std::vector and that a Slice can
@@ -75,6 +82,15 @@ namespace BitFunnel
 
         RowIndex GetRowCount() const;
 
+        // Returns the number of quadwords in a single row.
+        size_t GetQuadwordsPerRow() const;
+
+        // Returns a pointer to the first quadword of the row with the given
+        // RowIndex. Used by bulk operations, like density computation, that
+        // process an entire row a quadword at a time.
+        uint64_t const * GetRowData(void const * sliceBuffer,
+                                    RowIndex rowIndex) const;
+
         // Gets a bit in the given row and column.
         uint64_t GetBit(void const * sliceBuffer,
                         RowIndex rowIndex,
@@ -85,7 +101,21 @@ namespace BitFunnel
                     RowIndex rowIndex,
                     DocIndex docIndex) const;
 
-        // Clears a bit in the given row and column.
+        // Sets a bit in the given row, which is at rowOffset, as returned by
+        // GetRowOffset(rowIndex). Allows callers that cache row offsets to
+        // skip the row lookup.
+        void SetBitAtOffset(void* sliceBuffer,
+                            RowIndex rowIndex,
+                            ptrdiff_t rowOffset,
+                            DocIndex docIndex) const;
+
+        // Returns true if no bit in the given row has been set since the
+        // slice buffer was initialized.
+        bool IsRowEmpty(void const * sliceBuffer,
+                        RowIndex rowIndex) const;
+
+        // Clears a bit in the given row and column. Does not update the row
+        // summary.
         void ClearBit(void* sliceBuffer,
                       RowIndex rowIndex,
                       DocIndex docIndex) const;
@@ -94,6 +124,10 @@ namespace BitFunnel
         // start of the sliceBuffer.
         ptrdiff_t GetRowOffset(RowIndex rowIndex) const;
 
+        // Returns the position of the row summary bit for the given row, in
+        // bits from the start of the slice buffer.
+        ptrdiff_t GetSummaryBitOffset(RowIndex rowIndex) const;
+
         // Returns true if the given RowTableDescriptor is data-compatible with
         // this instance. Used when loading Slices from the stream.
         bool IsCompatibleWith(RowTableDescriptor const & other) const;
@@ -106,6 +140,10 @@ namespace BitFunnel
                                     Rank rank,
                                     Rank maxRank);
 
+        // Returns the byte size of the row summary for a RowTable with the
+        // given number of rows. The size is a multiple of the quadword size.
+        static size_t GetSummaryBufferSize(RowIndex rowCount);
+
         // RocTable buffers are placed such that it is aligned with this 
         // byte alignment. For performance reasons it is advantageous that
         // it is placed either at quadword or at cacheline boundaries.
@@ -120,8 +158,10 @@ namespace BitFunnel
         // RowIndex.
         uint64_t* GetRowData(void* sliceBuffer,
                              RowIndex rowIndex) const;
-        uint64_t const * GetRowData(void const * sliceBuffer,
-                                    RowIndex rowIndex) const;
+
+        // Marks the given row as non-empty in the row summary.
+        void SetSummaryBit(void* sliceBuffer,
+                           RowIndex rowIndex) const;
 
         // Returns the QWORD number for the given DocIndex.
         size_t QwordPositionFromDocIndex(DocIndex docIndex) const;
@@ -138,6 +178,9 @@ namespace BitFunnel
         // Offset where this RowTable starts in the slice buffer.
         const ptrdiff_t m_bufferOffset;
 
+        // Offset of the row summary in the slice buffer.
+        const ptrdiff_t m_summaryOffset;
+
         // Cached value of the number of bytes per single row.
         const size_t m_bytesPerRow;
     };
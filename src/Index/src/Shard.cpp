@@ -20,6 +20,10 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/IFileManager.h"
 #include "BitFunnel/Index/IRecycler.h"
@@ -28,7 +32,10 @@
 #include "BitFunnel/Index/Row.h"
 #include "BitFunnel/Index/RowIdSequence.h"
 #include "BitFunnel/Index/Token.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ITaskProcessor.h"
 #include "BitFunnel/Utilities/StreamUtilities.h"
+#include "BitFunnel/Utilities/TraceLog.h"
 #include "IRecyclable.h"
 #include "LoggerInterfaces/Check.h"
 #include "LoggerInterfaces/Logging.h"
@@ -36,6 +43,10 @@
 #include "Rounding.h"
 #include "Shard.h"
 
+#ifdef _MSC_VER
+#include <intrin.h>  // For __popcnt64, _BitScanForward64.
+#endif
+
 
 namespace BitFunnel
 {
@@ -76,7 +87,9 @@ namespace BitFunnel
                  ITermTable const & termTable,
                  IDocumentDataSchema const & docDataSchema,
                  ISliceBufferAllocator& sliceBufferAllocator,
-                 size_t sliceBufferSize)
+                 size_t sliceBufferSize,
+                 bool collectStatistics,
+                 size_t maxStatisticsTerms)
         : m_shardId(id),
           m_recycler(recycler),
           m_tokenManager(tokenManager),
@@ -85,12 +98,18 @@ namespace BitFunnel
           m_documentActiveRowId(RowIdForActiveDocument(termTable)),
           m_activeSlice(nullptr),
           m_sliceBuffers(new std::vector<void*>()),
+          m_createdSliceCount(0),
+          m_recycledSliceCount(0),
           m_sliceCapacity(GetCapacityForByteSize(sliceBufferSize,
                                                  docDataSchema,
                                                  termTable)),
           m_sliceBufferSize(sliceBufferSize),
           // TODO: will need one global, not one per shard.
-          m_docFrequencyTableBuilder(new DocumentFrequencyTableBuilder())
+          m_docFrequencyTableBuilder(collectStatistics ?
+                                     new DocumentFrequencyTableBuilder(
+                                         DocumentFrequencyTableBuilder::c_defaultCapacity,
+                                         maxStatisticsTerms) :
+                                     nullptr)
     {
         const size_t bufferSize =
             InitializeDescriptors(this,
@@ -172,6 +191,8 @@ namespace BitFunnel
     // Must be called with m_slicesLock held.
     void Shard::CreateNewActiveSlice()
     {
+        TraceScope trace("index", "SliceCreate");
+
         Slice* newSlice = new Slice(*this);
 
         std::vector<void*>* oldSlices = m_sliceBuffers;
@@ -180,6 +201,7 @@ namespace BitFunnel
 
         m_sliceBuffers = newSlices;
         m_activeSlice = newSlice;
+        ++m_createdSliceCount;
 
         // TODO: think if this can be done outside of the lock.
         std::unique_ptr<IRecyclable>
@@ -234,6 +256,12 @@ namespace BitFunnel
     }
 
 
+    ptrdiff_t Shard::GetRowSummaryBitOffset(RowId rowId) const
+    {
+        return GetRowTable(rowId.GetRank()).GetSummaryBitOffset(rowId.GetIndex());
+    }
+
+
     RowTableDescriptor const & Shard::GetRowTable(Rank rank) const
     {
         return m_rowTables.at(rank);
@@ -315,20 +343,37 @@ namespace BitFunnel
         //
         // RowTables
         //
+        size_t rowTableOffsets[c_maxRankValue + 1];
         for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
         {
             currentOffset = RoundUp(currentOffset, RowTableDescriptor::c_rowTableByteAlignment);
+            rowTableOffsets[rank] = currentOffset;
 
+            currentOffset += RowTableDescriptor::GetBufferSize(
+                sliceCapacity, termTable.GetTotalRowCount(rank), rank, maxRank);
+        }
+
+        //
+        // Row summaries
+        //
+        // The summaries for all ranks are packed together so that a query
+        // can check all of its rows in a cache line or two.
+        for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+        {
             const RowIndex rowCount = termTable.GetTotalRowCount(rank);
 
             if (shard != nullptr)
             {
                 shard->m_rowTables.emplace_back(
-                    sliceCapacity, rowCount, rank, maxRank, currentOffset);
+                    sliceCapacity,
+                    rowCount,
+                    rank,
+                    maxRank,
+                    static_cast<ptrdiff_t>(rowTableOffsets[rank]),
+                    static_cast<ptrdiff_t>(currentOffset));
             }
 
-            currentOffset += RowTableDescriptor::GetBufferSize(
-                sliceCapacity, rowCount, rank, maxRank);
+            currentOffset += RowTableDescriptor::GetSummaryBufferSize(rowCount);
         }
 
         const size_t sliceBufferSize = static_cast<size_t>(currentOffset);
@@ -339,6 +384,8 @@ namespace BitFunnel
 
     void Shard::RecycleSlice(Slice& slice)
     {
+        TraceScope trace("index", "SliceRecycle");
+
         std::vector<void*>* oldSlices = nullptr;
 
         {
@@ -367,6 +414,7 @@ namespace BitFunnel
 
             oldSlices = m_sliceBuffers.load();
             m_sliceBuffers = newSlices;
+            ++m_recycledSliceCount;
 
             if (m_activeSlice == &slice)
             {
@@ -406,6 +454,25 @@ namespace BitFunnel
         }
 
 
+        RowIdCache& cache = GetThreadRowIdCache();
+        RowIdCache::Entry const * entry = cache.Find(term);
+        if (entry != nullptr)
+        {
+            for (size_t i = 0; i < entry->m_rowCount; ++i)
+            {
+                m_rowTables[entry->m_ranks[i]].SetBitAtOffset(sliceBuffer,
+                                                              entry->m_rows[i],
+                                                              entry->m_offsets[i],
+                                                              index);
+            }
+            return;
+        }
+
+        Rank ranks[c_maxRowsPerTerm];
+        RowIndex indexes[c_maxRowsPerTerm];
+        ptrdiff_t offsets[c_maxRowsPerTerm];
+        size_t rowCount = 0;
+
         RowIdSequence rows(term, m_termTable);
 
         for (auto const row : rows)
@@ -413,7 +480,48 @@ namespace BitFunnel
             m_rowTables[row.GetRank()].SetBit(sliceBuffer,
                                               row.GetIndex(),
                                               index);
+            if (rowCount < c_maxRowsPerTerm)
+            {
+                ranks[rowCount] = row.GetRank();
+                indexes[rowCount] = row.GetIndex();
+                offsets[rowCount] =
+                    m_rowTables[row.GetRank()].GetRowOffset(row.GetIndex());
+            }
+            ++rowCount;
         }
+
+        cache.Insert(term, ranks, indexes, offsets, rowCount);
+    }
+
+
+    RowIdCache& Shard::GetThreadRowIdCache()
+    {
+        return m_rowIdCaches.Get();
+    }
+
+
+    void Shard::GetRowIdCacheCounts(size_t& hits, size_t& misses) const
+    {
+        hits = 0;
+        misses = 0;
+
+        m_rowIdCaches.ForEach([&](RowIdCache const & cache)
+        {
+            hits += cache.GetHitCount();
+            misses += cache.GetMissCount();
+        });
+    }
+
+
+    size_t Shard::GetCreatedSliceCount() const
+    {
+        return m_createdSliceCount;
+    }
+
+
+    size_t Shard::GetRecycledSliceCount() const
+    {
+        return m_recycledSliceCount;
     }
 
 
@@ -486,6 +594,13 @@ namespace BitFunnel
     }
 
 
+    DocumentFrequencyTableBuilder const *
+        Shard::GetDocumentFrequencyTableBuilder() const
+    {
+        return m_docFrequencyTableBuilder.get();
+    }
+
+
     // Reload a shard's saved slices, completely replacing whatever slices are in the shard
     // The last loaded slice will be the active slice
     void Shard::TemporaryReadAllSlices(IFileManager& fileManager, size_t nbrSlices)
@@ -500,6 +615,7 @@ namespace BitFunnel
             Slice* newSlice = new Slice(*this, *in);
             newSlices->push_back(newSlice->GetSliceBuffer());
             m_activeSlice = newSlice;
+            ++m_createdSliceCount;
         }
 
         std::vector<void*>* oldSlices = m_sliceBuffers;
@@ -535,10 +651,28 @@ namespace BitFunnel
     // DocumentHandle iterator.
     //
     //*************************************************************************
+
+    // Returns the index of the lowest set bit in value. Undefined if value is
+    // zero.
+    static DocIndex LowestSetBit(uint64_t value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<DocIndex>(index);
+#else
+        return static_cast<DocIndex>(__builtin_ctzll(value));
+#endif
+    }
+
+
     Shard::ConstIterator::ConstIterator(Shard const & shard)
       : m_token(shard.m_tokenManager.RequestToken()),
         m_sliceBuffers(shard.m_sliceBuffers),
         m_sliceCapacity(shard.m_sliceCapacity),
+        m_activeRowOffset(shard.GetRowOffset(shard.m_documentActiveRowId)),
+        m_activeRowQuadwords(
+            shard.GetRowTable(shard.m_documentActiveRowId.GetRank()).GetQuadwordsPerRow()),
         m_sliceIndex(0),
         m_slice(nullptr),
         m_sliceOffset(0)
@@ -550,19 +684,39 @@ namespace BitFunnel
 
     void Shard::ConstIterator::EnsureActive()
     {
-        for (; !AtEnd(); ++m_sliceIndex)
+        for (; !AtEnd(); ++m_sliceIndex, m_sliceOffset = 0)
         {
-            m_slice = Slice::GetSliceFromBuffer(
-                (*m_sliceBuffers)[m_sliceIndex],
-                GetSlicePtrOffset());
+            void* buffer = (*m_sliceBuffers)[m_sliceIndex];
+            m_slice = Slice::GetSliceFromBuffer(buffer, GetSlicePtrOffset());
+
+            uint64_t const * active = reinterpret_cast<uint64_t const *>(
+                static_cast<char const *>(buffer) + m_activeRowOffset);
 
-            for (; m_sliceOffset < m_sliceCapacity; ++m_sliceOffset)
+            size_t quadword = m_sliceOffset >> 6;
+            if (quadword >= m_activeRowQuadwords)
             {
-                DocumentHandleInternal handle(m_slice, m_sliceOffset);
-                if (handle.IsActive())
+                continue;
+            }
+
+            // Ignore documents before m_sliceOffset in the first quadword.
+            uint64_t bits = active[quadword] & (~0ull << (m_sliceOffset & 0x3F));
+            for (;;)
+            {
+                if (bits != 0)
+                {
+                    m_sliceOffset = (quadword << 6) + LowestSetBit(bits);
+                    if (m_sliceOffset < m_sliceCapacity)
+                    {
+                        return;
+                    }
+                    break;
+                }
+
+                if (++quadword == m_activeRowQuadwords)
                 {
-                    return;
+                    break;
                 }
+                bits = active[quadword];
             }
         }
     }
@@ -609,11 +763,215 @@ namespace BitFunnel
     }
 
 
+    void Shard::ForEachActive(ActiveDocumentCallback const & callback,
+                              size_t batchSize)
+    {
+        if (batchSize == 0)
+        {
+            RecoverableError
+                error("Shard::ForEachActive: batchSize must be greater than zero.");
+            throw error;
+        }
+
+        // Hold a token to ensure that m_sliceBuffers and the slices won't be
+        // recycled while the callback is running.
+        auto token = m_tokenManager.RequestToken();
+        std::vector<void*> const & buffers = *m_sliceBuffers;
+
+        RowTableDescriptor const & rowTable =
+            m_rowTables[m_documentActiveRowId.GetRank()];
+        const size_t quadwords = rowTable.GetQuadwordsPerRow();
+
+        std::vector<DocumentHandle> batch;
+        batch.reserve(batchSize);
+
+        for (auto buffer : buffers)
+        {
+            Slice* slice = Slice::GetSliceFromBuffer(buffer, GetSlicePtrOffset());
+            uint64_t const * active =
+                rowTable.GetRowData(static_cast<void const *>(buffer),
+                                    m_documentActiveRowId.GetIndex());
+
+            for (size_t quadword = 0; quadword < quadwords; ++quadword)
+            {
+                // Visit each set bit, clearing the lowest one at each step.
+                for (uint64_t bits = active[quadword]; bits != 0; bits &= bits - 1)
+                {
+                    const DocIndex index = (quadword << 6) + LowestSetBit(bits);
+                    if (index >= m_sliceCapacity)
+                    {
+                        break;
+                    }
+
+                    batch.push_back(DocumentHandleInternal(slice, index));
+                    if (batch.size() == batchSize)
+                    {
+                        callback(batch);
+                        batch.clear();
+                    }
+                }
+            }
+        }
+
+        if (!batch.empty())
+        {
+            callback(batch);
+        }
+    }
+
+
     //*************************************************************************
     //
     // GetDensities
     //
     //*************************************************************************
+
+    // Returns the number of bits set in value.
+    static size_t PopCount(uint64_t value)
+    {
+#ifdef _MSC_VER
+        return static_cast<size_t>(__popcnt64(value));
+#else
+        return static_cast<size_t>(__builtin_popcountll(value));
+#endif
+    }
+
+
+    //
+    // DensityProcessor counts set bits for a range of rows in a single slice.
+    // Each task corresponds to one (slice, block of rows) pair. Every
+    // processor accumulates counts into its own vector so that no locking is
+    // required. The caller sums the vectors once all tasks have completed.
+    //
+    class DensityProcessor : public ITaskProcessor, NonCopyable
+    {
+    public:
+        DensityProcessor(std::vector<void*> const & buffers,
+                         RowTableDescriptor const & rowTable,
+                         RowTableDescriptor const & rowTable0,
+                         RowIndex activeRow,
+                         Rank rank,
+                         size_t rowsPerTask)
+          : m_buffers(buffers),
+            m_rowTable(rowTable),
+            m_rowTable0(rowTable0),
+            m_activeRow(activeRow),
+            m_rank(rank),
+            m_rowsPerTask(rowsPerTask),
+            m_activeMask(rowTable.GetQuadwordsPerRow(), 0),
+            m_setBitCounts(rowTable.GetRowCount(), 0),
+            m_activeBitCount(0)
+        {
+        }
+
+
+        static size_t GetTaskCount(std::vector<void*> const & buffers,
+                                   RowIndex rowCount,
+                                   size_t rowsPerTask)
+        {
+            return buffers.size() * GetBlocksPerSlice(rowCount, rowsPerTask);
+        }
+
+
+        //
+        // ITaskProcessor methods.
+        //
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            const size_t blocksPerSlice =
+                GetBlocksPerSlice(m_rowTable.GetRowCount(), m_rowsPerTask);
+            void const * buffer = m_buffers[taskId / blocksPerSlice];
+            const size_t block = taskId % blocksPerSlice;
+
+            // Project the rank 0 document active row up to this rank so that
+            // each quadword in m_activeMask lines up with a quadword in the
+            // rows being measured. A bit in the rank up mask is set if any of
+            // the 2^rank documents it covers is active.
+            const size_t quadwords = m_rowTable.GetQuadwordsPerRow();
+            const size_t wordsPerQuadword = 1ull << m_rank;
+            uint64_t const * active =
+                m_rowTable0.GetRowData(buffer, m_activeRow);
+            size_t activeBitCount = 0;
+            for (size_t i = 0; i < quadwords; ++i)
+            {
+                uint64_t mask = 0;
+                for (size_t j = 0; j < wordsPerQuadword; ++j)
+                {
+                    mask |= *active++;
+                }
+                m_activeMask[i] = mask;
+                activeBitCount += PopCount(mask);
+            }
+
+            // Only the first block of each slice contributes to the active
+            // column count, so that each slice is counted exactly once.
+            if (block == 0)
+            {
+                m_activeBitCount += activeBitCount;
+            }
+
+            if (activeBitCount == 0)
+            {
+                // No active documents in this slice.
+                return;
+            }
+
+            const RowIndex first =
+                static_cast<RowIndex>(block * m_rowsPerTask);
+            const RowIndex last =
+                std::min(static_cast<RowIndex>(first + m_rowsPerTask),
+                         m_rowTable.GetRowCount());
+            for (RowIndex row = first; row < last; ++row)
+            {
+                uint64_t const * data = m_rowTable.GetRowData(buffer, row);
+                size_t setBitCount = 0;
+                for (size_t i = 0; i < quadwords; ++i)
+                {
+                    setBitCount += PopCount(data[i] & m_activeMask[i]);
+                }
+                m_setBitCounts[row] += setBitCount;
+            }
+        }
+
+
+        virtual void Finished() override
+        {
+        }
+
+
+        std::vector<size_t> const & GetSetBitCounts() const
+        {
+            return m_setBitCounts;
+        }
+
+
+        size_t GetActiveBitCount() const
+        {
+            return m_activeBitCount;
+        }
+
+    private:
+        static size_t GetBlocksPerSlice(RowIndex rowCount, size_t rowsPerTask)
+        {
+            return (rowCount + rowsPerTask - 1) / rowsPerTask;
+        }
+
+        std::vector<void*> const & m_buffers;
+        RowTableDescriptor const & m_rowTable;
+        RowTableDescriptor const & m_rowTable0;
+        const RowIndex m_activeRow;
+        const Rank m_rank;
+        const size_t m_rowsPerTask;
+
+        // Scratch space for the rank up projection of the active row.
+        std::vector<uint64_t> m_activeMask;
+
+        std::vector<size_t> m_setBitCounts;
+        size_t m_activeBitCount;
+    };
+
+
     std::vector<double> Shard::GetDensities(Rank rank) const
     {
         // Hold a token to ensure that m_sliceBuffers won't be recycled.
@@ -627,37 +985,66 @@ namespace BitFunnel
 
         RowTableDescriptor const & rowTable = m_rowTables[rank];
         RowTableDescriptor const & rowTable0 = m_rowTables[0];
-
-        RowIndex active = (*RowIdSequence(ITermTable::GetDocumentActiveTerm(),
-                                          m_termTable).begin()).GetIndex();
+        const RowIndex rowCount = rowTable.GetRowCount();
 
         std::vector<double> densities;
-        for (RowIndex row = 0; row < rowTable.GetRowCount(); ++row)
+        if (rowCount == 0)
         {
-            size_t activeBitCount = 0;
-            size_t setBitCount = 0;
-            for (auto buffer : buffers)
+            return densities;
+        }
+
+        // Number of rows handed to a DensityProcessor in a single task. Large
+        // enough to amortize the cost of projecting the active row to the
+        // target rank, small enough to spread a single slice across threads.
+        const size_t c_rowsPerTask = 256;
+
+        const size_t taskCount =
+            DensityProcessor::GetTaskCount(buffers, rowCount, c_rowsPerTask);
+        const size_t threadCount =
+            std::max(static_cast<size_t>(1),
+                     std::min(static_cast<size_t>(std::thread::hardware_concurrency()),
+                              taskCount));
+
+        std::vector<std::unique_ptr<ITaskProcessor>> processors;
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            processors.push_back(
+                std::unique_ptr<ITaskProcessor>(
+                    new DensityProcessor(buffers,
+                                         rowTable,
+                                         rowTable0,
+                                         m_documentActiveRowId.GetIndex(),
+                                         rank,
+                                         c_rowsPerTask)));
+        }
+
+        if (taskCount > 0)
+        {
+            auto distributor =
+                Factories::CreateTaskDistributor(processors, taskCount);
+            distributor->WaitForCompletion();
+        }
+
+        size_t activeBitCount = 0;
+        std::vector<size_t> setBitCounts(rowCount, 0);
+        for (auto const & processor : processors)
+        {
+            DensityProcessor const & p =
+                dynamic_cast<DensityProcessor const &>(*processor);
+            activeBitCount += p.GetActiveBitCount();
+            for (RowIndex row = 0; row < rowCount; ++row)
             {
-                for (DocIndex doc = 0; doc < GetSliceCapacity(); ++doc)
-                {
-                    // Only count bits for active documents.
-                    if (rowTable0.GetBit(buffer, active, doc) != 0)
-                    {
-                        // This document is active in the index.
-                        // Go ahead and include its bits in the density
-                        // calculation.
-                        ++activeBitCount;
-                        if (rowTable.GetBit(buffer, row, doc) != 0)
-                        {
-                            ++setBitCount;
-                        }
-                    }
-                }
+                setBitCounts[row] += p.GetSetBitCounts()[row];
             }
+        }
+
+        densities.reserve(rowCount);
+        for (RowIndex row = 0; row < rowCount; ++row)
+        {
             double density =
                 (activeBitCount == 0) ?
                 0.0 :
-                static_cast<double>(setBitCount) / activeBitCount;
+                static_cast<double>(setBitCounts[row]) / activeBitCount;
 
             densities.push_back(density);
         }
@@ -35,6 +35,8 @@
 #include "DocTableDescriptor.h"             // Required for embedded std::unique_ptr.
 #include "DocumentFrequencyTableBuilder.h"  // std::unique_ptr to this.
 #include "DocumentHandleInternal.h"         // Return value.
+#include "PerThreadObjects.h"               // PerThreadObjects member.
+#include "RowIdCache.h"                     // PerThreadObjects template parameter.
 #include "RowTableDescriptor.h"             // Required for embedded std::vector.
 #include "Slice.h"                          // std::unique_ptr template parameter.
 
@@ -69,13 +71,20 @@ namespace BitFunnel
         // Constructs an empty Shard with no slices. sliceBufferSize must be
         // sufficient to hold the minimum capacity Slice. The minimum capacity
         // is determined by a value returned by Row::DocumentsInRank0Row(1).
+        // When collectStatistics is false, the Shard does not build a
+        // DocumentFrequencyTable, removing all statistics overhead from
+        // AddPosting(). A non-zero maxStatisticsTerms bounds the memory used
+        // for statistics by counting only the most frequent terms (see
+        // DocumentFrequencyTableBuilder).
         Shard(ShardId id,
               IRecycler& recycler,
               ITokenManager& tokenManager,
               ITermTable const & termTable,
               IDocumentDataSchema const & docDataSchema,
               ISliceBufferAllocator& sliceBufferAllocator,
-              size_t sliceBufferSize);
+              size_t sliceBufferSize,
+              bool collectStatistics,
+              size_t maxStatisticsTerms);
 
         virtual ~Shard();
 
@@ -85,6 +94,20 @@ namespace BitFunnel
         void TemporaryRecordDocument();
         void TemporaryWriteCumulativeTermCounts(std::ostream& out) const;
 
+        // Returns the total number of AddPosting() lookups that were served
+        // by, and that missed, the per-thread RowIdCaches.
+        void GetRowIdCacheCounts(size_t& hits, size_t& misses) const;
+
+        // Returns the number of Slices this Shard has created and recycled
+        // since it was constructed.
+        size_t GetCreatedSliceCount() const;
+        size_t GetRecycledSliceCount() const;
+
+        // Returns the builder gathering this Shard's statistics, or nullptr
+        // if the Shard was constructed with collectStatistics == false.
+        DocumentFrequencyTableBuilder const *
+            GetDocumentFrequencyTableBuilder() const;
+
 
         //
         // IShard APIs.
@@ -100,6 +123,9 @@ namespace BitFunnel
         // Return the size of the slice buffer in bytes.
         virtual size_t GetSliceBufferSize() const override;
 
+        // Returns the TermTable that maps terms to rows in this shard.
+        virtual ITermTable const & GetTermTable() const override;
+
         // Returns a vector of slice buffers for this shard.  The callers needs
         // to obtain a Token from ITokenManager to protect the pointer to the
         // list of slice buffers, as well as the buffers themselves.
@@ -108,6 +134,12 @@ namespace BitFunnel
         // Returns the offset of the row in the slice buffer in a shard.
         virtual ptrdiff_t GetRowOffset(RowId rowId) const override;
 
+        // Returns the position of the row's summary bit, in bits from the
+        // start of the slice buffer. The bit is set in a slice once any bit
+        // in the row has been set there, so a query can skip slices where
+        // one of its required rows is still empty.
+        virtual ptrdiff_t GetRowSummaryBitOffset(RowId rowId) const override;
+
         virtual void TemporaryWriteDocumentFrequencyTable(
             std::ostream& out,
             ITermToText const * termToText) const override;
@@ -124,10 +156,18 @@ namespace BitFunnel
         // recycling. Be sure to release iterator when finished.
         virtual std::unique_ptr<const_iterator> GetIterator() override;
 
+        // Invokes callback with successive batches of up to batchSize
+        // DocumentHandles, covering every document currently active in the
+        // shard. Reads the document active row a quadword at a time, skipping
+        // quadwords with no active documents.
+        virtual void ForEachActive(ActiveDocumentCallback const & callback,
+                                   size_t batchSize) override;
+
         // Returns an std::vector containing the bit densities for each row in
         // the RowTable with the specified rank. Bit densities are computed
         // over all slices, for those columns that correspond to active
-        // documents.
+        // documents. At rank > 0, a column is considered active if any of
+        // the rank 0 documents it covers is active.
         virtual std::vector<double>
             GetDensities(Rank rank) const override;
 
@@ -174,9 +214,6 @@ namespace BitFunnel
         // copy of the vector of slices, is scheduled for recycling.
         void RecycleSlice(Slice& slice);
 
-        // Returns term table associated with this shard.
-        ITermTable const & GetTermTable() const;
-
         // Descriptor for RowTables and DocTable.
         DocTableDescriptor const & GetDocTable() const;
         RowTableDescriptor const & GetRowTable(Rank) const;
@@ -240,6 +277,10 @@ namespace BitFunnel
         //   swap newSlices and m_sliceBuffers, schedule newSlices for recycling.
         void CreateNewActiveSlice();
 
+        // Returns the calling thread's RowIdCache for this Shard, creating
+        // it on first use.
+        RowIdCache& GetThreadRowIdCache();
+
         //
         // Constructor parameters.
         //
@@ -313,6 +354,9 @@ namespace BitFunnel
         // of vectors is implemented.
         std::atomic<std::vector<void*>*> m_sliceBuffers;
 
+        std::atomic<size_t> m_createdSliceCount;
+        std::atomic<size_t> m_recycledSliceCount;
+
        // Capacity of a Slice. All Slices in the shard have the same capacity.
         const DocIndex m_sliceCapacity;
 
@@ -334,6 +378,9 @@ namespace BitFunnel
         std::unique_ptr<DocumentFrequencyTableBuilder> m_docFrequencyTableBuilder;
         std::mutex m_temporaryFrequencyTableMutex;
 
+        // One RowIdCache per ingestion thread, used by AddPosting().
+        PerThreadObjects<RowIdCache> m_rowIdCaches;
+
         //
         // DocumentHandle iterator
         //
@@ -352,7 +399,8 @@ namespace BitFunnel
 
         private:
             // If the current document is not active, advance until an active
-            // document is found or we reach the end of the shard.
+            // document is found or we reach the end of the shard. Scans the
+            // document active row a quadword at a time.
             void EnsureActive();
 
             // DESIGN NOTE: class is NonCopyable because Token is NonCopyable.
@@ -369,6 +417,11 @@ namespace BitFunnel
 
             const DocIndex m_sliceCapacity;
 
+            // Location of the document active row in each slice buffer and
+            // the number of quadwords it spans.
+            const ptrdiff_t m_activeRowOffset;
+            const size_t m_activeRowQuadwords;
+
             // State of the iteration is specified by m_sliceIndex and
             // m_sliceOffset. The member m_slice is a convenience variable.
             size_t m_sliceIndex;
@@ -21,12 +21,16 @@
 // THE SOFTWARE.
 
 
+#include <vector>
+
 #include "BitFunnel/Configuration/Factories.h"
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/Factories.h"
 #include "BitFunnel/Index/Helpers.h"
 #include "BitFunnel/Index/IRecycler.h"
+#include "BitFunnel/Index/IShard.h"
 #include "BitFunnel/Index/ISliceBufferAllocator.h"
+#include "DocumentFrequencyTableBuilder.h"
 #include "LoggerInterfaces/Check.h"
 #include "SimpleIndex.h"
 
@@ -55,6 +59,8 @@ namespace BitFunnel
     SimpleIndex::SimpleIndex(IFileSystem& fileSystem)
         : m_fileSystem(fileSystem),
           m_isStarted(false),
+          m_collectStatistics(true),
+          m_maxStatisticsTerms(0),
           m_blockAllocatorBufferSize(0)
     {
     }
@@ -136,6 +142,21 @@ namespace BitFunnel
     }
 
 
+    void SimpleIndex::SetMaxStatisticsTerms(size_t maxTerms)
+    {
+        EnsureStarted(false);
+        m_maxStatisticsTerms = maxTerms;
+    }
+
+
+    void SimpleIndex::SetMaxStatisticsPostingError(double maxPostingError)
+    {
+        EnsureStarted(false);
+        m_maxStatisticsTerms =
+            DocumentFrequencyTableBuilder::GetMaxTermsForPostingError(maxPostingError);
+    }
+
+
     void SimpleIndex::SetSliceBufferAllocator(
         std::unique_ptr<ISliceBufferAllocator> sliceAllocator)
     {
@@ -222,6 +243,10 @@ namespace BitFunnel
     {
         EnsureStarted(false);
 
+        // Serving indexes don't write statistics, so skip the per-posting
+        // cost of gathering them.
+        m_collectStatistics = false;
+
         //if (m_fileSystem.get() == nullptr)
         //{
         //    m_fileSystem = Factories::CreateFileSystem();
@@ -341,17 +366,77 @@ namespace BitFunnel
                 m_blockAllocatorBufferSize = 1073741824;
             }
 
-            // Calculate number of slices that will fit in requested memory.
-            // Ensure we have enough memory for at least one slice per termtable
-            size_t blockCount = m_blockAllocatorBufferSize / m_blockSize;
-            if (blockCount < m_termTables->size())
+            bool hasSliceCapacities = false;
+            for (ShardId shard = 0; shard < m_shardDefinition->GetShardCount(); ++shard)
             {
-                throw FatalError("Insufficient memory requested to build index");
+                if (m_shardDefinition->GetSliceCapacity(shard) != 0)
+                {
+                    hasSliceCapacities = true;
+                }
             }
 
-            m_sliceAllocator =
-                Factories::CreateSliceBufferAllocator(m_blockSize,
-                                                      blockCount);
+            if (!hasSliceCapacities)
+            {
+                // Calculate number of slices that will fit in requested memory.
+                // Ensure we have enough memory for at least one slice per termtable
+                size_t blockCount = m_blockAllocatorBufferSize / m_blockSize;
+                if (blockCount < m_termTables->size())
+                {
+                    throw FatalError("Insufficient memory requested to build index");
+                }
+
+                m_sliceAllocator =
+                    Factories::CreateSliceBufferAllocator(m_blockSize,
+                                                          blockCount);
+            }
+            else
+            {
+                // Shards with a slice capacity in the ShardDefinition get
+                // buffers sized for that capacity. The others use the default
+                // size. Each shard gets an equal share of the memory, and
+                // shards with the same buffer size share a pool.
+                const size_t shardBudget =
+                    m_blockAllocatorBufferSize / m_shardDefinition->GetShardCount();
+
+                std::vector<size_t> blockSizes(1, m_blockSize);
+                std::vector<size_t> blockCounts(1, 0);
+                for (ShardId shard = 0; shard < m_shardDefinition->GetShardCount(); ++shard)
+                {
+                    const DocIndex capacity = m_shardDefinition->GetSliceCapacity(shard);
+                    const size_t blockSize = (capacity == 0) ?
+                        m_blockSize :
+                        GetBlockSizeForCapacity(*m_schema,
+                                                m_termTables->GetTermTable(shard),
+                                                capacity);
+                    if (shardBudget < blockSize)
+                    {
+                        throw FatalError("Insufficient memory requested to build index");
+                    }
+
+                    size_t pool = 0;
+                    while (pool < blockSizes.size() && blockSizes[pool] != blockSize)
+                    {
+                        ++pool;
+                    }
+                    if (pool == blockSizes.size())
+                    {
+                        blockSizes.push_back(blockSize);
+                        blockCounts.push_back(0);
+                    }
+                    blockCounts[pool] += shardBudget / blockSize;
+                }
+
+                // Drop the default pool if every shard has its own capacity.
+                if (blockCounts[0] == 0)
+                {
+                    blockSizes.erase(blockSizes.begin());
+                    blockCounts.erase(blockCounts.begin());
+                }
+
+                m_sliceAllocator =
+                    Factories::CreateSliceBufferAllocator(blockSizes,
+                                                          blockCounts);
+            }
         }
 
         if (m_recycler.get() == nullptr)
@@ -364,7 +449,9 @@ namespace BitFunnel
                                                *m_recycler,
                                                *m_termTables,
                                                *m_shardDefinition,
-                                               *m_sliceAllocator);
+                                               *m_sliceAllocator,
+                                               m_collectStatistics,
+                                               m_maxStatisticsTerms);
 
         m_isStarted = true;
     }
@@ -426,7 +513,10 @@ namespace BitFunnel
     {
         EnsureStarted(true);
 
-        return m_termTables->GetTermTable(shardId);
+        // Shards added by IIngestor::AddShard() share a TermTable with the
+        // shard they were split from, so ask the shard rather than the
+        // collection.
+        return m_ingestor->GetShard(shardId).GetTermTable();
     }
 
 
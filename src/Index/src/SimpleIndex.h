@@ -73,6 +73,8 @@ namespace BitFunnel
 
         virtual void SetTermTableCollection(
             std::unique_ptr<ITermTableCollection> termTables) override;
+        virtual void SetMaxStatisticsTerms(size_t maxTerms) override;
+        virtual void SetMaxStatisticsPostingError(double maxPostingError) override;
 
 
         virtual void ConfigureForStatistics(char const * directory,
@@ -111,6 +113,14 @@ namespace BitFunnel
 
         bool m_isStarted;
 
+        // Set to false by ConfigureForServing() to disable gathering of
+        // document frequency statistics during ingestion.
+        bool m_collectStatistics;
+
+        // When non-zero, statistics are gathered with bounded-memory sketches
+        // that retain approximately this many terms per shard.
+        size_t m_maxStatisticsTerms;
+
         //
         // Members initialized by StartIndex().
         //
@@ -111,7 +111,7 @@ namespace BitFunnel
     // <padding>
     // ... (RowTables for other ranks which have rows)
     // RowTable6 data
-    // <padding>
+    // Row summaries for RowTable0 ... RowTable6
     // Slice* (stored in the last 8 bytes of the slice buffer).
     //
     //*************************************************************************
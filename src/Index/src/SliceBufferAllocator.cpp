@@ -39,33 +39,102 @@ namespace BitFunnel
     }
 
 
+    std::unique_ptr<ISliceBufferAllocator>
+        Factories::CreateSliceBufferAllocator(std::vector<size_t> const & blockSizes,
+                                              std::vector<size_t> const & blockCounts)
+    {
+        return std::unique_ptr<ISliceBufferAllocator>(
+            new SliceBufferAllocator(blockSizes, blockCounts));
+    }
+
+
     SliceBufferAllocator::SliceBufferAllocator(size_t blockSize,
                                                size_t blockCount)
-        : m_blockAllocator(Factories::CreateBlockAllocator(blockSize,
-                                                           blockCount))
+      : m_totalBuffersCount(blockCount),
+        m_inUseBuffersCount(0)
+    {
+        m_blockAllocators.push_back(Factories::CreateBlockAllocator(blockSize,
+                                                                    blockCount));
+    }
+
+
+    SliceBufferAllocator::SliceBufferAllocator(std::vector<size_t> const & blockSizes,
+                                               std::vector<size_t> const & blockCounts)
+      : m_totalBuffersCount(0),
+        m_inUseBuffersCount(0)
     {
+        LogAssertB(blockSizes.size() > 0, "No block sizes.");
+        LogAssertB(blockSizes.size() == blockCounts.size(),
+                   "blockSizes and blockCounts differ in size.");
+
+        for (size_t i = 0; i < blockSizes.size(); ++i)
+        {
+            for (size_t j = 0; j < i; ++j)
+            {
+                LogAssertB(blockSizes[i] != blockSizes[j],
+                           "Duplicate block size.");
+            }
+            m_blockAllocators.push_back(
+                Factories::CreateBlockAllocator(blockSizes[i], blockCounts[i]));
+            m_totalBuffersCount += blockCounts[i];
+        }
     }
 
 
     void* SliceBufferAllocator::Allocate(size_t byteSize)
     {
+        for (auto & blockAllocator : m_blockAllocators)
+        {
+            if (blockAllocator->GetBlockSize() == byteSize)
+            {
+                void* buffer = blockAllocator->AllocateBlock();
+                if (m_blockAllocators.size() > 1)
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_owners[buffer] = blockAllocator.get();
+                }
+                ++m_inUseBuffersCount;
+                return buffer;
+            }
+        }
+
         // Other implementations of IBlockAllocator may not have this
         // restriction.
-        LogAssertB(m_blockAllocator->GetBlockSize() == byteSize,
-                   "Allocate byteSize != block size.");
-
-        return m_blockAllocator->AllocateBlock();
+        LogAbortB("Allocate byteSize != block size.");
+        return nullptr;
     }
 
 
     void SliceBufferAllocator::Release(void* buffer)
     {
-        m_blockAllocator->ReleaseBlock(reinterpret_cast<uint64_t*>(buffer));
+        IBlockAllocator* owner = m_blockAllocators[0].get();
+        if (m_blockAllocators.size() > 1)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto it = m_owners.find(buffer);
+            LogAssertB(it != m_owners.end(), "Release of unknown buffer.");
+            owner = it->second;
+            m_owners.erase(it);
+        }
+        owner->ReleaseBlock(reinterpret_cast<uint64_t*>(buffer));
+        --m_inUseBuffersCount;
     }
 
 
     size_t SliceBufferAllocator::GetSliceBufferSize() const
     {
-        return m_blockAllocator->GetBlockSize();
+        return m_blockAllocators[0]->GetBlockSize();
+    }
+
+
+    size_t SliceBufferAllocator::GetInUseBuffersCount() const
+    {
+        return m_inUseBuffersCount;
+    }
+
+
+    size_t SliceBufferAllocator::GetTotalBuffersCount() const
+    {
+        return m_totalBuffersCount;
     }
 }
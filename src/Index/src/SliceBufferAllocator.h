@@ -23,8 +23,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <stddef.h>
+#include <unordered_map>
+#include <vector>
 
 #include "BitFunnel/Index/ISliceBufferAllocator.h"
 #include "BitFunnel/Utilities/IBlockAllocator.h"
@@ -39,6 +43,10 @@ namespace BitFunnel
     // number of blocks of the same byte size and re-uses them for Slices.
     // Slices adjusts their capacity based on the size of the buffer.
     //
+    // The allocator may also manage several pools, each with its own block
+    // size, so that shards can use different slice buffer sizes. The first
+    // pool's block size is the default reported by GetSliceBufferSize().
+    //
     // Allocate method expects only a well-known value of the buffer size,
     // otherwise it throws.
     //
@@ -52,16 +60,31 @@ namespace BitFunnel
         // hood to allocate and release blocks of the same byte size.
         SliceBufferAllocator(size_t blockSize, size_t blockCount);
 
+        // Creates a SliceBufferAllocator with one pool of blockCounts[i]
+        // blocks for each blockSizes[i]. Block sizes must be distinct.
+        SliceBufferAllocator(std::vector<size_t> const & blockSizes,
+                             std::vector<size_t> const & blockCounts);
+
         //
         // ISliceBufferAllocator API.
         //
         virtual void* Allocate(size_t byteSize) override;
         virtual void Release(void* buffer) override;
         virtual size_t GetSliceBufferSize() const override;
+        virtual size_t GetInUseBuffersCount() const override;
+        virtual size_t GetTotalBuffersCount() const override;
 
     private:
 
-        // Block allocator which hands out the blocks of the fixed size.
-        std::unique_ptr<IBlockAllocator> const m_blockAllocator;
+        // Block allocators which hand out the blocks of each fixed size.
+        std::vector<std::unique_ptr<IBlockAllocator>> m_blockAllocators;
+
+        // When there is more than one pool, records the pool each buffer
+        // came from so that Release() can return it.
+        std::mutex m_lock;
+        std::unordered_map<void*, IBlockAllocator*> m_owners;
+
+        size_t m_totalBuffersCount;
+        std::atomic<size_t> m_inUseBuffersCount;
     };
 }
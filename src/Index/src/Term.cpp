@@ -32,6 +32,7 @@
 #include "LoggerInterfaces/Logging.h"
 #include "MurmurHash2.h"
 #include "TermToText.h"
+#include "XXHash64.h"
 
 
 namespace BitFunnel
@@ -52,7 +53,7 @@ namespace BitFunnel
     Term::Term(char const * text,
                StreamId stream,
                IConfiguration const & configuration)
-        : m_rawHash(ComputeRawHash(text)),
+        : m_rawHash(ComputeRawHash(text, configuration.GetHashFunction())),
           m_stream(stream),
           m_gramSize(1)
     {
@@ -148,7 +149,7 @@ namespace BitFunnel
 
         Hash leftHash = m_rawHash;
 
-        m_rawHash = rotl64By1(m_rawHash) ^ term.m_rawHash;
+        m_rawHash = ExtendNGramHash(m_rawHash, term.m_rawHash);
         m_gramSize += term.m_gramSize;
 
 
@@ -332,14 +333,81 @@ namespace BitFunnel
     }
 
 
+    // TODO: Need some means to ensure that a term never gets the same hash
+    // as a system row or a fact.
+    static const int c_murmurHashSeedForText = 123456789;
+
+
+    static Term::Hash HashText(char const * text,
+                               size_t length,
+                               Term::HashFunction function)
+    {
+        switch (function)
+        {
+        case Term::HashFunction::MurmurHash64A:
+            return MurmurHash64A(text, length, c_murmurHashSeedForText);
+        case Term::HashFunction::XXHash64:
+            return XXHash64(text, length, c_murmurHashSeedForText);
+        default:
+            RecoverableError error("Term: unknown hash function.");
+            throw error;
+        }
+    }
+
+
     Term::Hash Term::ComputeRawHash(char const * text)
     {
-        // TODO: Need some means to ensure that a term never gets the same hash
-        // as a system row or a fact.
-        const int c_murmurHashSeedForText = 123456789;
+        return ComputeRawHash(text, HashFunction::MurmurHash64A);
+    }
 
-        Hash hash = MurmurHash64A(text, strlen(text), c_murmurHashSeedForText);
 
-        return hash;
+    Term::Hash Term::ComputeRawHash(char const * text, HashFunction function)
+    {
+        return HashText(text, strlen(text), function);
+    }
+
+
+    void Term::ComputeRawHashes(char const * const * texts,
+                                size_t const * lengths,
+                                size_t count,
+                                Hash* hashes)
+    {
+        ComputeRawHashes(texts,
+                         lengths,
+                         count,
+                         HashFunction::MurmurHash64A,
+                         hashes);
+    }
+
+
+    void Term::ComputeRawHashes(char const * const * texts,
+                                size_t const * lengths,
+                                size_t count,
+                                HashFunction function,
+                                Hash* hashes)
+    {
+        size_t i = 0;
+
+        // Only MurmurHash64A has a four-way form. Other functions hash one
+        // term at a time in the loop below.
+        for (; function == HashFunction::MurmurHash64A && i + 4 <= count; i += 4)
+        {
+            void const * const keys[4] =
+                { texts[i], texts[i + 1], texts[i + 2], texts[i + 3] };
+            MurmurHash64Ax4(keys,
+                            lengths + i,
+                            c_murmurHashSeedForText,
+                            hashes + i);
+        }
+        for (; i < count; ++i)
+        {
+            hashes[i] = HashText(texts[i], lengths[i], function);
+        }
+    }
+
+
+    Term::Hash Term::ExtendNGramHash(Hash ngramHash, Hash termHash)
+    {
+        return rotl64By1(ngramHash) ^ termHash;
     }
 }
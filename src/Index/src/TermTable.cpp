@@ -20,8 +20,10 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
 #include <math.h>
 #include <sstream>
+#include <string.h>
 
 #include "BitFunnel/BitFunnelTypes.h"
 #include "BitFunnel/Exceptions.h"
@@ -33,6 +35,19 @@
 
 namespace BitFunnel
 {
+    // Identifies a serialized TermTable image ("BFTTv001").
+    static const uint64_t c_imageMagic = 0x3130307654544642ull;
+
+    // Smallest number of slots in a sealed TermTable.
+    static const size_t c_minSlotCount = 16;
+
+
+    static size_t RoundUpToQuadword(size_t byteCount)
+    {
+        return (byteCount + 7) & ~static_cast<size_t>(7);
+    }
+
+
     //*************************************************************************
     //
     // Factory methods.
@@ -60,6 +75,12 @@ namespace BitFunnel
       : m_sealed(false),
         m_termOpen(false),
         m_ranksInUse({}),
+        m_rowIdData(nullptr),
+        m_rowIdCount(0),
+        m_header(nullptr),
+        m_slots(nullptr),
+        m_slotShift(0),
+        m_slotMask(0),
         m_explicitRowCounts(c_maxRankValue + 1, 0),
         m_adhocRowCounts(c_maxRankValue + 1, 0),
         m_sharedRowCounts(c_maxRankValue + 1, 0),
@@ -85,73 +106,59 @@ namespace BitFunnel
 
     TermTable::TermTable(std::istream& input)
       : m_sealed(true),
-        m_start(0)
+        m_termOpen(false),
+        m_start(0),
+        m_rowIdData(nullptr),
+        m_rowIdCount(0),
+        m_header(nullptr),
+        m_slots(nullptr),
+        m_slotShift(0),
+        m_slotMask(0)
     {
-        // Retrieve the map from all known explicit terms (hash) to row plans
-        size_t count = StreamUtilities::ReadField<size_t>(input);
-        for (size_t i = 0; i < count; ++i)
-        {
-            const Term::Hash hash = StreamUtilities::ReadField<Term::Hash>(input);
-            const PackedRowIdSequence rows = StreamUtilities::ReadField<PackedRowIdSequence>(input);
-
-            m_termHashToRows.insert(std::make_pair(hash, rows));
-        }
-
-        // Retrieve the map from known ad hoc terms (hash) to IdfX10
-        // These can later be mapped to the treatment's row plan for that IdfX10
-        size_t adhoccount = StreamUtilities::ReadField<size_t>(input);
-        for (size_t i = 0; i < adhoccount; ++i)
+        const ImageHeader header = StreamUtilities::ReadField<ImageHeader>(input);
+        if (header.m_magic != c_imageMagic ||
+            header.m_byteCount < sizeof(ImageHeader) ||
+            (header.m_byteCount % sizeof(uint64_t)) != 0)
         {
-            const Term::Hash hash(StreamUtilities::ReadField<Term::Hash>(input));
-            const Term::IdfX10 idf(StreamUtilities::ReadField<Term::IdfX10>(input));
-            m_adhocTerms.insert(std::make_pair(hash, idf));
+            RecoverableError error("TermTable: stream does not contain a valid TermTable image.");
+            throw error;
         }
 
-        m_ranksInUse = StreamUtilities::ReadField<RanksInUse>(input);
-        m_maxRankInUse = StreamUtilities::ReadField<Rank>(input);
-        m_adhocRows = StreamUtilities::ReadField<AdhocRecipes>(input);
-        m_rowIds = StreamUtilities::ReadVector<RowId>(input);
-        m_explicitRowCounts = StreamUtilities::ReadVector<RowIndex>(input);
-        m_adhocRowCounts = StreamUtilities::ReadVector<RowIndex>(input);
-        m_sharedRowCounts = StreamUtilities::ReadVector<RowIndex>(input);
-        m_factRowCount = StreamUtilities::ReadField<RowIndex>(input);
+        m_imageStorage.resize(header.m_byteCount / sizeof(uint64_t));
+        memcpy(m_imageStorage.data(), &header, sizeof(ImageHeader));
+        StreamUtilities::ReadBytes(
+            input,
+            reinterpret_cast<char*>(m_imageStorage.data()) + sizeof(ImageHeader),
+            header.m_byteCount - sizeof(ImageHeader));
 
-        m_sealed = true;
+        AttachImage(m_imageStorage.data(), header.m_byteCount);
     }
 
 
-    void TermTable::Write(std::ostream& output) const
+    TermTable::TermTable(void const * image, size_t byteCount)
+      : m_sealed(true),
+        m_termOpen(false),
+        m_start(0),
+        m_rowIdData(nullptr),
+        m_rowIdCount(0),
+        m_header(nullptr),
+        m_slots(nullptr),
+        m_slotShift(0),
+        m_slotMask(0)
     {
-        StreamUtilities::WriteField<size_t>(output, m_termHashToRows.size());
-        for (auto entry : m_termHashToRows)
-        {
-            const Term::Hash hash = entry.first;
-            const PackedRowIdSequence rows = entry.second;
-
-            StreamUtilities::WriteField<Term::Hash>(output, hash);
-            StreamUtilities::WriteField<PackedRowIdSequence>(output, rows);
-        }
+        AttachImage(image, byteCount);
+    }
 
-        StreamUtilities::WriteField<size_t>(output, m_adhocTerms.size());
-        for (auto entry : m_adhocTerms)
-        {
-            const Term::Hash hash = entry.first;
-            const Term::IdfX10 idf = entry.second;
 
-            StreamUtilities::WriteField<Term::Hash>(output, hash);
-            StreamUtilities::WriteField<Term::IdfX10>(output, idf);
-        }
-
-        StreamUtilities::WriteField<RanksInUse>(output, m_ranksInUse);
-        StreamUtilities::WriteField<Rank>(output, m_maxRankInUse);
-        StreamUtilities::WriteField<AdhocRecipes>(output, m_adhocRows);
-        StreamUtilities::WriteVector(output, m_rowIds);
-        StreamUtilities::WriteVector(output, m_explicitRowCounts);
-        StreamUtilities::WriteVector(output, m_adhocRowCounts);
-        StreamUtilities::WriteVector(output, m_sharedRowCounts);
-        StreamUtilities::WriteField<RowIndex>(output, m_factRowCount);
+    void TermTable::Write(std::ostream& output) const
+    {
+        EnsureSealed(true);
+        StreamUtilities::WriteBytes(output,
+                                    reinterpret_cast<char const *>(m_header),
+                                    m_header->m_byteCount);
     }
 
+
     static_assert(std::is_trivially_copyable<std::array<std::array<PackedRowIdSequence, 10>, 10>>::value, "foo");
 
 
@@ -171,6 +178,8 @@ namespace BitFunnel
         // AddRowId.
         m_ranksInUse[row.GetRank()] = true;
         m_rowIds.push_back(row);
+        m_rowIdData = m_rowIds.data();
+        m_rowIdCount = m_rowIds.size();
     }
 
 
@@ -252,6 +261,8 @@ namespace BitFunnel
         m_explicitRowCounts[rank] = explicitCount;
         m_adhocRowCounts[rank] = adhocCount;
         m_sharedRowCounts[rank] = totalRowCount;
+        m_adhocModulo[rank] =
+            (adhocCount == 0) ? FastModulo() : FastModulo(adhocCount);
     }
 
 
@@ -322,6 +333,204 @@ namespace BitFunnel
                 }
             }
         }
+
+        BuildImage();
+    }
+
+
+    void TermTable::BuildImage()
+    {
+        // Gather every hash that needs a slot, in sorted order so that the
+        // image is independent of std::unordered_map iteration order.
+        std::vector<Term::Hash> hashes;
+        hashes.reserve(m_termHashToRows.size() + m_adhocTerms.size());
+        for (auto const & entry : m_termHashToRows)
+        {
+            hashes.push_back(entry.first);
+        }
+        for (auto const & entry : m_adhocTerms)
+        {
+            hashes.push_back(entry.first);
+        }
+        std::sort(hashes.begin(), hashes.end());
+        hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+
+        // Keep the load factor at or below 1/2 so that probe sequences stay
+        // short.
+        size_t slotCount = c_minSlotCount;
+        unsigned shift = 64 - 4;
+        while (slotCount < 2 * hashes.size())
+        {
+            slotCount *= 2;
+            --shift;
+        }
+
+        const size_t byteCount = GetImageByteCount(slotCount, m_rowIds.size());
+        std::vector<uint64_t> storage(byteCount / sizeof(uint64_t), 0);
+        char * const base = reinterpret_cast<char*>(storage.data());
+
+        ImageHeader & header = *reinterpret_cast<ImageHeader*>(base);
+        header.m_magic = c_imageMagic;
+        header.m_byteCount = byteCount;
+        header.m_slotCount = slotCount;
+        header.m_rowIdCount = m_rowIds.size();
+        header.m_factRowCount = m_factRowCount;
+        header.m_maxRankInUse = m_maxRankInUse;
+        header.m_ranksInUse = 0;
+        for (Rank r = 0; r <= c_maxRankValue; ++r)
+        {
+            if (m_ranksInUse[r])
+            {
+                header.m_ranksInUse |= (1ull << r);
+            }
+            header.m_explicitRowCounts[r] = m_explicitRowCounts[r];
+            header.m_adhocRowCounts[r] = m_adhocRowCounts[r];
+            header.m_sharedRowCounts[r] = m_sharedRowCounts[r];
+        }
+
+        size_t offset = sizeof(ImageHeader);
+        memcpy(base + offset, &m_adhocRows, sizeof(AdhocRecipes));
+        offset += RoundUpToQuadword(sizeof(AdhocRecipes));
+
+        Slot * const slots = reinterpret_cast<Slot*>(base + offset);
+        for (auto hash : hashes)
+        {
+            size_t index = GetSlotIndex(hash, shift);
+            while (slots[index].m_flags != 0)
+            {
+                index = (index + 1) & (slotCount - 1);
+            }
+
+            Slot & slot = slots[index];
+            slot.m_hash = hash;
+            slot.m_idf = Term::c_maxIdfX10Value;
+
+            auto explicitTerm = m_termHashToRows.find(hash);
+            if (explicitTerm != m_termHashToRows.end())
+            {
+                slot.m_rows = explicitTerm->second;
+                slot.m_flags |= c_explicitSlot;
+            }
+
+            auto adhocTerm = m_adhocTerms.find(hash);
+            if (adhocTerm != m_adhocTerms.end())
+            {
+                slot.m_idf = adhocTerm->second;
+                slot.m_flags |= c_adhocSlot;
+            }
+        }
+        offset += slotCount * sizeof(Slot);
+
+        if (!m_rowIds.empty())
+        {
+            memcpy(base + offset, m_rowIds.data(), m_rowIds.size() * sizeof(RowId));
+        }
+
+        // The build-phase structures are no longer needed.
+        m_termHashToRows.clear();
+        m_adhocTerms.clear();
+        std::vector<RowId>().swap(m_rowIds);
+
+        m_imageStorage = std::move(storage);
+        AttachImage(m_imageStorage.data(), byteCount);
+    }
+
+
+    void TermTable::AttachImage(void const * image, size_t byteCount)
+    {
+        if ((reinterpret_cast<uintptr_t>(image) % sizeof(uint64_t)) != 0)
+        {
+            RecoverableError error("TermTable: image must be 8-byte aligned.");
+            throw error;
+        }
+
+        ImageHeader const * header = static_cast<ImageHeader const *>(image);
+        if (byteCount < sizeof(ImageHeader) ||
+            header->m_magic != c_imageMagic ||
+            header->m_byteCount != byteCount ||
+            header->m_slotCount < c_minSlotCount ||
+            (header->m_slotCount & (header->m_slotCount - 1)) != 0 ||
+            header->m_maxRankInUse > c_maxRankValue ||
+            GetImageByteCount(header->m_slotCount, header->m_rowIdCount) != byteCount)
+        {
+            RecoverableError error("TermTable: invalid TermTable image.");
+            throw error;
+        }
+
+        char const * const base = static_cast<char const *>(image);
+        size_t offset = sizeof(ImageHeader);
+
+        memcpy(&m_adhocRows, base + offset, sizeof(AdhocRecipes));
+        offset += RoundUpToQuadword(sizeof(AdhocRecipes));
+
+        m_slots = reinterpret_cast<Slot const *>(base + offset);
+        m_slotMask = header->m_slotCount - 1;
+        m_slotShift = 64;
+        for (size_t count = header->m_slotCount; count > 1; count >>= 1)
+        {
+            --m_slotShift;
+        }
+        offset += header->m_slotCount * sizeof(Slot);
+
+        m_rowIdData = reinterpret_cast<RowId const *>(base + offset);
+        m_rowIdCount = header->m_rowIdCount;
+
+        m_factRowCount = header->m_factRowCount;
+        m_maxRankInUse = static_cast<Rank>(header->m_maxRankInUse);
+        m_explicitRowCounts.assign(c_maxRankValue + 1, 0);
+        m_adhocRowCounts.assign(c_maxRankValue + 1, 0);
+        m_sharedRowCounts.assign(c_maxRankValue + 1, 0);
+        for (Rank r = 0; r <= c_maxRankValue; ++r)
+        {
+            m_ranksInUse[r] = ((header->m_ranksInUse >> r) & 1) != 0;
+            m_explicitRowCounts[r] = header->m_explicitRowCounts[r];
+            m_adhocRowCounts[r] = header->m_adhocRowCounts[r];
+            m_sharedRowCounts[r] = header->m_sharedRowCounts[r];
+            m_adhocModulo[r] = (m_adhocRowCounts[r] == 0) ?
+                FastModulo() : FastModulo(m_adhocRowCounts[r]);
+        }
+
+        m_header = header;
+    }
+
+
+    TermTable::Slot const * TermTable::FindSlot(Term::Hash hash) const
+    {
+        // BuildImage() always leaves empty slots, but an attached image may
+        // be corrupt, so give up after visiting every slot rather than
+        // probing forever.
+        size_t index = GetSlotIndex(hash, m_slotShift);
+        for (size_t probe = 0; probe <= m_slotMask; ++probe)
+        {
+            Slot const & slot = m_slots[index];
+            if (slot.m_flags == 0)
+            {
+                return nullptr;
+            }
+            if (slot.m_hash == hash)
+            {
+                return &slot;
+            }
+            index = (index + 1) & m_slotMask;
+        }
+        return nullptr;
+    }
+
+
+    size_t TermTable::GetImageByteCount(size_t slotCount, size_t rowIdCount)
+    {
+        return sizeof(ImageHeader) +
+            RoundUpToQuadword(sizeof(AdhocRecipes)) +
+            slotCount * sizeof(Slot) +
+            RoundUpToQuadword(rowIdCount * sizeof(RowId));
+    }
+
+
+    size_t TermTable::GetSlotIndex(Term::Hash hash, unsigned shift)
+    {
+        // Fibonacci hashing spreads hashes that differ only in their low
+        // bits, e.g. consecutive hashes used by tests and facts.
+        return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> shift);
     }
 
 
@@ -348,6 +557,85 @@ namespace BitFunnel
     }
 
 
+    size_t TermTable::GetAdhocRowCount(Rank rank) const
+    {
+        return m_adhocRowCounts[rank];
+    }
+
+
+    size_t TermTable::GetExplicitRowCount(Rank rank) const
+    {
+        // At rank 0, m_explicitRowCounts includes the system and fact rows,
+        // which sit at the end of the explicit block.
+        return m_explicitRowCounts[rank] - ((rank == 0) ? m_factRowCount : 0);
+    }
+
+
+    void TermTable::PermuteExplicitRows(Rank rank,
+                                        std::vector<RowIndex> const & mapping)
+    {
+        EnsureSealed(true);
+
+        if (m_imageStorage.empty())
+        {
+            RecoverableError error("TermTable::PermuteExplicitRows: image is not owned by the TermTable.");
+            throw error;
+        }
+
+        const size_t count = GetExplicitRowCount(rank);
+        if (mapping.size() != count)
+        {
+            RecoverableError error("TermTable::PermuteExplicitRows: mapping has the wrong size.");
+            throw error;
+        }
+
+        std::vector<bool> used(count, false);
+        for (auto index : mapping)
+        {
+            if (index >= count || used[index])
+            {
+                RecoverableError error("TermTable::PermuteExplicitRows: mapping is not a permutation.");
+                throw error;
+            }
+            used[index] = true;
+        }
+
+        // Rewrite a copy of the image rather than the sealed one, then
+        // attach the copy.
+        std::vector<uint64_t> storage(m_imageStorage);
+        const ptrdiff_t rowIdOffset =
+            reinterpret_cast<char const *>(m_rowIdData) -
+            reinterpret_cast<char const *>(m_imageStorage.data());
+        RowId * const rowIds = reinterpret_cast<RowId *>(
+            reinterpret_cast<char *>(storage.data()) + rowIdOffset);
+
+        const RowIndex first = m_adhocRowCounts[rank];
+        for (size_t i = 0; i <= m_slotMask; ++i)
+        {
+            Slot const & slot = m_slots[i];
+            if ((slot.m_flags & c_explicitSlot) == 0)
+            {
+                continue;
+            }
+
+            for (RowIndex r = slot.m_rows.GetStart(); r < slot.m_rows.GetEnd(); ++r)
+            {
+                const RowId row = rowIds[r];
+                if (row.GetRank() == rank &&
+                    row.GetIndex() >= first &&
+                    row.GetIndex() < first + count)
+                {
+                    rowIds[r] = RowId(rank, first + mapping[row.GetIndex() - first]);
+                }
+            }
+        }
+
+        const size_t byteCount = m_header->m_byteCount;
+        m_imageStorage = std::move(storage);
+        AttachImage(m_imageStorage.data(), byteCount);
+    }
+
+
     double TermTable::GetBytesPerDocument(Rank rank) const
     {
         return GetTotalRowCount(rank) / pow(2.0, rank) / c_bitsPerByte;
@@ -362,6 +650,26 @@ namespace BitFunnel
         {
             return PackedRowIdSequence(hash, hash + 1, PackedRowIdSequence::Type::Fact);
         }
+        else if (m_header != nullptr)
+        {
+            // Sealed: a single probe resolves both explicit terms and the
+            // idf of known adhoc terms.
+            Term::IdfX10 idf = Term::c_maxIdfX10Value;
+            Slot const * slot = FindSlot(hash);
+            if (slot != nullptr)
+            {
+                if ((slot->m_flags & c_explicitSlot) != 0)
+                {
+                    return slot->m_rows;
+                }
+                idf = slot->m_idf;
+            }
+
+            // If term isn't found, assume it is adhoc.
+            // Return a PackedRowIdSequence that will be used as a recipe for
+            // generating adhoc term RowIds.
+            return m_adhocRows[idf][term.GetGramSize()];
+        }
         else
         {
             auto it = m_termHashToRows.find(term.GetRawHash());
@@ -382,13 +690,13 @@ namespace BitFunnel
 
     RowId TermTable::GetRowIdExplicit(size_t index) const
     {
-        if (index >= m_rowIds.size())
+        if (index >= m_rowIdCount)
         {
             RecoverableError error("TermTable::GetRowIdExplicit: index out of range.");
             throw error;
         }
 
-        return m_rowIds[index];
+        return m_rowIdData[index];
     }
 
 
@@ -396,7 +704,7 @@ namespace BitFunnel
                                    size_t index,
                                    size_t variant) const
     {
-        if (index >= m_rowIds.size())
+        if (index >= m_rowIdCount)
         {
             RecoverableError error("TermTable::GetRowIdAdhoc: index out of range.");
             throw error;
@@ -408,12 +716,10 @@ namespace BitFunnel
             throw error;
         }
 
-        const RowId rowId = m_rowIds[index];
+        const RowId rowId = m_rowIdData[index];
 
         const Rank rank = rowId.GetRank();
 
-        const size_t adhocRowCount = m_adhocRowCounts[rank];
-
         // Derive adhoc row index from a combination of the term hash and the
         // variant. Want to ensure that all rows generated for the same
         // (ShardId, Rank) are different.
@@ -423,12 +729,18 @@ namespace BitFunnel
         hash = hash ^ m_randomHashes[variant];
 
         // Adhoc rows start at RowIndex 0.
-        return RowId(rank, (hash % adhocRowCount));
+        return RowId(rank, m_adhocModulo[rank].Modulo(hash));
     }
 
 
     Term::IdfX10 TermTable::GetIdf(Term::Hash hash) const
     {
+        if (m_header != nullptr)
+        {
+            Slot const * slot = FindSlot(hash);
+            return (slot != nullptr) ? slot->m_idf : Term::c_maxIdfX10Value;
+        }
+
         auto it = m_adhocTerms.find(hash);
         if (it != m_adhocTerms.end())
         {
@@ -469,12 +781,22 @@ namespace BitFunnel
 
     bool TermTable::operator==(TermTable const & other) const
     {
+        if (m_header != nullptr && other.m_header != nullptr)
+        {
+            // Images are built deterministically, so sealed tables are equal
+            // exactly when their images are.
+            return m_header->m_byteCount == other.m_header->m_byteCount &&
+                memcmp(m_header, other.m_header, m_header->m_byteCount) == 0;
+        }
+
         bool equals = true;
         equals = equals && (m_ranksInUse == other.m_ranksInUse);
         equals = equals && (m_maxRankInUse == other.m_maxRankInUse);
         equals = equals && (m_termHashToRows == other.m_termHashToRows);
         equals = equals && (m_adhocRows == other.m_adhocRows);
-        equals = equals && (m_rowIds == other.m_rowIds);
+        equals = equals && (m_rowIdCount == other.m_rowIdCount);
+        equals = equals &&
+            std::equal(m_rowIdData, m_rowIdData + m_rowIdCount, other.m_rowIdData);
         equals = equals && (m_explicitRowCounts == other.m_explicitRowCounts);
         equals = equals && (m_adhocRowCounts == other.m_adhocRowCounts);
         equals = equals && (m_sharedRowCounts == other.m_sharedRowCounts);
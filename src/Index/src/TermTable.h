@@ -22,18 +22,36 @@
 
 #pragma once
 
-#include <unordered_map>                // std::unordered_map member.
-#include <array>                        // std::array member.
-#include <memory>                       // Embeds std::unique_ptr.
-#include <vector>                       // std::vector member.
+#include <unordered_map>                        // std::unordered_map member.
+#include <array>                                // std::array member.
+#include <memory>                               // Embeds std::unique_ptr.
+#include <vector>                               // std::vector member.
 
-#include "BitFunnel/Index/ITermTable.h" // Base class.
-#include "BitFunnel/Index/RowId.h"      // RowId template parameter.
-#include "BitFunnel/Term.h"             // Term::Hash parameter.
+#include "BitFunnel/Index/ITermTable.h"         // Base class.
+#include "BitFunnel/Index/RowId.h"              // RowId template parameter.
+#include "BitFunnel/Term.h"                     // Term::Hash parameter.
+#include "BitFunnel/Utilities/FastModulo.h"     // FastModulo member.
 
 
 namespace BitFunnel
 {
+    //*************************************************************************
+    //
+    // TermTable
+    //
+    // During the build phase, the TermTable records explicit terms and adhoc
+    // idf values in hash maps. Seal() converts these maps into a single flat,
+    // position-independent image consisting of a header, the adhoc recipes,
+    // an open-addressed table of 16-byte slots keyed by Term::Hash, and the
+    // RowId buffer. Lookups on a sealed TermTable probe the slot array, which
+    // typically touches a single cache line per term.
+    //
+    // The image is also the serialization format, so a sealed TermTable can
+    // be loaded from a stream without rebuilding any per-term structures, or
+    // attached directly to memory supplied by the caller (e.g. a memory
+    // mapped file).
+    //
+    //*************************************************************************
     class TermTable : public ITermTable
     {
     public:
@@ -43,7 +61,17 @@ namespace BitFunnel
         // Write() method.
         TermTable(std::istream& input);
 
-        // Writes the contents of the ITermTable to a stream.
+        // Constructs a sealed TermTable that reads directly from an image
+        // previously serialized via the Write() method. The image must be
+        // 8-byte aligned and must outlive the TermTable. Intended for use
+        // with memory mapped files.
+        TermTable(void const * image, size_t byteCount);
+
+        TermTable(TermTable const &) = delete;
+        TermTable& operator=(TermTable const &) = delete;
+
+        // Writes the contents of the ITermTable to a stream. The TermTable
+        // must be sealed.
         virtual void Write(std::ostream& output) const override;
 
         // Instructs the TermTable to start recording RowIds added by AddRowId.
@@ -97,6 +125,18 @@ namespace BitFunnel
         // facts, if applicable.
         virtual size_t GetTotalRowCount(Rank rank) const override;
 
+        // Returns the number of adhoc rows at (rank).
+        virtual size_t GetAdhocRowCount(Rank rank) const override;
+
+        // Returns the number of explicit term rows at (rank).
+        virtual size_t GetExplicitRowCount(Rank rank) const override;
+
+        // Renumbers the explicit term rows at (rank) by rewriting a copy of
+        // the image. The image must be owned by this TermTable. Not safe to
+        // call while other threads read the TermTable.
+        virtual void PermuteExplicitRows(Rank rank,
+                                         std::vector<RowIndex> const & mapping) override;
+
         // Returns the number of bytes of Row data required to store each
         // document using this TermTable.
         virtual double GetBytesPerDocument(Rank rank) const override;
@@ -134,6 +174,50 @@ namespace BitFunnel
         bool operator==(TermTable const & other) const;
 
     private:
+        // Header at the start of the serialized image. All fields are 64-bit
+        // to keep the layout identical across platforms.
+        struct ImageHeader
+        {
+            uint64_t m_magic;
+            uint64_t m_byteCount;
+            uint64_t m_slotCount;
+            uint64_t m_rowIdCount;
+            uint64_t m_factRowCount;
+            uint64_t m_maxRankInUse;
+            uint64_t m_ranksInUse;
+            uint64_t m_explicitRowCounts[c_maxRankValue + 1];
+            uint64_t m_adhocRowCounts[c_maxRankValue + 1];
+            uint64_t m_sharedRowCounts[c_maxRankValue + 1];
+        };
+
+        // One entry in the open-addressed hash table. A slot may hold an
+        // explicit term, an adhoc term's IdfX10, or both.
+        struct Slot
+        {
+            Term::Hash m_hash;
+            PackedRowIdSequence m_rows;
+            Term::IdfX10 m_idf;
+            uint8_t m_flags;
+            uint16_t m_unused;
+        };
+
+        static_assert(sizeof(Slot) == 16, "TermTable: Slot must be 16 bytes.");
+
+        static const uint8_t c_explicitSlot = 1;
+        static const uint8_t c_adhocSlot = 2;
+
+        // Builds the image from the build-phase maps and attaches to it.
+        void BuildImage();
+
+        // Validates the image and points the reader members into it.
+        void AttachImage(void const * image, size_t byteCount);
+
+        // Returns the slot for hash, or nullptr if hash is not in the table.
+        Slot const * FindSlot(Term::Hash hash) const;
+
+        static size_t GetImageByteCount(size_t slotCount, size_t rowIdCount);
+        static size_t GetSlotIndex(Term::Hash hash, unsigned shift);
+
         void EnsureSealed(bool value) const;
 
         // This is a helper method to catch careless bugs. There's no reason, in
@@ -180,6 +264,23 @@ namespace BitFunnel
 
         std::vector<RowId> m_rowIds;
 
+        // Reader view of the RowId buffer. Refers to m_rowIds while building
+        // and into the image once sealed.
+        RowId const * m_rowIdData;
+        size_t m_rowIdCount;
+
+        // The sealed image. m_imageStorage is empty when the image is owned
+        // by the caller.
+        std::vector<uint64_t> m_imageStorage;
+        ImageHeader const * m_header;
+        Slot const * m_slots;
+        unsigned m_slotShift;
+        size_t m_slotMask;
+
+        // Precomputed reciprocals of m_adhocRowCounts, used to avoid a
+        // hardware divide on each adhoc RowId.
+        std::array<FastModulo, c_maxRankValue + 1> m_adhocModulo;
+
         // DESIGN NOTE: m_explicitRowCounts includes facts. Facts includes
         // system terms. This is mixing together two concepts, which means that
         // some uses of m_explicitRowCounts require subtracting off
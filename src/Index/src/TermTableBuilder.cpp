@@ -21,15 +21,23 @@
 // THE SOFTWARE.
 
 #include <algorithm>
+#include <array>
 #include <iostream>     // TODO: Remove this temporary include.
 #include <math.h>
+#include <unordered_map>
 
 #include "BitFunnel/BitFunnelTypes.h"
 #include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IQueryAdaptiveTreatment.h"
+#include "BitFunnel/Index/IQueryProfile.h"
 #include "BitFunnel/Index/ITermTable.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ITaskDistributor.h"
+#include "BitFunnel/Utilities/ITaskProcessor.h"
 #include "BitFunnel/Utilities/Stopwatch.h"
 #include "DocumentFrequencyTable.h"
 #include "LoggerInterfaces/Check.h"
+#include "QueryCostModel.h"
 #include "TermTableBuilder.h"
 
 
@@ -47,16 +55,116 @@ namespace BitFunnel
                                           IDocumentFrequencyTable const & terms,
                                           IFactSet const & facts,
                                           ITermTable & termTable)
+    {
+        return CreateTermTableBuilder(density,
+                                      adhocFrequency,
+                                      treatment,
+                                      terms,
+                                      facts,
+                                      nullptr,
+                                      termTable,
+                                      1);
+    }
+
+
+    std::unique_ptr<ITermTableBuilder>
+        Factories::CreateTermTableBuilder(double density,
+                                          double adhocFrequency,
+                                          ITermTreatment const & treatment,
+                                          IDocumentFrequencyTable const & terms,
+                                          IFactSet const & facts,
+                                          ITermTable const * previous,
+                                          ITermTable & termTable,
+                                          size_t threadCount)
     {
         // TODO: make skipDistance (currently c_explicitRowRandomizaitonLimit) a parameter.
-        return
-            std::unique_ptr<ITermTableBuilder>(new TermTableBuilder(density,
-                                                                    adhocFrequency,
-                                                                    treatment,
-                                                                    terms,
-                                                                    facts,
-                                                                    termTable,
-                                                                    c_explicitRowRandomizationLimit));
+        if (previous == nullptr)
+        {
+            return
+                std::unique_ptr<ITermTableBuilder>(new TermTableBuilder(density,
+                                                                        adhocFrequency,
+                                                                        treatment,
+                                                                        terms,
+                                                                        facts,
+                                                                        termTable,
+                                                                        c_explicitRowRandomizationLimit,
+                                                                        threadCount));
+        }
+        else
+        {
+            return
+                std::unique_ptr<ITermTableBuilder>(new TermTableBuilder(density,
+                                                                        adhocFrequency,
+                                                                        treatment,
+                                                                        terms,
+                                                                        facts,
+                                                                        *previous,
+                                                                        termTable,
+                                                                        c_explicitRowRandomizationLimit,
+                                                                        threadCount));
+        }
+    }
+
+
+    //*************************************************************************
+    //
+    // TermTableBuilder::RowAssignerProcessor
+    //
+    // Runs the explicit row assignment for one Rank per task.
+    //
+    //*************************************************************************
+    class TermTableBuilder::RowAssignerProcessor : public ITaskProcessor
+    {
+    public:
+        RowAssignerProcessor(TermTableBuilder& builder)
+          : m_builder(builder)
+        {
+        }
+
+        //
+        // ITaskProcessor methods
+        //
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            m_builder.m_rowAssigners[taskId]->
+                AssignExplicitTerms(m_builder.m_explicitTerms,
+                                    m_builder.m_previous);
+        }
+
+        virtual void Finished() override
+        {
+        }
+
+    private:
+        TermTableBuilder& m_builder;
+    };
+
+
+    //*************************************************************************
+    //
+    // TermTableBuilder::ExplicitTerm
+    //
+    //*************************************************************************
+    TermTableBuilder::ExplicitTerm::ExplicitTerm(Term::Hash hash,
+                                                 double frequency,
+                                                 RowConfiguration configuration,
+                                                 bool isPrivate,
+                                                 PackedRowIdSequence previousRows,
+                                                 bool isRetained)
+      : m_hash(hash),
+        m_frequency(frequency),
+        m_configuration(configuration),
+        m_isPrivate(isPrivate),
+        m_previousRows(previousRows),
+        m_isRetained(isRetained)
+    {
+    }
+
+
+    double TermTableBuilder::ExplicitTerm::GetAssignmentFrequency() const
+    {
+        return m_isPrivate ? 1.0 : m_frequency;
     }
 
 
@@ -71,17 +179,55 @@ namespace BitFunnel
                                        IDocumentFrequencyTable const & terms,
                                        IFactSet const & facts,
                                        ITermTable & termTable,
-                                       unsigned randomSkipDistance)
+                                       unsigned randomSkipDistance,
+                                       size_t threadCount)
         : m_termTable(termTable),
+          m_previous(nullptr),
+          m_density(density),
+          m_retainedTermCount(0),
+          m_threadCount(threadCount),
           m_buildTime(0.0),
-          // seed, min value, max value.
-          m_random(std::make_unique<RandomInt<unsigned>>(0,
-                                                         0,
-                                                         randomSkipDistance))
+          m_isQueryAdaptive(false),
+          m_promotedTermCount(0),
+          m_demotedTermCount(0),
+          m_expectedQuadwordsPerQuery(0.0),
+          m_idfOnlyQuadwordsPerQuery(0.0)
     {
-        Stopwatch stopwatch;
+        for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+        {
+            m_rowAssigners.push_back(
+                std::unique_ptr<RowAssigner>(
+                    new RowAssigner(rank,
+                                    density,
+                                    termTable,
+                                    randomSkipDistance)));
+        }
+
+        Build(adhocFrequency, treatment, terms, facts, nullptr, threadCount);
+    }
+
 
-        // Create one RowAssigner for each rank.
+    TermTableBuilder::TermTableBuilder(double density,
+                                       double adhocFrequency,
+                                       ITermTreatment const & treatment,
+                                       IDocumentFrequencyTable const & terms,
+                                       IFactSet const & facts,
+                                       ITermTable const & previous,
+                                       ITermTable & termTable,
+                                       unsigned randomSkipDistance,
+                                       size_t threadCount)
+        : m_termTable(termTable),
+          m_previous(&previous),
+          m_density(density),
+          m_retainedTermCount(0),
+          m_threadCount(threadCount),
+          m_buildTime(0.0),
+          m_isQueryAdaptive(false),
+          m_promotedTermCount(0),
+          m_demotedTermCount(0),
+          m_expectedQuadwordsPerQuery(0.0),
+          m_idfOnlyQuadwordsPerQuery(0.0)
+    {
         for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
         {
             m_rowAssigners.push_back(
@@ -89,9 +235,34 @@ namespace BitFunnel
                     new RowAssigner(rank,
                                     density,
                                     termTable,
-                                    *m_random)));
+                                    randomSkipDistance)));
+        }
+
+        Build(adhocFrequency, treatment, terms, facts, &previous, threadCount);
+    }
+
+
+    void TermTableBuilder::Build(double adhocFrequency,
+                                 ITermTreatment const & treatment,
+                                 IDocumentFrequencyTable const & terms,
+                                 IFactSet const & facts,
+                                 ITermTable const * previous,
+                                 size_t threadCount)
+    {
+        Stopwatch stopwatch;
+
+        for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+        {
+            m_configurations.push_back(treatment.GetTreatment(idf));
         }
 
+        IQueryAdaptiveTreatment const * adaptive =
+            dynamic_cast<IQueryAdaptiveTreatment const *>(&treatment);
+        m_isQueryAdaptive = (adaptive != nullptr);
+
+        //
+        // Phase 1: classify terms.
+        //
 
         // For each entry in the document frequency table.
         // (note that the entries are sorted in order of decreasing frequency).
@@ -99,20 +270,37 @@ namespace BitFunnel
         {
             // TODO: Consider handling disposed terms here.
 
-            //std::cout << "Term: ";
-            //dfEntry.GetTerm().Print(std::cout);
-            //std::cout << "; frequency = " << dfEntry.GetFrequency() << std::endl;
-
             // Get the term's RowConfiguration.
             Term::IdfX10 idf = Term::ComputeIdfX10(dfEntry.GetFrequency(), Term::c_maxIdfX10Value);
-            auto configuration = treatment.GetTreatment(idf);
+            auto configuration = m_configurations[idf];
 
             // Ignore all terms whose IDF is the max value, as this IDF
             // is exclusively used for handling "unknown" terms.
             if (idf >= Term::c_maxIdfX10Value)
                 break;
 
-            if (dfEntry.GetFrequency() < adhocFrequency)
+            const Term::Hash hash = dfEntry.GetTerm().GetRawHash();
+            bool isAdhoc = (dfEntry.GetFrequency() < adhocFrequency);
+            bool isPrivate = false;
+            if (adaptive != nullptr)
+            {
+                if (adaptive->IsPrivate(hash))
+                {
+                    // Frequently queried terms get private rows even if
+                    // they are rare enough to be adhoc.
+                    isAdhoc = false;
+                    isPrivate = true;
+                    configuration = adaptive->GetTreatment(hash, idf);
+                    ++m_promotedTermCount;
+                }
+                else if (!isAdhoc && adaptive->IsAdhoc(hash, dfEntry.GetFrequency()))
+                {
+                    isAdhoc = true;
+                    ++m_demotedTermCount;
+                }
+            }
+
+            if (isAdhoc)
             {
                 // For each rank entry in the RowConfiguration.
                 for (auto rcEntry : configuration)
@@ -128,22 +316,87 @@ namespace BitFunnel
             }
             else
             {
-                m_termTable.OpenTerm();
-                //std::cout << "  Configuration: ";
-                //configuration.Write(std::cout);
-                //std::cout << std::endl;
+                PackedRowIdSequence previousRows;
+                bool isRetained = false;
+                if (previous != nullptr)
+                {
+                    previousRows = previous->GetRows(dfEntry.GetTerm());
+                    isRetained = CanRetain(previousRows,
+                                           isPrivate ? 1.0 : dfEntry.GetFrequency(),
+                                           configuration);
+                }
 
-                // For each rank entry in the RowConfiguration.
-                for (auto rcEntry : configuration)
+                if (isRetained)
                 {
-                    // Assign the appropriate rows.
-                    m_rowAssigners[rcEntry.GetRank()]->
-                        AssignExplicit(dfEntry.GetFrequency(),
-                                       rcEntry.GetRowCount());
+                    ++m_retainedTermCount;
                 }
 
-                m_termTable.CloseTerm(dfEntry.GetTerm().GetRawHash());
+                m_explicitTerms.push_back(
+                    ExplicitTerm(hash,
+                                 dfEntry.GetFrequency(),
+                                 configuration,
+                                 isPrivate,
+                                 previousRows,
+                                 isRetained));
+            }
+        }
+
+        //
+        // Phase 2: assign explicit rows, one task per rank.
+        //
+        const size_t rankCount = c_maxRankValue + 1;
+        if (threadCount <= 1)
+        {
+            RowAssignerProcessor processor(*this);
+            for (size_t rank = 0; rank < rankCount; ++rank)
+            {
+                processor.ProcessTask(rank);
+            }
+        }
+        else
+        {
+            std::vector<std::unique_ptr<ITaskProcessor>> processors;
+            for (size_t i = 0; i < (std::min)(threadCount, rankCount); ++i)
+            {
+                processors.push_back(
+                    std::unique_ptr<ITaskProcessor>(
+                        new RowAssignerProcessor(*this)));
+            }
+
+            auto distributor =
+                Factories::CreateTaskDistributor(processors, rankCount);
+            distributor->WaitForCompletion();
+        }
+
+        //
+        // Phase 3: record the explicit rows in the TermTable.
+        //
+        for (auto const & term : m_explicitTerms)
+        {
+            m_termTable.OpenTerm();
+
+            if (term.m_isRetained)
+            {
+                for (RowIndex r = term.m_previousRows.GetStart();
+                     r < term.m_previousRows.GetEnd();
+                     ++r)
+                {
+                    RowId rowId = previous->GetRowIdExplicit(r);
+                    m_termTable.AddRowId(
+                        RowId(rowId.GetRank(),
+                              ToRelativeIndex(*previous, rowId)));
+                }
+            }
+            else
+            {
+                // For each rank entry in the RowConfiguration.
+                for (auto rcEntry : term.m_configuration)
+                {
+                    m_rowAssigners[rcEntry.GetRank()]->AddNextAssignment();
+                }
             }
+
+            m_termTable.CloseTerm(term.m_hash);
         }
 
         // Calculate row assignments needed for estimated number of unknown terms
@@ -170,7 +423,7 @@ namespace BitFunnel
             {
                 m_termTable.OpenTerm();
 
-                auto configuration = treatment.GetTreatment(idf);
+                auto configuration = m_configurations[idf];
                 for (auto rcEntry : configuration)
                 {
                     for (size_t i = 0; i < rcEntry.GetRowCount(); ++i)
@@ -198,13 +451,188 @@ namespace BitFunnel
 
         m_termTable.Seal();
 
+        if (adaptive != nullptr)
+        {
+            EstimateQueryCost(*adaptive, terms);
+        }
+
         m_buildTime = stopwatch.ElapsedTime();
     }
 
 
+    void TermTableBuilder::EstimateQueryCost(
+        IQueryAdaptiveTreatment const & adaptive,
+        IDocumentFrequencyTable const & terms)
+    {
+        auto const & queries = adaptive.GetQueryProfile().GetQueries();
+        if (queries.empty())
+        {
+            return;
+        }
+
+        // Document frequency and RowConfiguration of each query term.
+        // Explicit terms use the configuration they were built with. Query
+        // terms that are adhoc or absent from the frequency table use the
+        // idf-only configuration.
+        struct QueryTerm
+        {
+            double m_frequency;
+            RowConfiguration m_configuration;
+        };
+        std::unordered_map<Term::Hash, QueryTerm> queryTerms;
+        for (auto const & query : queries)
+        {
+            for (auto hash : query)
+            {
+                const double frequency =
+                    Term::IdfX10ToFrequency(Term::c_maxIdfX10Value);
+                queryTerms.insert(std::make_pair(
+                    hash,
+                    QueryTerm { frequency,
+                                m_configurations[Term::c_maxIdfX10Value] }));
+            }
+        }
+
+        for (auto dfEntry : terms)
+        {
+            auto it = queryTerms.find(dfEntry.GetTerm().GetRawHash());
+            if (it != queryTerms.end())
+            {
+                Term::IdfX10 idf =
+                    Term::ComputeIdfX10(dfEntry.GetFrequency(),
+                                        Term::c_maxIdfX10Value);
+                it->second.m_frequency = dfEntry.GetFrequency();
+                it->second.m_configuration = m_configurations[idf];
+            }
+        }
+
+        std::unordered_map<Term::Hash, ExplicitTerm const *> explicitTerms;
+        for (auto const & term : m_explicitTerms)
+        {
+            if (queryTerms.find(term.m_hash) != queryTerms.end())
+            {
+                explicitTerms.insert(std::make_pair(term.m_hash, &term));
+            }
+        }
+
+        QueryCostModel actual(m_density);
+        QueryCostModel idfOnly(m_density);
+        double actualTotal = 0.0;
+        double idfOnlyTotal = 0.0;
+        for (auto const & query : queries)
+        {
+            actual.Reset();
+            idfOnly.Reset();
+            for (auto hash : query)
+            {
+                QueryTerm const & term = queryTerms.find(hash)->second;
+                auto it = explicitTerms.find(hash);
+                if (it != explicitTerms.end())
+                {
+                    actual.AddTerm(term.m_frequency,
+                                   it->second->m_configuration,
+                                   it->second->m_isPrivate);
+                }
+                else
+                {
+                    actual.AddTerm(term.m_frequency, term.m_configuration);
+                }
+                idfOnly.AddTerm(term.m_frequency, term.m_configuration);
+            }
+            actualTotal += actual.GetExpectedQuadwords();
+            idfOnlyTotal += idfOnly.GetExpectedQuadwords();
+        }
+
+        m_expectedQuadwordsPerQuery = actualTotal / queries.size();
+        m_idfOnlyQuadwordsPerQuery = idfOnlyTotal / queries.size();
+    }
+
+
+    bool TermTableBuilder::CanRetain(PackedRowIdSequence previousRows,
+                                     double frequency,
+                                     RowConfiguration configuration) const
+    {
+        if (previousRows.GetType() != PackedRowIdSequence::Type::Explicit ||
+            previousRows.GetStart() == previousRows.GetEnd())
+        {
+            return false;
+        }
+
+        std::array<size_t, c_maxRankValue + 1> expected = {};
+        for (auto rcEntry : configuration)
+        {
+            const Rank rank = rcEntry.GetRank();
+            const double f = Term::FrequencyAtRank(frequency, rank);
+            expected[rank] += (f >= m_density) ? 1 : rcEntry.GetRowCount();
+        }
+
+        std::array<size_t, c_maxRankValue + 1> observed = {};
+        for (RowIndex r = previousRows.GetStart(); r < previousRows.GetEnd(); ++r)
+        {
+            ++observed[m_previous->GetRowIdExplicit(r).GetRank()];
+        }
+
+        return expected == observed;
+    }
+
+
+    RowIndex TermTableBuilder::ToRelativeIndex(ITermTable const & previous,
+                                               RowId rowId)
+    {
+        const Rank rank = rowId.GetRank();
+        RowIndex index = static_cast<RowIndex>(rowId.GetIndex()
+                                               - previous.GetAdhocRowCount(rank));
+
+        // See TermTable::Seal(). Explicit rows at rank 0 were shifted down
+        // over the rows reserved for the system terms.
+        if (rank == 0)
+        {
+            index += ITermTable::SystemTerm::Count;
+        }
+
+        return index;
+    }
+
+
+    size_t TermTableBuilder::GetRetainedTermCount() const
+    {
+        return m_retainedTermCount;
+    }
+
+
+    size_t TermTableBuilder::GetAssignedTermCount() const
+    {
+        return m_explicitTerms.size() - m_retainedTermCount;
+    }
+
+
+    double TermTableBuilder::GetExpectedQuadwordsPerQuery() const
+    {
+        return m_expectedQuadwordsPerQuery;
+    }
+
+
     void TermTableBuilder::Print(std::ostream& output) const
     {
         output << "Total build time: " << m_buildTime << " seconds." << std::endl;
+        output << "Threads: " << m_threadCount << std::endl;
+        if (m_previous != nullptr)
+        {
+            output << "Incremental build" << std::endl;
+            output << "  Retained terms: " << GetRetainedTermCount() << std::endl;
+            output << "  Reassigned terms: " << GetAssignedTermCount() << std::endl;
+        }
+        if (m_isQueryAdaptive)
+        {
+            output << "Query adaptive treatment" << std::endl;
+            output << "  Private (frequently queried) terms: " << m_promotedTermCount << std::endl;
+            output << "  Adhoc (unqueried) terms: " << m_demotedTermCount << std::endl;
+            output << "  Expected quadwords per query per 64 documents: "
+                   << m_expectedQuadwordsPerQuery
+                   << " (idf-only treatment: "
+                   << m_idfOnlyQuadwordsPerQuery
+                   << ")" << std::endl;
+        }
 
         for (auto&& assigner : m_rowAssigners)
         {
@@ -240,19 +668,21 @@ namespace BitFunnel
         Rank rank,
         double density,
         ITermTable & termTable,
-        RandomInt<unsigned>& random)
+        unsigned randomSkipDistance)
         : m_rank(rank),
           m_density(density),
           m_termTable(termTable),
           m_adhocTotal(0),
           m_currentRow(0),
+          m_nextAssignment(0),
           m_privateExplicitTermCount(0),
           m_sharedAdhocTermCount(0),
           m_sharedExplicitTermCount(0),
           m_privateExplicitRowCount(0),
           m_unknownTermCount(0),
           m_unknownTotal(0),
-          m_random(random)
+          // seed, min value, max value.
+          m_random(static_cast<unsigned>(rank), 0, randomSkipDistance)
     {
         // TODO: Is there a way to reduce this coupling between RowAssigner
         // and the internals of TermTable?
@@ -265,6 +695,132 @@ namespace BitFunnel
     }
 
 
+    void TermTableBuilder::RowAssigner::AssignExplicitTerms(
+        std::vector<ExplicitTerm> const & terms,
+        ITermTable const * previous)
+    {
+        if (previous != nullptr)
+        {
+            // Load on each row at this rank from the retained terms, indexed
+            // by RowIndex relative to firstRow.
+            const RowIndex firstRow = m_currentRow;
+            std::vector<double> loads;
+            std::vector<bool> isPrivate;
+
+            for (auto const & term : terms)
+            {
+                if (!term.m_isRetained)
+                {
+                    continue;
+                }
+
+                const double f = Term::FrequencyAtRank(term.GetAssignmentFrequency(),
+                                                       m_rank);
+                bool hasRowAtRank = false;
+                for (RowIndex r = term.m_previousRows.GetStart();
+                     r < term.m_previousRows.GetEnd();
+                     ++r)
+                {
+                    RowId rowId = previous->GetRowIdExplicit(r);
+                    if (rowId.GetRank() != m_rank)
+                    {
+                        continue;
+                    }
+
+                    const RowIndex index = ToRelativeIndex(*previous, rowId);
+                    CHECK_GE(index, firstRow)
+                        << "TermTableBuilder::RowAssigner: previous TermTable has an invalid explicit row.";
+
+                    const size_t slot = index - firstRow;
+                    if (slot >= loads.size())
+                    {
+                        loads.resize(slot + 1, 0.0);
+                        isPrivate.resize(slot + 1, false);
+                    }
+                    loads[slot] += f;
+                    if (f >= m_density)
+                    {
+                        isPrivate[slot] = true;
+                    }
+                    hasRowAtRank = true;
+                }
+
+                if (hasRowAtRank)
+                {
+                    if (f >= m_density)
+                    {
+                        ++m_privateExplicitTermCount;
+                    }
+                    else
+                    {
+                        ++m_sharedExplicitTermCount;
+                    }
+                }
+            }
+
+            CreateRetainedBins(firstRow, loads, isPrivate);
+        }
+
+        for (auto const & term : terms)
+        {
+            if (term.m_isRetained)
+            {
+                continue;
+            }
+
+            for (auto rcEntry : term.m_configuration)
+            {
+                if (rcEntry.GetRank() == m_rank)
+                {
+                    AssignExplicit(term.GetAssignmentFrequency(),
+                                   rcEntry.GetRowCount());
+                }
+            }
+        }
+    }
+
+
+    void TermTableBuilder::RowAssigner::CreateRetainedBins(
+        RowIndex firstRow,
+        std::vector<double> const & loads,
+        std::vector<bool> const & isPrivate)
+    {
+        // Rows that only held terms that moved or disappeared are left with
+        // a load of zero and become empty bins that new terms can fill.
+        for (size_t i = 0; i < loads.size(); ++i)
+        {
+            const RowIndex index = static_cast<RowIndex>(firstRow + i);
+            if (isPrivate[i])
+            {
+                ++m_privateExplicitRowCount;
+            }
+            else
+            {
+                m_bins.insert(Bin(m_density, loads[i], index));
+            }
+        }
+
+        m_currentRow = static_cast<RowIndex>(firstRow + loads.size());
+    }
+
+
+    void TermTableBuilder::RowAssigner::AddNextAssignment()
+    {
+        CHECK_LT(m_nextAssignment, m_assignmentEnds.size())
+            << "TermTableBuilder::RowAssigner::AddNextAssignment: no assignment recorded.";
+
+        const size_t start =
+            (m_nextAssignment == 0) ? 0 : m_assignmentEnds[m_nextAssignment - 1];
+        const size_t end = m_assignmentEnds[m_nextAssignment++];
+
+        for (size_t i = start; i < end; ++i)
+        {
+            // TODO: figure out ShardId value here.
+            m_termTable.AddRowId(RowId(m_rank, m_assignedRows[i]));
+        }
+    }
+
+
     void TermTableBuilder::RowAssigner::AssignExplicit(double frequency,
                                                        RowIndex count)
     {
@@ -281,9 +837,8 @@ namespace BitFunnel
             ++m_privateExplicitTermCount;
             ++m_privateExplicitRowCount;
 
-            // Just reserve the RowIndex and then add the appropriate RowID to
-            // the TermTableBuilder.
-            m_termTable.AddRowId(RowId(m_rank, m_currentRow++));
+            // Just reserve the RowIndex and record it for the merge phase.
+            m_assignedRows.push_back(m_currentRow++);
         }
         else
         {
@@ -355,16 +910,17 @@ namespace BitFunnel
 
             // All of the bins for this term have been identified.
 
-            // Now add the appropriate RowIds to the TermTable.
+            // Record the rows for the merge phase.
             for (auto b : currentBins)
             {
-                // TODO: figure out ShardId value here.
-                m_termTable.AddRowId(RowId(m_rank, b.GetIndex()));
+                m_assignedRows.push_back(b.GetIndex());
             }
 
             // Reinsert the bins into m_bins.
             m_bins.insert(currentBins.begin(), currentBins.end());
         }
+
+        m_assignmentEnds.push_back(m_assignedRows.size());
     }
 
 
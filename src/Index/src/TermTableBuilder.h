@@ -31,6 +31,8 @@
 
 #include "BitFunnel/BitFunnelTypes.h"           // Rank parameter.
 #include "BitFunnel/Index/ITermTableBuilder.h"  // Base class.
+#include "BitFunnel/Index/ITermTreatment.h"     // RowConfiguration member.
+#include "BitFunnel/Index/PackedRowIdSequence.h" // PackedRowIdSequence member.
 #include "BitFunnel/Index/RowId.h"              // RowIndex, RowId parameter.
 #include "BitFunnel/Term.h"                     // Term::Hash template parameter.
 #include "BitFunnel/Utilities/Accumulator.h"    // Accumulator member.
@@ -41,9 +43,34 @@ namespace BitFunnel
 {
     class DocumentFrequencyTable;   // TODO: IDocumentFrequencyTable
     class IFactSet;
+    class IQueryAdaptiveTreatment;
     class ITermTreatment;
     class ITermTable;
 
+    //*************************************************************************
+    //
+    // TermTableBuilder
+    //
+    // Configures an ITermTable from an IDocumentFrequencyTable in three
+    // phases:
+    //   1. A sequential scan of the frequency table that classifies each term
+    //      as adhoc or explicit and, in incremental mode, decides which
+    //      explicit terms keep the rows they had in the previous TermTable.
+    //   2. Row assignment for the explicit terms. Each Rank's RowAssigner
+    //      owns its bins, its row counter and its random number generator, so
+    //      the ranks are processed concurrently on up to threadCount threads.
+    //   3. A sequential merge that adds each term's RowIds to the ITermTable
+    //      in frequency table order.
+    //
+    // Because each rank draws from its own random number generator, the
+    // resulting TermTable does not depend on threadCount.
+    //
+    // When the treatment is an IQueryAdaptiveTreatment, each explicit term's
+    // RowConfiguration comes from its hash as well as its idf, rarely
+    // queried terms may be made adhoc, and the builder estimates the
+    // quadwords read per query for the treatment's query log.
+    //
+    //*************************************************************************
     class TermTableBuilder : public ITermTableBuilder
     {
     public:
@@ -53,10 +80,39 @@ namespace BitFunnel
                          IDocumentFrequencyTable const & terms,
                          IFactSet const & facts,
                          ITermTable & termTable,
-                         unsigned randomSkipDistance);
+                         unsigned randomSkipDistance,
+                         size_t threadCount = 1);
+
+        // Incremental build. Explicit terms whose rows in (previous) still
+        // have the shape that the treatment calls for at their current
+        // frequency keep those rows. Only new terms and terms whose
+        // treatment changed are bin-packed, into the space left over by the
+        // retained terms. The previous TermTable must have been built with
+        // the same density and treatment.
+        TermTableBuilder(double density,
+                         double adhocFrequency,
+                         ITermTreatment const & treatment,
+                         IDocumentFrequencyTable const & terms,
+                         IFactSet const & facts,
+                         ITermTable const & previous,
+                         ITermTable & termTable,
+                         unsigned randomSkipDistance,
+                         size_t threadCount = 1);
 
         virtual void Print(std::ostream& output) const override;
 
+        // Returns the number of explicit terms that kept the rows they had
+        // in the previous TermTable. Always zero for a full build.
+        size_t GetRetainedTermCount() const;
+
+        // Returns the number of explicit terms that were assigned new rows.
+        size_t GetAssignedTermCount() const;
+
+        // Returns the expected number of quadwords read per 64 documents,
+        // averaged over the queries of an IQueryAdaptiveTreatment's query
+        // log. Returns zero for other treatments.
+        double GetExpectedQuadwordsPerQuery() const;
+
         // TODO: Come up with a more principled solution.
         // When building a TermTable based on a small IDocumentFrequencyTable,
         // the builder may run into a situation where it encounters no adhoc
@@ -80,39 +136,82 @@ namespace BitFunnel
         static size_t GetMinAdhocRowCount();
 
     private:
+        void Build(double adhocFrequency,
+                   ITermTreatment const & treatment,
+                   IDocumentFrequencyTable const & terms,
+                   IFactSet const & facts,
+                   ITermTable const * previous,
+                   size_t threadCount);
+
+        // Returns true if the explicit rows (previousRows) from the previous
+        // TermTable have, at every rank, the number of rows that
+        // (configuration) calls for at (frequency).
+        bool CanRetain(PackedRowIdSequence previousRows,
+                       double frequency,
+                       RowConfiguration configuration) const;
+
+        // Converts an absolute explicit RowId from the previous TermTable
+        // back to the relative RowIndex that was originally passed to
+        // AddRowId(). This is the inverse of the conversion in Seal().
+        static RowIndex ToRelativeIndex(ITermTable const & previous,
+                                        RowId rowId);
+
         ITermTable & m_termTable;
+        ITermTable const * m_previous;
+        double m_density;
 
         class RowAssigner;
         std::vector <std::unique_ptr<RowAssigner>> m_rowAssigners;
 
-        double m_buildTime;
+        class RowAssignerProcessor;
+
+        // Estimates the quadwords per query for the query log of
+        // (adaptive), using the RowConfigurations that the terms were
+        // actually given and, for comparison, the idf-only configurations.
+        void EstimateQueryCost(IQueryAdaptiveTreatment const & adaptive,
+                               IDocumentFrequencyTable const & terms);
 
-        // Random number generator.
-        std::unique_ptr<RandomInt<unsigned>> m_random;
+        // RowConfiguration for each IdfX10 value.
+        std::vector<RowConfiguration> m_configurations;
 
-        class RowAssignment
+        // Explicit terms, in frequency table order.
+        class ExplicitTerm
         {
         public:
-            RowAssignment(size_t start, size_t end)
-                : m_start(static_cast<unsigned>(start)),
-                  m_end(static_cast<unsigned>(end))
-            {
-            }
-
-            unsigned GetStart() const
-            {
-                return m_start;
-            }
+            ExplicitTerm(Term::Hash hash,
+                         double frequency,
+                         RowConfiguration configuration,
+                         bool isPrivate,
+                         PackedRowIdSequence previousRows,
+                         bool isRetained);
+
+            // Returns the frequency used to assign the term's rows. Terms
+            // that an IQueryAdaptiveTreatment makes private reserve whole
+            // rows, as if their frequency were 1.0.
+            double GetAssignmentFrequency() const;
+
+            Term::Hash m_hash;
+            double m_frequency;
+            RowConfiguration m_configuration;
+            bool m_isPrivate;
+
+            // When m_isRetained is true, the term keeps m_previousRows from
+            // the previous TermTable instead of being bin-packed.
+            PackedRowIdSequence m_previousRows;
+            bool m_isRetained;
+        };
+        std::vector<ExplicitTerm> m_explicitTerms;
 
-            unsigned GetEnd() const
-            {
-                return m_end;
-            }
+        size_t m_retainedTermCount;
+        size_t m_threadCount;
+        double m_buildTime;
 
-        private:
-            unsigned m_start;
-            unsigned m_end;
-        };
+        // Statistics for an IQueryAdaptiveTreatment.
+        bool m_isQueryAdaptive;
+        size_t m_promotedTermCount;
+        size_t m_demotedTermCount;
+        double m_expectedQuadwordsPerQuery;
+        double m_idfOnlyQuadwordsPerQuery;
 
 
         class RowAssigner
@@ -121,7 +220,20 @@ namespace BitFunnel
             RowAssigner(Rank rank,
                         double density,
                         ITermTable & termTable,
-                        RandomInt<unsigned>& random);
+                        unsigned randomSkipDistance);
+
+            // Seeds the bins with the rows of the retained terms and then
+            // bin-packs every other explicit term that has rows at this rank.
+            // Touches only this RowAssigner's state, so RowAssigners for
+            // different ranks may run concurrently.
+            void AssignExplicitTerms(
+                std::vector<ExplicitTerm> const & terms,
+                ITermTable const * previous);
+
+            // Adds the rows recorded by the next call to AssignExplicit()
+            // to the TermTable. Calls must follow the same (term, entry)
+            // order that AssignExplicitTerms() used.
+            void AddNextAssignment();
 
             void AssignExplicit(double frequency, RowIndex count);
             void AssignAdhoc(double frequency, RowIndex count);
@@ -134,6 +246,10 @@ namespace BitFunnel
             void Print(std::ostream& output) const;
 
         private:
+            void CreateRetainedBins(RowIndex firstRow,
+                                    std::vector<double> const & loads,
+                                    std::vector<bool> const & isPrivate);
+
             // Constructor parameters.
             Rank m_rank;
             double m_density;
@@ -148,6 +264,13 @@ namespace BitFunnel
             class Bin;
             std::set<Bin> m_bins;
 
+            // Relative RowIndex values chosen by AssignExplicit(), in call
+            // order. m_assignmentEnds[i] is the end of the i-th call's rows
+            // in m_assignedRows.
+            std::vector<RowIndex> m_assignedRows;
+            std::vector<size_t> m_assignmentEnds;
+            size_t m_nextAssignment;
+
             // If any termCount is > 0, then we consider this rank "in use" and
             // set the row count to be at least some minimum value..
             //
@@ -168,7 +291,10 @@ namespace BitFunnel
             size_t m_unknownTermCount;
             double m_unknownTotal;
 
-            RandomInt<unsigned>& m_random;
+            // Random number generator for the skip distance. Seeded with the
+            // rank so that the ranks are independent of each other and of
+            // the order in which they are processed.
+            RandomInt<unsigned> m_random;
 
 
             class Bin
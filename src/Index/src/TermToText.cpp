@@ -45,6 +45,12 @@ namespace BitFunnel
 
 
     TermToText::TermToText(std::istream & input)
+    {
+        AddTerms(input);
+    }
+
+
+    void TermToText::AddTerms(std::istream & input)
     {
         CsvTsv::CsvTableParser parser(input);
         CsvTsv::TableReader reader(parser);
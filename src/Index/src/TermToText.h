@@ -51,6 +51,9 @@ namespace BitFunnel
         // Constructs a map from data previously persisted via Write().
         TermToText(std::istream & input);
 
+        // Adds the mappings from data previously persisted via Write().
+        void AddTerms(std::istream & input);
+
         //
         // ITermToText methods.
         //
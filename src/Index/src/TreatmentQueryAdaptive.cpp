@@ -0,0 +1,239 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <limits>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IDocumentFrequencyTable.h"
+#include "BitFunnel/Index/IQueryProfile.h"
+#include "QueryCostModel.h"
+#include "TreatmentQueryAdaptive.h"
+
+
+namespace BitFunnel
+{
+    std::unique_ptr<IQueryAdaptiveTreatment>
+        Factories::CreateQueryAdaptiveTreatment(
+            ITermTreatment const & base,
+            IQueryProfile const & queries,
+            IDocumentFrequencyTable const & terms,
+            double density,
+            double memoryBudget)
+    {
+        return std::unique_ptr<IQueryAdaptiveTreatment>(
+            new TreatmentQueryAdaptive(base,
+                                       queries,
+                                       terms,
+                                       density,
+                                       memoryBudget));
+    }
+
+
+    //*************************************************************************
+    //
+    // TreatmentQueryAdaptive
+    //
+    //*************************************************************************
+    TreatmentQueryAdaptive::TreatmentQueryAdaptive(
+        ITermTreatment const & base,
+        IQueryProfile const & queries,
+        IDocumentFrequencyTable const & terms,
+        double density,
+        double memoryBudget)
+      : m_base(base),
+        m_queries(queries),
+        m_density(density),
+        m_extraBitsPerDocument(0.0)
+    {
+        if (memoryBudget < 0.0)
+        {
+            RecoverableError error("TreatmentQueryAdaptive: memory budget must not be negative.");
+            throw error;
+        }
+
+        struct Candidate
+        {
+            Term::Hash m_hash;
+            RowConfiguration m_configuration;
+
+            // Expected quadwords saved per query, weighted by query
+            // frequency, for each extra bit per document.
+            double m_benefitPerBit;
+            double m_extraBits;
+        };
+        std::vector<Candidate> candidates;
+
+        double baseBits = 0.0;
+        QueryCostModel model(density);
+
+        for (auto dfEntry : terms)
+        {
+            const double frequency = dfEntry.GetFrequency();
+            Term::IdfX10 idf = Term::ComputeIdfX10(frequency, Term::c_maxIdfX10Value);
+            if (idf >= Term::c_maxIdfX10Value)
+            {
+                break;
+            }
+
+            RowConfiguration configuration = base.GetTreatment(idf);
+            const double bits =
+                QueryCostModel::GetBitsPerDocument(density, frequency, configuration);
+            baseBits += bits;
+
+            const Term::Hash hash = dfEntry.GetTerm().GetRawHash();
+            const double queryFrequency = queries.GetQueryFrequency(hash);
+            if (queryFrequency == 0.0)
+            {
+                continue;
+            }
+
+            model.Reset();
+            model.AddTerm(frequency, configuration);
+            const double baseCost = model.GetExpectedQuadwords();
+
+            // Candidates have one private row at rank 0 and, optionally, at
+            // the ranks the base configuration uses. Each may add one
+            // private row at another rank.
+            bool baseRanks[c_maxRankValue + 1] = {};
+            for (auto entry : configuration)
+            {
+                baseRanks[entry.GetRank()] = true;
+            }
+
+            RowConfiguration best;
+            double bestCost = baseCost;
+            for (size_t useBaseRanks = 0; useBaseRanks < 2; ++useBaseRanks)
+            {
+                for (Rank extra = 0; extra <= c_maxRankValue; ++extra)
+                {
+                    RowConfiguration candidate;
+                    for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+                    {
+                        if (rank == 0 ||
+                            rank == extra ||
+                            (useBaseRanks != 0 && baseRanks[rank]))
+                        {
+                            candidate.push_front(RowConfiguration::Entry(rank, 1));
+                        }
+                    }
+
+                    model.Reset();
+                    model.AddTerm(frequency, candidate, true);
+                    const double cost = model.GetExpectedQuadwords();
+                    if (cost < bestCost)
+                    {
+                        best = candidate;
+                        bestCost = cost;
+                    }
+                }
+            }
+
+            if (bestCost < baseCost)
+            {
+                const double benefit = queryFrequency * (baseCost - bestCost);
+                const double extraBits =
+                    QueryCostModel::GetBitsPerDocument(density, frequency, best, true)
+                    - bits;
+                candidates.push_back(
+                    Candidate { hash,
+                                best,
+                                (extraBits > 0.0) ?
+                                    benefit / extraBits :
+                                    std::numeric_limits<double>::infinity(),
+                                extraBits });
+            }
+        }
+
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [](Candidate const & a, Candidate const & b)
+        {
+            return a.m_benefitPerBit > b.m_benefitPerBit;
+        });
+
+        const double budget = memoryBudget * baseBits;
+        for (auto const & candidate : candidates)
+        {
+            if (m_extraBitsPerDocument + candidate.m_extraBits <= budget)
+            {
+                m_promoted.insert(std::make_pair(candidate.m_hash,
+                                                 candidate.m_configuration));
+                m_extraBitsPerDocument += candidate.m_extraBits;
+            }
+        }
+    }
+
+
+    RowConfiguration TreatmentQueryAdaptive::GetTreatment(Term::IdfX10 idf) const
+    {
+        return m_base.GetTreatment(idf);
+    }
+
+
+    RowConfiguration TreatmentQueryAdaptive::GetTreatment(Term::Hash hash,
+                                                          Term::IdfX10 idf) const
+    {
+        auto it = m_promoted.find(hash);
+        if (it != m_promoted.end())
+        {
+            return it->second;
+        }
+
+        return m_base.GetTreatment(idf);
+    }
+
+
+    bool TreatmentQueryAdaptive::IsPrivate(Term::Hash hash) const
+    {
+        return m_promoted.find(hash) != m_promoted.end();
+    }
+
+
+    bool TreatmentQueryAdaptive::IsAdhoc(Term::Hash hash, double frequency) const
+    {
+        // Terms frequent enough to need a private row stay explicit, since
+        // they would dominate the density of any adhoc row they shared. An
+        // empty query log says nothing about which terms are cold.
+        return m_queries.GetQueryCount() > 0 &&
+               frequency < m_density &&
+               m_queries.GetQueryFrequency(hash) == 0.0;
+    }
+
+
+    IQueryProfile const & TreatmentQueryAdaptive::GetQueryProfile() const
+    {
+        return m_queries;
+    }
+
+
+    size_t TreatmentQueryAdaptive::GetPromotedTermCount() const
+    {
+        return m_promoted.size();
+    }
+
+
+    double TreatmentQueryAdaptive::GetExtraBitsPerDocument() const
+    {
+        return m_extraBitsPerDocument;
+    }
+}
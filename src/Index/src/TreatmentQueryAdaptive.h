@@ -0,0 +1,99 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <unordered_map>                                // std::unordered_map member.
+
+#include "BitFunnel/Index/IQueryAdaptiveTreatment.h"    // Base class.
+
+
+namespace BitFunnel
+{
+    class IDocumentFrequencyTable;
+    class IQueryProfile;
+
+    //*************************************************************************
+    //
+    // TreatmentQueryAdaptive
+    //
+    // Adjusts a base ITermTreatment using query frequencies from a query log.
+    //
+    // For each term in the query log, the constructor compares the base
+    // configuration with configurations of private rows: one at rank 0,
+    // optionally one at each rank the base configuration uses, and
+    // optionally one at some other rank. It keeps the option with the fewest
+    // expected quadwords per query for the term according to
+    // QueryCostModel. Terms whose best option beats the base configuration
+    // are promoted in order of decreasing benefit per extra bit, where the
+    // benefit is the saving weighted by query frequency, until the extra
+    // bits per document reach the memory budget.
+    //
+    // Terms that never appear in the query log and whose rows would be
+    // shared are made adhoc.
+    //
+    //*************************************************************************
+    class TreatmentQueryAdaptive : public IQueryAdaptiveTreatment
+    {
+    public:
+        TreatmentQueryAdaptive(ITermTreatment const & base,
+                               IQueryProfile const & queries,
+                               IDocumentFrequencyTable const & terms,
+                               double density,
+                               double memoryBudget);
+
+        //
+        // ITermTreatment methods.
+        //
+
+        virtual RowConfiguration GetTreatment(Term::IdfX10 idf) const override;
+
+        //
+        // IQueryAdaptiveTreatment methods.
+        //
+
+        virtual RowConfiguration GetTreatment(Term::Hash hash,
+                                              Term::IdfX10 idf) const override;
+
+        virtual bool IsPrivate(Term::Hash hash) const override;
+
+        virtual bool IsAdhoc(Term::Hash hash, double frequency) const override;
+
+        virtual IQueryProfile const & GetQueryProfile() const override;
+
+        // Returns the number of terms given private rows.
+        size_t GetPromotedTermCount() const;
+
+        // Returns the extra bits per document used by the promoted terms.
+        double GetExtraBitsPerDocument() const;
+
+    private:
+        ITermTreatment const & m_base;
+        IQueryProfile const & m_queries;
+        double m_density;
+        double m_extraBitsPerDocument;
+
+        // Configurations of the promoted terms, all of whose rows are
+        // private.
+        std::unordered_map<Term::Hash, RowConfiguration> m_promoted;
+    };
+}
@@ -21,10 +21,14 @@
 // THE SOFTWARE.
 
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 
+#include "BitFunnel/Exceptions.h"
 #include "DocumentFrequencyTable.h"
+#include "DocumentFrequencyTableBuilder.h"
 #include "TermToText.h"
 
 
@@ -135,5 +139,181 @@ namespace BitFunnel
                 EXPECT_EQ(observed, expected);
             }
         }
+
+
+        // Ingests documents 0..documentCount-1 from several threads. Document
+        // d contains terms with hashes 1..(d % 10) + 1, so term h appears in
+        // a fraction (11 - h) / 10 of the documents. A small initial capacity
+        // forces the per-thread tables to grow.
+        static void IngestDocuments(DocumentFrequencyTableBuilder& builder,
+                                    size_t threadId,
+                                    size_t threadCount,
+                                    size_t documentCount)
+        {
+            for (size_t d = threadId; d < documentCount; d += threadCount)
+            {
+                for (Term::Hash h = 1; h <= (d % 10) + 1; ++h)
+                {
+                    builder.OnTerm(Term(h, 0, 1));
+                }
+                builder.OnDocumentEnter();
+            }
+        }
+
+
+        TEST(DocumentFrequencyTableBuilder, MultipleThreads)
+        {
+            const size_t threadCount = 4;
+            const size_t documentCount = 1000;
+            DocumentFrequencyTableBuilder builder(2);
+
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < threadCount; ++t)
+            {
+                threads.emplace_back(IngestDocuments,
+                                     std::ref(builder),
+                                     t,
+                                     threadCount,
+                                     documentCount);
+            }
+            for (auto & thread : threads)
+            {
+                thread.join();
+            }
+
+            std::stringstream frequencies;
+            builder.WriteFrequencies(frequencies, 0.0, nullptr);
+            DocumentFrequencyTable table(frequencies);
+
+            std::vector<bool> found(11, false);
+            size_t entryCount = 0;
+            for (auto entry : table)
+            {
+                auto hash = entry.GetTerm().GetRawHash();
+                ASSERT_GE(hash, 1u);
+                ASSERT_LE(hash, 10u);
+                EXPECT_FALSE(found[hash]);
+                found[hash] = true;
+                EXPECT_DOUBLE_EQ((11 - hash) / 10.0, entry.GetFrequency());
+                ++entryCount;
+            }
+            EXPECT_EQ(10u, entryCount);
+
+            // Cumulative counts are non-decreasing and reach all 10 terms by
+            // the last document.
+            std::stringstream cumulative;
+            builder.WriteCumulativeTermCounts(cumulative);
+            size_t previous = 0;
+            size_t lines = 0;
+            size_t document;
+            char comma;
+            size_t uniqueTerms;
+            while (cumulative >> document >> comma >> uniqueTerms)
+            {
+                EXPECT_EQ(lines, document);
+                EXPECT_GE(uniqueTerms, previous);
+                previous = uniqueTerms;
+                ++lines;
+            }
+            EXPECT_EQ(documentCount, lines);
+            EXPECT_EQ(10u, previous);
+        }
+
+
+        // Document d contains term h, for 1 <= h <= 10, when h divides d, so
+        // term h appears in 1 + 999 / h of the 1000 documents. Each document
+        // also contains a term that appears nowhere else. With room for only
+        // 200 terms, the sketch must count the frequent terms exactly and
+        // may only overestimate the frequencies of the rare terms it keeps.
+        TEST(DocumentFrequencyTableBuilder, Sketch)
+        {
+            const size_t documentCount = 1000;
+            const size_t maxTerms = 200;
+            const Term::Hash frequentTermCount = 10;
+            DocumentFrequencyTableBuilder builder(16, maxTerms);
+
+            for (size_t d = 0; d < documentCount; ++d)
+            {
+                for (Term::Hash h = 1; h <= frequentTermCount; ++h)
+                {
+                    if (d % h == 0)
+                    {
+                        builder.OnTerm(Term(h, 0, 1));
+                    }
+                }
+                builder.OnTerm(Term(frequentTermCount + 1 + d, 0, 1));
+                builder.OnDocumentEnter();
+            }
+
+            std::stringstream frequencies;
+            builder.WriteFrequencies(frequencies, 0.0, nullptr);
+            DocumentFrequencyTable table(frequencies);
+
+            EXPECT_LE(table.size(), maxTerms);
+
+            std::vector<bool> found(frequentTermCount + 1, false);
+            for (auto entry : table)
+            {
+                auto hash = entry.GetTerm().GetRawHash();
+                ASSERT_GE(hash, 1u);
+                if (hash <= frequentTermCount)
+                {
+                    found[hash] = true;
+                    const double expected =
+                        static_cast<double>(1 + (documentCount - 1) / hash) /
+                        documentCount;
+                    EXPECT_DOUBLE_EQ(expected, entry.GetFrequency());
+                }
+                else
+                {
+                    EXPECT_GE(entry.GetFrequency(), 1.0 / documentCount);
+                    EXPECT_LE(entry.GetFrequency(), 0.02);
+                }
+            }
+
+            for (Term::Hash h = 1; h <= frequentTermCount; ++h)
+            {
+                EXPECT_TRUE(found[h]);
+            }
+        }
+
+
+        // A sketch sized by GetMaxTermsForPostingError() never overestimates
+        // a count by more than maxPostingError times the number of postings
+        // recorded, even when most terms are too rare to stay in the table.
+        TEST(DocumentFrequencyTableBuilder, SketchErrorBound)
+        {
+            EXPECT_EQ(40u, DocumentFrequencyTableBuilder::GetMaxTermsForPostingError(0.05));
+            EXPECT_EQ(2u, DocumentFrequencyTableBuilder::GetMaxTermsForPostingError(1.0));
+            EXPECT_THROW(DocumentFrequencyTableBuilder::GetMaxTermsForPostingError(0.0),
+                         RecoverableError);
+            EXPECT_THROW(DocumentFrequencyTableBuilder::GetMaxTermsForPostingError(1.5),
+                         RecoverableError);
+
+            const double maxPostingErrors[] = { 0.2, 0.05, 0.01 };
+            for (auto maxPostingError : maxPostingErrors)
+            {
+                const size_t maxTerms =
+                    DocumentFrequencyTableBuilder::GetMaxTermsForPostingError(maxPostingError);
+                DocumentFrequencyTableBuilder builder(16, maxTerms);
+
+                const size_t documentCount = 2000;
+                const size_t termsPerDocument = 6;
+                for (size_t d = 0; d < documentCount; ++d)
+                {
+                    builder.OnTerm(Term(1, 0, 1));
+                    for (size_t j = 1; j < termsPerDocument; ++j)
+                    {
+                        builder.OnTerm(Term(2 + (d * 7 + j * 131) % 997, 0, 1));
+                    }
+                    builder.OnDocumentEnter();
+                }
+
+                std::stringstream counts;
+                const size_t error = builder.WritePartialCounts(counts);
+                EXPECT_GT(error, 0u);
+                EXPECT_LE(error, maxPostingError * documentCount * termsPerDocument);
+            }
+        }
     }
 }
@@ -109,7 +109,9 @@ namespace BitFunnel
                     *termTable,
                     docDataSchema,
                     *trackingAllocator,
-                    blockSize);
+                    blockSize,
+                    false,
+                    0);
         auto sliceCapacity = shard.GetSliceCapacity();
         Slice* currentSlice = nullptr;
         std::vector<Slice*> slices;
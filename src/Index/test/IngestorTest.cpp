@@ -32,9 +32,18 @@
 #include "BitFunnel/BitFunnelTypes.h"
 #include "BitFunnel/Configuration/IFileSystem.h"
 #include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IDocument.h"
+#include "BitFunnel/Index/IDocumentCache.h"
 #include "BitFunnel/Index/IIngestor.h"
 #include "BitFunnel/Index/IShard.h"
 #include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Index/ITermTable.h"
+#include "BitFunnel/Index/ITermTableCollection.h"
+#include "BitFunnel/Index/Row.h"
 #include "BitFunnel/Index/RowIdSequence.h"
 #include "BitFunnel/Mocks/Factories.h"
 #include "BitFunnel/Utilities/Primes.h"
@@ -275,6 +284,217 @@ namespace BitFunnel
     }
 
 
+    TEST(Ingestor, PerShardSliceCapacity)
+    {
+        const DocId c_maxDocId = 1000;
+        const ShardId c_shardCount = 2;
+
+        auto termTables = Factories::CreateTermTableCollection();
+        for (ShardId shard = 0; shard < c_shardCount; ++shard)
+        {
+            termTables->AddTermTable(
+                Factories::CreatePrimeFactorsTermTable(c_maxDocId, 0));
+        }
+        const DocIndex quantum =
+            Row::DocumentsInRank0Row(1, termTables->GetTermTable(0).GetMaxRankUsed());
+
+        // Documents with three or more distinct prime factors go to shard 1.
+        // Only shard 0 gets an explicit capacity.
+        auto shardDefinition = Factories::CreateShardDefinition();
+        shardDefinition->AddShard(0, 0.15);
+        shardDefinition->AddShard(3, 0.15);
+        shardDefinition->SetSliceCapacity(0, 2 * quantum);
+
+        auto fileSystem = Factories::CreateFileSystem();
+        auto index = Factories::CreateSimpleIndex(*fileSystem);
+        index->SetTermTableCollection(std::move(termTables));
+        index->SetShardDefinition(std::move(shardDefinition));
+        index->SetBlockAllocatorBufferSize(1ull << 24);
+        index->ConfigureAsMock(1, false);
+        index->StartIndex();
+
+        IIngestor & ingestor = index->GetIngestor();
+        EXPECT_EQ(ingestor.GetShard(0).GetSliceCapacity(), 2 * quantum);
+        EXPECT_EQ(ingestor.GetShard(1).GetSliceCapacity(), quantum);
+        EXPECT_GT(ingestor.GetShard(0).GetSliceBufferSize(),
+                  ingestor.GetShard(1).GetSliceBufferSize());
+
+        for (DocId docId = 0; docId <= c_maxDocId; ++docId)
+        {
+            auto document =
+                Factories::CreatePrimeFactorsDocument(index->GetConfiguration(),
+                                                      docId,
+                                                      c_maxDocId,
+                                                      0);
+            ingestor.Add(docId, *document);
+        }
+
+        // Both pools hand out buffers, and every document can still be
+        // found.
+        EXPECT_GT(ingestor.GetShard(0).GetSliceBuffers().size(), 0u);
+        EXPECT_GT(ingestor.GetShard(1).GetSliceBuffers().size(), 0u);
+        for (DocId docId = 0; docId <= c_maxDocId; ++docId)
+        {
+            EXPECT_TRUE(ingestor.Contains(docId));
+        }
+    }
+
+
+    TEST(Ingestor, OnlineResharding)
+    {
+        const DocId c_maxDocId = 1000;
+        const DocId c_firstBatch = 500;
+
+        auto termTables = Factories::CreateTermTableCollection();
+        termTables->AddTermTable(
+            Factories::CreatePrimeFactorsTermTable(c_maxDocId, 0));
+
+        auto shardDefinition = Factories::CreateShardDefinition();
+        shardDefinition->AddShard(0, 0.15);
+
+        auto fileSystem = Factories::CreateFileSystem();
+        auto index = Factories::CreateSimpleIndex(*fileSystem);
+        index->SetTermTableCollection(std::move(termTables));
+        index->SetShardDefinition(std::move(shardDefinition));
+        index->SetBlockAllocatorBufferSize(1ull << 24);
+        index->ConfigureAsMock(1, false);
+        index->StartIndex();
+
+        IIngestor & ingestor = index->GetIngestor();
+        std::vector<size_t> postingCounts;
+        auto ingest = [&](DocId docId)
+        {
+            auto document =
+                Factories::CreatePrimeFactorsDocument(index->GetConfiguration(),
+                                                      docId,
+                                                      c_maxDocId,
+                                                      0);
+            postingCounts.push_back(document->GetPostingCount());
+            ingestor.Add(docId, *document);
+            ingestor.GetDocumentCache().Add(std::move(document), docId);
+        };
+
+        for (DocId docId = 0; docId < c_firstBatch; ++docId)
+        {
+            ingest(docId);
+        }
+
+        // Split off documents with three or more postings.
+        const size_t c_boundary = 3;
+        EXPECT_EQ(ingestor.AddShard(c_boundary), 1u);
+        EXPECT_THROW(ingestor.AddShard(c_boundary), RecoverableError);
+        ASSERT_EQ(ingestor.GetShardCount(), 2u);
+        EXPECT_EQ(ingestor.GetShardForPostingCount(c_boundary - 1), 0u);
+        EXPECT_EQ(ingestor.GetShardForPostingCount(c_boundary), 1u);
+        EXPECT_EQ(ingestor.GetShardForPostingCount(c_maxDocId), 1u);
+        EXPECT_EQ(&index->GetTermTable(1), &index->GetTermTable(0));
+
+        // New documents go to the new shard right away.
+        for (DocId docId = c_firstBatch; docId <= c_maxDocId; ++docId)
+        {
+            ingest(docId);
+            EXPECT_EQ(ingestor.GetHandle(docId).GetShardId(),
+                      ingestor.GetShardForPostingCount(postingCounts[docId]));
+        }
+
+        // Earlier documents move when migrated.
+        size_t expectedMoves = 0;
+        for (DocId docId = 0; docId < c_firstBatch; ++docId)
+        {
+            EXPECT_EQ(ingestor.GetHandle(docId).GetShardId(), 0u);
+            if (postingCounts[docId] >= c_boundary)
+            {
+                ++expectedMoves;
+            }
+        }
+        ASSERT_GT(expectedMoves, 0u);
+        EXPECT_EQ(ingestor.MigrateDocuments(), expectedMoves);
+        EXPECT_EQ(ingestor.MigrateDocuments(), 0u);
+
+        for (DocId docId = 0; docId <= c_maxDocId; ++docId)
+        {
+            ASSERT_TRUE(ingestor.Contains(docId));
+            DocumentHandle handle = ingestor.GetHandle(docId);
+            EXPECT_TRUE(handle.IsActive());
+            EXPECT_EQ(handle.GetShardId(),
+                      ingestor.GetShardForPostingCount(postingCounts[docId]));
+        }
+        EXPECT_EQ(ingestor.GetDocumentCount(), c_maxDocId + 1);
+
+        // With every document ingested, the live histogram favors splitting
+        // the first shard as well.
+        EXPECT_EQ(ingestor.ProposeShardBoundary(1.0), 2u);
+    }
+
+
+    TEST(Ingestor, SaveAddedShards)
+    {
+        const DocId c_maxDocId = 100;
+        const size_t c_boundary = 3;
+
+        auto fileSystem = Factories::CreateRAMFileSystem();
+        auto fileManager = Factories::CreateFileManager("config",
+                                                        "statistics",
+                                                        "index",
+                                                        *fileSystem);
+
+        auto createIndex = [&]()
+        {
+            auto termTables = Factories::CreateTermTableCollection();
+            termTables->AddTermTable(
+                Factories::CreatePrimeFactorsTermTable(c_maxDocId, 0));
+
+            auto shardDefinition = Factories::CreateShardDefinition();
+            shardDefinition->AddShard(0, 0.15);
+
+            auto index = Factories::CreateSimpleIndex(*fileSystem);
+            index->SetTermTableCollection(std::move(termTables));
+            index->SetShardDefinition(std::move(shardDefinition));
+            index->SetBlockAllocatorBufferSize(1ull << 24);
+            index->ConfigureAsMock(1, false);
+            index->StartIndex();
+            return index;
+        };
+
+        std::vector<size_t> sliceCounts;
+        {
+            auto index = createIndex();
+            IIngestor & ingestor = index->GetIngestor();
+            ingestor.AddShard(c_boundary);
+            for (DocId docId = 0; docId <= c_maxDocId; ++docId)
+            {
+                auto document =
+                    Factories::CreatePrimeFactorsDocument(index->GetConfiguration(),
+                                                          docId,
+                                                          c_maxDocId,
+                                                          0);
+                ingestor.Add(docId, *document);
+            }
+
+            for (ShardId shard = 0; shard < ingestor.GetShardCount(); ++shard)
+            {
+                sliceCounts.push_back(
+                    ingestor.GetShard(shard).GetSliceBuffers().size());
+            }
+            ingestor.TemporaryWriteAllSlices(*fileManager);
+        }
+
+        auto index = createIndex();
+        IIngestor & ingestor = index->GetIngestor();
+        ingestor.TemporaryReadAllSlices(*fileManager);
+
+        ASSERT_EQ(ingestor.GetShardCount(), 2u);
+        EXPECT_EQ(ingestor.GetShardForPostingCount(c_boundary - 1), 0u);
+        EXPECT_EQ(ingestor.GetShardForPostingCount(c_boundary), 1u);
+        for (ShardId shard = 0; shard < ingestor.GetShardCount(); ++shard)
+        {
+            EXPECT_EQ(ingestor.GetShard(shard).GetSliceBuffers().size(),
+                      sliceCounts[shard]);
+        }
+        EXPECT_EQ(ingestor.GetDocumentCount(), c_maxDocId + 1);
+    }
+
+
     TEST(Ingestor, BasicMultiShard)
     {
         const int c_maxDocId = 63;
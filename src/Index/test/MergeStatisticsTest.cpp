@@ -0,0 +1,178 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/MergeStatistics.h"
+#include "DocumentFrequencyTable.h"
+#include "DocumentFrequencyTableBuilder.h"
+
+
+namespace BitFunnel
+{
+    namespace MergeStatisticsTest
+    {
+        // Document d contains term h when h divides d + 1.
+        static void AddDocuments(DocumentFrequencyTableBuilder& builder,
+                                 size_t begin,
+                                 size_t end)
+        {
+            for (size_t d = begin; d < end; ++d)
+            {
+                for (Term::Hash h = 1; h <= 100; ++h)
+                {
+                    if ((d + 1) % h == 0)
+                    {
+                        builder.OnTerm(Term(h, 0, 1));
+                    }
+                }
+                builder.OnDocumentEnter();
+            }
+        }
+
+
+        static std::unique_ptr<IFileManager>
+            CreateFileManager(IFileSystem& fileSystem, char const * directory)
+        {
+            return Factories::CreateFileManager(directory,
+                                                directory,
+                                                directory,
+                                                fileSystem);
+        }
+
+
+        // Writes the files that IIngestor::WritePartialStatistics() would
+        // write for a single shard index.
+        static void WritePartial(IFileManager& fileManager,
+                                 DocumentFrequencyTableBuilder const & builder)
+        {
+            size_t maxError = 0;
+            {
+                auto out = fileManager.PartialDocFreqTable(0).OpenForWrite();
+                maxError = builder.WritePartialCounts(*out);
+            }
+            {
+                auto out = fileManager.PartialStatistics().OpenForWrite();
+                *out << "shard,documents,maxError" << std::endl
+                     << "0," << builder.GetDocumentCount()
+                     << "," << maxError << std::endl;
+            }
+            {
+                auto out = fileManager.DocumentHistogram().OpenForWrite();
+                *out << "Postings,Count" << std::endl
+                     << "3," << builder.GetDocumentCount() << std::endl;
+            }
+        }
+
+
+        static std::map<Term::Hash, double>
+            ReadFrequencies(std::istream& input)
+        {
+            DocumentFrequencyTable table(input);
+            std::map<Term::Hash, double> frequencies;
+            for (auto entry : table)
+            {
+                frequencies[entry.GetTerm().GetRawHash()] = entry.GetFrequency();
+            }
+            return frequencies;
+        }
+
+
+        // Merging three partitions of a corpus gives the same statistics
+        // as ingesting the entire corpus in one DocumentFrequencyTableBuilder.
+        TEST(MergeStatistics, MatchesSinglePass)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+
+            const std::vector<size_t> boundaries = { 0, 300, 301, 1000 };
+            std::vector<std::unique_ptr<IFileManager>> fileManagers;
+            std::vector<IFileManager*> partitions;
+            for (size_t p = 0; p + 1 < boundaries.size(); ++p)
+            {
+                std::string directory = "partition" + std::to_string(p);
+                fileManagers.push_back(
+                    CreateFileManager(*fileSystem, directory.c_str()));
+                partitions.push_back(fileManagers.back().get());
+
+                DocumentFrequencyTableBuilder builder;
+                AddDocuments(builder, boundaries[p], boundaries[p + 1]);
+                WritePartial(*partitions.back(), builder);
+            }
+
+            auto output = CreateFileManager(*fileSystem, "merged");
+            MergeStatistics(partitions, *output);
+
+            DocumentFrequencyTableBuilder expected;
+            AddDocuments(expected, boundaries.front(), boundaries.back());
+
+            std::stringstream expectedFrequencies;
+            expected.WriteFrequencies(expectedFrequencies, 0.0, nullptr);
+            auto observed =
+                ReadFrequencies(*output->DocFreqTable(0).OpenForRead());
+            EXPECT_EQ(ReadFrequencies(expectedFrequencies), observed);
+
+            std::stringstream expectedCounts;
+            expected.WriteCumulativeTermCounts(expectedCounts);
+            std::stringstream observedCounts;
+            observedCounts << output->CumulativeTermCounts(0).OpenForRead()->rdbuf();
+            EXPECT_EQ(expectedCounts.str(), observedCounts.str());
+
+            std::stringstream histogram;
+            histogram << output->DocumentHistogram().OpenForRead()->rdbuf();
+            EXPECT_EQ("Postings,Count\n3,1000\n", histogram.str());
+        }
+
+
+        TEST(MergeStatistics, ShardCountMismatch)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+
+            auto a = CreateFileManager(*fileSystem, "a");
+            auto b = CreateFileManager(*fileSystem, "b");
+
+            DocumentFrequencyTableBuilder builder;
+            AddDocuments(builder, 0, 10);
+            WritePartial(*a, builder);
+            WritePartial(*b, builder);
+            {
+                auto out = b->PartialStatistics().OpenForWrite();
+                *out << "shard,documents,maxError" << std::endl
+                     << "0,10,0" << std::endl
+                     << "1,10,0" << std::endl;
+            }
+
+            auto output = CreateFileManager(*fileSystem, "merged");
+            std::vector<IFileManager*> partitions = { a.get(), b.get() };
+            EXPECT_THROW(MergeStatistics(partitions, *output), RecoverableError);
+        }
+    }
+}
@@ -0,0 +1,130 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "PerThreadObjects.h"
+
+
+namespace BitFunnel
+{
+    namespace PerThreadObjectsTest
+    {
+        class Counter
+        {
+        public:
+            Counter(size_t start)
+              : m_value(start)
+            {
+            }
+
+            size_t m_value;
+        };
+
+
+        TEST(PerThreadObjects, OnePerThread)
+        {
+            const size_t c_threadCount = 4;
+            const size_t c_incrementCount = 1000;
+
+            PerThreadObjects<Counter> a;
+            PerThreadObjects<Counter> b;
+
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < c_threadCount; ++t)
+            {
+                threads.emplace_back([&]()
+                {
+                    for (size_t i = 0; i < c_incrementCount; ++i)
+                    {
+                        ++a.Get(0).m_value;
+                        b.Get(100).m_value += 2;
+                    }
+
+                    // The same thread always gets the same object.
+                    EXPECT_EQ(&a.Get(0), &a.Get(0));
+                    EXPECT_NE(static_cast<void*>(&a.Get(0)),
+                              static_cast<void*>(&b.Get(100)));
+                });
+            }
+            for (auto & thread : threads)
+            {
+                thread.join();
+            }
+
+            size_t count = 0;
+            a.ForEach([&](Counter const & counter)
+            {
+                ++count;
+                EXPECT_EQ(c_incrementCount, counter.m_value);
+            });
+            EXPECT_EQ(c_threadCount, count);
+
+            count = 0;
+            b.ForEach([&](Counter const & counter)
+            {
+                ++count;
+                EXPECT_EQ(100 + 2 * c_incrementCount, counter.m_value);
+            });
+            EXPECT_EQ(c_threadCount, count);
+        }
+
+
+        TEST(PerThreadObjects, ManyOwners)
+        {
+            // More owners than the thread local table holds, so some of them
+            // collide in the table.
+            const size_t c_ownerCount = 40;
+
+            std::vector<std::unique_ptr<PerThreadObjects<Counter>>> owners;
+            for (size_t i = 0; i < c_ownerCount; ++i)
+            {
+                owners.emplace_back(new PerThreadObjects<Counter>());
+            }
+
+            for (size_t round = 0; round < 3; ++round)
+            {
+                for (size_t i = 0; i < c_ownerCount; ++i)
+                {
+                    ++owners[i]->Get(i).m_value;
+                }
+            }
+
+            for (size_t i = 0; i < c_ownerCount; ++i)
+            {
+                size_t count = 0;
+                owners[i]->ForEach([&](Counter const & counter)
+                {
+                    ++count;
+                    EXPECT_EQ(i + 3, counter.m_value);
+                });
+                EXPECT_EQ(1u, count);
+            }
+        }
+    }
+}
@@ -0,0 +1,109 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "gtest/gtest.h"
+
+#include "RowIdCache.h"
+
+
+namespace BitFunnel
+{
+    namespace RowIdCacheTest
+    {
+        TEST(RowIdCache, HitAndMiss)
+        {
+            RowIdCache cache(16);
+
+            Term term(1234567, 1, 2);
+            EXPECT_EQ(nullptr, cache.Find(term));
+
+            const Rank ranks[] = { 0, 3, 0 };
+            const RowIndex rows[] = { 1, 20, 300 };
+            const ptrdiff_t offsets[] = { 100, 2000, 30000 };
+            cache.Insert(term, ranks, rows, offsets, 3);
+
+            RowIdCache::Entry const * entry = cache.Find(term);
+            ASSERT_NE(nullptr, entry);
+            ASSERT_EQ(3u, entry->m_rowCount);
+            for (size_t i = 0; i < 3; ++i)
+            {
+                EXPECT_EQ(ranks[i], entry->m_ranks[i]);
+                EXPECT_EQ(rows[i], entry->m_rows[i]);
+                EXPECT_EQ(offsets[i], entry->m_offsets[i]);
+            }
+
+            // Same hash with a different stream or gram size is a different
+            // term.
+            EXPECT_EQ(nullptr, cache.Find(Term(1234567, 0, 2)));
+            EXPECT_EQ(nullptr, cache.Find(Term(1234567, 1, 1)));
+
+            EXPECT_EQ(1u, cache.GetHitCount());
+            EXPECT_EQ(3u, cache.GetMissCount());
+        }
+
+
+        TEST(RowIdCache, Eviction)
+        {
+            // With a two entry cache, inserting three terms must evict at
+            // least one, and every term found must have its own rows.
+            RowIdCache cache(2);
+
+            for (Term::Hash hash = 1; hash <= 3; ++hash)
+            {
+                const Rank rank = 0;
+                const RowIndex row = hash;
+                const ptrdiff_t offset = static_cast<ptrdiff_t>(hash * 10);
+                cache.Insert(Term(hash, 0, 1), &rank, &row, &offset, 1);
+            }
+
+            size_t found = 0;
+            for (Term::Hash hash = 1; hash <= 3; ++hash)
+            {
+                RowIdCache::Entry const * entry = cache.Find(Term(hash, 0, 1));
+                if (entry != nullptr)
+                {
+                    ++found;
+                    EXPECT_EQ(static_cast<ptrdiff_t>(hash * 10),
+                              entry->m_offsets[0]);
+                }
+            }
+            EXPECT_LE(found, 2u);
+            EXPECT_GE(found, 1u);
+        }
+
+
+        TEST(RowIdCache, TooManyRows)
+        {
+            RowIdCache cache;
+
+            const size_t rowCount = RowIdCache::c_maxRowsPerEntry + 1;
+            Rank ranks[rowCount] = {};
+            RowIndex rows[rowCount] = {};
+            ptrdiff_t offsets[rowCount] = {};
+
+            Term term(98765, 0, 1);
+            cache.Insert(term, ranks, rows, offsets, rowCount);
+            EXPECT_EQ(nullptr, cache.Find(term));
+        }
+    }
+}
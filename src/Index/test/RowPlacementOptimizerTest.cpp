@@ -0,0 +1,160 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <sstream>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/RowIdSequence.h"
+#include "RowPlacementOptimizer.h"
+#include "TermTable.h"
+
+
+namespace BitFunnel
+{
+    namespace RowPlacementOptimizerTest
+    {
+        const Term::Hash c_firstHash = 1000ull;
+        const size_t c_termCount = 8;
+
+        // Builds a TermTable with one private rank 0 row per term.
+        void BuildTermTable(TermTable& termTable)
+        {
+            for (size_t i = 0; i < c_termCount; ++i)
+            {
+                termTable.OpenTerm();
+                termTable.AddRowId(
+                    RowId(0, static_cast<RowIndex>(ITermTable::SystemTerm::Count + i)));
+                termTable.CloseTerm(c_firstHash + i);
+            }
+            termTable.SetRowCounts(0, ITermTable::SystemTerm::Count + c_termCount, 10);
+            for (Rank rank = 1; rank <= c_maxRankValue; ++rank)
+            {
+                termTable.SetRowCounts(rank, 0, 0);
+            }
+            termTable.SetFactCount(0);
+            termTable.Seal();
+        }
+
+
+        std::vector<RowId> GetRows(ITermTable const & termTable,
+                                   std::vector<size_t> const & terms)
+        {
+            std::vector<RowId> rows;
+            for (auto t : terms)
+            {
+                RowIdSequence sequence(Term(c_firstHash + t, 0, 1), termTable);
+                rows.insert(rows.end(), sequence.begin(), sequence.end());
+            }
+            return rows;
+        }
+
+
+        TEST(RowPlacementOptimizer, CoQueriedRowsShareAPage)
+        {
+            TermTable termTable;
+            BuildTermTable(termTable);
+            ASSERT_EQ(c_termCount, termTable.GetExplicitRowCount(0));
+
+            // 16384 documents per slice gives 2KB rank 0 rows, two per page.
+            RowPlacementOptimizer optimizer(termTable, 16384);
+
+            // Each pair of terms sits on opposite ends of the row table.
+            const std::vector<std::vector<size_t>> queries = {
+                { 0, 7 }, { 1, 6 }, { 2, 5 }, { 3, 4 }
+            };
+            for (size_t repeat = 0; repeat < 3; ++repeat)
+            {
+                for (auto const & query : queries)
+                {
+                    optimizer.AddQuery(GetRows(termTable, query));
+                }
+            }
+
+            EXPECT_EQ(2.0, optimizer.GetMeanPagesBefore());
+
+            optimizer.Apply(termTable);
+
+            EXPECT_EQ(1.0, optimizer.GetMeanPagesAfter());
+
+            // The TermTable itself now places each pair on one page.
+            const size_t adhocRowCount = termTable.GetAdhocRowCount(0);
+            for (auto const & query : queries)
+            {
+                auto rows = GetRows(termTable, query);
+                ASSERT_EQ(2u, rows.size());
+                EXPECT_EQ((rows[0].GetIndex() - adhocRowCount) / 2,
+                          (rows[1].GetIndex() - adhocRowCount) / 2);
+            }
+
+            // System rows do not move.
+            RowIdSequence matchAll(ITermTable::GetMatchAllTerm(), termTable);
+            EXPECT_EQ(adhocRowCount + c_termCount + ITermTable::SystemTerm::MatchAll,
+                      (*matchAll.begin()).GetIndex());
+        }
+
+
+        TEST(RowPlacementOptimizer, RejectsInvalidPermutation)
+        {
+            TermTable termTable;
+            BuildTermTable(termTable);
+
+            std::vector<RowIndex> mapping(c_termCount, 0);
+            EXPECT_THROW(termTable.PermuteExplicitRows(0, mapping),
+                         RecoverableError);
+
+            mapping.pop_back();
+            EXPECT_THROW(termTable.PermuteExplicitRows(0, mapping),
+                         RecoverableError);
+        }
+
+
+        TEST(RowPlacementOptimizer, RejectsAttachedImage)
+        {
+            TermTable termTable;
+            BuildTermTable(termTable);
+
+            std::stringstream stream;
+            termTable.Write(stream);
+            const std::string image = stream.str();
+
+            std::vector<uint64_t> buffer((image.size() + 7) / 8);
+            memcpy(buffer.data(), image.data(), image.size());
+            const std::vector<uint64_t> original(buffer);
+
+            TermTable attached(buffer.data(), image.size());
+            std::vector<RowIndex> mapping;
+            for (size_t i = 0; i < c_termCount; ++i)
+            {
+                mapping.push_back(c_termCount - 1 - i);
+            }
+            EXPECT_THROW(attached.PermuteExplicitRows(0, mapping),
+                         RecoverableError);
+            EXPECT_EQ(original, buffer);
+        }
+    }
+}
@@ -20,16 +20,23 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
 #include <future>
 
 #include "gtest/gtest.h"
 
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
 #include "BitFunnel/Index/Factories.h"
 #include "BitFunnel/Index/Helpers.h"
+#include "BitFunnel/Index/IIngestor.h"
 #include "BitFunnel/Index/IRecycler.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
 #include "BitFunnel/Index/ISliceBufferAllocator.h"
 #include "BitFunnel/Index/ITermTable.h"
+#include "BitFunnel/Index/RowIdSequence.h"
 #include "BitFunnel/Index/Token.h"
+#include "BitFunnel/Mocks/Factories.h"
 #include "BitFunnel/Utilities/Factories.h"
 #include "DocumentDataSchema.h"
 #include "IndexUtils.h"
@@ -65,7 +72,9 @@ namespace BitFunnel
                         *termTable,
                         docDataSchema,
                         *trackingAllocator,
-                        blockSize);
+                        blockSize,
+                        false,
+                        0);
 
             auto sliceCapacity = shard.GetSliceCapacity();
             ASSERT_GT(sliceCapacity, 0u);
@@ -120,5 +129,207 @@ namespace BitFunnel
             recycler->Shutdown();
             background.wait();
         }
+
+
+        // Computes densities one bit at a time, as a reference for the
+        // quadword-at-a-time implementation of Shard::GetDensities().
+        std::vector<double> ExpectedDensities(Shard const & shard, Rank rank)
+        {
+            RowTableDescriptor const & rowTable = shard.GetRowTable(rank);
+            RowTableDescriptor const & rowTable0 = shard.GetRowTable(0);
+            const RowIndex active = shard.GetDocumentActiveRowId().GetIndex();
+            const DocIndex columnsPerBit = 1u << rank;
+
+            std::vector<double> densities;
+            for (RowIndex row = 0; row < rowTable.GetRowCount(); ++row)
+            {
+                size_t activeBitCount = 0;
+                size_t setBitCount = 0;
+                for (auto buffer : shard.GetSliceBuffers())
+                {
+                    // Visit each rank 0 quadword group that makes up one
+                    // quadword at the target rank.
+                    const DocIndex capacity = shard.GetSliceCapacity();
+                    for (DocIndex base = 0; base < capacity; base += 64 * columnsPerBit)
+                    {
+                        for (DocIndex bit = 0; bit < 64; ++bit)
+                        {
+                            bool isActive = false;
+                            for (DocIndex i = 0; i < columnsPerBit; ++i)
+                            {
+                                if (rowTable0.GetBit(buffer, active, base + i * 64 + bit) != 0)
+                                {
+                                    isActive = true;
+                                }
+                            }
+                            if (isActive)
+                            {
+                                ++activeBitCount;
+                                if (rowTable.GetBit(buffer, row, base + bit) != 0)
+                                {
+                                    ++setBitCount;
+                                }
+                            }
+                        }
+                    }
+                }
+                densities.push_back(
+                    (activeBitCount == 0) ?
+                    0.0 :
+                    static_cast<double>(setBitCount) / activeBitCount);
+            }
+
+            return densities;
+        }
+
+
+        TEST(Shard, GetDensities)
+        {
+            auto fileSystem = Factories::CreateFileSystem();
+            const DocId maxDocId = 2000;
+            auto index = Factories::CreatePrimeFactorsIndex(*fileSystem,
+                                                            maxDocId,
+                                                            0,
+                                                            1);
+            Shard const & shard =
+                dynamic_cast<Shard const &>(index->GetIngestor().GetShard(0));
+
+            // Make sure the test covers more than one slice.
+            ASSERT_GT(shard.GetSliceBuffers().size(), 1u);
+
+            for (Rank rank = 0; rank <= 2; ++rank)
+            {
+                auto expected = ExpectedDensities(shard, rank);
+                auto observed = shard.GetDensities(rank);
+
+                ASSERT_EQ(expected.size(), observed.size());
+                ASSERT_GT(observed.size(), 0u);
+                for (size_t row = 0; row < expected.size(); ++row)
+                {
+                    EXPECT_EQ(expected[row], observed[row]);
+                }
+            }
+
+            // Every document is active, so the density of the rank 0 row for
+            // the term "2" should be very close to 1/2.
+            RowIdSequence rows(Term(Term::ComputeRawHash("2"), 0, 0),
+                               index->GetTermTable(0));
+            const RowId row = *rows.begin();
+            ASSERT_EQ(row.GetRank(), 0u);
+            EXPECT_NEAR(shard.GetDensities(0)[row.GetIndex()], 0.5, 0.001);
+        }
+
+
+        TEST(Shard, RowSummary)
+        {
+            auto fileSystem = Factories::CreateFileSystem();
+            const DocId maxDocId = 2000;
+            auto index = Factories::CreatePrimeFactorsIndex(*fileSystem,
+                                                            maxDocId,
+                                                            0,
+                                                            1);
+            Shard const & shard =
+                dynamic_cast<Shard const &>(index->GetIngestor().GetShard(0));
+            ASSERT_GT(shard.GetSliceBuffers().size(), 1u);
+
+            // Nothing has been deleted, so a row's summary bit must be set
+            // exactly when the row has a set bit.
+            size_t emptyCount = 0;
+            for (Rank rank = 0; rank <= 2; ++rank)
+            {
+                RowTableDescriptor const & rowTable = shard.GetRowTable(rank);
+                const size_t quadwords = rowTable.GetQuadwordsPerRow();
+                for (auto buffer : shard.GetSliceBuffers())
+                {
+                    for (RowIndex row = 0; row < rowTable.GetRowCount(); ++row)
+                    {
+                        uint64_t const * data =
+                            rowTable.GetRowData(static_cast<void const *>(buffer), row);
+                        bool isEmpty = true;
+                        for (size_t i = 0; i < quadwords; ++i)
+                        {
+                            if (data[i] != 0)
+                            {
+                                isEmpty = false;
+                            }
+                        }
+                        EXPECT_EQ(isEmpty, rowTable.IsRowEmpty(buffer, row));
+                        EXPECT_EQ(rowTable.GetSummaryBitOffset(row),
+                                  shard.GetRowSummaryBitOffset(RowId(rank, row)));
+                        if (isEmpty)
+                        {
+                            ++emptyCount;
+                        }
+                    }
+                }
+            }
+
+            // Primes above the first slice's documents only have bits in
+            // later slices, so some rows must be empty in some slices.
+            EXPECT_GT(emptyCount, 0u);
+        }
+
+
+        TEST(Shard, ActiveDocumentEnumeration)
+        {
+            auto fileSystem = Factories::CreateFileSystem();
+            const DocId maxDocId = 2000;
+            auto index = Factories::CreatePrimeFactorsIndex(*fileSystem,
+                                                            maxDocId,
+                                                            0,
+                                                            1);
+            IIngestor & ingestor = index->GetIngestor();
+            IShard & shard = ingestor.GetShard(0);
+            ASSERT_GT(shard.GetSliceBuffers().size(), 1u);
+
+            // Delete a run of documents that spans whole quadwords, plus
+            // every third document, so that enumeration must skip both empty
+            // quadwords and individual bits.
+            std::vector<DocId> expected;
+            for (DocId id = 0; id <= maxDocId; ++id)
+            {
+                if ((id >= 100 && id < 400) || id % 3 == 0)
+                {
+                    ASSERT_TRUE(ingestor.Delete(id));
+                }
+                else
+                {
+                    expected.push_back(id);
+                }
+            }
+
+            std::vector<DocId> fromIterator;
+            {
+                auto itPtr = shard.GetIterator();
+                auto & it = *itPtr;
+                for (; !it.AtEnd(); ++it)
+                {
+                    fromIterator.push_back((*it).GetDocId());
+                }
+            }
+
+            const size_t c_batchSize = 7;
+            size_t batchCount = 0;
+            std::vector<DocId> fromForEach;
+            auto recordBatch = [&](std::vector<DocumentHandle> const & documents)
+            {
+                EXPECT_GT(documents.size(), 0u);
+                EXPECT_LE(documents.size(), c_batchSize);
+                ++batchCount;
+                for (auto const & document : documents)
+                {
+                    EXPECT_TRUE(document.IsActive());
+                    fromForEach.push_back(document.GetDocId());
+                }
+            };
+            shard.ForEachActive(recordBatch, c_batchSize);
+
+            std::sort(fromIterator.begin(), fromIterator.end());
+            std::sort(fromForEach.begin(), fromForEach.end());
+            EXPECT_EQ(expected, fromIterator);
+            EXPECT_EQ(expected, fromForEach);
+            EXPECT_EQ((expected.size() + c_batchSize - 1) / c_batchSize,
+                      batchCount);
+        }
     }
 }
@@ -351,6 +351,154 @@ private:
             // TODO: Verify facts
             // TODO: Verify row counts.
         }
+
+
+        void ExpectSameRows(IDocumentFrequencyTable const & terms,
+                            ITermTable const & expected,
+                            ITermTable const & observed)
+        {
+            for (auto term : terms)
+            {
+                RowIdSequence e(term.GetTerm(), expected);
+                RowIdSequence o(term.GetTerm(), observed);
+
+                EXPECT_TRUE(std::equal(o.begin(), o.end(), e.begin()));
+                EXPECT_TRUE(std::equal(e.begin(), e.end(), o.begin()));
+            }
+
+            for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+            {
+                EXPECT_EQ(expected.GetTotalRowCount(rank),
+                          observed.GetTotalRowCount(rank));
+            }
+        }
+
+
+        // Ranks draw from independent random number generators, so the
+        // table must not depend on how many threads assigned the rows.
+        TEST(TermTableBuilder, ThreadCountIndependent)
+        {
+            TestEnvironment environment;
+            double density = 0.1;
+            double adhocFrequency = 0.0001;
+            unsigned c_randomSkipDistance = 3;
+
+            TermTable serial;
+            TermTableBuilder serialBuilder(density,
+                                           adhocFrequency,
+                                           environment.GetTermTreatment(),
+                                           environment.GetDocFrequencyTable(),
+                                           environment.GetFactSet(),
+                                           serial,
+                                           c_randomSkipDistance,
+                                           1);
+
+            TermTable parallel;
+            TermTableBuilder parallelBuilder(density,
+                                             adhocFrequency,
+                                             environment.GetTermTreatment(),
+                                             environment.GetDocFrequencyTable(),
+                                             environment.GetFactSet(),
+                                             parallel,
+                                             c_randomSkipDistance,
+                                             4);
+
+            ExpectSameRows(environment.GetDocFrequencyTable(), serial, parallel);
+            EXPECT_TRUE(serial == parallel);
+        }
+
+
+        TEST(TermTableBuilder, Incremental)
+        {
+            TestEnvironment environment;
+            ITermTreatment const & treatment = environment.GetTermTreatment();
+            DocumentFrequencyTable const & terms =
+                environment.GetDocFrequencyTable();
+            double density = 0.1;
+            double adhocFrequency = 0.0001;
+            unsigned c_randomSkipDistance = 0;
+
+            TermTable previous;
+            TermTableBuilder builder(density,
+                                     adhocFrequency,
+                                     treatment,
+                                     terms,
+                                     environment.GetFactSet(),
+                                     previous,
+                                     c_randomSkipDistance);
+
+            // Rebuilding from the same frequencies retains every term.
+            {
+                TermTable termTable;
+                TermTableBuilder incremental(density,
+                                             adhocFrequency,
+                                             treatment,
+                                             terms,
+                                             environment.GetFactSet(),
+                                             previous,
+                                             termTable,
+                                             c_randomSkipDistance,
+                                             2);
+
+                EXPECT_EQ(terms.size(), incremental.GetRetainedTermCount());
+                EXPECT_EQ(0u, incremental.GetAssignedTermCount());
+                ExpectSameRows(terms, previous, termTable);
+            }
+
+            // Drop the 0.07 term and add a new 0.05 term. The remaining terms
+            // keep their rows and the new term is packed into the space the
+            // dropped term freed up, next to the 0.02 term.
+            {
+                const Term removed(1002ull, 1, 1);
+                const Term added(2000ull, 1, 1);
+                const Term neighbor(1004ull, 1, 1);
+
+                DocumentFrequencyTable updated;
+                for (auto entry : terms)
+                {
+                    if (entry.GetTerm() == removed)
+                    {
+                        continue;
+                    }
+                    updated.AddEntry(entry);
+                    if (entry.GetFrequency() == 0.05)
+                    {
+                        updated.AddEntry(
+                            DocumentFrequencyTable::Entry(added, 0.05));
+                    }
+                }
+
+                TermTable termTable;
+                TermTableBuilder incremental(density,
+                                             adhocFrequency,
+                                             treatment,
+                                             updated,
+                                             environment.GetFactSet(),
+                                             previous,
+                                             termTable,
+                                             c_randomSkipDistance);
+
+                EXPECT_EQ(updated.size() - 1, incremental.GetRetainedTermCount());
+                EXPECT_EQ(1u, incremental.GetAssignedTermCount());
+
+                for (auto entry : updated)
+                {
+                    if (entry.GetTerm() == added)
+                    {
+                        continue;
+                    }
+                    RowIdSequence e(entry.GetTerm(), previous);
+                    RowIdSequence o(entry.GetTerm(), termTable);
+                    EXPECT_TRUE(std::equal(o.begin(), o.end(), e.begin()));
+                }
+
+                RowIdSequence addedRows(added, termTable);
+                RowIdSequence neighborRows(neighbor, termTable);
+                EXPECT_TRUE(std::equal(addedRows.begin(),
+                                       addedRows.end(),
+                                       neighborRows.begin()));
+            }
+        }
     }
 }
 #ifdef _MSC_VER
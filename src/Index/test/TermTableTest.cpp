@@ -21,9 +21,12 @@
 // THE SOFTWARE.
 
 #include <sstream>
+#include <string.h>
+#include <vector>
 
 #include "gtest/gtest.h"
 
+#include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/RowIdSequence.h"
 #include "TermTable.h"
 
@@ -453,9 +456,158 @@ namespace BitFunnel
         //
         //*********************************************************************
 
+        static void VerifySameRows(Term const & term,
+                                   ITermTable const & expected,
+                                   ITermTable const & observed)
+        {
+            RowIdSequence expectedRows(term, expected);
+            RowIdSequence observedRows(term, observed);
+            std::vector<RowId> a(expectedRows.begin(), expectedRows.end());
+            std::vector<RowId> b(observedRows.begin(), observedRows.end());
+            EXPECT_EQ(a, b);
+            EXPECT_EQ(expected.GetIdf(term.GetRawHash()),
+                      observed.GetIdf(term.GetRawHash()));
+        }
+
+
         TEST(TermTable, RoundTrip)
         {
-            // TODO: Implement this test.
+            const Term::Hash c_firstExplicit = 1000ull;
+            const Term::Hash c_firstAdhoc = 1500ull;
+            const size_t c_termCount = 1000;
+
+            TermTable termTable;
+
+            // Explicit terms [1000, 2000) and adhoc terms [1500, 2500), so
+            // that half of the adhoc terms are also explicit.
+            for (size_t i = 0; i < c_termCount; ++i)
+            {
+                termTable.OpenTerm();
+                for (size_t r = 0; r <= (i % 3); ++r)
+                {
+                    termTable.AddRowId(RowId((i + r) % 2 == 0 ? 0 : 3, i + r));
+                }
+                termTable.CloseTerm(c_firstExplicit + i);
+
+                termTable.AddAdhocTerm(
+                    c_firstAdhoc + i,
+                    static_cast<Term::IdfX10>(i % (Term::c_maxIdfX10Value + 1)));
+            }
+
+            for (Term::IdfX10 idf = 0; idf <= Term::c_maxIdfX10Value; ++idf)
+            {
+                termTable.OpenTerm();
+                termTable.AddRowId(RowId(0, 0));
+                termTable.AddRowId(RowId(3, 0));
+                termTable.CloseAdhocTerm(idf, 1);
+            }
+
+            termTable.SetRowCounts(0, 2000, 321);
+            termTable.SetRowCounts(3, 2000, 123);
+            termTable.SetFactCount(5);
+            termTable.Seal();
+
+            std::stringstream stream;
+            termTable.Write(stream);
+            const std::string image = stream.str();
+
+            TermTable fromStream(stream);
+            EXPECT_EQ(termTable, fromStream);
+
+            // Attach a second TermTable directly to a copy of the image, as
+            // would be done with a memory mapped file.
+            std::vector<uint64_t> buffer((image.size() + 7) / 8);
+            memcpy(buffer.data(), image.data(), image.size());
+            TermTable fromImage(buffer.data(), image.size());
+            EXPECT_EQ(termTable, fromImage);
+
+            for (Rank rank = 0; rank <= c_maxRankValue; ++rank)
+            {
+                EXPECT_EQ(termTable.IsRankUsed(rank), fromImage.IsRankUsed(rank));
+                EXPECT_EQ(termTable.GetTotalRowCount(rank),
+                          fromImage.GetTotalRowCount(rank));
+            }
+            EXPECT_EQ(termTable.GetMaxRankUsed(), fromImage.GetMaxRankUsed());
+
+            for (Term::Hash hash = 0; hash < 3000; ++hash)
+            {
+                Term term(hash, 0, 1);
+                VerifySameRows(term, termTable, fromStream);
+                VerifySameRows(term, termTable, fromImage);
+            }
+            VerifySameRows(ITermTable::GetDocumentActiveTerm(), termTable, fromImage);
+
+            const Term::IdfX10 maxIdf = Term::c_maxIdfX10Value;
+            EXPECT_EQ(1, termTable.GetIdf(c_firstAdhoc + 1));
+            EXPECT_EQ(maxIdf, termTable.GetIdf(c_firstExplicit));
+        }
+
+
+        TEST(TermTable, InvalidImage)
+        {
+            TermTable termTable;
+            termTable.Seal();
+
+            std::stringstream stream;
+            termTable.Write(stream);
+            std::string image = stream.str();
+
+            std::vector<uint64_t> buffer((image.size() + 7) / 8 + 1);
+            memcpy(buffer.data(), image.data(), image.size());
+
+            // Truncated image.
+            EXPECT_THROW(TermTable(buffer.data(), image.size() - 8),
+                         RecoverableError);
+
+            // Misaligned image.
+            memcpy(reinterpret_cast<char*>(buffer.data()) + 4,
+                   image.data(),
+                   image.size());
+            EXPECT_THROW(
+                TermTable(reinterpret_cast<char*>(buffer.data()) + 4, image.size()),
+                RecoverableError);
+
+            // Bad magic.
+            image[0] = 'X';
+            std::stringstream badStream(image);
+            EXPECT_THROW(TermTable table(badStream), RecoverableError);
+        }
+
+
+        TEST(TermTable, FullImage)
+        {
+            TermTable termTable;
+            termTable.Seal();
+
+            std::stringstream stream;
+            termTable.Write(stream);
+            const std::string image = stream.str();
+
+            std::vector<uint64_t> buffer((image.size() + 7) / 8);
+            memcpy(buffer.data(), image.data(), image.size());
+
+            // Corrupt the image so that every slot holds some other term.
+            // The header starts with the magic number, the byte count, the
+            // slot count and the RowId count. The slots are 16 bytes each,
+            // with the hash in the first 8 bytes and the flags in byte 13,
+            // and come just before the RowIds.
+            const size_t slotCount = buffer[2];
+            const size_t rowIdBytes =
+                (buffer[3] * sizeof(RowId) + sizeof(uint64_t) - 1) /
+                sizeof(uint64_t) * sizeof(uint64_t);
+            char * slots = reinterpret_cast<char*>(buffer.data()) +
+                image.size() - rowIdBytes - slotCount * 16;
+            for (size_t i = 0; i < slotCount; ++i)
+            {
+                const Term::Hash other = 0xFFFFFFFFFFFFFFFFull - i;
+                memcpy(slots + i * 16, &other, sizeof(other));
+                slots[i * 16 + 13] = 1;
+            }
+
+            // Lookups must terminate rather than probe forever.
+            TermTable fromImage(buffer.data(), image.size());
+            const Term::IdfX10 maxIdf = Term::c_maxIdfX10Value;
+            EXPECT_EQ(maxIdf, fromImage.GetIdf(12345ull));
         }
     }
 }
@@ -20,6 +20,9 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "BitFunnel/Term.h"
@@ -39,4 +42,72 @@ namespace BitFunnel
         EXPECT_EQ(Term::ComputeMaxRank(1.0, 0.1), 0u);
         EXPECT_GE(Term::ComputeMaxRank(Term::IdfX10ToFrequency(Term::c_maxIdfX10Value), 0.1), 6u);
     }
+
+
+    TEST(ComputeRawHashes, MatchesComputeRawHash)
+    {
+        // Texts of every length up to 30 characters, in a batch whose size
+        // is not a multiple of four.
+        std::vector<std::string> strings;
+        for (size_t length = 0; length <= 30; ++length)
+        {
+            strings.push_back(std::string(length, static_cast<char>('a' + length % 26)));
+        }
+
+        std::vector<char const *> texts;
+        std::vector<size_t> lengths;
+        for (auto const & text : strings)
+        {
+            texts.push_back(text.c_str());
+            lengths.push_back(text.size());
+        }
+
+        std::vector<Term::Hash> hashes(texts.size());
+        Term::ComputeRawHashes(texts.data(),
+                               lengths.data(),
+                               texts.size(),
+                               hashes.data());
+
+        for (size_t i = 0; i < texts.size(); ++i)
+        {
+            EXPECT_EQ(Term::ComputeRawHash(texts[i]), hashes[i]);
+        }
+
+        const Term::HashFunction functions[] = {
+            Term::HashFunction::MurmurHash64A,
+            Term::HashFunction::XXHash64
+        };
+        for (auto function : functions)
+        {
+            Term::ComputeRawHashes(texts.data(),
+                                   lengths.data(),
+                                   texts.size(),
+                                   function,
+                                   hashes.data());
+
+            for (size_t i = 0; i < texts.size(); ++i)
+            {
+                EXPECT_EQ(Term::ComputeRawHash(texts[i], function), hashes[i]);
+            }
+        }
+    }
+
+
+    TEST(ComputeRawHash, HashFunctions)
+    {
+        // The default must stay MurmurHash64A so that existing term tables
+        // and statistics remain valid.
+        EXPECT_EQ(Term::ComputeRawHash("hello"),
+                  Term::ComputeRawHash("hello", Term::HashFunction::MurmurHash64A));
+        EXPECT_NE(Term::ComputeRawHash("hello", Term::HashFunction::MurmurHash64A),
+                  Term::ComputeRawHash("hello", Term::HashFunction::XXHash64));
+    }
+
+
+    TEST(ExtendNGramHash, MatchesAddTerm)
+    {
+        const Term::Hash a = 0x8000000000000001ull;
+        const Term::Hash b = 0x1234567890abcdefull;
+        EXPECT_EQ(((a << 1) | (a >> 63)) ^ b, Term::ExtendNGramHash(a, b));
+    }
 }
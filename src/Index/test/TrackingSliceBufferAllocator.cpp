@@ -75,4 +75,11 @@ namespace BitFunnel
     {
         return m_blockSize;
     }
+
+
+    size_t TrackingSliceBufferAllocator::GetTotalBuffersCount() const
+    {
+        // Buffers come from malloc() rather than a fixed pool.
+        return 0;
+    }
 }
@@ -38,11 +38,11 @@ namespace BitFunnel
     public:
         TrackingSliceBufferAllocator(size_t blockSize);
 
-        size_t GetInUseBuffersCount() const;
-
         virtual void* Allocate(size_t byteSize) override;
         virtual void Release(void* buffer) override;
         virtual size_t GetSliceBufferSize() const override;
+        virtual size_t GetInUseBuffersCount() const override;
+        virtual size_t GetTotalBuffersCount() const override;
 
     private:
         mutable std::mutex m_lock;
@@ -0,0 +1,240 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IQueryAdaptiveTreatment.h"
+#include "BitFunnel/Index/IQueryProfile.h"
+#include "BitFunnel/Index/ITermTreatmentFactory.h"
+#include "DocumentFrequencyTable.h"
+#include "FactSetBase.h"
+#include "QueryCostModel.h"
+#include "TermTable.h"
+#include "TermTableBuilder.h"
+#include "TreatmentQueryAdaptive.h"
+
+
+namespace BitFunnel
+{
+    namespace TreatmentQueryAdaptiveTest
+    {
+        const double c_density = 0.1;
+        const Term::Hash c_commonTerm = 100;
+        const Term::Hash c_firstTerm = 200;
+        const Term::Hash c_termCount = 100;
+        const Term::Hash c_hotTerm = 1000;
+
+
+        // A frequency table with one term common enough for a private row,
+        // c_termCount terms that share rows, and one rare term that is
+        // frequently queried.
+        std::unique_ptr<DocumentFrequencyTable> CreateTerms()
+        {
+            std::unique_ptr<DocumentFrequencyTable> terms(new DocumentFrequencyTable());
+            terms->AddEntry(IDocumentFrequencyTable::Entry(Term(c_commonTerm, 0, 1), 0.3));
+            for (Term::Hash hash = c_firstTerm; hash < c_firstTerm + c_termCount; ++hash)
+            {
+                terms->AddEntry(IDocumentFrequencyTable::Entry(Term(hash, 0, 1), 0.02));
+            }
+            terms->AddEntry(IDocumentFrequencyTable::Entry(Term(c_hotTerm, 0, 1), 0.005));
+            return terms;
+        }
+
+
+        std::unique_ptr<IQueryProfile> CreateQueries()
+        {
+            auto queries = Factories::CreateQueryProfile();
+            for (size_t i = 0; i < 9; ++i)
+            {
+                queries->AddQuery({ c_hotTerm });
+            }
+            queries->AddQuery({ c_firstTerm, c_hotTerm, c_firstTerm });
+            return queries;
+        }
+
+
+        TEST(QueryProfile, Basic)
+        {
+            auto queries = CreateQueries();
+
+            EXPECT_EQ(10u, queries->GetQueryCount());
+            EXPECT_EQ(1.0, queries->GetQueryFrequency(c_hotTerm));
+            EXPECT_EQ(0.1, queries->GetQueryFrequency(c_firstTerm));
+            EXPECT_EQ(0.0, queries->GetQueryFrequency(c_commonTerm));
+
+            // Repeated terms are recorded once.
+            EXPECT_EQ(2u, queries->GetQueries().back().size());
+        }
+
+
+        TEST(QueryCostModel, PrivateRowsReadFewerQuadwords)
+        {
+            RowConfiguration shared;
+            shared.push_front(RowConfiguration::Entry(0, 3));
+
+            QueryCostModel model(c_density);
+            model.AddTerm(0.005, shared);
+            const double sharedCost = model.GetExpectedQuadwords();
+
+            model.Reset();
+            model.AddTerm(0.005, shared, true);
+            const double privateCost = model.GetExpectedQuadwords();
+
+            // The first row is always read.
+            EXPECT_EQ(1.0, privateCost);
+            EXPECT_GT(sharedCost, privateCost);
+
+            // But the private row costs a whole bit per document.
+            EXPECT_EQ(1.0,
+                      QueryCostModel::GetBitsPerDocument(c_density, 0.005, shared, true));
+            EXPECT_LT(QueryCostModel::GetBitsPerDocument(c_density, 0.005, shared),
+                      1.0);
+        }
+
+
+        TEST(TreatmentQueryAdaptive, Budget)
+        {
+            auto terms = CreateTerms();
+            auto queries = CreateQueries();
+            auto treatments = Factories::CreateTreatmentFactory();
+            auto base = treatments->CreateTreatment("PrivateSharedRank0",
+                                                    c_density,
+                                                    10.0);
+            const Term::IdfX10 hotIdf =
+                Term::ComputeIdfX10(0.005, Term::c_maxIdfX10Value);
+
+            // With no budget, nothing is promoted.
+            {
+                TreatmentQueryAdaptive treatment(*base, *queries, *terms, c_density, 0.0);
+                EXPECT_EQ(0u, treatment.GetPromotedTermCount());
+                EXPECT_FALSE(treatment.IsPrivate(c_hotTerm));
+                EXPECT_EQ(base->GetTreatment(hotIdf),
+                          treatment.GetTreatment(c_hotTerm, hotIdf));
+            }
+
+            // With enough budget, the hot term gets a private rank 0 row.
+            {
+                TreatmentQueryAdaptive treatment(*base, *queries, *terms, c_density, 1.0);
+                EXPECT_TRUE(treatment.IsPrivate(c_hotTerm));
+                EXPECT_GT(treatment.GetExtraBitsPerDocument(), 0.0);
+
+                bool hasRank0 = false;
+                for (auto entry : treatment.GetTreatment(c_hotTerm, hotIdf))
+                {
+                    EXPECT_EQ(1u, entry.GetRowCount());
+                    hasRank0 |= (entry.GetRank() == 0);
+                }
+                EXPECT_TRUE(hasRank0);
+
+                // Adhoc terms still use the base treatment.
+                EXPECT_EQ(base->GetTreatment(hotIdf),
+                          treatment.GetTreatment(hotIdf));
+            }
+        }
+
+
+        TEST(TreatmentQueryAdaptive, IsAdhoc)
+        {
+            auto terms = CreateTerms();
+            auto queries = CreateQueries();
+            auto treatments = Factories::CreateTreatmentFactory();
+            auto base = treatments->CreateTreatment("PrivateSharedRank0",
+                                                    c_density,
+                                                    10.0);
+
+            TreatmentQueryAdaptive treatment(*base, *queries, *terms, c_density, 1.0);
+
+            // Unqueried terms with shared rows become adhoc.
+            EXPECT_TRUE(treatment.IsAdhoc(c_firstTerm + 1, 0.02));
+
+            // Queried terms and terms with private rows do not.
+            EXPECT_FALSE(treatment.IsAdhoc(c_firstTerm, 0.02));
+            EXPECT_FALSE(treatment.IsAdhoc(c_commonTerm, 0.3));
+
+            // An empty query log says nothing about which terms are cold.
+            auto empty = Factories::CreateQueryProfile();
+            TreatmentQueryAdaptive emptyTreatment(*base, *empty, *terms, c_density, 1.0);
+            EXPECT_FALSE(emptyTreatment.IsAdhoc(c_firstTerm + 1, 0.02));
+        }
+
+
+        TEST(TreatmentQueryAdaptive, TermTableBuilder)
+        {
+            auto terms = CreateTerms();
+            auto queries = CreateQueries();
+            auto treatments = Factories::CreateTreatmentFactory();
+            auto base = treatments->CreateTreatment("PrivateSharedRank0",
+                                                    c_density,
+                                                    10.0);
+            FactSetBase facts;
+
+            const double adhocFrequency = 0.0;
+            const unsigned randomSkip = 0;
+
+            TermTable noBudgetTable;
+            TreatmentQueryAdaptive noBudget(*base, *queries, *terms, c_density, 0.0);
+            TermTableBuilder noBudgetBuilder(c_density,
+                                             adhocFrequency,
+                                             noBudget,
+                                             *terms,
+                                             facts,
+                                             noBudgetTable,
+                                             randomSkip);
+
+            TermTable table;
+            TreatmentQueryAdaptive adaptive(*base, *queries, *terms, c_density, 1.0);
+            TermTableBuilder builder(c_density,
+                                     adhocFrequency,
+                                     adaptive,
+                                     *terms,
+                                     facts,
+                                     table,
+                                     randomSkip);
+
+            // Unqueried terms with shared rows are adhoc. The hot term and
+            // the term with a private row are explicit.
+            auto explicitType = PackedRowIdSequence::Type::Explicit;
+            EXPECT_NE(explicitType, table.GetRows(Term(c_firstTerm + 1, 0, 1)).GetType());
+            EXPECT_EQ(explicitType, table.GetRows(Term(c_firstTerm, 0, 1)).GetType());
+            EXPECT_EQ(explicitType, table.GetRows(Term(c_hotTerm, 0, 1)).GetType());
+            EXPECT_EQ(explicitType, table.GetRows(Term(c_commonTerm, 0, 1)).GetType());
+
+            EXPECT_GT(noBudgetBuilder.GetExpectedQuadwordsPerQuery(), 0.0);
+            EXPECT_LT(builder.GetExpectedQuadwordsPerQuery(),
+                      noBudgetBuilder.GetExpectedQuadwordsPerQuery());
+
+            std::stringstream expected;
+            expected << "Private (frequently queried) terms: "
+                     << adaptive.GetPromotedTermCount() << std::endl
+                     << "  Adhoc (unqueried) terms: " << c_termCount - 1;
+
+            std::stringstream output;
+            builder.Print(output);
+            EXPECT_NE(std::string::npos, output.str().find(expected.str()));
+        }
+    }
+}
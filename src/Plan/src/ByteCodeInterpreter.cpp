@@ -30,8 +30,10 @@
 #include "BitFunnel/IDiagnosticStream.h"
 #include "BitFunnel/Index/DocumentHandle.h"
 #include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Plan/ExecutionProfile.h"
 #include "BitFunnel/Plan/QueryInstrumentation.h"
 #include "BitFunnel/Plan/ResultsBuffer.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
 #include "ByteCodeInterpreter.h"
 #include "CacheLineRecorder.h"
 
@@ -68,6 +70,33 @@ Decide on type of Slices
         IDiagnosticStream * diagnosticStream,
         QueryInstrumentation & instrumentation,
         size_t sliceBufferSize)
+      : ByteCodeInterpreter(code,
+                            resultsBuffer,
+                            sliceCount,
+                            sliceBuffers,
+                            iterationsPerSlice,
+                            initialRank,
+                            rowOffsets,
+                            diagnosticStream,
+                            instrumentation,
+                            sliceBufferSize,
+                            nullptr)
+    {
+    }
+
+
+    ByteCodeInterpreter::ByteCodeInterpreter(
+        ByteCodeGenerator const & code,
+        ResultsBuffer & resultsBuffer,
+        size_t sliceCount,
+        void * const * sliceBuffers,
+        size_t iterationsPerSlice,
+        Rank initialRank,
+        ptrdiff_t const * rowOffsets,
+        IDiagnosticStream * diagnosticStream,
+        QueryInstrumentation & instrumentation,
+        size_t sliceBufferSize,
+        ExecutionProfile * profile)
       : m_code(code.GetCode()),
         m_jumpTable(code.GetJumpTable()),
         m_resultsBuffer(resultsBuffer),
@@ -78,9 +107,12 @@ Decide on type of Slices
         m_rowOffsets(rowOffsets),
         m_dedupe(),
         m_diagnosticStream(diagnosticStream),
-        m_instrumentation(instrumentation)
+        m_instrumentation(instrumentation),
+        m_profile(profile),
+        m_lastRow(0)
     {
         m_cacheLineRecorder = sliceBufferSize ? new CacheLineRecorder(sliceBufferSize) : nullptr;
+        m_sliceStopwatch = (profile != nullptr) ? new Stopwatch() : nullptr;
     }
 
 
@@ -90,6 +122,11 @@ Decide on type of Slices
         {
             delete m_cacheLineRecorder;
         }
+
+        if (m_sliceStopwatch != nullptr)
+        {
+            delete m_sliceStopwatch;
+        }
     }
 
     bool ByteCodeInterpreter::Run()
@@ -120,6 +157,13 @@ Decide on type of Slices
 
         bool terminate = false;
 
+        size_t matchCount = 0;
+        if (m_profile != nullptr)
+        {
+            m_sliceStopwatch->Reset();
+            matchCount = m_resultsBuffer.size();
+        }
+
         for (size_t i = 0; i < m_iterationsPerSlice; ++i)
         {
             terminate = RunOneIteration(sliceBuffer, i);
@@ -129,6 +173,13 @@ Decide on type of Slices
             }
         }
 
+        if (m_profile != nullptr)
+        {
+            m_profile->RecordSlice(slice,
+                                   m_sliceStopwatch->ElapsedTime(),
+                                   m_resultsBuffer.size() - matchCount);
+        }
+
         if (m_cacheLineRecorder != nullptr)
         {
             m_instrumentation.IncrementCacheLineCount(
@@ -198,6 +249,12 @@ Decide on type of Slices
                     m_zeroFlag = (accumulator == 0);
                     ip++;
 
+                    if (m_profile != nullptr)
+                    {
+                        m_profile->RecordRowLoad(row, value, accumulator);
+                        m_lastRow = row;
+                    }
+
                     if (m_diagnosticStream != nullptr &&
                         m_diagnosticStream->IsEnabled("bytecode/loadrow"))
                     {
@@ -225,6 +282,12 @@ Decide on type of Slices
                     m_zeroFlag = (accumulator == 0);
                     ip++;
 
+                    if (m_profile != nullptr)
+                    {
+                        m_profile->RecordRowLoad(row, value, accumulator);
+                        m_lastRow = row;
+                    }
+
                     if (m_diagnosticStream != nullptr &&
                         m_diagnosticStream->IsEnabled("bytecode/loadrow"))
                     {
@@ -305,6 +368,12 @@ Decide on type of Slices
                 }
                 break;
             case Opcode::Jz:
+                if (m_profile != nullptr)
+                {
+                    m_profile->RecordJz(static_cast<size_t>(ip - m_code.data()),
+                                        m_lastRow,
+                                        accumulator == 0ull);
+                }
                 if (accumulator == 0ull)
                 {
                     ip = m_jumpTable[row];
@@ -37,7 +37,9 @@ namespace BitFunnel
     class CacheLineRecorder;
     class IDiagnosticStream;
     class QueryInstrumentation;
+    class ExecutionProfile;
     class ResultsBuffer;
+    class Stopwatch;
 
     //*************************************************************************
     //
@@ -74,6 +76,21 @@ namespace BitFunnel
                             QueryInstrumentation & instrumentation,
                             size_t sliceBufferSize);
 
+        // Also records the execution profile for 'explain analyze' in the
+        // profile, which may be nullptr. The caller is responsible for
+        // calling profile->StartShard() before Run().
+        ByteCodeInterpreter(ByteCodeGenerator const & code,
+                            ResultsBuffer & resultsBuffer,
+                            size_t sliceCount,
+                            void * const * sliceBuffers,
+                            size_t iterationsPerSlice,
+                            Rank initialRank,
+                            ptrdiff_t const * rowOffsets,
+                            IDiagnosticStream * diagnosticStream,
+                            QueryInstrumentation & instrumentation,
+                            size_t sliceBufferSize,
+                            ExecutionProfile * profile);
+
         ~ByteCodeInterpreter();
         
         // Runs the instruction sequence for a specified number of iterations.
@@ -232,6 +249,14 @@ namespace BitFunnel
         IDiagnosticStream* m_diagnosticStream;
         QueryInstrumentation& m_instrumentation;
         CacheLineRecorder * m_cacheLineRecorder;
+
+        ExecutionProfile * m_profile;
+
+        // Times each slice for the profile. nullptr when not profiling.
+        Stopwatch * m_sliceStopwatch;
+
+        // Row of the most recent AndRow or LoadRow, for the profile.
+        unsigned m_lastRow;
     };
 
 
@@ -21,8 +21,10 @@
 // THE SOFTWARE.
 
 #include <iostream>
+#include <memory>
 
 #include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Plan/ExecutionProfile.h"
 #include "BitFunnel/Plan/Factories.h"
 #include "BitFunnel/Index/IIngestor.h"
 #include "BitFunnel/Index/IShard.h"
@@ -32,10 +34,14 @@
 #include "BitFunnel/Plan/ResultsBuffer.h"
 #include "BitFunnel/Utilities/Allocator.h"
 #include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+#include "BitFunnel/Utilities/TraceLog.h"
 #include "ByteCodeQueryEngine.h"
 #include "CompileNode.h"
+#include "IPlanRows.h"
 #include "QueryPlanner.h"
 #include "RowSet.h"
+#include "RowSummaryFilter.h"
 
 
 namespace BitFunnel
@@ -53,6 +59,8 @@ namespace BitFunnel
     // Parse a query
     TermMatchNode const *ByteCodeQueryEngine::Parse(const char *query)
     {
+        TraceScope trace("query", "Parse");
+
         m_matchTreeAllocator->Reset();
         QueryParser parser(query,
             m_config,
@@ -64,8 +72,27 @@ namespace BitFunnel
     void ByteCodeQueryEngine::Run(TermMatchNode const * tree,
         QueryInstrumentation & instrumentation,
         ResultsBuffer & resultsBuffer)
+    {
+        RunInternal(tree, instrumentation, resultsBuffer, nullptr);
+    }
+
+
+    void ByteCodeQueryEngine::Run(TermMatchNode const * tree,
+        QueryInstrumentation & instrumentation,
+        ResultsBuffer & resultsBuffer,
+        ExecutionProfile & profile)
+    {
+        RunInternal(tree, instrumentation, resultsBuffer, &profile);
+    }
+
+
+    void ByteCodeQueryEngine::RunInternal(TermMatchNode const * tree,
+        QueryInstrumentation & instrumentation,
+        ResultsBuffer & resultsBuffer,
+        ExecutionProfile * profile)
     {
         const int c_arbitraryRowCount = 500;
+        TraceScope planTrace("query", "Plan");
         QueryPlanner planner(*tree,
                              c_arbitraryRowCount,
                              m_index,
@@ -75,29 +102,66 @@ namespace BitFunnel
         CompileNode const & compileTree = planner.GetCompileTree();
         const Rank initialRank = planner.GetInitialRank();
         const RowSet & rowSet = planner.GetRowSet();
+        std::vector<void*> sliceBuffers;
+        planTrace.End();
 
+        // The generator is sealed after compiling, so each query needs its
+        // own.
         // TODO: Clear results buffer here?
-        compileTree.Compile(m_code);
-        m_code.Seal();
+        TraceScope compileTrace("query", "Compile");
+        ByteCodeGenerator code;
+        compileTree.Compile(code);
+        code.Seal();
+        compileTrace.End();
 
         instrumentation.FinishPlanning();
         resultsBuffer.Reset();
 
         // Get token before we GetSliceBuffers.
         {
+            TraceScope trace("query", "Match");
             auto token = m_index.GetIngestor().GetTokenManager().RequestToken();
 
-            for (ShardId shardId = 0; shardId < m_index.GetIngestor().GetShardCount(); ++shardId)
+            for (ShardId shardId = 0; shardId < rowSet.GetShardCount(); ++shardId)
             {
                 auto & shard = m_index.GetIngestor().GetShard(shardId);
-                auto & sliceBuffers = shard.GetSliceBuffers();
+
+                // Skip slices where a required row has no set bits.
+                RowSummaryFilter filter(shard,
+                                        shardId,
+                                        planner.GetPlanRows(),
+                                        planner.GetRequiredRows());
+                sliceBuffers.clear();
+                filter.Filter(shard.GetSliceBuffers(), sliceBuffers);
 
                 // Iterations per slice calculation.
                 auto iterationsPerSlice = shard.GetSliceCapacity() >> 6 >> initialRank;
 
                 auto countCacheLines = m_diagnostic->IsEnabled("planning/countcachelines");
 
-                ByteCodeInterpreter interpreter(m_code,
+                // Only read the clock and the match count when profiling.
+                std::unique_ptr<Stopwatch> stopwatch;
+                size_t matchCount = 0;
+                if (profile != nullptr)
+                {
+                    stopwatch.reset(new Stopwatch());
+                    matchCount = resultsBuffer.size();
+
+                    IPlanRows const & planRows = planner.GetPlanRows();
+                    std::vector<RowId> physicalRows;
+                    for (unsigned i = 0; i < rowSet.GetRowCount(); ++i)
+                    {
+                        physicalRows.push_back(planRows.PhysicalRow(shardId, i));
+                    }
+
+                    profile->SetInitialRank(initialRank);
+                    profile->StartShard(shardId,
+                                        shard.GetSliceBuffers().size(),
+                                        sliceBuffers.size(),
+                                        physicalRows);
+                }
+
+                ByteCodeInterpreter interpreter(code,
                     resultsBuffer,
                     sliceBuffers.size(),
                     sliceBuffers.data(),
@@ -106,9 +170,16 @@ namespace BitFunnel
                     rowSet.GetRowOffsets(shardId),
                     nullptr,
                     instrumentation,
-                    countCacheLines ? shard.GetSliceBufferSize() : 0);
+                    countCacheLines ? shard.GetSliceBufferSize() : 0,
+                    profile);
 
                 interpreter.Run();
+
+                if (profile != nullptr)
+                {
+                    profile->FinishShard(stopwatch->ElapsedTime(),
+                                         resultsBuffer.size() - matchCount);
+                }
             }
 
             instrumentation.FinishMatching();
@@ -33,6 +33,8 @@
 
 namespace BitFunnel
 {
+    class ExecutionProfile;
+
     //*************************************************************************
     //
     // ByteCodeQueryEngine
@@ -55,6 +57,13 @@ namespace BitFunnel
                          QueryInstrumentation & instrumentation,
                          ResultsBuffer & resultsBuffer) override;
 
+        // Runs a parsed query, recording its execution profile for
+        // 'explain analyze'.
+        void Run(TermMatchNode const * tree,
+                 QueryInstrumentation & instrumentation,
+                 ResultsBuffer & resultsBuffer,
+                 ExecutionProfile & profile);
+
         // Adds the diagnostic keyword prefix to the list of prefixes that
         // enable diagnostics.
         virtual void EnableDiagnostic(char const * prefix) override;
@@ -64,11 +73,14 @@ namespace BitFunnel
         virtual void DisableDiagnostic(char const * prefix) override;
 
     private:
+        void RunInternal(TermMatchNode const * tree,
+                         QueryInstrumentation & instrumentation,
+                         ResultsBuffer & resultsBuffer,
+                         ExecutionProfile * profile);
+
         ISimpleIndex const & m_index;
         IStreamConfiguration const & m_config;
         std::unique_ptr<IDiagnosticStream> m_diagnostic;
         std::unique_ptr<IAllocator> m_matchTreeAllocator;
-
-        ByteCodeGenerator m_code;
     };
 }
@@ -49,8 +49,9 @@ namespace BitFunnel
         size_t cacheLineCount =
             RoundUp(sliceBufferSize, c_bytesPerCacheLine) / c_bytesPerCacheLine;
 
+        // Round up to whole quadwords for GetBitArray().
         m_bitArraySize =
-            RoundUp(cacheLineCount, c_bitsPerByte) / c_bitsPerByte;
+            RoundUp(cacheLineCount, c_bitsPerQuadword) / c_bitsPerByte;
 
         m_bitArray.reset(new uint8_t[m_bitArraySize]);
     }
@@ -83,6 +84,12 @@ namespace BitFunnel
     }
 
 
+    uint64_t * CacheLineRecorder::GetBitArray()
+    {
+        return reinterpret_cast<uint64_t *>(m_bitArray.get());
+    }
+
+
     void CacheLineRecorder::Reset()
     {
         memset(m_bitArray.get(), 0ull, m_bitArraySize);
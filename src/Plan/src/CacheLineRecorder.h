@@ -24,6 +24,7 @@
 
 #include <memory>       // std::unique_ptr embedded.
 #include <stddef.h>     // uint8_t template parameter.
+#include <stdint.h>     // uint64_t return value.
 
 
 namespace BitFunnel
@@ -38,6 +39,12 @@ namespace BitFunnel
 
         size_t GetCacheLinesAccessed() const;
 
+        // Returns the bit array, one bit per cache line in the slice buffer,
+        // so that code generated by the NativeJIT matcher can record accesses
+        // directly. The array is padded to a whole number of quadwords and
+        // bit i of quadword q records cache line 64 * q + i.
+        uint64_t * GetBitArray();
+
         void Reset();
 
     private:
@@ -0,0 +1,269 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <iomanip>
+#include <ostream>
+
+#include "BitFunnel/Plan/ExecutionProfile.h"
+#include "LoggerInterfaces/Check.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>  // For __popcnt64.
+#endif
+
+
+namespace BitFunnel
+{
+    // Returns the number of bits set in value.
+    static size_t PopCount(uint64_t value)
+    {
+#ifdef _MSC_VER
+        return static_cast<size_t>(__popcnt64(value));
+#else
+        return static_cast<size_t>(__builtin_popcountll(value));
+#endif
+    }
+
+
+    //*************************************************************************
+    //
+    // ExecutionProfile::RowStatistics
+    //
+    //*************************************************************************
+    double ExecutionProfile::RowStatistics::GetDensity() const
+    {
+        return (m_quadwordCount == 0) ?
+            0.0 :
+            static_cast<double>(m_bitCount) / (m_quadwordCount * 64);
+    }
+
+
+    //*************************************************************************
+    //
+    // ExecutionProfile
+    //
+    //*************************************************************************
+    ExecutionProfile::ExecutionProfile()
+      : m_initialRank(0),
+        m_shardRowStart(0),
+        m_sliceQuadwordCount(0)
+    {
+    }
+
+
+    void ExecutionProfile::SetInitialRank(Rank rank)
+    {
+        m_initialRank = rank;
+    }
+
+
+    void ExecutionProfile::StartShard(ShardId shard,
+                                  size_t sliceCount,
+                                  size_t scannedSliceCount,
+                                  std::vector<RowId> const & physicalRows)
+    {
+        m_shardRowStart = m_rows.size();
+        for (size_t i = 0; i < physicalRows.size(); ++i)
+        {
+            m_rows.push_back({ shard, i, physicalRows[i], 0, 0, 0 });
+        }
+
+        m_shards.push_back({ shard, sliceCount, scannedSliceCount, 0.0, 0 });
+        m_sliceQuadwordCount = 0;
+    }
+
+
+    void ExecutionProfile::FinishShard(double seconds, size_t matchCount)
+    {
+        CHECK_GT(m_shards.size(), 0u)
+            << "FinishShard() without StartShard().";
+        m_shards.back().m_seconds = seconds;
+        m_shards.back().m_matchCount = matchCount;
+    }
+
+
+    void ExecutionProfile::RecordRowLoad(size_t row,
+                                     uint64_t value,
+                                     uint64_t accumulator)
+    {
+        RowStatistics & statistics = m_rows[m_shardRowStart + row];
+        ++statistics.m_quadwordCount;
+        statistics.m_bitCount += PopCount(value);
+        if (accumulator == 0)
+        {
+            ++statistics.m_zeroCount;
+        }
+        ++m_sliceQuadwordCount;
+    }
+
+
+    void ExecutionProfile::RecordJz(size_t instruction, size_t row, bool fired)
+    {
+        auto it = m_jumps.find(instruction);
+        if (it == m_jumps.end())
+        {
+            it = m_jumps.insert(
+                std::make_pair(instruction,
+                               JumpStatistics { instruction, row, 0, 0 })).first;
+        }
+
+        ++it->second.m_executedCount;
+        if (fired)
+        {
+            ++it->second.m_firedCount;
+        }
+    }
+
+
+    void ExecutionProfile::RecordSlice(size_t slice,
+                                   double seconds,
+                                   size_t matchCount)
+    {
+        CHECK_GT(m_shards.size(), 0u)
+            << "RecordSlice() without StartShard().";
+        m_slices.push_back({ m_shards.back().m_shard,
+                             slice,
+                             seconds,
+                             m_sliceQuadwordCount,
+                             matchCount });
+        m_sliceQuadwordCount = 0;
+    }
+
+
+    Rank ExecutionProfile::GetInitialRank() const
+    {
+        return m_initialRank;
+    }
+
+
+    std::vector<ExecutionProfile::RowStatistics> const &
+        ExecutionProfile::GetRows() const
+    {
+        return m_rows;
+    }
+
+
+    std::vector<ExecutionProfile::JumpStatistics> ExecutionProfile::GetJumps() const
+    {
+        std::vector<JumpStatistics> jumps;
+        for (auto const & jump : m_jumps)
+        {
+            jumps.push_back(jump.second);
+        }
+        return jumps;
+    }
+
+
+    std::vector<ExecutionProfile::SliceStatistics> const &
+        ExecutionProfile::GetSlices() const
+    {
+        return m_slices;
+    }
+
+
+    std::vector<ExecutionProfile::ShardStatistics> const &
+        ExecutionProfile::GetShards() const
+    {
+        return m_shards;
+    }
+
+
+    void ExecutionProfile::Print(std::ostream& out) const
+    {
+        const double c_microseconds = 1e6;
+        const auto flags = out.flags();
+        const auto precision = out.precision();
+
+        out << "Initial rank: " << m_initialRank << std::endl
+            << std::endl
+            << "Rows:" << std::endl
+            << std::setw(8) << "shard"
+            << std::setw(8) << "row"
+            << std::setw(8) << "rank"
+            << std::setw(10) << "physical"
+            << std::setw(12) << "quadwords"
+            << std::setw(12) << "zero after"
+            << std::setw(10) << "density" << std::endl;
+        for (auto const & row : m_rows)
+        {
+            out << std::setw(8) << row.m_shard
+                << std::setw(8) << row.m_row
+                << std::setw(8) << row.m_physicalRow.GetRank()
+                << std::setw(10) << row.m_physicalRow.GetIndex()
+                << std::setw(12) << row.m_quadwordCount
+                << std::setw(12) << row.m_zeroCount
+                << std::setw(10) << std::fixed << std::setprecision(4)
+                << row.GetDensity() << std::endl;
+        }
+
+        out << std::endl
+            << "Jz short-circuits:" << std::endl
+            << std::setw(12) << "instruction"
+            << std::setw(8) << "row"
+            << std::setw(12) << "executed"
+            << std::setw(12) << "fired" << std::endl;
+        for (auto const & jump : m_jumps)
+        {
+            out << std::setw(12) << jump.second.m_instruction
+                << std::setw(8) << jump.second.m_row
+                << std::setw(12) << jump.second.m_executedCount
+                << std::setw(12) << jump.second.m_firedCount << std::endl;
+        }
+
+        out << std::endl
+            << "Shards:" << std::endl
+            << std::setw(8) << "shard"
+            << std::setw(8) << "slices"
+            << std::setw(10) << "scanned"
+            << std::setw(12) << "time (us)"
+            << std::setw(10) << "matches" << std::endl;
+        for (auto const & shard : m_shards)
+        {
+            out << std::setw(8) << shard.m_shard
+                << std::setw(8) << shard.m_sliceCount
+                << std::setw(10) << shard.m_scannedSliceCount
+                << std::setw(12) << std::fixed << std::setprecision(1)
+                << shard.m_seconds * c_microseconds
+                << std::setw(10) << shard.m_matchCount << std::endl;
+        }
+
+        out << std::endl
+            << "Slices:" << std::endl
+            << std::setw(8) << "shard"
+            << std::setw(8) << "slice"
+            << std::setw(12) << "time (us)"
+            << std::setw(12) << "quadwords"
+            << std::setw(10) << "matches" << std::endl;
+        for (auto const & slice : m_slices)
+        {
+            out << std::setw(8) << slice.m_shard
+                << std::setw(8) << slice.m_slice
+                << std::setw(12) << std::fixed << std::setprecision(1)
+                << slice.m_seconds * c_microseconds
+                << std::setw(12) << slice.m_quadwordCount
+                << std::setw(10) << slice.m_matchCount << std::endl;
+        }
+
+        out.flags(flags);
+        out.precision(precision);
+    }
+}
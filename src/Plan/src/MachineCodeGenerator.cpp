@@ -47,8 +47,17 @@ namespace BitFunnel
 
     MachineCodeGenerator::MachineCodeGenerator(RegisterAllocator const & registers,
                                                FunctionBuffer & code)
+      : MachineCodeGenerator(registers, code, false)
+    {
+    }
+
+
+    MachineCodeGenerator::MachineCodeGenerator(RegisterAllocator const & registers,
+                                               FunctionBuffer & code,
+                                               bool recordCacheLines)
       : m_registers(registers),
         m_code(code),
+        m_recordCacheLines(recordCacheLines),
         m_pushCount(0)
     {
     }
@@ -88,12 +97,14 @@ namespace BitFunnel
                     // Case 1: rankDelta > 0 && !inverted && IsRegister
                     m_code.Emit<OpCode::Add>(rax, rdx);
                     unsigned reg = m_registers.GetRegister(id);
+                    RecordCacheLine(rax, Register<8u, false>(reg));
                     m_code.Emit<OpCode::And>(rbx, rax, Register<8u, false>(reg), SIB::Scale1, 0);
                 }
                 else
                 {
                     // Case 2: rankDelta > 0 && !inverted && !IsRegister
                     m_code.Emit<OpCode::Add>(rax, rsi, id * 8);
+                    RecordCacheLine(rax, rdx);
                     m_code.Emit<OpCode::And>(rbx, rax, rdx, SIB::Scale1, 0);
                 }
             }
@@ -104,12 +115,14 @@ namespace BitFunnel
                     // Case 3: rankDelta > 0 && inverted && IsRegister
                     m_code.Emit<OpCode::Add>(rax, rdx);
                     unsigned reg = m_registers.GetRegister(id);
+                    RecordCacheLine(rax, Register<8u, false>(reg));
                     m_code.Emit<OpCode::Mov>(rax, rax, Register<8u, false>(reg), SIB::Scale1, 0);
                 }
                 else
                 {
                     // Case 4: rankDelta > 0 && inverted && !IsRegister
                     m_code.Emit<OpCode::Add>(rax, rsi, id * 8);
+                    RecordCacheLine(rax, rdx);
                     m_code.Emit<OpCode::Mov>(rax, rax, rdx, SIB::Scale1, 0);
                 }
 
@@ -126,6 +139,7 @@ namespace BitFunnel
                 {
                     // Case 5: rankDelta == 0 && !inverted && IsRegister
                     unsigned reg = m_registers.GetRegister(id);
+                    RecordCacheLine(rcx, Register<8u, false>(reg));
                     m_code.Emit<OpCode::And>(rbx, rcx, Register<8u, false>(reg), SIB::Scale1, 0);
                 }
                 else
@@ -133,6 +147,7 @@ namespace BitFunnel
                     // Case 6: rankDelta == 0 && !inverted && !IsRegister
                     m_code.Emit<OpCode::Mov>(rax, rcx);
                     m_code.Emit<OpCode::Add>(rax, rsi, id * 8);
+                    RecordCacheLine(rax);
                     m_code.Emit<OpCode::And>(rbx, rax, 0);
                 }
             }
@@ -143,6 +158,7 @@ namespace BitFunnel
                 {
                     // Case 7: rankDelta == 0 && inverted && IsRegister
                     unsigned reg = m_registers.GetRegister(id);
+                    RecordCacheLine(rcx, Register<8u, false>(reg));
                     m_code.Emit<OpCode::Mov>(rax, rcx, Register<8u, false>(reg), SIB::Scale1, 0);
                 }
                 else
@@ -150,6 +166,7 @@ namespace BitFunnel
                     // Case 8: rankDelta == 0 && inverted && !IsRegister
                     m_code.Emit<OpCode::Mov>(rax, rcx);
                     m_code.Emit<OpCode::Add>(rax, rsi, id * 8);
+                    RecordCacheLine(rax);
                     m_code.Emit<OpCode::Mov>(rax, rax, 0);
                 }
 
@@ -188,12 +205,14 @@ namespace BitFunnel
                 // Case 1: rankDelta > 0, IsRegister
                 m_code.Emit<OpCode::Add>(rax, rdx);
                 unsigned reg = m_registers.GetRegister(id);
+                RecordCacheLine(rax, Register<8u, false>(reg));
                 m_code.Emit<OpCode::Mov>(rbx, rax, Register<8u, false>(reg), SIB::Scale1, 0);
             }
             else
             {
                 // Case 2: rankDelta > 0, !IsRegister
                 m_code.Emit<OpCode::Add>(rax, rsi, id * 8);
+                RecordCacheLine(rax, rdx);
                 m_code.Emit<OpCode::Mov>(rbx, rax, rdx, SIB::Scale1, 0);
             }
         }
@@ -203,6 +222,7 @@ namespace BitFunnel
             {
                 // Case 3: rankDelta == 0, IsRegister
                 unsigned reg = m_registers.GetRegister(id);
+                RecordCacheLine(rcx, Register<8u, false>(reg));
                 m_code.Emit<OpCode::Mov>(rbx, rcx, Register<8u, false>(reg), SIB::Scale1, 0);
             }
             else
@@ -210,6 +230,7 @@ namespace BitFunnel
                 // Case 4: rankDelta == 0, !IsRegister
                 m_code.Emit<OpCode::Mov>(rax, rcx);
                 m_code.Emit<OpCode::Add>(rax, rsi, id * 8);
+                RecordCacheLine(rax);
                 m_code.Emit<OpCode::Mov>(rbx, rax, 0);
             }
         }
@@ -226,6 +247,63 @@ namespace BitFunnel
     }
 
 
+    void MachineCodeGenerator::RecordCacheLine(Register<8u, false> base,
+                                               Register<8u, false> index)
+    {
+        if (m_recordCacheLines)
+        {
+            m_code.Emit<OpCode::Push>(rax);
+            m_code.Emit<OpCode::Push>(rbx);
+            m_code.Emit<OpCode::Push>(rcx);
+
+            m_code.Emit<OpCode::Mov>(rbx, base);
+            m_code.Emit<OpCode::Add>(rbx, index);
+            MarkCacheLine();
+
+            m_code.Emit<OpCode::Pop>(rcx);
+            m_code.Emit<OpCode::Pop>(rbx);
+            m_code.Emit<OpCode::Pop>(rax);
+        }
+    }
+
+
+    void MachineCodeGenerator::RecordCacheLine(Register<8u, false> address)
+    {
+        if (m_recordCacheLines)
+        {
+            m_code.Emit<OpCode::Push>(rax);
+            m_code.Emit<OpCode::Push>(rbx);
+            m_code.Emit<OpCode::Push>(rcx);
+
+            m_code.Emit<OpCode::Mov>(rbx, address);
+            MarkCacheLine();
+
+            m_code.Emit<OpCode::Pop>(rcx);
+            m_code.Emit<OpCode::Pop>(rbx);
+            m_code.Emit<OpCode::Pop>(rax);
+        }
+    }
+
+
+    void MachineCodeGenerator::MarkCacheLine()
+    {
+        // Cache line number relative to the slice buffer in rdx.
+        m_code.Emit<OpCode::Sub>(rbx, rdx);
+        m_code.EmitImmediate<OpCode::Shr>(rbx, static_cast<uint8_t>(6));
+
+        // Address of the quadword holding the cache line's bit.
+        m_code.Emit<OpCode::Mov>(rcx, rbx);
+        m_code.EmitImmediate<OpCode::Shr>(rcx, static_cast<uint8_t>(6));
+        m_code.EmitImmediate<OpCode::Shl>(rcx, static_cast<uint8_t>(3));
+        m_code.Emit<OpCode::Add>(rcx, rdi, NativeCodeGenerator::m_cacheLines);
+
+        // The register form of BTS uses the low six bits of rbx.
+        m_code.Emit<OpCode::Mov>(rax, rcx, 0);
+        m_code.Emit<OpCode::Bts>(rax, rbx);
+        m_code.Emit<OpCode::Mov>(rcx, 0, rax);
+    }
+
+
     void MachineCodeGenerator::LeftShiftOffset(size_t shift)
     {
         // Decode the offset into RCX, adjust for the shift and then encode it back.
@@ -24,6 +24,7 @@
 
 #include "BitFunnel/NonCopyable.h"      // Base class.
 #include "ICodeGenerator.h"             // Base class.
+#include "NativeJIT/CodeGen/Register.h" // Register parameter.
 
 
 namespace NativeJIT
@@ -57,6 +58,14 @@ namespace BitFunnel
         MachineCodeGenerator(RegisterAllocator const & registers,
                              FunctionBuffer & code);
 
+        // When recordCacheLines is true, the generated code also sets a bit
+        // in the NativeCodeGenerator::Parameters::m_cacheLines bit array for
+        // each cache line it loads from the slice buffer. The other
+        // constructor generates code without this overhead.
+        MachineCodeGenerator(RegisterAllocator const & registers,
+                             FunctionBuffer & code,
+                             bool recordCacheLines);
+
         //
         // ICodeGenerator methods
         //
@@ -112,6 +121,18 @@ namespace BitFunnel
         static unsigned GetSlotCount();
 
     protected:
+        // When m_recordCacheLines is set, emit code to mark the cache line
+        // at address base + index in the m_cacheLines bit array. The emitted
+        // code preserves all registers, but not flags. Neither base nor index
+        // may be rbx.
+        void RecordCacheLine(Register<8u, false> base,
+                             Register<8u, false> index);
+        void RecordCacheLine(Register<8u, false> address);
+
+        // Marks the cache line whose address is in rbx. Clobbers rax, rbx
+        // and rcx.
+        void MarkCacheLine();
+
         //
         // Constructor parameters
         //
@@ -120,6 +141,8 @@ namespace BitFunnel
 
         FunctionBuffer & m_code;
 
+        const bool m_recordCacheLines;
+
 
         // Records the number of items pushed on the X64 stack since the
         // stack frame setup was completed. Required to satisfy X64 calling
@@ -21,7 +21,11 @@
 // THE SOFTWARE.
 
 
+#include "BitFunnel/Plan/QueryInstrumentation.h"
+#include "BitFunnel/Plan/ResultsBuffer.h"
 #include "BitFunnel/Utilities/Allocator.h"
+#include "CacheLineRecorder.h"
+#include "LoggerInterfaces/Check.h"
 #include "MatchTreeCompiler.h"
 
 using namespace NativeJIT;
@@ -39,6 +43,23 @@ namespace BitFunnel
                                          CompileNode const & tree,
                                          RegisterAllocator const & registers,
                                          Rank initialRank)
+      : MatchTreeCompiler(expressionTreeAllocator,
+                          code,
+                          tree,
+                          registers,
+                          initialRank,
+                          false)
+    {
+    }
+
+
+    MatchTreeCompiler::MatchTreeCompiler(Allocators::IAllocator & expressionTreeAllocator,
+                                         NativeJIT::FunctionBuffer & code,
+                                         CompileNode const & tree,
+                                         RegisterAllocator const & registers,
+                                         Rank initialRank,
+                                         bool countCacheLines)
+      : m_countCacheLines(countCacheLines)
     {
         NativeCodeGenerator::Prototype expression(expressionTreeAllocator,
                                                   code);
@@ -49,7 +70,8 @@ namespace BitFunnel
             expression.PlacementConstruct<NativeCodeGenerator>(expression,
                                                                tree,
                                                                registers,
-                                                               initialRank);
+                                                               initialRank,
+                                                               countCacheLines);
         m_function = expression.Compile(node);
     }
 
@@ -70,7 +92,8 @@ namespace BitFunnel
             results.m_capacity,
             results.m_size,
             results.m_buffer,
-            0
+            0,
+            nullptr
         };
 
         // For now ignore return value.
@@ -98,4 +121,48 @@ namespace BitFunnel
 
         return parameters.m_quadwordCount;
     }
+
+
+    size_t MatchTreeCompiler::Run(size_t sliceCount,
+                                  void * const * sliceBuffers,
+                                  size_t iterationsPerSlice,
+                                  ptrdiff_t const * rowOffsets,
+                                  ResultsBuffer & results,
+                                  CacheLineRecorder & cacheLines,
+                                  QueryInstrumentation & instrumentation)
+    {
+        CHECK_TRUE(m_countCacheLines)
+            << "Matcher was compiled without cache line counting.";
+
+        NativeCodeGenerator::Parameters parameters = {
+            0,
+            sliceBuffers,
+            iterationsPerSlice,
+            rowOffsets,
+            0,
+            { 0 },
+            results.m_capacity,
+            results.m_size,
+            results.m_buffer,
+            0,
+            cacheLines.GetBitArray()
+        };
+
+        // The generated code counts down m_sliceCount and advances
+        // m_sliceBuffers, so running it with a count of one processes the
+        // next slice. This keeps per-slice bookkeeping out of the generated
+        // outer loop, which is shared with the uninstrumented matcher.
+        for (size_t i = 0; i < sliceCount; ++i)
+        {
+            cacheLines.Reset();
+            parameters.m_sliceCount = 1;
+            m_function(&parameters);
+            instrumentation.IncrementCacheLineCount(
+                cacheLines.GetCacheLinesAccessed());
+        }
+
+        results.m_size = parameters.m_matchCount;
+
+        return parameters.m_quadwordCount;
+    }
 }
@@ -38,7 +38,9 @@ namespace NativeJIT
 
 namespace BitFunnel
 {
+    class CacheLineRecorder;
     class CompileNode;
+    class QueryInstrumentation;
     class RegisterAllocator;
     class ResultsBuffer;
 
@@ -56,13 +58,35 @@ namespace BitFunnel
                           RegisterAllocator const & registers,
                           Rank initialRank);
 
+        // When countCacheLines is true, the compiled matcher records the
+        // cache lines it loads and must be run with the overload of Run()
+        // that takes a CacheLineRecorder.
+        MatchTreeCompiler(Allocators::IAllocator & resources,
+                          NativeJIT::FunctionBuffer & code,
+                          CompileNode const & tree,
+                          RegisterAllocator const & registers,
+                          Rank initialRank,
+                          bool countCacheLines);
+
         size_t Run(size_t slicecount,
                    void * const * slicebuffers,
                    size_t iterationsperslice,
                    ptrdiff_t const * rowoffsets,
                    ResultsBuffer & results);
 
+        // Runs the matcher one slice at a time, adding the number of
+        // distinct cache lines loaded from each slice to the instrumentation.
+        // The recorder must be sized for the slice buffers.
+        size_t Run(size_t slicecount,
+                   void * const * slicebuffers,
+                   size_t iterationsperslice,
+                   ptrdiff_t const * rowoffsets,
+                   ResultsBuffer & results,
+                   CacheLineRecorder & cacheLines,
+                   QueryInstrumentation & instrumentation);
+
     private:
         NativeCodeGenerator::Prototype::FunctionType m_function;
+        const bool m_countCacheLines;
     };
 }
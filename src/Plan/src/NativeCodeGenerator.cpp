@@ -45,10 +45,26 @@ namespace BitFunnel
         CompileNode const & compileNodeTree,
         RegisterAllocator const & registers,
         Rank initialRank)
+      : NativeCodeGenerator(expression,
+                            compileNodeTree,
+                            registers,
+                            initialRank,
+                            false)
+    {
+    }
+
+
+    NativeCodeGenerator::NativeCodeGenerator(
+        Prototype& expression,
+        CompileNode const & compileNodeTree,
+        RegisterAllocator const & registers,
+        Rank initialRank,
+        bool countCacheLines)
       : Node(expression),
         m_compileNodeTree(compileNodeTree),
         m_registers(registers),
-        m_initialRank(initialRank)
+        m_initialRank(initialRank),
+        m_countCacheLines(countCacheLines)
     {
     }
 
@@ -215,7 +231,9 @@ namespace BitFunnel
         code.Emit<OpCode::Pop>(rcx);
 
         {
-            MachineCodeGenerator generator(m_registers, tree.GetCodeGenerator());
+            MachineCodeGenerator generator(m_registers,
+                                           tree.GetCodeGenerator(),
+                                           m_countCacheLines);
             m_compileNodeTree.Compile(generator);
         }
 
@@ -22,7 +22,8 @@
 
 #pragma once
 
-#include <stddef.h>     // size_t, ptrdiff_t parameters.
+#include <stddef.h>     // size_t, ptrdiff_t parameters, offsetof.
+#include <stdint.h>     // uint64_t embedded.
 
 #include "BitFunnel/BitFunnelTypes.h"           // Rank parameter.
 #include "BitFunnel/Plan/ResultsBuffer.h"       // ResultsBuffer::Result type.
@@ -54,7 +55,7 @@ namespace BitFunnel
     }
 
 #define OFFSET_OF(object, field) \
-static_cast<int32_t>(reinterpret_cast<uint64_t>(&((static_cast<object*>(nullptr))->field)))
+static_cast<int32_t>(offsetof(object, field))
 
 
     //*************************************************************************
@@ -86,6 +87,10 @@ static_cast<int32_t>(reinterpret_cast<uint64_t>(&((static_cast<object*>(nullptr)
             ResultsBuffer::Result* m_matches;
 
             size_t m_quadwordCount;
+
+            // One bit per cache line of the current slice buffer. Only
+            // accessed by code generated with countCacheLines set.
+            uint64_t * m_cacheLines;
         };
         static_assert(std::is_standard_layout<Parameters>::value,
                       "Generated code requires that Parameters be standard layout.");
@@ -98,6 +103,14 @@ static_cast<int32_t>(reinterpret_cast<uint64_t>(&((static_cast<object*>(nullptr)
                             RegisterAllocator const & registers,
                             Rank initialRank);
 
+        // When countCacheLines is true, the generated code records each
+        // cache line it loads in Parameters::m_cacheLines.
+        NativeCodeGenerator(Prototype& expression,
+                            CompileNode const & compileNodeTree,
+                            RegisterAllocator const & registers,
+                            Rank initialRank,
+                            bool countCacheLines);
+
         virtual ExpressionTree::Storage<size_t>
             CodeGenValue(ExpressionTree& tree) override;
 
@@ -113,6 +126,7 @@ static_cast<int32_t>(reinterpret_cast<uint64_t>(&((static_cast<object*>(nullptr)
         static const int32_t m_matchCount = OFFSET_OF(Parameters, m_matchCount);
         static const int32_t m_matches = OFFSET_OF(Parameters, m_matches);
         static const int32_t m_quadwordCount = OFFSET_OF(Parameters, m_quadwordCount);
+        static const int32_t m_cacheLines = OFFSET_OF(Parameters, m_cacheLines);
 
 
     private:
@@ -125,6 +139,7 @@ static_cast<int32_t>(reinterpret_cast<uint64_t>(&((static_cast<object*>(nullptr)
         CompileNode const & m_compileNodeTree;
         RegisterAllocator const & m_registers;
         const Rank m_initialRank;
+        const bool m_countCacheLines;
 
         Register<8u, false> m_param1;
         Register<8u, false> m_return;
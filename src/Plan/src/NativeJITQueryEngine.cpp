@@ -32,13 +32,16 @@
 #include "BitFunnel/Plan/ResultsBuffer.h"
 #include "BitFunnel/Utilities/Allocator.h"
 #include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/TraceLog.h"
 #include "NativeJITQueryEngine.h"
+#include "CacheLineRecorder.h"
 #include "CompileNode.h"
 #include "MatchTreeCompiler.h"
 #include "NativeCodeGenerator.h"
 #include "QueryPlanner.h"
 #include "RegisterAllocator.h"
 #include "RowSet.h"
+#include "RowSummaryFilter.h"
 
 
 namespace BitFunnel
@@ -68,6 +71,8 @@ namespace BitFunnel
     // Parse a query
     TermMatchNode const *NativeJITQueryEngine::Parse(const char *query)
     {
+        TraceScope trace("query", "Parse");
+
         m_matchTreeAllocator->Reset();
         m_expressionTreeAllocator->Reset();
         // WARNING: Do not reset m_codeAllocator. It is used to provision m_code.
@@ -85,6 +90,7 @@ namespace BitFunnel
         ResultsBuffer & resultsBuffer)
     {
         const int c_arbitraryRowCount = 500;
+        TraceScope planTrace("query", "Plan");
         QueryPlanner planner(*tree,
                              c_arbitraryRowCount,
                              m_index,
@@ -101,36 +107,69 @@ namespace BitFunnel
                                           c_registerBase,
                                           c_registerCount,
                                           *m_matchTreeAllocator);
+        planTrace.End();
+
+        // Cache line counting compiles a separately instrumented matcher so
+        // that ordinary queries run the uninstrumented code.
+        const bool countCacheLines =
+            m_diagnostic->IsEnabled("planning/countcachelines");
 
+        TraceScope compileTrace("query", "Compile");
         MatchTreeCompiler compiler(*m_expressionTreeAllocator,
                                    *m_code,
                                    compileTree,
                                    registers,
-                                   initialRank);
+                                   initialRank,
+                                   countCacheLines);
+        compileTrace.End();
 
 
         instrumentation.FinishPlanning();
 
         resultsBuffer.Reset();
+        std::vector<void*> sliceBuffers;
 
         // Get token before we GetSliceBuffers.
         {
+            TraceScope trace("query", "Match");
             auto token = m_index.GetIngestor().GetTokenManager().RequestToken();
 
-            for (ShardId shardId = 0; shardId < m_index.GetIngestor().GetShardCount(); ++shardId)
+            for (ShardId shardId = 0; shardId < rowSet.GetShardCount(); ++shardId)
             {
                 auto & shard = m_index.GetIngestor().GetShard(shardId);
-                auto & sliceBuffers = shard.GetSliceBuffers();
+
+                // Skip slices where a required row has no set bits.
+                RowSummaryFilter filter(shard,
+                                        shardId,
+                                        planner.GetPlanRows(),
+                                        planner.GetRequiredRows());
+                sliceBuffers.clear();
+                filter.Filter(shard.GetSliceBuffers(), sliceBuffers);
 
                 // Iterations per slice calculation.
                 auto iterationsPerSlice = shard.GetSliceCapacity() >> 6 >> initialRank;
 
 
-                size_t quadwordCount = compiler.Run(sliceBuffers.size(),
-                    sliceBuffers.data(),
-                    iterationsPerSlice,
-                    rowSet.GetRowOffsets(shardId),
-                    resultsBuffer);
+                size_t quadwordCount = 0;
+                if (countCacheLines)
+                {
+                    CacheLineRecorder cacheLines(shard.GetSliceBufferSize());
+                    quadwordCount = compiler.Run(sliceBuffers.size(),
+                        sliceBuffers.data(),
+                        iterationsPerSlice,
+                        rowSet.GetRowOffsets(shardId),
+                        resultsBuffer,
+                        cacheLines,
+                        instrumentation);
+                }
+                else
+                {
+                    quadwordCount = compiler.Run(sliceBuffers.size(),
+                        sliceBuffers.data(),
+                        iterationsPerSlice,
+                        rowSet.GetRowOffsets(shardId),
+                        resultsBuffer);
+                }
 
                 instrumentation.IncrementQuadwordCount(quadwordCount);
             }
@@ -45,13 +45,15 @@ namespace BitFunnel
     //
     //*************************************************************************
     PlanRows::PlanRows(const ISimpleIndex& index)
-        : m_index(index)
+        : m_index(index),
+          m_shardCount(index.GetIngestor().GetShardCount())
     {
     }
 
 
     PlanRows::PlanRows(IInputStream& stream, const ISimpleIndex& index)
-        : m_index(index)
+        : m_index(index),
+          m_shardCount(index.GetIngestor().GetShardCount())
     {
         const unsigned size = StreamUtilities::ReadField<unsigned>(stream);
 
@@ -69,8 +71,7 @@ namespace BitFunnel
 
     ShardId PlanRows::GetShardCount() const
     {
-        // return static_cast<unsigned>(m_index.GetShardCount());
-        return m_index.GetIngestor().GetShardCount();
+        return m_shardCount;
     }
 
 
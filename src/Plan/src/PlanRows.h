@@ -97,6 +97,11 @@ namespace BitFunnel
 
         const ISimpleIndex& m_index;
 
+        // Shards can be added while the index is serving queries. The count
+        // is fixed when the plan is made so that a query covers the same
+        // shards from planning through matching.
+        const ShardId m_shardCount;
+
         FixedCapacityVector<Entry, c_maxRowsPerQuery> m_rows;
     };
 }
@@ -38,6 +38,11 @@ namespace BitFunnel
         formatter.WriteField("parse");
         formatter.WriteField("plan");
         formatter.WriteField("match");
+        for (size_t i = 0; i < HardwareCounters::CounterCount; ++i)
+        {
+            formatter.WriteField(
+                HardwareCounters::GetName(static_cast<HardwareCounters::Counter>(i)));
+        }
         formatter.WriteRowEnd();
     }
 
@@ -53,6 +58,19 @@ namespace BitFunnel
         formatter.WriteField(m_parsingTime);
         formatter.WriteField(m_planningTime);
         formatter.WriteField(m_matchingTime);
+        for (size_t i = 0; i < HardwareCounters::CounterCount; ++i)
+        {
+            // Leave the field empty when the counter wasn't sampled so that
+            // it can't be mistaken for a measured zero.
+            if (m_hasHardwareCounter[i])
+            {
+                formatter.WriteField(m_hardwareCounters[i]);
+            }
+            else
+            {
+                formatter.WriteField("");
+            }
+        }
         formatter.WriteRowEnd();
     }
 }
@@ -37,6 +37,7 @@
 #include "QueryPlanner.h"
 #include "RankDownCompiler.h"
 #include "RowSet.h"
+#include "RowSummaryFilter.h"
 #include "TermPlan.h"
 #include "TermPlanConverter.h"
 
@@ -85,6 +86,7 @@ namespace BitFunnel
         }
 
         m_planRows = &rowPlan.GetPlanRows();
+        RowSummaryFilter::GetRequiredRows(rowPlan.GetMatchTree(), m_requiredRows);
 
         if (diagnosticStream.IsEnabled("planning/planrows"))
         {
@@ -184,4 +186,10 @@ namespace BitFunnel
     {
         return *m_planRows;
     }
+
+
+    std::vector<unsigned> const & QueryPlanner::GetRequiredRows() const
+    {
+        return m_requiredRows;
+    }
 }
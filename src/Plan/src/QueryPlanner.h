@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <vector>                         // std::vector embedded.
+
 #include "BitFunnel/NonCopyable.h"        // Inherits from NonCopyable.
 #include "RowSet.h"
 
@@ -54,6 +56,10 @@ namespace BitFunnel
 
         IPlanRows const & GetPlanRows() const;
 
+        // Returns the ids of the plan rows that must have a bit set for a
+        // document to match. See RowSummaryFilter.
+        std::vector<unsigned> const & GetRequiredRows() const;
+
     private:
         CompileNode const * m_compileTree;
 
@@ -63,5 +69,7 @@ namespace BitFunnel
         
         IPlanRows const * m_planRows;
 
+        std::vector<unsigned> m_requiredRows;
+
     };
 }
@@ -0,0 +1,110 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/RowIdSequence.h"
+#include "BitFunnel/Plan/QueryRows.h"
+#include "BitFunnel/Plan/TermMatchNode.h"
+#include "BitFunnel/Term.h"
+#include "StringVector.h"
+
+
+namespace BitFunnel
+{
+    void GetQueryTerms(TermMatchNode const & tree,
+                       IConfiguration const & configuration,
+                       std::vector<Term>& terms)
+    {
+        switch (tree.GetType())
+        {
+        case TermMatchNode::AndMatch:
+            {
+                auto const & node = dynamic_cast<const TermMatchNode::And&>(tree);
+                GetQueryTerms(node.GetLeft(), configuration, terms);
+                GetQueryTerms(node.GetRight(), configuration, terms);
+            }
+            break;
+        case TermMatchNode::NotMatch:
+            GetQueryTerms(dynamic_cast<const TermMatchNode::Not&>(tree).GetChild(),
+                          configuration,
+                          terms);
+            break;
+        case TermMatchNode::OrMatch:
+            {
+                auto const & node = dynamic_cast<const TermMatchNode::Or&>(tree);
+                GetQueryTerms(node.GetLeft(), configuration, terms);
+                GetQueryTerms(node.GetRight(), configuration, terms);
+            }
+            break;
+        case TermMatchNode::PhraseMatch:
+            {
+                auto const & node = dynamic_cast<const TermMatchNode::Phrase&>(tree);
+                StringVector const & grams = node.GetGrams();
+
+                // Each position starts an n-gram of up to c_maxGramSize
+                // grams, matching TermMatchTreeConverter's ring buffer.
+                for (unsigned i = 0; i < grams.GetSize(); ++i)
+                {
+                    Term term(grams[i], node.GetStreamId(), configuration);
+                    terms.push_back(term);
+                    for (unsigned n = 1;
+                         n < Term::c_maxGramSize && i + n < grams.GetSize();
+                         ++n)
+                    {
+                        term.AddTerm(Term(grams[i + n], node.GetStreamId(), configuration),
+                                     configuration);
+                        terms.push_back(term);
+                    }
+                }
+            }
+            break;
+        case TermMatchNode::UnigramMatch:
+            {
+                auto const & node = dynamic_cast<const TermMatchNode::Unigram&>(tree);
+                terms.push_back(Term(node.GetText(), node.GetStreamId(), configuration));
+            }
+            break;
+        case TermMatchNode::FactMatch:
+            break;
+        default:
+            RecoverableError error("GetQueryTerms: invalid node type.");
+            throw error;
+        }
+    }
+
+
+    void GetQueryRows(TermMatchNode const & tree,
+                      IConfiguration const & configuration,
+                      ITermTable const & termTable,
+                      std::vector<RowId>& rows)
+    {
+        std::vector<Term> terms;
+        GetQueryTerms(tree, configuration, terms);
+
+        for (auto const & term : terms)
+        {
+            RowIdSequence sequence(term, termTable);
+            rows.insert(rows.end(), sequence.begin(), sequence.end());
+        }
+    }
+}
@@ -20,14 +20,19 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <chrono>
+#include <cmath>                // std::log.
 #include <condition_variable>
+#include <iomanip>              // std::setw.
 #include <iostream>             // Used for DiagnosticStream ref; not actually used.
+#include <thread>               // std::this_thread::sleep_for.
 
 #include "BitFunnel/Configuration/Factories.h"
 #include "BitFunnel/Configuration/IStreamConfiguration.h"
 #include "BitFunnel/IDiagnosticStream.h"
 #include "BitFunnel/Index/IIngestor.h"
 #include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Plan/ExecutionProfile.h"
 #include "BitFunnel/Plan/Factories.h"
 #include "BitFunnel/Plan/QueryInstrumentation.h"
 #include "BitFunnel/Plan/IQueryEngine.h"
@@ -36,6 +41,10 @@
 #include "BitFunnel/Plan/ResultsBuffer.h"
 #include "BitFunnel/Utilities/Factories.h"
 #include "BitFunnel/Utilities/Allocator.h"
+#include "BitFunnel/Utilities/BlockingQueue.h"
+#include "BitFunnel/Utilities/HardwareCounters.h"
+#include "BitFunnel/Utilities/LatencyHistogram.h"
+#include "BitFunnel/Utilities/Random.h"
 #include "ByteCodeQueryEngine.h"
 #include "CsvTsv/Csv.h"
 #include "NativeJITQueryEngine.h"
@@ -51,7 +60,11 @@ namespace BitFunnel
         double elapsedTime,
         double parsingTime,
         double planningTime,
-        double matchingTime)
+        double matchingTime,
+        LatencyHistogram const & parsingHistogram,
+        LatencyHistogram const & planningHistogram,
+        LatencyHistogram const & matchingHistogram,
+        LatencyHistogram const & totalHistogram)
       : m_threadCount(threadCount),
         m_uniqueQueryCount(uniqueQueryCount),
         m_processedCount(processedCount),
@@ -59,7 +72,11 @@ namespace BitFunnel
         m_elapsedTime(elapsedTime),
         m_parsingLatency(parsingTime),
         m_planningLatency(planningTime),
-        m_matchingLatency(matchingTime)
+        m_matchingLatency(matchingTime),
+        m_parsingHistogram(parsingHistogram),
+        m_planningHistogram(planningHistogram),
+        m_matchingHistogram(matchingHistogram),
+        m_totalHistogram(totalHistogram)
     {
     }
 
@@ -89,6 +106,110 @@ namespace BitFunnel
             << "QPS: " << m_processedCount / m_elapsedTime << std::endl
             << "MPS: " << m_matchCount / m_elapsedTime << std::endl
             << "MPQ: " << static_cast<double>(m_matchCount) / m_processedCount << std::endl;
+
+        out << std::endl << "Latency percentiles (microseconds):" << std::endl;
+        LatencyHistogram::WritePercentiles(
+            out,
+            { "parse", "plan", "match", "total" },
+            { &m_parsingHistogram,
+              &m_planningHistogram,
+              &m_matchingHistogram,
+              &m_totalHistogram });
+    }
+
+
+    double QueryRunner::Statistics::GetQueriesPerSecond() const
+    {
+        return (m_elapsedTime > 0.0) ? m_processedCount / m_elapsedTime : 0.0;
+    }
+
+
+    size_t QueryRunner::Statistics::GetProcessedCount() const
+    {
+        return m_processedCount;
+    }
+
+
+    LatencyHistogram const & QueryRunner::Statistics::GetTotalHistogram() const
+    {
+        return m_totalHistogram;
+    }
+
+
+    //*************************************************************************
+    //
+    // QueryRunner::LoadStatistics
+    //
+    //*************************************************************************
+    QueryRunner::LoadStatistics::LoadStatistics(
+        double targetQps,
+        size_t offeredCount,
+        size_t processedCount,
+        double elapsedTime,
+        LatencyHistogram const & responseTime,
+        LatencyHistogram const & serviceTime)
+      : m_targetQps(targetQps),
+        m_offeredCount(offeredCount),
+        m_processedCount(processedCount),
+        m_elapsedTime(elapsedTime),
+        m_responseTime(responseTime),
+        m_serviceTime(serviceTime)
+    {
+    }
+
+
+    void QueryRunner::LoadStatistics::PrintHeader(std::ostream& out)
+    {
+        const int c_width = 12;
+        out << std::setw(c_width) << "targetQPS"
+            << std::setw(c_width) << "actualQPS"
+            << std::setw(c_width) << "offered"
+            << std::setw(c_width) << "processed"
+            << std::setw(c_width) << "service"
+            << std::setw(c_width) << "p50"
+            << std::setw(c_width) << "p90"
+            << std::setw(c_width) << "p99"
+            << std::setw(c_width) << "p99.9"
+            << std::setw(c_width) << "max"
+            << std::endl;
+    }
+
+
+    void QueryRunner::LoadStatistics::PrintRow(std::ostream& out) const
+    {
+        // Latencies are reported in microseconds, matching the percentile
+        // table written by Statistics::Print().
+        const int c_width = 12;
+        out << std::setw(c_width) << m_targetQps
+            << std::setw(c_width) << GetQueriesPerSecond()
+            << std::setw(c_width) << m_offeredCount
+            << std::setw(c_width) << m_processedCount
+            << std::setw(c_width) << m_serviceTime.GetMean() * 1e6
+            << std::setw(c_width) << m_responseTime.GetPercentile(50.0) * 1e6
+            << std::setw(c_width) << m_responseTime.GetPercentile(90.0) * 1e6
+            << std::setw(c_width) << m_responseTime.GetPercentile(99.0) * 1e6
+            << std::setw(c_width) << m_responseTime.GetPercentile(99.9) * 1e6
+            << std::setw(c_width) << m_responseTime.GetMax() * 1e6
+            << std::endl;
+    }
+
+
+    double QueryRunner::LoadStatistics::GetQueriesPerSecond() const
+    {
+        return (m_elapsedTime > 0.0) ? m_processedCount / m_elapsedTime : 0.0;
+    }
+
+
+    size_t QueryRunner::LoadStatistics::GetProcessedCount() const
+    {
+        return m_processedCount;
+    }
+
+
+    LatencyHistogram const &
+        QueryRunner::LoadStatistics::GetResponseTimeHistogram() const
+    {
+        return m_responseTime;
     }
 
 
@@ -154,6 +275,47 @@ namespace BitFunnel
     }
 
 
+    //*************************************************************************
+    //
+    // CreateQueryEngine
+    //
+    // Creates the per-thread query engine used by both QueryProcessor and
+    // OpenLoopWorker.
+    //
+    //*************************************************************************
+
+    // TODO: Issue #390. Trec 2006 Efficiency Topic 43860 is too bit for
+    // c_allocatorSize == 1ull << 17 when using TreatmentClassicBitsliced:
+    //     the nps air quality monitoring program provides information on ozone
+    //     levels acid rain and visibility impairment in parks from 1990 1999
+    //     of the 28 parks that were monitored for visibility
+    static const size_t c_allocatorSize = 1ull << 17;
+
+    static std::unique_ptr<IQueryEngine>
+        CreateQueryEngine(ISimpleIndex const & index,
+                          IStreamConfiguration const & config,
+                          bool useNativeCode,
+                          bool countCacheLines)
+    {
+        std::unique_ptr<IQueryEngine> queryEngine;
+        if (useNativeCode)
+        {
+            queryEngine = std::unique_ptr<IQueryEngine>(new NativeJITQueryEngine(index, config, c_allocatorSize, c_allocatorSize));
+        }
+        else
+        {
+            queryEngine = std::unique_ptr<IQueryEngine>(new ByteCodeQueryEngine(index, config, c_allocatorSize));
+        }
+
+        if (countCacheLines)
+        {
+            queryEngine->EnableDiagnostic("planning/countcachelines");
+        }
+
+        return queryEngine;
+    }
+
+
     //*************************************************************************
     //
     // QueryProcessor
@@ -169,6 +331,7 @@ namespace BitFunnel
                        size_t maxResultCount,
                        bool useNativeCode,
                        bool countCacheLines,
+                       bool countHardwareEvents,
                        ThreadSynchronizer& synchronizer);
 
         //
@@ -178,6 +341,13 @@ namespace BitFunnel
         virtual void ProcessTask(size_t taskId) override;
         virtual void Finished() override;
 
+        // Latency distributions of the queries processed by this thread.
+        // Only valid after processing has finished.
+        LatencyHistogram const & GetParsingHistogram() const;
+        LatencyHistogram const & GetPlanningHistogram() const;
+        LatencyHistogram const & GetMatchingHistogram() const;
+        LatencyHistogram const & GetTotalHistogram() const;
+
     private:
         //
         // constructor parameters
@@ -194,12 +364,19 @@ namespace BitFunnel
 
         size_t m_queriesProcessed;
 
-        // TODO: Issue #390. Trec 2006 Efficiency Topic 43860 is too bit for
-        // c_allocatorSize == 1ull << 17 when using TreatmentClassicBitsliced:
-        //     the nps air quality monitoring program provides information on ozone
-        //     levels acid rain and visibility impairment in parks from 1990 1999
-        //     of the 28 parks that were monitored for visibility
-        static const size_t c_allocatorSize = 1ull << 17;
+        // Hardware counters count events for the thread that opens them, so
+        // they are created by the first call to ProcessTask(), which runs on
+        // the processor's worker thread.
+        bool m_countHardwareEvents;
+        std::unique_ptr<HardwareCounters> m_hardwareCounters;
+
+        // Each thread records into its own histograms so that no
+        // synchronization is needed on the query path. QueryRunner merges
+        // them after all threads have finished.
+        LatencyHistogram m_parsingHistogram;
+        LatencyHistogram m_planningHistogram;
+        LatencyHistogram m_matchingHistogram;
+        LatencyHistogram m_totalHistogram;
     };
 
 
@@ -210,27 +387,20 @@ namespace BitFunnel
                                    size_t maxResultCount,
                                    bool useNativeCode,
                                    bool countCacheLines,
+                                   bool countHardwareEvents,
                                    ThreadSynchronizer& synchronizer)
       : m_queries(queries),
         m_results(results),
         m_synchronizer(synchronizer),
         m_matches(maxResultCount, {nullptr, 0}),
         m_resultsBuffer(index.GetIngestor().GetDocumentCount()),
-        m_queriesProcessed(0)
+        m_queriesProcessed(0),
+        m_countHardwareEvents(countHardwareEvents)
     {
-        if (useNativeCode)
-        {
-            m_queryEngine = std::unique_ptr<IQueryEngine>(new NativeJITQueryEngine(index, config, c_allocatorSize, c_allocatorSize));
-        }
-        else
-        {
-            m_queryEngine = std::unique_ptr<IQueryEngine>(new ByteCodeQueryEngine(index, config, c_allocatorSize));
-        }
-
-        if (countCacheLines)
-        {
-            m_queryEngine->EnableDiagnostic("planning/countcachelines");
-        }
+        m_queryEngine = CreateQueryEngine(index,
+                                          config,
+                                          useNativeCode,
+                                          countCacheLines);
     }
 
 
@@ -239,11 +409,16 @@ namespace BitFunnel
         // If this is the first query, wait for other threads before continuing.
         if (m_queriesProcessed == 0)
         {
+            if (m_countHardwareEvents)
+            {
+                m_hardwareCounters.reset(new HardwareCounters());
+            }
             m_synchronizer.Wait();
         }
         ++m_queriesProcessed;
 
         QueryInstrumentation instrumentation;
+        instrumentation.SetHardwareCounters(m_hardwareCounters.get());
 
         size_t queryId = taskId % m_queries.size();
 
@@ -266,7 +441,18 @@ namespace BitFunnel
             // The instrumentation for this query will show that it didn't succeed.
         }
 
-        m_results[taskId] = instrumentation.GetData();
+        QueryInstrumentation::Data data = instrumentation.GetData();
+        if (data.GetSucceeded())
+        {
+            m_parsingHistogram.Record(data.GetParsingTime());
+            m_planningHistogram.Record(data.GetPlanningTime());
+            m_matchingHistogram.Record(data.GetMatchingTime());
+            m_totalHistogram.Record(data.GetParsingTime() +
+                                    data.GetPlanningTime() +
+                                    data.GetMatchingTime());
+        }
+
+        m_results[taskId] = data;
     }
 
 
@@ -274,6 +460,166 @@ namespace BitFunnel
     {
     }
 
+
+    LatencyHistogram const & QueryProcessor::GetParsingHistogram() const
+    {
+        return m_parsingHistogram;
+    }
+
+
+    LatencyHistogram const & QueryProcessor::GetPlanningHistogram() const
+    {
+        return m_planningHistogram;
+    }
+
+
+    LatencyHistogram const & QueryProcessor::GetMatchingHistogram() const
+    {
+        return m_matchingHistogram;
+    }
+
+
+    LatencyHistogram const & QueryProcessor::GetTotalHistogram() const
+    {
+        return m_totalHistogram;
+    }
+
+
+    //*************************************************************************
+    //
+    // OpenLoopWorker
+    //
+    // Services queries that the open loop generator in RunOpenLoop() has
+    // placed in a shared queue. Response time is measured from the time at
+    // which a request was scheduled to arrive, not the time at which it was
+    // dequeued, so that time spent waiting behind a backlog is charged to
+    // the request.
+    //
+    //*************************************************************************
+    struct OpenLoopRequest
+    {
+        size_t m_queryId;
+
+        // Scheduled arrival time, in seconds since the start of the run.
+        double m_arrivalTime;
+    };
+
+
+    class OpenLoopWorker : public IThreadBase
+    {
+    public:
+        OpenLoopWorker(ISimpleIndex const & index,
+                       IStreamConfiguration const & config,
+                       std::vector<std::string> const & queries,
+                       BlockingQueue<OpenLoopRequest> & requests,
+                       Stopwatch const & clock,
+                       bool useNativeCode,
+                       size_t maxResultCount);
+
+        //
+        // IThreadBase methods
+        //
+
+        virtual void EntryPoint() override;
+
+        size_t GetProcessedCount() const;
+        LatencyHistogram const & GetResponseTimeHistogram() const;
+        LatencyHistogram const & GetServiceTimeHistogram() const;
+
+    private:
+        //
+        // constructor parameters
+        //
+        std::vector<std::string> const & m_queries;
+        BlockingQueue<OpenLoopRequest> & m_requests;
+        Stopwatch const & m_clock;
+
+        ResultsBuffer m_resultsBuffer;
+
+        std::unique_ptr<IQueryEngine> m_queryEngine;
+
+        size_t m_processedCount;
+
+        // Time from scheduled arrival to completion.
+        LatencyHistogram m_responseTime;
+
+        // Time from dequeue to completion.
+        LatencyHistogram m_serviceTime;
+    };
+
+
+    OpenLoopWorker::OpenLoopWorker(ISimpleIndex const & index,
+                                   IStreamConfiguration const & config,
+                                   std::vector<std::string> const & queries,
+                                   BlockingQueue<OpenLoopRequest> & requests,
+                                   Stopwatch const & clock,
+                                   bool useNativeCode,
+                                   size_t maxResultCount)
+      : m_queries(queries),
+        m_requests(requests),
+        m_clock(clock),
+        m_resultsBuffer(maxResultCount),
+        m_queryEngine(CreateQueryEngine(index, config, useNativeCode, false)),
+        m_processedCount(0)
+    {
+    }
+
+
+    void OpenLoopWorker::EntryPoint()
+    {
+        OpenLoopRequest request;
+        while (m_requests.TryDequeue(request))
+        {
+            const double startTime = m_clock.ElapsedTime();
+            QueryInstrumentation instrumentation;
+
+            try
+            {
+                auto tree = m_queryEngine->Parse(m_queries[request.m_queryId].c_str());
+                instrumentation.FinishParsing();
+
+                if (tree != nullptr)
+                {
+                    m_queryEngine->Run(tree,
+                                       instrumentation,
+                                       m_resultsBuffer);
+                }
+            }
+            catch (RecoverableError e)
+            {
+                // Failed queries still occupied the worker, but they are
+                // not included in the latency distributions.
+            }
+
+            const double finishTime = m_clock.ElapsedTime();
+            if (instrumentation.GetData().GetSucceeded())
+            {
+                ++m_processedCount;
+                m_responseTime.Record(finishTime - request.m_arrivalTime);
+                m_serviceTime.Record(finishTime - startTime);
+            }
+        }
+    }
+
+
+    size_t OpenLoopWorker::GetProcessedCount() const
+    {
+        return m_processedCount;
+    }
+
+
+    LatencyHistogram const & OpenLoopWorker::GetResponseTimeHistogram() const
+    {
+        return m_responseTime;
+    }
+
+
+    LatencyHistogram const & OpenLoopWorker::GetServiceTimeHistogram() const
+    {
+        return m_serviceTime;
+    }
+
+
     //*************************************************************************
     //
     // QueryRunner
@@ -283,7 +629,8 @@ namespace BitFunnel
         char const * query,
         ISimpleIndex const & index,
         bool useNativeCode,
-        bool countCacheLines)
+        bool countCacheLines,
+        bool countHardwareEvents)
     {
         std::vector<std::string> queries;
         queries.push_back(std::string(query));
@@ -304,6 +651,7 @@ namespace BitFunnel
                       maxResultCount,
                       useNativeCode,
                       countCacheLines,
+                      countHardwareEvents,
                       synchronizer);
         processor.ProcessTask(0);
         processor.Finished();
@@ -312,6 +660,28 @@ namespace BitFunnel
     }
 
 
+    QueryInstrumentation::Data QueryRunner::Explain(
+        char const * query,
+        ISimpleIndex const & index,
+        ExecutionProfile & profile)
+    {
+        auto config = Factories::CreateStreamConfiguration();
+        ByteCodeQueryEngine queryEngine(index, *config, c_allocatorSize);
+        ResultsBuffer results(index.GetIngestor().GetDocumentCount());
+
+        QueryInstrumentation instrumentation;
+        auto tree = queryEngine.Parse(query);
+        instrumentation.FinishParsing();
+
+        if (tree != nullptr)
+        {
+            queryEngine.Run(tree, instrumentation, results, profile);
+        }
+
+        return instrumentation.GetData();
+    }
+
+
     QueryRunner::Statistics QueryRunner::Run(
         ISimpleIndex const & index,
         char const * outDir,
@@ -319,7 +689,8 @@ namespace BitFunnel
         std::vector<std::string> const & queries,
         size_t iterations,
         bool useNativeCode,
-        bool countCacheLines)
+        bool countCacheLines,
+        bool countHardwareEvents)
     {
         std::vector<QueryInstrumentation::Data> results(queries.size() * iterations);
 
@@ -330,17 +701,20 @@ namespace BitFunnel
         ThreadSynchronizer synchronizer(threadCount);
 
         std::vector<std::unique_ptr<ITaskProcessor>> processors;
+        std::vector<QueryProcessor const *> queryProcessors;
         for (size_t i = 0; i < threadCount; ++i) {
-            processors.push_back(
-                std::unique_ptr<ITaskProcessor>(
-                    new QueryProcessor(index,
-                                       *config,
-                                       queries,
-                                       results,
-                                       maxResultCount,
-                                       useNativeCode,
-                                       countCacheLines,
-                                       synchronizer)));
+            QueryProcessor* processor =
+                new QueryProcessor(index,
+                                   *config,
+                                   queries,
+                                   results,
+                                   maxResultCount,
+                                   useNativeCode,
+                                   countCacheLines,
+                                   countHardwareEvents,
+                                   synchronizer);
+            queryProcessors.push_back(processor);
+            processors.push_back(std::unique_ptr<ITaskProcessor>(processor));
         }
 
         auto distributor =
@@ -368,6 +742,18 @@ namespace BitFunnel
             }
         }
 
+        LatencyHistogram parsingHistogram;
+        LatencyHistogram planningHistogram;
+        LatencyHistogram matchingHistogram;
+        LatencyHistogram totalHistogram;
+        for (auto processor : queryProcessors)
+        {
+            parsingHistogram.Merge(processor->GetParsingHistogram());
+            planningHistogram.Merge(processor->GetPlanningHistogram());
+            matchingHistogram.Merge(processor->GetMatchingHistogram());
+            totalHistogram.Merge(processor->GetTotalHistogram());
+        }
+
         auto statistics(QueryRunner::Statistics(threadCount,
                                                 queries.size(),
                                                 queriesProcessed,
@@ -375,7 +761,11 @@ namespace BitFunnel
                                                 elapsedTime,
                                                 totalParsingTime,
                                                 totalPlanningTime,
-                                                totalMatchingTime));
+                                                totalMatchingTime,
+                                                parsingHistogram,
+                                                planningHistogram,
+                                                matchingHistogram,
+                                                totalHistogram));
 
         {
             std::cout << "Writing results ..." << std::endl;
@@ -399,4 +789,132 @@ namespace BitFunnel
 
         return statistics;
     }
+
+
+    QueryRunner::LoadStatistics QueryRunner::RunOpenLoop(
+        ISimpleIndex const & index,
+        size_t threadCount,
+        std::vector<std::string> const & queries,
+        double targetQps,
+        double duration,
+        ArrivalProcess arrivals,
+        size_t queueCapacity,
+        bool useNativeCode)
+    {
+        return RunOpenLoop(index,
+                           threadCount,
+                           queries,
+                           targetQps,
+                           duration,
+                           arrivals,
+                           queueCapacity,
+                           useNativeCode,
+                           index.GetIngestor().GetDocumentCount());
+    }
+
+
+    QueryRunner::LoadStatistics QueryRunner::RunOpenLoop(
+        ISimpleIndex const & index,
+        size_t threadCount,
+        std::vector<std::string> const & queries,
+        double targetQps,
+        double duration,
+        ArrivalProcess arrivals,
+        size_t queueCapacity,
+        bool useNativeCode,
+        size_t maxResultCount)
+    {
+        if (queries.empty() || !(targetQps > 0.0) || !(duration > 0.0))
+        {
+            throw RecoverableError("QueryRunner::RunOpenLoop(): expected queries, a positive target QPS and a positive duration.");
+        }
+
+        // Compute the whole arrival schedule up front so that the generator
+        // loop does no work beyond waiting and enqueueing. A fixed seed makes
+        // Poisson schedules repeatable from run to run.
+        const unsigned c_seed = 12345;
+        RandomReal<double> uniform(c_seed, 0.0, 1.0);
+        std::vector<double> schedule;
+        double arrivalTime = 0.0;
+        while (arrivalTime < duration)
+        {
+            schedule.push_back(arrivalTime);
+            if (arrivals == PoissonArrivals)
+            {
+                // Exponentially distributed inter-arrival times.
+                arrivalTime += -std::log(1.0 - uniform()) / targetQps;
+            }
+            else
+            {
+                arrivalTime += 1.0 / targetQps;
+            }
+        }
+
+        auto config = Factories::CreateStreamConfiguration();
+        BlockingQueue<OpenLoopRequest> requests(static_cast<unsigned>(queueCapacity));
+        Stopwatch clock;
+
+        std::vector<std::unique_ptr<IThreadBase>> threads;
+        std::vector<OpenLoopWorker const *> workers;
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            OpenLoopWorker* worker =
+                new OpenLoopWorker(index,
+                                   *config,
+                                   queries,
+                                   requests,
+                                   clock,
+                                   useNativeCode,
+                                   maxResultCount);
+            workers.push_back(worker);
+            threads.push_back(std::unique_ptr<IThreadBase>(worker));
+        }
+        auto threadManager = Factories::CreateThreadManager(threads);
+
+        // Start the clock once the workers have been constructed so that
+        // engine setup isn't charged to the first requests.
+        clock.Reset();
+        for (size_t i = 0; i < schedule.size(); ++i)
+        {
+            // Sleep until shortly before the arrival, then spin the rest of
+            // the way for accuracy at high rates.
+            double remaining = schedule[i] - clock.ElapsedTime();
+            while (remaining > 0.0)
+            {
+                if (remaining > 0.0002)
+                {
+                    std::this_thread::sleep_for(
+                        std::chrono::duration<double>(remaining - 0.0001));
+                }
+                remaining = schedule[i] - clock.ElapsedTime();
+            }
+
+            // When the queue is full this blocks, delaying subsequent
+            // arrivals. Their response times are still measured from their
+            // scheduled arrival, so the backlog shows up in the latencies
+            // rather than being hidden.
+            requests.TryEnqueue({ i % queries.size(), schedule[i] });
+        }
+
+        requests.Shutdown();
+        threadManager->WaitForThreads();
+        const double elapsedTime = clock.ElapsedTime();
+
+        size_t processedCount = 0;
+        LatencyHistogram responseTime;
+        LatencyHistogram serviceTime;
+        for (auto worker : workers)
+        {
+            processedCount += worker->GetProcessedCount();
+            responseTime.Merge(worker->GetResponseTimeHistogram());
+            serviceTime.Merge(worker->GetServiceTimeHistogram());
+        }
+
+        return LoadStatistics(targetQps,
+                              schedule.size(),
+                              processedCount,
+                              elapsedTime,
+                              responseTime,
+                              serviceTime);
+    }
 }
@@ -0,0 +1,124 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+
+#include "BitFunnel/Index/IShard.h"
+#include "IPlanRows.h"
+#include "RowMatchNode.h"
+#include "RowSummaryFilter.h"
+
+
+namespace BitFunnel
+{
+    RowSummaryFilter::RowSummaryFilter(IShard const & shard,
+                                       ShardId shardId,
+                                       IPlanRows const & planRows,
+                                       std::vector<unsigned> const & requiredRows)
+    {
+        for (auto id : requiredRows)
+        {
+            m_summaryBits.push_back(
+                shard.GetRowSummaryBitOffset(planRows.PhysicalRow(shardId, id)));
+        }
+
+        // Duplicates arise when several plan rows map to the same physical
+        // row. Sorting also makes the summary reads sequential.
+        std::sort(m_summaryBits.begin(), m_summaryBits.end());
+        m_summaryBits.erase(std::unique(m_summaryBits.begin(),
+                                        m_summaryBits.end()),
+                            m_summaryBits.end());
+    }
+
+
+    size_t RowSummaryFilter::Filter(std::vector<void*> const & sliceBuffers,
+                                    std::vector<void*>& filtered) const
+    {
+        size_t skipped = 0;
+        for (auto sliceBuffer : sliceBuffers)
+        {
+            if (MayMatch(sliceBuffer))
+            {
+                filtered.push_back(sliceBuffer);
+            }
+            else
+            {
+                ++skipped;
+            }
+        }
+        return skipped;
+    }
+
+
+    void RowSummaryFilter::GetRequiredRows(RowMatchNode const & tree,
+                                           std::vector<unsigned>& rows)
+    {
+        switch (tree.GetType())
+        {
+        case RowMatchNode::AndMatch:
+            {
+                RowMatchNode::And const & node =
+                    dynamic_cast<RowMatchNode::And const &>(tree);
+                GetRequiredRows(node.GetLeft(), rows);
+                GetRequiredRows(node.GetRight(), rows);
+            }
+            break;
+        case RowMatchNode::ReportMatch:
+            {
+                RowMatchNode::Report const & node =
+                    dynamic_cast<RowMatchNode::Report const &>(tree);
+                if (node.GetChild() != nullptr)
+                {
+                    GetRequiredRows(*node.GetChild(), rows);
+                }
+            }
+            break;
+        case RowMatchNode::RowMatch:
+            {
+                AbstractRow const & row =
+                    dynamic_cast<RowMatchNode::Row const &>(tree).GetRow();
+                if (!row.IsInverted())
+                {
+                    rows.push_back(row.GetId());
+                }
+            }
+            break;
+        default:
+            // A match under an Or or a Not does not require any single row.
+            break;
+        }
+    }
+
+
+    bool RowSummaryFilter::MayMatch(void const * sliceBuffer) const
+    {
+        uint64_t const * buffer = reinterpret_cast<uint64_t const *>(sliceBuffer);
+        for (auto bit : m_summaryBits)
+        {
+            if ((buffer[bit >> 6] & (1ull << (bit & 0x3F))) == 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,75 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <stddef.h>                     // ptrdiff_t embedded.
+#include <vector>                       // std::vector embedded.
+
+#include "BitFunnel/BitFunnelTypes.h"   // ShardId parameter.
+#include "BitFunnel/NonCopyable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class IPlanRows;
+    class IShard;
+    class RowMatchNode;
+
+    //*************************************************************************
+    //
+    // RowSummaryFilter selects the slices in a shard that may contain
+    // matches for a query. A row is required if every match must have a bit
+    // set in it, i.e. it is a non-inverted row reachable from the root of
+    // the row plan through And nodes only. A slice whose row summary shows
+    // any required row to be empty cannot contain a match and is skipped
+    // without running the matcher over it.
+    //
+    //*************************************************************************
+    class RowSummaryFilter : NonCopyable
+    {
+    public:
+        // Constructs a filter for the physical rows in the specified shard
+        // that correspond to the required plan rows.
+        RowSummaryFilter(IShard const & shard,
+                         ShardId shardId,
+                         IPlanRows const & planRows,
+                         std::vector<unsigned> const & requiredRows);
+
+        // Appends to 'filtered' each slice buffer in which every required
+        // row may have bits set. Returns the number of slices skipped.
+        size_t Filter(std::vector<void*> const & sliceBuffers,
+                      std::vector<void*>& filtered) const;
+
+        // Appends the plan row ids of the required rows in the tree to
+        // 'rows'.
+        static void GetRequiredRows(RowMatchNode const & tree,
+                                    std::vector<unsigned>& rows);
+
+    private:
+        bool MayMatch(void const * sliceBuffer) const;
+
+        // Summary bit positions of the required rows, relative to the start
+        // of the slice buffer.
+        std::vector<ptrdiff_t> m_summaryBits;
+    };
+}
@@ -0,0 +1,204 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Mocks/Factories.h"
+#include "BitFunnel/Plan/ExecutionProfile.h"
+#include "BitFunnel/Plan/QueryInstrumentation.h"
+#include "BitFunnel/Plan/QueryRunner.h"
+
+
+namespace BitFunnel
+{
+    namespace QueryRunnerTest
+    {
+        TEST(QueryRunner, OpenLoop)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            const DocId c_maxDocId = 1000;
+            auto index = Factories::CreatePrimeFactorsIndex(*fileSystem,
+                                                            c_maxDocId,
+                                                            0,
+                                                            1);
+
+            std::vector<std::string> queries = { "2", "3 5", "7", "11 | 13" };
+
+            // A fixed rate schedule issues exactly duration * targetQps
+            // requests. The load is light enough that every request should
+            // complete well within the run.
+            const double c_targetQps = 500.0;
+            const double c_duration = 0.2;
+            auto statistics =
+                QueryRunner::RunOpenLoop(*index,
+                                         2,
+                                         queries,
+                                         c_targetQps,
+                                         c_duration,
+                                         QueryRunner::FixedRateArrivals,
+                                         16,
+                                         false);
+
+            auto const & responseTime = statistics.GetResponseTimeHistogram();
+            EXPECT_EQ(responseTime.GetCount(), 100u);
+            EXPECT_GT(responseTime.GetPercentile(50.0), 0.0);
+            EXPECT_GE(responseTime.GetMax(), responseTime.GetPercentile(99.0));
+            EXPECT_GT(statistics.GetQueriesPerSecond(), 0.0);
+
+            // Poisson arrivals are random, but the count should be close to
+            // the expected value.
+            statistics =
+                QueryRunner::RunOpenLoop(*index,
+                                         2,
+                                         queries,
+                                         c_targetQps,
+                                         c_duration,
+                                         QueryRunner::PoissonArrivals,
+                                         16,
+                                         false);
+            EXPECT_GT(statistics.GetResponseTimeHistogram().GetCount(), 50u);
+            EXPECT_LT(statistics.GetResponseTimeHistogram().GetCount(), 150u);
+        }
+
+
+        TEST(QueryRunner, NativeCacheLineCount)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            const DocId c_maxDocId = 2000;
+            auto index = Factories::CreatePrimeFactorsIndex(*fileSystem,
+                                                            c_maxDocId,
+                                                            0,
+                                                            1);
+
+            // The interpreter and the instrumented native matcher run the
+            // same plan, so they must load the same cache lines.
+            std::vector<char const *> queries =
+                { "2", "3 5", "11 | 13", "2 3 5 7" };
+            for (auto query : queries)
+            {
+                auto interpreter =
+                    QueryRunner::Run(query, *index, false, true, false);
+                auto native =
+                    QueryRunner::Run(query, *index, true, true, false);
+                auto uninstrumented =
+                    QueryRunner::Run(query, *index, true, false, false);
+
+                EXPECT_GT(interpreter.GetCacheLineCount(), 0u) << query;
+                EXPECT_EQ(interpreter.GetCacheLineCount(),
+                          native.GetCacheLineCount()) << query;
+                EXPECT_EQ(interpreter.GetMatchCount(),
+                          native.GetMatchCount()) << query;
+                EXPECT_EQ(native.GetMatchCount(),
+                          uninstrumented.GetMatchCount()) << query;
+                EXPECT_EQ(0u, uninstrumented.GetCacheLineCount()) << query;
+            }
+        }
+
+
+        TEST(QueryRunner, Explain)
+        {
+            auto fileSystem = Factories::CreateRAMFileSystem();
+            const DocId c_maxDocId = 2000;
+            auto index = Factories::CreatePrimeFactorsIndex(*fileSystem,
+                                                            c_maxDocId,
+                                                            0,
+                                                            1);
+
+            std::vector<char const *> queries =
+                { "2", "3 5", "11 | 13", "2 3 5 7" };
+            for (auto query : queries)
+            {
+                ExecutionProfile profile;
+                auto explained = QueryRunner::Explain(query, *index, profile);
+                auto expected =
+                    QueryRunner::Run(query, *index, false, false, false);
+
+                EXPECT_EQ(expected.GetMatchCount(),
+                          explained.GetMatchCount()) << query;
+
+                ASSERT_GT(profile.GetRows().size(), 0u) << query;
+                for (auto const & row : profile.GetRows())
+                {
+                    EXPECT_LE(row.m_zeroCount, row.m_quadwordCount) << query;
+                    EXPECT_LE(row.m_bitCount, row.m_quadwordCount * 64)
+                        << query;
+                    EXPECT_GE(row.GetDensity(), 0.0) << query;
+                    EXPECT_LE(row.GetDensity(), 1.0) << query;
+                }
+
+                for (auto const & jump : profile.GetJumps())
+                {
+                    EXPECT_LE(jump.m_firedCount, jump.m_executedCount)
+                        << query;
+                }
+
+                // Every match is reported by exactly one slice and one shard.
+                ASSERT_GT(profile.GetShards().size(), 0u) << query;
+                ASSERT_GT(profile.GetSlices().size(), 0u) << query;
+                size_t sliceMatches = 0;
+                for (auto const & slice : profile.GetSlices())
+                {
+                    sliceMatches += slice.m_matchCount;
+                }
+                size_t shardMatches = 0;
+                for (auto const & shard : profile.GetShards())
+                {
+                    EXPECT_LE(shard.m_scannedSliceCount, shard.m_sliceCount)
+                        << query;
+                    shardMatches += shard.m_matchCount;
+                }
+                EXPECT_EQ(explained.GetMatchCount(), sliceMatches) << query;
+                EXPECT_EQ(explained.GetMatchCount(), shardMatches) << query;
+            }
+
+            // Half of the documents contain the term "2", so each of its
+            // rows, at every rank, is half full. The plan also loads the
+            // document active row, in which almost every bit is set.
+            ExecutionProfile profile;
+            QueryRunner::Explain("2", *index, profile);
+            size_t termRows = 0;
+            size_t activeRows = 0;
+            for (auto const & row : profile.GetRows())
+            {
+                EXPECT_GT(row.m_quadwordCount, 0u);
+                if (row.GetDensity() > 0.9)
+                {
+                    ++activeRows;
+                }
+                else
+                {
+                    EXPECT_NEAR(row.GetDensity(), 0.5, 0.02);
+                    ++termRows;
+                }
+            }
+            EXPECT_EQ(1u, activeRows);
+            EXPECT_GT(termRows, 0u);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <sstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "BitFunnel/Utilities/Allocator.h"
+#include "RowMatchNode.h"
+#include "RowSummaryFilter.h"
+#include "TextObjectParser.h"
+
+
+namespace BitFunnel
+{
+    namespace RowSummaryFilterUnitTest
+    {
+        std::vector<unsigned> GetRequiredRows(char const * text)
+        {
+            std::stringstream input(text);
+            Allocator allocator(1024 * 4);
+            TextObjectParser parser(input, allocator, &RowPlanBase::GetType);
+            RowMatchNode const & root = RowMatchNode::Parse(parser);
+
+            std::vector<unsigned> rows;
+            RowSummaryFilter::GetRequiredRows(root, rows);
+            return rows;
+        }
+
+
+        TEST(RowSummaryFilter, GetRequiredRows)
+        {
+            // A single row is required.
+            EXPECT_EQ(std::vector<unsigned>({ 0 }),
+                      GetRequiredRows("Row(0, 0, 0, false)"));
+
+            // An inverted row is not.
+            EXPECT_EQ(std::vector<unsigned>(),
+                      GetRequiredRows("Row(0, 0, 0, true)"));
+
+            // Rows under And are required, rows under Or and Not are not.
+            EXPECT_EQ(std::vector<unsigned>({ 0, 3 }),
+                      GetRequiredRows(
+                          "And {"
+                          "  Children: ["
+                          "    Row(0, 0, 0, false),"
+                          "    Or {"
+                          "      Children: ["
+                          "        Row(1, 3, 0, false),"
+                          "        Row(2, 3, 0, false)"
+                          "      ]"
+                          "    },"
+                          "    Not {"
+                          "      Child: Row(4, 6, 0, false)"
+                          "    },"
+                          "    Row(3, 6, 0, false)"
+                          "  ]"
+                          "}"));
+        }
+    }
+}
@@ -26,11 +26,15 @@
 #include "BitFunnel/Configuration/Factories.h"
 #include "BitFunnel/Configuration/IFileSystem.h"
 #include "BitFunnelTool.h"
+#include "CorpusGenerator.h"
 #include "FilterChunks.h"
 #include "QueryLogBuilderTool.h"
 #include "REPL.h"
+#include "RowPlacementTool.h"
 #include "ShardBuilder.h"
+#include "SliceCapacityTuner.h"
 #include "StatisticsBuilder.h"
+#include "StatisticsMerger.h"
 #include "TermTableBuilderTool.h"
 
 
@@ -89,10 +93,18 @@ namespace BitFunnel
     {
         std::unique_ptr<IExecutable> executable;
 
-        if (strcmp(name, "filter") == 0)
+        if (strcmp(name, "corpus") == 0)
+        {
+            executable.reset(new CorpusGenerator(m_fileSystem));
+        }
+        else if (strcmp(name, "filter") == 0)
         {
             executable.reset(new FilterChunks(m_fileSystem));
         }
+        else if (strcmp(name, "merge") == 0)
+        {
+            executable.reset(new StatisticsMerger(m_fileSystem));
+        }
         else if (strcmp(name, "querylog") == 0)
         {
             executable.reset(new QueryLogBuilderTool(m_fileSystem));
@@ -101,10 +113,18 @@ namespace BitFunnel
         {
             executable.reset(new REPL(m_fileSystem));
         }
+        else if (strcmp(name, "rowplacement") == 0)
+        {
+            executable.reset(new RowPlacementTool(m_fileSystem));
+        }
         else if (strcmp(name, "shard") == 0)
         {
             executable.reset(new ShardBuilder(m_fileSystem));
         }
+        else if (strcmp(name, "slicecapacity") == 0)
+        {
+            executable.reset(new SliceCapacityTuner(m_fileSystem));
+        }
         else if (strcmp(name, "statistics") == 0)
         {
             executable.reset(new StatisticsBuilder(m_fileSystem));
@@ -146,9 +166,13 @@ namespace BitFunnel
             << "usage: BitFunnel <command> [<args>]" << std::endl
             << std::endl
             << "The most commonly used commands are" << std::endl
+            << "   corpus         Generate a synthetic Zipfian corpus and query log." << std::endl
             << "   filter         Copy the corpus, filtering documents by predicate." << std::endl
+            << "   merge          Combine partial statistics from 'statistics -partition'." << std::endl
             << "   querylog       Generate a random query log." << std::endl
+            << "   rowplacement   Reorder TermTable rows to match a query log." << std::endl
             << "   shard          Compute shard definition based on histogram." << std::endl
+            << "   slicecapacity  Choose slice capacities that maximize query throughput." << std::endl
             << "   statistics     Generate corpus statistics used to configure the index." << std::endl
             << "   termtable      Construct a term table based on generated corpus statistics." << std::endl
             << "   repl           Run interative read-eval-print console." << std::endl
@@ -0,0 +1,343 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Data/ZipfianChunks.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ITaskDistributor.h"
+#include "BitFunnel/Utilities/ITaskProcessor.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+#include "CmdLineParser/CmdLineParser.h"
+#include "CorpusGenerator.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // CorpusGenerator::ChunkProcessor
+    //
+    // Writes one chunk file per task.
+    //
+    //*************************************************************************
+    class CorpusGenerator::ChunkProcessor : public ITaskProcessor
+    {
+    public:
+        ChunkProcessor(IFileSystem& fileSystem,
+                       std::mutex& fileSystemLock,
+                       ZipfianChunks const & chunks,
+                       std::vector<std::string> const & paths)
+          : m_fileSystem(fileSystem),
+            m_fileSystemLock(fileSystemLock),
+            m_chunks(chunks),
+            m_paths(paths)
+        {
+        }
+
+        //
+        // ITaskProcessor methods
+        //
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            std::unique_ptr<std::ostream> out;
+            {
+                // IFileSystem implementations are not required to be
+                // threadsafe, so only the writes themselves run in parallel.
+                std::lock_guard<std::mutex> lock(m_fileSystemLock);
+                out = m_fileSystem.OpenForWrite(
+                    m_paths[taskId].c_str(),
+                    std::ios::out | std::ios::binary);
+            }
+            m_chunks.WriteChunk(*out, taskId);
+        }
+
+        virtual void Finished() override
+        {
+        }
+
+    private:
+        IFileSystem& m_fileSystem;
+        std::mutex& m_fileSystemLock;
+        ZipfianChunks const & m_chunks;
+        std::vector<std::string> const & m_paths;
+    };
+
+
+    //*************************************************************************
+    //
+    // CorpusGenerator
+    //
+    //*************************************************************************
+    CorpusGenerator::CorpusGenerator(IFileSystem& fileSystem)
+      : m_fileSystem(fileSystem)
+    {
+    }
+
+
+    int CorpusGenerator::Main(std::istream& /*input*/,
+                              std::ostream& output,
+                              int argc,
+                              char const *argv[])
+    {
+        CmdLine::CmdLineParser parser(
+            "CorpusGenerator",
+            "Write a synthetic corpus with a Zipfian vocabulary, its manifest, "
+            "and a matching query log.");
+
+        CmdLine::RequiredParameter<char const *> outputDirectory(
+            "outputDirectory",
+            "Existing directory where the chunk files, manifest.txt and "
+            "QueryLog.txt will be written.");
+
+        CmdLine::RequiredParameter<int> documentCount(
+            "documentCount",
+            "Number of documents in the corpus.",
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<int> chunkCount(
+            "chunks",
+            "Number of chunk files.",
+            16,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<int> threadCount(
+            "threads",
+            "Number of threads generating chunk files.",
+            1,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<int> seed(
+            "seed",
+            "Seed for the random number generators.",
+            1,
+            CmdLine::GreaterThanOrEqual(0));
+
+        CmdLine::OptionalParameter<int> vocabularySize(
+            "vocabulary",
+            "Number of distinct terms.",
+            100000,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<double> zipfExponent(
+            "zipf",
+            "Exponent of the Zipf rank-frequency distribution.",
+            1.0,
+            CmdLine::GreaterThanOrEqual(0.0));
+
+        CmdLine::OptionalParameter<int> streamCount(
+            "streams",
+            "Number of streams in each document.",
+            1,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<double> meanTerms(
+            "terms",
+            "Mean number of terms in each stream.",
+            100.0,
+            CmdLine::GreaterThanOrEqual(1.0));
+
+        CmdLine::OptionalParameter<double> termsDeviation(
+            "deviation",
+            "Standard deviation of the log-normal number of terms in each "
+            "stream.",
+            50.0,
+            CmdLine::GreaterThanOrEqual(0.0));
+
+        CmdLine::OptionalParameter<int> queryCount(
+            "queries",
+            "Number of queries in QueryLog.txt. Zero skips the query log.",
+            0,
+            CmdLine::GreaterThanOrEqual(0));
+
+        CmdLine::OptionalParameter<double> meanQueryTerms(
+            "queryterms",
+            "Mean number of terms in each query.",
+            2.0,
+            CmdLine::GreaterThanOrEqual(1.0));
+
+        CmdLine::OptionalParameter<double> headFraction(
+            "head",
+            "Fraction of query terms drawn from the head of the vocabulary, "
+            "the most frequent terms that make up half of all postings.",
+            0.3,
+            CmdLine::GreaterThanOrEqual(0.0));
+
+        CmdLine::OptionalParameter<double> tailFraction(
+            "tail",
+            "Fraction of query terms drawn from the tail of the vocabulary, "
+            "the rare terms that make up the last tenth of all postings. "
+            "The remaining terms come from the torso.",
+            0.2,
+            CmdLine::GreaterThanOrEqual(0.0));
+
+        parser.AddParameter(outputDirectory);
+        parser.AddParameter(documentCount);
+        parser.AddParameter(chunkCount);
+        parser.AddParameter(threadCount);
+        parser.AddParameter(seed);
+        parser.AddParameter(vocabularySize);
+        parser.AddParameter(zipfExponent);
+        parser.AddParameter(streamCount);
+        parser.AddParameter(meanTerms);
+        parser.AddParameter(termsDeviation);
+        parser.AddParameter(queryCount);
+        parser.AddParameter(meanQueryTerms);
+        parser.AddParameter(headFraction);
+        parser.AddParameter(tailFraction);
+
+        int returnCode = 1;
+
+        if (parser.TryParse(output, argc, argv))
+        {
+            try
+            {
+                if (streamCount > 256)
+                {
+                    RecoverableError error("Stream count must not exceed 256.");
+                    throw error;
+                }
+                if (headFraction + tailFraction > 1.0)
+                {
+                    RecoverableError error("Head and tail fractions must not exceed 1.");
+                    throw error;
+                }
+
+                GenerateCorpus(output,
+                               outputDirectory,
+                               static_cast<size_t>(documentCount),
+                               static_cast<size_t>(chunkCount),
+                               static_cast<size_t>(threadCount),
+                               static_cast<unsigned>(seed),
+                               static_cast<size_t>(vocabularySize),
+                               zipfExponent,
+                               static_cast<size_t>(streamCount),
+                               meanTerms,
+                               termsDeviation,
+                               static_cast<size_t>(queryCount),
+                               meanQueryTerms,
+                               headFraction,
+                               tailFraction);
+                returnCode = 0;
+            }
+            catch (RecoverableError e)
+            {
+                output << "Error: " << e.what() << std::endl;
+            }
+            catch (...)
+            {
+                output << "Unexpected error." << std::endl;
+            }
+        }
+
+        return returnCode;
+    }
+
+
+    void CorpusGenerator::GenerateCorpus(std::ostream& output,
+                                         char const * outputDirectory,
+                                         size_t documentCount,
+                                         size_t chunkCount,
+                                         size_t threadCount,
+                                         unsigned seed,
+                                         size_t vocabularySize,
+                                         double zipfExponent,
+                                         size_t streamCount,
+                                         double meanTerms,
+                                         double termsDeviation,
+                                         size_t queryCount,
+                                         double meanQueryTerms,
+                                         double headFraction,
+                                         double tailFraction) const
+    {
+        ZipfianChunks chunks(seed,
+                             vocabularySize,
+                             zipfExponent,
+                             documentCount,
+                             chunkCount,
+                             streamCount,
+                             meanTerms,
+                             termsDeviation);
+
+        const std::string directory(outputDirectory);
+        auto makePath = [&directory](std::string const & name)
+        {
+            return directory + "/" + name;
+        };
+
+        std::vector<std::string> paths;
+        {
+            auto manifest = m_fileSystem.OpenForWrite(
+                makePath("manifest.txt").c_str());
+            for (size_t i = 0; i < chunkCount; ++i)
+            {
+                paths.push_back(makePath(chunks.GetChunkName(i)));
+                *manifest << paths.back() << std::endl;
+            }
+        }
+
+        output
+            << "Writing " << documentCount << " documents to "
+            << chunkCount << " chunks in '" << outputDirectory << "' using "
+            << threadCount << " thread(s)." << std::endl;
+
+        Stopwatch stopwatch;
+        std::mutex fileSystemLock;
+        std::vector<std::unique_ptr<ITaskProcessor>> processors;
+        for (size_t i = 0; i < (std::min)(threadCount, chunkCount); ++i)
+        {
+            processors.push_back(
+                std::unique_ptr<ITaskProcessor>(
+                    new ChunkProcessor(m_fileSystem,
+                                       fileSystemLock,
+                                       chunks,
+                                       paths)));
+        }
+        auto distributor =
+            Factories::CreateTaskDistributor(processors, chunkCount);
+        distributor->WaitForCompletion();
+
+        output
+            << "Wrote corpus in " << stopwatch.ElapsedTime()
+            << " seconds." << std::endl;
+
+        if (queryCount > 0)
+        {
+            auto queryLog = m_fileSystem.OpenForWrite(
+                makePath("QueryLog.txt").c_str());
+            chunks.WriteQueryLog(*queryLog,
+                                 queryCount,
+                                 meanQueryTerms,
+                                 headFraction,
+                                 tailFraction);
+            output << "Wrote " << queryCount << " queries." << std::endl;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>                   // std::ostream parameter.
+#include <stddef.h>                 // size_t parameter.
+
+#include "BitFunnel/IExecutable.h"  // Base class.
+
+
+namespace BitFunnel
+{
+    class IFileSystem;
+
+    //*************************************************************************
+    //
+    // CorpusGenerator
+    //
+    // An IExecutable that writes a synthetic corpus of chunk files with a
+    // Zipfian vocabulary, along with a manifest for the 'statistics' command
+    // and the REPL, and optionally a query log over the same vocabulary.
+    // Chunks are generated in parallel and the output depends only on the
+    // seed and the corpus parameters, not on the number of threads.
+    //
+    //*************************************************************************
+    class CorpusGenerator : public IExecutable
+    {
+    public:
+        CorpusGenerator(IFileSystem& fileSystem);
+
+        //
+        // IExecutable methods
+        //
+        virtual int Main(std::istream& input,
+                         std::ostream& output,
+                         int argc,
+                         char const *argv[]) override;
+
+    private:
+        class ChunkProcessor;
+
+        void GenerateCorpus(std::ostream& output,
+                            char const * outputDirectory,
+                            size_t documentCount,
+                            size_t chunkCount,
+                            size_t threadCount,
+                            unsigned seed,
+                            size_t vocabularySize,
+                            double zipfExponent,
+                            size_t streamCount,
+                            double meanTerms,
+                            double termsDeviation,
+                            size_t queryCount,
+                            double meanQueryTerms,
+                            double headFraction,
+                            double tailFraction) const;
+
+        IFileSystem& m_fileSystem;
+    };
+}
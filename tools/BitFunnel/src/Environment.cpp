@@ -21,7 +21,10 @@
 // THE SOFTWARE.
 
 #include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IIngestor.h"
 #include "BitFunnel/Index/IRecycler.h"
+#include "BitFunnel/Utilities/MetricsExporter.h"
+#include "BitFunnel/Utilities/MetricsRegistry.h"
 #include "AnalyzeCommand.h"
 #include "CacheLineCountCommand.h"
 #include "CdCommand.h"
@@ -30,17 +33,21 @@
 #include "Environment.h"
 #include "ExitCommand.h"
 #include "FailOnExceptionCommand.h"
+#include "HardwareCountersCommand.h"
 #include "HelpCommand.h"
 #include "IngestCommands.h"
 #include "InterpreterCommand.h"
+#include "MetricsCommand.h"
 #include "QueryCommand.h"
 #include "ScriptCommand.h"
 #include "ShardCommand.h"
 #include "ShowCommand.h"
 #include "StatusCommand.h"
+#include "StressCommand.h"
 #include "TaskFactory.h"
 #include "TaskPool.h"
 #include "ThreadsCommand.h"
+#include "TraceCommand.h"
 #include "VerifyCommand.h"
 #include "SaveCommand.h"
 
@@ -60,9 +67,11 @@ namespace BitFunnel
         // Start one extra thread for the Recycler.
         m_taskPool(new TaskPool(threadCount + 1)),
         m_index(Factories::CreateSimpleIndex(fileSystem)),
+        m_metrics(new MetricsRegistry()),
         m_cacheLineCountMode(false),
         m_compilerMode(true),
         m_failOnException(false),
+        m_hardwareCounterMode(false),
         m_threadCount(threadCount),
         m_memory(memory),
         m_directory(directory),
@@ -85,15 +94,19 @@ namespace BitFunnel
         m_taskFactory->RegisterCommand<Correlate>();
         m_taskFactory->RegisterCommand<Exit>();
         m_taskFactory->RegisterCommand<FailOnException>();
+        m_taskFactory->RegisterCommand<HardwareCountersCommand>();
         m_taskFactory->RegisterCommand<Help>();
         m_taskFactory->RegisterCommand<InterpreterCommand>();
         m_taskFactory->RegisterCommand<Load>();
+        m_taskFactory->RegisterCommand<MetricsCommand>();
         m_taskFactory->RegisterCommand<Query>();
         m_taskFactory->RegisterCommand<Script>();
         m_taskFactory->RegisterCommand<ShardCommand>();
         m_taskFactory->RegisterCommand<Show>();
         m_taskFactory->RegisterCommand<Status>();
+        m_taskFactory->RegisterCommand<StressCommand>();
         m_taskFactory->RegisterCommand<ThreadsCommand>();
+        m_taskFactory->RegisterCommand<TraceCommand>();
         m_taskFactory->RegisterCommand<Verify>();
         m_taskFactory->RegisterCommand<WriteSlicesCommand>();
     }
@@ -104,6 +117,7 @@ namespace BitFunnel
         m_index->SetBlockAllocatorBufferSize(m_memory);
         m_index->ConfigureForServing(m_directory.c_str(), m_gramSize, false);
         m_index->StartIndex();
+        m_index->GetIngestor().RegisterMetrics(*m_metrics);
     }
 
 
@@ -113,6 +127,24 @@ namespace BitFunnel
     }
 
 
+    MetricsRegistry & Environment::GetMetrics() const
+    {
+        return *m_metrics;
+    }
+
+
+    MetricsExporter * Environment::GetMetricsExporter() const
+    {
+        return m_metricsExporter.get();
+    }
+
+
+    void Environment::SetMetricsExporter(std::unique_ptr<MetricsExporter> exporter)
+    {
+        m_metricsExporter = std::move(exporter);
+    }
+
+
     IFileSystem & Environment::GetFileSystem() const
     {
         return m_fileSystem;
@@ -131,6 +163,18 @@ namespace BitFunnel
     }
 
 
+    bool Environment::GetHardwareCounterMode() const
+    {
+        return m_hardwareCounterMode;
+    }
+
+
+    void Environment::SetHardwareCounterMode(bool mode)
+    {
+        m_hardwareCounterMode = mode;
+    }
+
+
     bool Environment::GetFailOnException() const
     {
         return m_failOnException;
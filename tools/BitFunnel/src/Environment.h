@@ -35,6 +35,8 @@
 namespace BitFunnel
 {
     class IFileSystem;
+    class MetricsExporter;
+    class MetricsRegistry;
     class TaskFactory;
     class TaskPool;
 
@@ -60,6 +62,9 @@ namespace BitFunnel
         bool GetCompilerMode() const;
         void SetCompilerMode(bool mode);
 
+        bool GetHardwareCounterMode() const;
+        void SetHardwareCounterMode(bool mode);
+
         bool GetFailOnException() const;
         void SetFailOnException(bool mode);
 
@@ -84,6 +89,17 @@ namespace BitFunnel
         IIngestor & GetIngestor() const;
         ITermTable const & GetTermTable(ShardId shard) const;
 
+        // The registry holds the index's metrics once StartIndex() has been
+        // called, along with query counts and latencies recorded by the
+        // query command.
+        MetricsRegistry & GetMetrics() const;
+
+        // Returns the exporter writing the metrics periodically, or nullptr.
+        MetricsExporter * GetMetricsExporter() const;
+
+        // Replaces the exporter. Passing nullptr stops exporting.
+        void SetMetricsExporter(std::unique_ptr<MetricsExporter> exporter);
+
     private:
         void RegisterCommands();
 
@@ -93,9 +109,15 @@ namespace BitFunnel
         std::unique_ptr<TaskPool> m_taskPool;
         std::unique_ptr<ISimpleIndex> m_index;
 
+        // Declared after m_index so that the exporter stops before the
+        // index it reads is destroyed.
+        std::unique_ptr<MetricsRegistry> m_metrics;
+        std::unique_ptr<MetricsExporter> m_metricsExporter;
+
         bool m_cacheLineCountMode;
         bool m_compilerMode;
         bool m_failOnException;
+        bool m_hardwareCounterMode;
         size_t m_threadCount;
         size_t m_memory;
         std::string m_directory;
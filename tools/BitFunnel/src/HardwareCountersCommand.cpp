@@ -0,0 +1,89 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <iostream>
+
+#include "BitFunnel/Utilities/HardwareCounters.h"
+#include "Environment.h"
+#include "HardwareCountersCommand.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // HardwareCountersCommand
+    //
+    //*************************************************************************
+    HardwareCountersCommand::HardwareCountersCommand(Environment & environment,
+                                                     Id id,
+                                                     char const * /*parameters*/)
+        : TaskBase(environment, id, Type::Synchronous)
+    {
+    }
+
+
+    void HardwareCountersCommand::Execute()
+    {
+        auto & env = GetEnvironment();
+        env.SetHardwareCounterMode(!env.GetHardwareCounterMode());
+
+        if (env.GetHardwareCounterMode())
+        {
+            std::cout
+                << "Counting hardware events during matching.";
+
+            // Probe from this thread so the user learns up front whether
+            // the host permits perf events. Queries still run either way;
+            // unavailable counters are left blank in the results.
+            HardwareCounters probe;
+            if (!probe.IsAvailable())
+            {
+                std::cout
+                    << std::endl
+                    << "Warning: hardware counters are not available on this host.";
+            }
+        }
+        else
+        {
+            std::cout
+                << "Hardware event counting disabled.";
+        }
+        std::cout
+            << std::endl
+            << std::endl;
+    }
+
+
+    ICommand::Documentation HardwareCountersCommand::GetDocumentation()
+    {
+        return Documentation(
+            "counters",
+            "Toggles hardware performance counters.",
+            "counters\n"
+            "  Toggles sampling of CPU cycles, instructions, last level cache\n"
+            "  misses, data TLB misses and branch misses during the matching\n"
+            "  phase of each query. Requires Linux perf events."
+        );
+    }
+}
@@ -47,7 +47,8 @@ namespace BitFunnel
                    char const * parameters,
                    bool cacheDocuments)
         : TaskBase(environment, id, Type::Synchronous),
-        m_cacheDocuments(cacheDocuments)
+        m_cacheDocuments(cacheDocuments),
+        m_reorderDocuments(false)
     {
         auto command = TaskFactory::GetNextToken(parameters);
         if (command.compare("manifest") == 0)
@@ -65,6 +66,17 @@ namespace BitFunnel
         }
 
         m_path = TaskFactory::GetNextToken(parameters);
+
+        auto option = TaskFactory::GetNextToken(parameters);
+        if (option.compare("reorder") == 0)
+        {
+            m_reorderDocuments = true;
+        }
+        else if (!option.empty())
+        {
+            RecoverableError error("Ingest expects optional \"reorder\".");
+            throw error;
+        }
     }
 
 
@@ -138,9 +150,11 @@ namespace BitFunnel
                 configuration,
                 ingestor,
                 filter,
-                m_cacheDocuments);
+                m_cacheDocuments,
+                m_reorderDocuments);
 
             IngestChunks(*manifest, threadCount);
+            manifest->PrintStatistics(std::cout);
         }
         double t = stopwatch.ElapsedTime();
         GetEnvironment().GetIngestor().PrintStatistics(std::cout, t);
@@ -152,7 +166,7 @@ namespace BitFunnel
         return Documentation(
             "ingest",
             "Ingests documents into the index. (TODO)",
-            "ingest (manifest | chunk) <path>\n"
+            "ingest (manifest | chunk) <path> [reorder]\n"
             "  Ingests a single chunk file or a list of chunk\n"
             "  files specified by a manifest.\n"
             "  NOT IMPLEMENTED"
@@ -179,10 +193,14 @@ namespace BitFunnel
             "cache",
             "Ingests documents into the index and also stores them in a cache\n"
             "for query verification purposes.",
-            "cache (manifest | chunk) <path>\n"
+            "cache (manifest | chunk) <path> [reorder]\n"
             "  Ingests a single chunk file or a list of chunk\n"
             "  files specified by a manifest.\n"
             "  Also caches IDocuments for query verification.\n"
+            "  The reorder option buffers a slice of documents at a\n"
+            "  time and assigns adjacent DocIndexes to similar\n"
+            "  documents, then reports the mean row density at each\n"
+            "  rank.\n"
         );
     }
 
@@ -205,9 +223,13 @@ namespace BitFunnel
         return Documentation(
             "load",
             "Ingests documents into the index",
-            "load (manifest | chunk) <path>\n"
+            "load (manifest | chunk) <path> [reorder]\n"
             "  Ingests a single chunk file or a list of chunk\n"
             "  files specified by a manifest.\n"
+            "  The reorder option buffers a slice of documents at a\n"
+            "  time and assigns adjacent DocIndexes to similar\n"
+            "  documents, then reports the mean row density at each\n"
+            "  rank.\n"
         );
     }
 }
@@ -42,6 +42,7 @@ namespace BitFunnel
         bool m_manifest;
         std::string m_path;
         bool m_cacheDocuments;
+        bool m_reorderDocuments;
     };
 
 
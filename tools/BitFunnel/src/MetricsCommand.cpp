@@ -0,0 +1,143 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <iostream>
+
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Utilities/MetricsExporter.h"
+#include "BitFunnel/Utilities/MetricsRegistry.h"
+#include "Environment.h"
+#include "MetricsCommand.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // MetricsCommand
+    //
+    //*************************************************************************
+    MetricsCommand::MetricsCommand(Environment & environment,
+                                   Id id,
+                                   char const * parameters)
+        : TaskBase(environment, id, Type::Synchronous),
+          m_mode(Show),
+          m_interval(0.0)
+    {
+        auto tokens = TaskFactory::Tokenize(parameters);
+        if (tokens.size() == 0)
+        {
+            m_mode = Show;
+        }
+        else if (tokens.size() == 3 && tokens[0].compare("export") == 0)
+        {
+            m_mode = Export;
+            m_fileName = tokens[1];
+            m_interval = std::stod(tokens[2]);
+            if (!(m_interval > 0.0))
+            {
+                RecoverableError error("metrics export interval must be positive.");
+                throw error;
+            }
+        }
+        else if (tokens.size() == 1 && tokens[0].compare("stop") == 0)
+        {
+            m_mode = Stop;
+        }
+        else
+        {
+            RecoverableError error("metrics expects no arguments, export <file> <seconds>, or stop.");
+            throw error;
+        }
+    }
+
+
+    void MetricsCommand::Execute()
+    {
+        auto & environment = GetEnvironment();
+        switch (m_mode)
+        {
+        case Show:
+            environment.GetMetrics().Write(std::cout);
+            break;
+        case Export:
+            {
+                std::unique_ptr<MetricsExporter>
+                    exporter(new MetricsExporter(environment.GetMetrics(),
+                                                 m_fileName.c_str(),
+                                                 m_interval));
+                environment.SetMetricsExporter(std::move(exporter));
+                std::cout
+                    << "Writing metrics to "
+                    << m_fileName
+                    << " every "
+                    << m_interval
+                    << " seconds." << std::endl;
+            }
+            break;
+        case Stop:
+            {
+                MetricsExporter * exporter = environment.GetMetricsExporter();
+                if (exporter == nullptr)
+                {
+                    std::cout << "Metrics are not being exported." << std::endl;
+                }
+                else
+                {
+                    // The exporter writes a final snapshot as it is
+                    // destroyed, so read its counts first.
+                    const size_t snapshots = exporter->GetSnapshotCount();
+                    const size_t failures = exporter->GetFailureCount();
+                    environment.SetMetricsExporter(nullptr);
+                    std::cout
+                        << "Stopped exporting metrics after "
+                        << snapshots
+                        << " snapshots ("
+                        << failures
+                        << " failed)." << std::endl;
+                }
+            }
+            break;
+        }
+        std::cout << std::endl;
+    }
+
+
+    ICommand::Documentation MetricsCommand::GetDocumentation()
+    {
+        return Documentation(
+            "metrics",
+            "Shows or exports index and query metrics.",
+            "metrics [(export <file> <seconds>) | stop]\n"
+            "  With no arguments, prints the current metrics in the\n"
+            "  Prometheus text exposition format.\n"
+            "  'export' rewrites <file> every <seconds> seconds, e.g. for the\n"
+            "  node exporter's textfile collector. 'stop' stops exporting.\n"
+            "  Metrics cover documents, postings and bytes ingested, slices\n"
+            "  created, recycled, active and awaiting recycling, slice buffer\n"
+            "  pool utilization, tokens in flight, row cache hits and misses,\n"
+            "  and the count and latency of queries run by 'query'.\n"
+            "  Counters are totals; use rate() for per second values."
+        );
+    }
+}
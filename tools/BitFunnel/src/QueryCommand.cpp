@@ -27,11 +27,13 @@
 #include "BitFunnel/Configuration/IStreamConfiguration.h"
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Plan/ExecutionProfile.h"
 #include "BitFunnel/Plan/Factories.h"
 #include "BitFunnel/Plan/IQueryEngine.h"
 #include "BitFunnel/Plan/QueryInstrumentation.h"
 #include "BitFunnel/Plan/QueryRunner.h"
 #include "BitFunnel/Plan/ResultsBuffer.h"
+#include "BitFunnel/Utilities/MetricsRegistry.h"
 #include "BitFunnel/Utilities/ReadLines.h"
 #include "CsvTsv/Csv.h"
 #include "Environment.h"
@@ -41,6 +43,30 @@
 
 namespace BitFunnel
 {
+    static MetricsRegistry::Counter& GetQueryCounter(MetricsRegistry & metrics)
+    {
+        return metrics.GetCounter("bitfunnel_queries_total",
+                                  "Queries processed by the query command.");
+    }
+
+
+    static MetricsRegistry::Histogram& GetQueryLatency(MetricsRegistry & metrics)
+    {
+        return metrics.GetHistogram("bitfunnel_query_latency_seconds",
+                                    "Query latency, from parsing to the end of matching.");
+    }
+
+
+    static void RecordQuery(MetricsRegistry & metrics,
+                            QueryInstrumentation::Data & data)
+    {
+        GetQueryCounter(metrics).Increment();
+        GetQueryLatency(metrics).Observe(data.GetParsingTime() +
+                                         data.GetPlanningTime() +
+                                         data.GetMatchingTime());
+    }
+
+
     //*************************************************************************
     //
     // Query
@@ -62,13 +88,49 @@ namespace BitFunnel
             m_queryCommand = QueryDocs;
             m_query = parameters;
         }
+        else if (command.compare("explain") == 0)
+        {
+            m_queryCommand = QueryExplain;
+            m_query = parameters;
+        }
+        else if (command.compare("load") == 0)
+        {
+            m_queryCommand = QueryLoad;
+            m_query = TaskFactory::GetNextToken(parameters);
+
+            auto arrivals = TaskFactory::GetNextToken(parameters);
+            if (arrivals.compare("poisson") == 0)
+            {
+                m_arrivals = QueryRunner::PoissonArrivals;
+            }
+            else if (arrivals.compare("fixed") == 0)
+            {
+                m_arrivals = QueryRunner::FixedRateArrivals;
+            }
+            else
+            {
+                throw RecoverableError("expected poisson or fixed");
+            }
+
+            m_duration = stod(TaskFactory::GetNextToken(parameters));
+            for (auto load = TaskFactory::GetNextToken(parameters);
+                 !load.empty();
+                 load = TaskFactory::GetNextToken(parameters))
+            {
+                m_loads.push_back(stod(load));
+            }
+            if (m_loads.empty())
+            {
+                throw RecoverableError("expected at least one QPS level");
+            }
+        }
         else
         {
             m_queryCommand = QueryLog;
             if (command.compare("log") != 0)
             {
                 std::stringstream message;
-                message << "expected log or one" << std::endl;
+                message << "expected log, load, one, docs, or explain" << std::endl;
                 throw RecoverableError(message.str().c_str());
             }
             m_query = TaskFactory::GetNextToken(parameters);
@@ -92,12 +154,15 @@ namespace BitFunnel
                     QueryRunner::Run(m_query.c_str(),
                         GetEnvironment().GetSimpleIndex(),
                         GetEnvironment().GetCompilerMode(),
-                        GetEnvironment().GetCacheLineCountMode());
+                        GetEnvironment().GetCacheLineCountMode(),
+                        GetEnvironment().GetHardwareCounterMode());
 
                 output << "Results:" << std::endl;
                 CsvTsv::CsvTableFormatter formatter(output);
                 QueryInstrumentation::Data::FormatHeader(formatter);
                 instrumentation.Format(formatter);
+
+                RecordQuery(GetEnvironment().GetMetrics(), instrumentation);
             }
             else if (m_queryCommand == QueryDocs)
             {
@@ -122,6 +187,9 @@ namespace BitFunnel
                 QueryInstrumentation::Data::FormatHeader(formatter);
                 instrumentation.GetData().Format(formatter);
 
+                RecordQuery(GetEnvironment().GetMetrics(),
+                            instrumentation.GetData());
+
                 output << std::endl << "Document Ids" << std::endl;
                 for (auto result : resultsBuffer)
                 {
@@ -129,6 +197,64 @@ namespace BitFunnel
                 }
 
             }
+            else if (m_queryCommand == QueryExplain)
+            {
+                output
+                    << "Explaining query \""
+                    << m_query
+                    << "\"" << std::endl;
+
+                ExecutionProfile profile;
+                auto instrumentation =
+                    QueryRunner::Explain(m_query.c_str(),
+                                         GetEnvironment().GetSimpleIndex(),
+                                         profile);
+
+                output << "Results:" << std::endl;
+                CsvTsv::CsvTableFormatter formatter(output);
+                QueryInstrumentation::Data::FormatHeader(formatter);
+                instrumentation.Format(formatter);
+
+                output << std::endl;
+                profile.Print(output);
+
+                RecordQuery(GetEnvironment().GetMetrics(), instrumentation);
+            }
+            else if (m_queryCommand == QueryLoad)
+            {
+                output
+                    << "Open loop load test with queries from log at \""
+                    << m_query
+                    << "\"" << std::endl;
+
+                auto fileSystem = Factories::CreateFileSystem();  // TODO: Use environment file system
+                auto queries = ReadLines(*fileSystem, m_query.c_str());
+
+                // Large enough to absorb Poisson bursts at any load the
+                // workers can sustain, small enough that an overloaded run
+                // drains promptly.
+                const size_t c_queueCapacity = 1024;
+
+                output << "Response times in microseconds:" << std::endl;
+                QueryRunner::LoadStatistics::PrintHeader(output);
+                for (auto load : m_loads)
+                {
+                    auto statistics =
+                        QueryRunner::RunOpenLoop(GetEnvironment().GetSimpleIndex(),
+                                                 GetEnvironment().GetThreadCount(),
+                                                 queries,
+                                                 load,
+                                                 m_duration,
+                                                 m_arrivals,
+                                                 c_queueCapacity,
+                                                 GetEnvironment().GetCompilerMode());
+                    statistics.PrintRow(output);
+
+                    auto & metrics = GetEnvironment().GetMetrics();
+                    GetQueryCounter(metrics).Increment(statistics.GetProcessedCount());
+                    GetQueryLatency(metrics).Merge(statistics.GetResponseTimeHistogram());
+                }
+            }
             else
             {
                 CHECK_NE(*GetEnvironment().GetOutputDir().c_str(), '\0')
@@ -153,10 +279,15 @@ namespace BitFunnel
                         queries,
                         c_iterations,
                         GetEnvironment().GetCompilerMode(),
-                        GetEnvironment().GetCacheLineCountMode());
+                        GetEnvironment().GetCacheLineCountMode(),
+                        GetEnvironment().GetHardwareCounterMode());
                 output << "Results:" << std::endl;
                 statistics.Print(output);
 
+                auto & metrics = GetEnvironment().GetMetrics();
+                GetQueryCounter(metrics).Increment(statistics.GetProcessedCount());
+                GetQueryLatency(metrics).Merge(statistics.GetTotalHistogram());
+
                 // TODO: unify this with the fileManager that's passed into
                 // QueryRunner::Run.
                 auto outFileManager =
@@ -185,10 +316,19 @@ namespace BitFunnel
         return Documentation(
             "query",
             "Process a single query or list of queries.",
-            "query (one <query>) | (docs <query>) | (log <file>)\n"
+            "query (one <query>) | (docs <query>) | (explain <query>) |\n"
+            "      (log <file>) |\n"
+            "      (load <file> (poisson | fixed) <seconds> <qps> [<qps> ...])\n"
             "  Processes a single query or a list of queries\n"
             "  specified by a file.\n"
-            "  'docs' lists all matching documents."
+            "  'docs' lists all matching documents.\n"
+            "  'explain' runs the query in the interpreter and reports, for\n"
+            "  each row, its rank, physical row, quadwords loaded, loads that\n"
+            "  left the accumulator zero and observed density, along with\n"
+            "  Jz short-circuits and per shard and per slice times.\n"
+            "  'load' issues the queries open loop at each target QPS for the\n"
+            "  given number of seconds and prints response time percentiles,\n"
+            "  measured from scheduled arrival, against offered load."
         );
     }
 }
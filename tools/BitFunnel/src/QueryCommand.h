@@ -23,6 +23,9 @@
 #pragma once
 
 #include <string>       // std::string embedded.
+#include <vector>       // std::vector embedded.
+
+#include "BitFunnel/Plan/QueryRunner.h"     // QueryRunner::ArrivalProcess embedded.
 
 #include "TaskBase.h"   // TaskBase base class.
 
@@ -43,9 +46,16 @@ namespace BitFunnel
         enum QueryCommand {
             QueryOne,
             QueryLog,
-            QueryDocs
+            QueryDocs,
+            QueryExplain,
+            QueryLoad
         };
         QueryCommand m_queryCommand;
         std::string m_query;
+
+        // Parameters for QueryLoad.
+        QueryRunner::ArrivalProcess m_arrivals;
+        double m_duration;
+        std::vector<double> m_loads;
     };
 }
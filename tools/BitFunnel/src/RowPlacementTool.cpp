@@ -0,0 +1,197 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Configuration/IStreamConfiguration.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IFactSet.h"
+#include "BitFunnel/Index/IRowPlacementOptimizer.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Index/ITermTable.h"
+#include "BitFunnel/Plan/QueryParser.h"
+#include "BitFunnel/Plan/QueryRows.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Allocators/IAllocator.h"
+#include "CmdLineParser/CmdLineParser.h"
+#include "RowPlacementTool.h"
+
+
+namespace BitFunnel
+{
+    RowPlacementTool::RowPlacementTool(IFileSystem& fileSystem)
+      : m_fileSystem(fileSystem)
+    {
+    }
+
+
+    int RowPlacementTool::Main(std::istream& /*input*/,
+                               std::ostream& output,
+                               int argc,
+                               char const *argv[])
+    {
+        CmdLine::CmdLineParser parser(
+            "RowPlacementTool",
+            "Renumber TermTable rows so that rows read by the same queries "
+            "in the query log are adjacent. Rewrites the TermTables in place.");
+
+        CmdLine::RequiredParameter<char const *> config(
+            "config",
+            "Path to configuration directory containing the TermTables and "
+            "the query log generated by the 'BitFunnel querylog' command.");
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> gramSize(
+            "gramsize",
+            "Maximum ngram size the index was built with.",
+            1u,
+            CmdLine::GreaterThan(0));
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> capacity(
+            "capacity",
+            "Slice capacity in documents, used to determine how many rows "
+            "share a page. Defaults to the smallest capacity the TermTable "
+            "supports, which is what the index uses by default.",
+            1u,
+            CmdLine::GreaterThan(0));
+
+        parser.AddParameter(config);
+        parser.AddParameter(gramSize);
+        parser.AddParameter(capacity);
+
+        int returnCode = 1;
+
+        if (parser.TryParse(output, argc, argv))
+        {
+            try
+            {
+                auto fileManager = Factories::CreateFileManager(config,
+                                                                config,
+                                                                config,
+                                                                m_fileSystem);
+
+                ShardId shardCount = 0;
+                {
+                    auto input = fileManager->ShardDefinition().OpenForRead();
+                    auto shardDefinition = Factories::CreateShardDefinition(*input);
+                    shardCount = shardDefinition->GetShardCount();
+                }
+
+                for (ShardId shard = 0; shard < shardCount; ++shard)
+                {
+                    OptimizeShard(output,
+                                  *fileManager,
+                                  shard,
+                                  static_cast<size_t>(gramSize),
+                                  static_cast<DocIndex>(capacity));
+                }
+
+                returnCode = 0;
+            }
+            catch (RecoverableError e)
+            {
+                output << "Error: " << e.what() << std::endl;
+            }
+            catch (...)
+            {
+                output << "Unexpected error." << std::endl;
+            }
+        }
+
+        return returnCode;
+    }
+
+
+    void RowPlacementTool::OptimizeShard(std::ostream& output,
+                                         IFileManager& fileManager,
+                                         ShardId shard,
+                                         size_t gramSize,
+                                         DocIndex sliceCapacity) const
+    {
+        output << "Optimizing row placement for shard " << shard << std::endl;
+
+        auto termTable(Factories::CreateTermTable(
+            *fileManager.TermTable(shard).OpenForRead()));
+
+        auto facts(Factories::CreateFactSet());
+        auto configuration(Factories::CreateConfiguration(gramSize, false, *facts));
+        auto streamConfiguration(Factories::CreateStreamConfiguration());
+
+        auto optimizer(Factories::CreateRowPlacementOptimizer(*termTable,
+                                                              sliceCapacity));
+
+        const size_t c_allocatorSize = 1ull << 16;
+        auto allocator(Factories::CreateAllocator(c_allocatorSize));
+
+        size_t skipped = 0;
+        std::vector<RowId> rows;
+        auto log = fileManager.QueryLog().OpenForRead();
+        std::string query;
+        while (std::getline(*log, query))
+        {
+            if (query.find_first_not_of(" \t\r") == std::string::npos)
+            {
+                continue;
+            }
+
+            allocator->Reset();
+            try
+            {
+                QueryParser queryParser(query.c_str(),
+                                        *streamConfiguration,
+                                        *allocator);
+                TermMatchNode const * tree = queryParser.Parse();
+                if (tree != nullptr)
+                {
+                    rows.clear();
+                    GetQueryRows(*tree, *configuration, *termTable, rows);
+                    optimizer->AddQuery(rows);
+                }
+            }
+            catch (RecoverableError)
+            {
+                ++skipped;
+            }
+        }
+
+        if (skipped > 0)
+        {
+            output << "Skipped " << skipped << " unparsable queries." << std::endl;
+        }
+
+        optimizer->Apply(*termTable);
+        optimizer->Print(output);
+
+        termTable->Write(*fileManager.TermTable(shard).OpenForWrite());
+    }
+}
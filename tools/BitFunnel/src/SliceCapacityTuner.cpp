@@ -0,0 +1,397 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BitFunnel/Allocators/IAllocator.h"
+#include "BitFunnel/Chunks/DocumentFilters.h"
+#include "BitFunnel/Chunks/Factories.h"
+#include "BitFunnel/Chunks/IChunkManifestIngestor.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Configuration/IShardDefinition.h"
+#include "BitFunnel/Configuration/IStreamConfiguration.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/Helpers.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IDocumentDataSchema.h"
+#include "BitFunnel/Index/IFactSet.h"
+#include "BitFunnel/Index/IngestChunks.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Index/ITermTable.h"
+#include "BitFunnel/Index/Row.h"
+#include "BitFunnel/Index/RowId.h"
+#include "BitFunnel/Plan/QueryInstrumentation.h"
+#include "BitFunnel/Plan/QueryParser.h"
+#include "BitFunnel/Plan/QueryRows.h"
+#include "BitFunnel/Plan/QueryRunner.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ReadLines.h"
+#include "CmdLineParser/CmdLineParser.h"
+#include "SliceCapacityTuner.h"
+
+
+namespace BitFunnel
+{
+    SliceCapacityTuner::SliceCapacityTuner(IFileSystem& fileSystem)
+      : m_fileSystem(fileSystem)
+    {
+    }
+
+
+    int SliceCapacityTuner::Main(std::istream& /*input*/,
+                                 std::ostream& output,
+                                 int argc,
+                                 char const *argv[])
+    {
+        CmdLine::CmdLineParser parser(
+            "SliceCapacityTuner",
+            "Choose the slice capacity for each shard that gives the highest "
+            "query throughput on the query log. Writes the capacities to the "
+            "ShardDefinition.");
+
+        CmdLine::RequiredParameter<char const *> config(
+            "config",
+            "Path to configuration directory containing the TermTables, the "
+            "ShardDefinition, and the query log.");
+
+        CmdLine::RequiredParameter<char const *> manifest(
+            "manifest",
+            "Path to a file containing the paths to the chunk files used to "
+            "build the index for each candidate.");
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> gramSize(
+            "gramsize",
+            "Maximum ngram size the index was built with.",
+            1u,
+            CmdLine::GreaterThan(0));
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> memory(
+            "memory",
+            "Amount of memory (in KiB) to use for Slice buffers.",
+            1000000u,
+            CmdLine::GreaterThan(0));
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> cache(
+            "cache",
+            "Cache size (in KiB) that the rows read by a query from one "
+            "slice should fit in.",
+            1024u,
+            CmdLine::GreaterThan(0));
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> candidates(
+            "candidates",
+            "Maximum number of capacities to try for each shard.",
+            6u,
+            CmdLine::GreaterThan(0));
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> iterations(
+            "iterations",
+            "Number of times to run the query log for each candidate.",
+            1u,
+            CmdLine::GreaterThan(0));
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> threadCount(
+            "threads",
+            "Thread count for ingestion and query processing.",
+            1u,
+            CmdLine::GreaterThan(0));
+
+        parser.AddParameter(config);
+        parser.AddParameter(manifest);
+        parser.AddParameter(gramSize);
+        parser.AddParameter(memory);
+        parser.AddParameter(cache);
+        parser.AddParameter(candidates);
+        parser.AddParameter(iterations);
+        parser.AddParameter(threadCount);
+
+        int returnCode = 1;
+
+        if (parser.TryParse(output, argc, argv))
+        {
+            try
+            {
+                auto fileManager = Factories::CreateFileManager(config,
+                                                                config,
+                                                                config,
+                                                                m_fileSystem);
+
+                std::unique_ptr<IShardDefinition> shardDefinition;
+                {
+                    auto input = fileManager->ShardDefinition().OpenForRead();
+                    shardDefinition = Factories::CreateShardDefinition(*input);
+                }
+
+                const std::vector<std::string> chunks =
+                    ReadLines(m_fileSystem, manifest);
+
+                std::vector<std::string> queries;
+                {
+                    auto log = fileManager->QueryLog().OpenForRead();
+                    std::string query;
+                    while (std::getline(*log, query))
+                    {
+                        if (query.find_first_not_of(" \t\r") != std::string::npos)
+                        {
+                            queries.push_back(query);
+                        }
+                    }
+                }
+                if (queries.empty())
+                {
+                    throw RecoverableError("Query log is empty.");
+                }
+
+                auto facts(Factories::CreateFactSet());
+                auto configuration(
+                    Factories::CreateConfiguration(static_cast<size_t>(gramSize),
+                                                   false,
+                                                   *facts));
+                auto streamConfiguration(Factories::CreateStreamConfiguration());
+                const size_t c_allocatorSize = 1ull << 16;
+                auto allocator(Factories::CreateAllocator(c_allocatorSize));
+
+                const ShardId shardCount = shardDefinition->GetShardCount();
+                const size_t memoryBytes = static_cast<size_t>(memory) * 1024ull;
+
+                std::vector<DocIndex> capacities;
+                for (ShardId shard = 0; shard < shardCount; ++shard)
+                {
+                    capacities.push_back(shardDefinition->GetSliceCapacity(shard));
+                }
+
+                for (ShardId shard = 0; shard < shardCount; ++shard)
+                {
+                    auto termTable(Factories::CreateTermTable(
+                        *fileManager->TermTable(shard).OpenForRead()));
+
+                    // Gather the rows each query reads in this shard.
+                    std::vector<std::vector<RowId>> queryRows;
+                    for (auto const & query : queries)
+                    {
+                        allocator->Reset();
+                        try
+                        {
+                            QueryParser queryParser(query.c_str(),
+                                                    *streamConfiguration,
+                                                    *allocator);
+                            TermMatchNode const * tree = queryParser.Parse();
+                            if (tree != nullptr)
+                            {
+                                std::vector<RowId> rows;
+                                GetQueryRows(*tree, *configuration, *termTable, rows);
+                                std::sort(rows.begin(), rows.end());
+                                rows.erase(std::unique(rows.begin(), rows.end()),
+                                           rows.end());
+                                queryRows.push_back(rows);
+                            }
+                        }
+                        catch (RecoverableError)
+                        {
+                            // QueryRunner skips unparsable queries as well.
+                        }
+                    }
+
+                    auto shardCandidates =
+                        GetCandidates(*termTable,
+                                      queryRows,
+                                      memoryBytes / shardCount,
+                                      static_cast<size_t>(cache) * 1024ull,
+                                      static_cast<size_t>(candidates));
+
+                    output << "Shard " << shard << ":" << std::endl;
+
+                    DocIndex best = shardCandidates.front();
+                    if (shardCandidates.size() > 1)
+                    {
+                        double bestQps = 0.0;
+                        for (auto capacity : shardCandidates)
+                        {
+                            capacities[shard] = capacity;
+                            const double qps =
+                                Measure(config,
+                                        chunks,
+                                        queries,
+                                        capacities,
+                                        static_cast<size_t>(gramSize),
+                                        memoryBytes,
+                                        static_cast<size_t>(threadCount),
+                                        static_cast<size_t>(iterations));
+                            output << "  capacity " << capacity
+                                   << ": " << qps << " QPS" << std::endl;
+                            if (qps > bestQps)
+                            {
+                                bestQps = qps;
+                                best = capacity;
+                            }
+                        }
+                    }
+
+                    capacities[shard] = best;
+                    shardDefinition->SetSliceCapacity(shard, best);
+                    output << "  chose capacity " << best << std::endl;
+                }
+
+                {
+                    auto out = fileManager->ShardDefinition().OpenForWrite();
+                    shardDefinition->Write(*out);
+                }
+
+                returnCode = 0;
+            }
+            catch (RecoverableError e)
+            {
+                output << "Error: " << e.what() << std::endl;
+            }
+            catch (FatalError e)
+            {
+                output << "Error: " << e.what() << std::endl;
+            }
+            catch (...)
+            {
+                output << "Unexpected error." << std::endl;
+            }
+        }
+
+        return returnCode;
+    }
+
+
+    std::vector<DocIndex>
+        SliceCapacityTuner::GetCandidates(
+            ITermTable const & termTable,
+            std::vector<std::vector<RowId>> const & queryRows,
+            size_t shardBudget,
+            size_t cacheSize,
+            size_t candidateCount) const
+    {
+        auto schema(Factories::CreateDocumentDataSchema());
+        const Rank maxRank = termTable.GetMaxRankUsed();
+        const DocIndex quantum = Row::DocumentsInRank0Row(1, maxRank);
+
+        // The smallest capacity is always a candidate. Larger capacities
+        // amortize per-slice overhead over more documents, but stop paying
+        // off once the rows a query reads from a slice no longer fit in the
+        // cache, or once a slice no longer fits in the shard's memory.
+        std::vector<DocIndex> result(1, quantum);
+        DocIndex capacity = quantum;
+        while (result.size() < candidateCount)
+        {
+            capacity *= 2;
+
+            if (GetBlockSizeForCapacity(*schema, termTable, capacity) > shardBudget)
+            {
+                break;
+            }
+
+            size_t bytes = 0;
+            for (auto const & rows : queryRows)
+            {
+                for (auto row : rows)
+                {
+                    bytes += Row::BytesInRow(capacity, row.GetRank(), maxRank);
+                }
+            }
+            if (!queryRows.empty() && bytes / queryRows.size() > cacheSize)
+            {
+                break;
+            }
+
+            result.push_back(capacity);
+        }
+
+        return result;
+    }
+
+
+    double SliceCapacityTuner::Measure(
+        char const * config,
+        std::vector<std::string> const & manifest,
+        std::vector<std::string> const & queries,
+        std::vector<DocIndex> const & capacities,
+        size_t gramSize,
+        size_t memory,
+        size_t threadCount,
+        size_t iterations) const
+    {
+        auto index = Factories::CreateSimpleIndex(m_fileSystem);
+
+        {
+            auto fileManager = Factories::CreateFileManager(config,
+                                                            config,
+                                                            config,
+                                                            m_fileSystem);
+            auto input = fileManager->ShardDefinition().OpenForRead();
+            auto shardDefinition = Factories::CreateShardDefinition(*input);
+            for (ShardId shard = 0; shard < capacities.size(); ++shard)
+            {
+                shardDefinition->SetSliceCapacity(shard, capacities[shard]);
+            }
+            index->SetShardDefinition(std::move(shardDefinition));
+        }
+
+        index->SetBlockAllocatorBufferSize(memory);
+        index->ConfigureForServing(config, gramSize, false);
+        index->StartIndex();
+
+        NopFilter filter;
+        auto ingestor = Factories::CreateChunkManifestIngestor(
+            m_fileSystem,
+            nullptr,
+            manifest,
+            index->GetConfiguration(),
+            index->GetIngestor(),
+            filter,
+            false);
+        IngestChunks(*ingestor, threadCount);
+
+        auto statistics = QueryRunner::Run(*index,
+                                           config,
+                                           threadCount,
+                                           queries,
+                                           iterations,
+                                           false,
+                                           false,
+                                           false);
+
+        return statistics.GetQueriesPerSecond();
+    }
+}
@@ -0,0 +1,90 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#pragma once
+
+#include <string>                       // std::string parameter.
+#include <vector>                       // std::vector parameter.
+
+#include "BitFunnel/BitFunnelTypes.h"   // DocIndex return value.
+#include "BitFunnel/IExecutable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    class IFileSystem;
+    class ITermTable;
+    class RowId;
+
+    //*************************************************************************
+    //
+    // SliceCapacityTuner
+    //
+    // Chooses a slice capacity for each shard by building the index once per
+    // candidate capacity and measuring the throughput of the queries in the
+    // query log. Candidates are the smallest capacity the shard's TermTable
+    // supports, doubled repeatedly. A candidate is only benchmarked if the
+    // rows an average query reads from one slice fit in the cache. The
+    // winning capacities are written to the ShardDefinition.
+    //
+    //*************************************************************************
+    class SliceCapacityTuner : public IExecutable
+    {
+    public:
+        SliceCapacityTuner(IFileSystem& fileSystem);
+
+        //
+        // IExecutable methods
+        //
+        virtual int Main(std::istream& input,
+                         std::ostream& output,
+                         int argc,
+                         char const *argv[]) override;
+
+    private:
+        // Returns the candidate capacities for a shard, smallest first.
+        std::vector<DocIndex>
+            GetCandidates(ITermTable const & termTable,
+                          std::vector<std::vector<RowId>> const & queryRows,
+                          size_t shardBudget,
+                          size_t cacheSize,
+                          size_t candidateCount) const;
+
+        // Builds an index from the manifest with the ShardDefinition in
+        // config and the given slice capacity for each shard. Returns the
+        // throughput of the queries in queries per second.
+        double Measure(char const * config,
+                       std::vector<std::string> const & manifest,
+                       std::vector<std::string> const & queries,
+                       std::vector<DocIndex> const & capacities,
+                       size_t gramSize,
+                       size_t memory,
+                       size_t threadCount,
+                       size_t iterations) const;
+
+        //
+        // Constructor parameters.
+        //
+
+        IFileSystem& m_fileSystem;
+    };
+}
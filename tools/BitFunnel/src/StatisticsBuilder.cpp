@@ -78,10 +78,47 @@ namespace BitFunnel
             1u,
             CmdLine::GreaterThan(0));
 
+        CmdLine::OptionalParameter<int> maxTerms(
+            "maxterms",
+            "Bound statistics memory by counting roughly this many of the "
+            "most frequent terms per shard. Rarer terms are dropped or have "
+            "estimated frequencies. Default (0) counts every term exactly.",
+            0u,
+            CmdLine::GreaterThanOrEqual(0));
+
+        CmdLine::OptionalParameter<double> maxPostingError(
+            "maxpostingerror",
+            "Bound statistics memory by a target error instead of -maxterms. "
+            "Term counts are overestimated by at most roughly this fraction "
+            "of the postings in each shard, so frequencies are overestimated "
+            "by about this value times the mean postings per document. The "
+            "achieved bound is printed in both units.",
+            0.0,
+            CmdLine::GreaterThan(0.0));
+
+        CmdLine::OptionalParameterList partition(
+            "partition",
+            "Ingest one of several equal, contiguous partitions of the "
+            "manifest and write partial statistics for the 'BitFunnel merge' "
+            "command.");
+        CmdLine::RequiredParameter<int> partitionIndex(
+            "index",
+            "Zero-based index of the partition to ingest.",
+            CmdLine::GreaterThanOrEqual(0));
+        CmdLine::RequiredParameter<int> partitionCount(
+            "count",
+            "Number of partitions.",
+            CmdLine::GreaterThan(0));
+        partition.AddParameter(partitionIndex);
+        partition.AddParameter(partitionCount);
+
         parser.AddParameter(manifestFileName);
         parser.AddParameter(outputPath);
         parser.AddParameter(termToText);
         parser.AddParameter(gramSize);
+        parser.AddParameter(maxTerms);
+        parser.AddParameter(maxPostingError);
+        parser.AddParameter(partition);
 
         int returnCode = 1;
 
@@ -89,10 +126,34 @@ namespace BitFunnel
         {
             try
             {
+                size_t index = 0;
+                size_t count = 1;
+                if (partition.IsActivated())
+                {
+                    index = static_cast<size_t>(partitionIndex);
+                    count = static_cast<size_t>(partitionCount);
+                    if (index >= count)
+                    {
+                        RecoverableError error("Partition index must be less than partition count.");
+                        throw error;
+                    }
+                }
+
+                if (maxTerms.IsActivated() && maxPostingError.IsActivated())
+                {
+                    RecoverableError error("Use -maxterms or -maxpostingerror, not both.");
+                    throw error;
+                }
+
                 LoadAndIngestChunkList(output,
                                        outputPath,
                                        manifestFileName,
                                        gramSize,
+                                       maxTerms,
+                                       maxPostingError,
+                                       index,
+                                       count,
+                                       partition.IsActivated(),
                                        true,
                                        termToText.IsActivated());
                 returnCode = 0;
@@ -117,6 +178,11 @@ namespace BitFunnel
         char const * chunkListFileName,
         // TODO: gramSize should be unsigned once CmdLineParser supports unsigned.
         int gramSize,
+        int maxTerms,
+        double maxPostingError,
+        size_t partitionIndex,
+        size_t partitionCount,
+        bool writePartialStatistics,
         bool generateStatistics,
         bool generateTermToText) const
     {
@@ -125,6 +191,14 @@ namespace BitFunnel
         index->ConfigureForStatistics(intermediateDirectory,
                                       static_cast<size_t>(gramSize),
                                       generateTermToText);
+        if (maxPostingError > 0.0)
+        {
+            index->SetMaxStatisticsPostingError(maxPostingError);
+        }
+        else
+        {
+            index->SetMaxStatisticsTerms(static_cast<size_t>(maxTerms));
+        }
         index->StartIndex();
 
 
@@ -135,6 +209,18 @@ namespace BitFunnel
 
         std::vector<std::string> filePaths = ReadLines(m_fileSystem, chunkListFileName);
 
+        if (partitionCount > 1)
+        {
+            // Keep this partition's contiguous range of the manifest so
+            // that merged document numbering follows manifest order.
+            const size_t begin = partitionIndex * filePaths.size() / partitionCount;
+            const size_t end = (partitionIndex + 1) * filePaths.size() / partitionCount;
+            filePaths = std::vector<std::string>(filePaths.begin() + begin,
+                                                 filePaths.begin() + end);
+            output << "Partition " << partitionIndex
+                   << " of " << partitionCount << std::endl;
+        }
+
         output << "Reading " << filePaths.size() << " files\n";
 
         IConfiguration const & configuration = index->GetConfiguration();
@@ -182,7 +268,15 @@ namespace BitFunnel
             {
                 termToText = &configuration.GetTermToText();
             }
-            ingestor.WriteStatistics(index->GetFileManager(), termToText);
+            if (writePartialStatistics)
+            {
+                ingestor.WritePartialStatistics(index->GetFileManager(),
+                                                termToText);
+            }
+            else
+            {
+                ingestor.WriteStatistics(index->GetFileManager(), termToText);
+            }
         }
     }
 }
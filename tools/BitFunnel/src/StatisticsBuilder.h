@@ -21,6 +21,8 @@
 // THE SOFTWARE.
 
 
+#include <stddef.h>                 // size_t parameter.
+
 #include "BitFunnel/IExecutable.h"  // Base class.
 
 
@@ -47,6 +49,11 @@ namespace BitFunnel
             char const * intermediateDirectory,
             char const * chunkListFileName,
             int gramSize,
+            int maxTerms,
+            double maxPostingError,
+            size_t partitionIndex,
+            size_t partitionCount,
+            bool writePartialStatistics,
             bool generateStatistics,
             bool generateTermToText) const;
 
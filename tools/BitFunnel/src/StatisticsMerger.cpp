@@ -0,0 +1,122 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/IFileManager.h"
+#include "BitFunnel/Index/MergeStatistics.h"
+#include "BitFunnel/Utilities/ReadLines.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+#include "CmdLineParser/CmdLineParser.h"
+#include "StatisticsMerger.h"
+
+
+namespace BitFunnel
+{
+    StatisticsMerger::StatisticsMerger(IFileSystem& fileSystem)
+      : m_fileSystem(fileSystem)
+    {
+    }
+
+
+    int StatisticsMerger::Main(std::istream& /*input*/,
+                               std::ostream& output,
+                               int argc,
+                               char const *argv[])
+    {
+        CmdLine::CmdLineParser parser(
+            "StatisticsMerger",
+            "Combine partial statistics into the statistics for the entire corpus.");
+
+        CmdLine::RequiredParameter<char const *> partitionListFileName(
+            "partitionList",
+            "Path to a file containing the paths to the directories written by "
+            "'BitFunnel statistics -partition'. One directory per line, in "
+            "partition order.");
+
+        CmdLine::RequiredParameter<char const *> outputPath(
+            "config",
+            "Path to the configuration directory where files will be written.");
+
+        parser.AddParameter(partitionListFileName);
+        parser.AddParameter(outputPath);
+
+        int returnCode = 1;
+
+        if (parser.TryParse(output, argc, argv))
+        {
+            try
+            {
+                std::vector<std::string> directories =
+                    ReadLines(m_fileSystem, partitionListFileName);
+
+                char const * outputDirectory = outputPath;
+                output << "Merging " << directories.size()
+                       << " partitions into '" << outputDirectory << "'"
+                       << std::endl;
+
+                std::vector<std::unique_ptr<IFileManager>> fileManagers;
+                std::vector<IFileManager*> partitions;
+                for (auto const & directory : directories)
+                {
+                    fileManagers.push_back(
+                        Factories::CreateFileManager(directory.c_str(),
+                                                     directory.c_str(),
+                                                     directory.c_str(),
+                                                     m_fileSystem));
+                    partitions.push_back(fileManagers.back().get());
+                }
+
+                auto fileManager = Factories::CreateFileManager(outputDirectory,
+                                                                outputDirectory,
+                                                                outputDirectory,
+                                                                m_fileSystem);
+
+                Stopwatch stopwatch;
+                MergeStatistics(partitions, *fileManager);
+
+                output << "Merge complete." << std::endl
+                       << "  Merge time = " << stopwatch.ElapsedTime()
+                       << std::endl;
+
+                returnCode = 0;
+            }
+            catch (RecoverableError e)
+            {
+                output << "Error: " << e.what() << std::endl;
+            }
+            catch (...)
+            {
+                output << "Unexpected error." << std::endl;
+            }
+        }
+
+        return returnCode;
+    }
+}
@@ -0,0 +1,294 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "BitFunnel/Chunks/DocumentFilters.h"
+#include "BitFunnel/Chunks/Factories.h"
+#include "BitFunnel/Chunks/IChunkManifestIngestor.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Index/DocumentHandle.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/IShard.h"
+#include "BitFunnel/Plan/QueryRunner.h"
+#include "BitFunnel/Utilities/ReadLines.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+#include "Environment.h"
+#include "StressCommand.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // StressCommand
+    //
+    //*************************************************************************
+    StressCommand::StressCommand(Environment & environment,
+                                 Id id,
+                                 char const * parameters)
+        : TaskBase(environment, id, Type::Synchronous),
+          m_deletesPerSecond(0.0)
+    {
+        auto tokens = TaskFactory::Tokenize(parameters);
+        if (!(tokens.size() == 5 ||
+              (tokens.size() == 7 && tokens[5].compare("deletes") == 0)))
+        {
+            RecoverableError error("stress expects <manifest> <query log> <seconds> <docs/s> <QPS> [deletes <deletes/s>].");
+            throw error;
+        }
+
+        m_manifest = tokens[0];
+        m_queryLog = tokens[1];
+        m_duration = std::stod(tokens[2]);
+        m_documentsPerSecond = std::stod(tokens[3]);
+        m_queriesPerSecond = std::stod(tokens[4]);
+        if (tokens.size() == 7)
+        {
+            m_deletesPerSecond = std::stod(tokens[6]);
+        }
+
+        if (!(m_duration > 0.0) ||
+            !(m_documentsPerSecond > 0.0) ||
+            !(m_queriesPerSecond > 0.0) ||
+            m_deletesPerSecond < 0.0)
+        {
+            RecoverableError error("stress expects positive rates and duration.");
+            throw error;
+        }
+    }
+
+
+    void StressCommand::Execute()
+    {
+        Environment & environment = GetEnvironment();
+        std::ostream& output = environment.GetOutputStream();
+        IIngestor & ingestor = environment.GetIngestor();
+
+        auto filePaths = ReadLines(environment.GetFileSystem(),
+                                   m_manifest.c_str());
+        auto queries = ReadLines(environment.GetFileSystem(),
+                                 m_queryLog.c_str());
+
+        // Deletes are drawn from the documents active before the run, in
+        // shard order.
+        const size_t maxDeleteCount =
+            static_cast<size_t>(std::ceil(m_deletesPerSecond * m_duration));
+        std::vector<DocId> deleteCandidates;
+        for (ShardId shard = 0;
+             shard < ingestor.GetShardCount() &&
+             deleteCandidates.size() < maxDeleteCount;
+             ++shard)
+        {
+            auto collect = [&](std::vector<DocumentHandle> const & documents)
+            {
+                for (auto const & document : documents)
+                {
+                    if (deleteCandidates.size() < maxDeleteCount)
+                    {
+                        deleteCandidates.push_back(document.GetDocId());
+                    }
+                }
+            };
+            const size_t c_batchSize = 1024;
+            ingestor.GetShard(shard).ForEachActive(collect, c_batchSize);
+        }
+
+        // Same queue as 'query load'.
+        const size_t c_queueCapacity = 1024;
+        const size_t threadCount = environment.GetThreadCount();
+
+        output
+            << "Stress test with queries from \""
+            << m_queryLog
+            << "\" and documents from \""
+            << m_manifest
+            << "\" for "
+            << m_duration
+            << " seconds." << std::endl;
+
+        // Baseline: the same query load against the static index.
+        auto baseline =
+            QueryRunner::RunOpenLoop(environment.GetSimpleIndex(),
+                                     threadCount,
+                                     queries,
+                                     m_queriesPerSecond,
+                                     m_duration,
+                                     QueryRunner::PoissonArrivals,
+                                     c_queueCapacity,
+                                     environment.GetCompilerMode());
+
+        // Mixed: ingestion and deletion run on their own threads while the
+        // query load runs on this one.
+        const size_t maxDocumentCount =
+            static_cast<size_t>(std::ceil(m_documentsPerSecond * m_duration));
+        const size_t documentCount = ingestor.GetDocumentCount();
+        const size_t postingCount = ingestor.GetPostingCount();
+        const size_t byteCount = ingestor.GetTotalSouceBytesIngested();
+
+        // Set when the mixed query run ends, so that ingestion and deletion
+        // do not outlast the window that the query percentiles cover.
+        std::atomic<bool> stopped(false);
+        Stopwatch window;
+
+        auto ingestion = std::async(std::launch::async, [&]()
+        {
+            // The RateLimitFilter keeps every document, so it is safe to
+            // place after the DocumentCountFilter.
+            CompositeFilter filter;
+            filter.AddFilter(std::unique_ptr<IDocumentFilter>(
+                new CancellationFilter(stopped)));
+            filter.AddFilter(std::unique_ptr<IDocumentFilter>(
+                new DocumentCountFilter(maxDocumentCount)));
+            filter.AddFilter(std::unique_ptr<IDocumentFilter>(
+                new RateLimitFilter(m_documentsPerSecond)));
+
+            auto manifest = Factories::CreateChunkManifestIngestor(
+                environment.GetFileSystem(),
+                nullptr,
+                filePaths,
+                environment.GetConfiguration(),
+                ingestor,
+                filter,
+                false);
+
+            Stopwatch stopwatch;
+            for (size_t i = 0;
+                 i < manifest->GetChunkCount() &&
+                 ingestor.GetDocumentCount() - documentCount < maxDocumentCount &&
+                 !stopped;
+                 ++i)
+            {
+                manifest->IngestChunk(i);
+            }
+            manifest->Flush();
+            return stopwatch.ElapsedTime();
+        });
+
+        auto deletion = std::async(std::launch::async, [&]()
+        {
+            size_t deleteCount = 0;
+            Stopwatch stopwatch;
+            for (auto id : deleteCandidates)
+            {
+                const double scheduled = deleteCount / m_deletesPerSecond;
+                if (scheduled >= m_duration)
+                {
+                    break;
+                }
+                const double remaining = scheduled - stopwatch.ElapsedTime();
+                if (remaining > 0.0)
+                {
+                    std::this_thread::sleep_for(
+                        std::chrono::duration<double>(remaining));
+                }
+                if (stopped)
+                {
+                    break;
+                }
+                ingestor.Delete(id);
+                ++deleteCount;
+            }
+            return deleteCount;
+        });
+
+        auto mixed =
+            QueryRunner::RunOpenLoop(environment.GetSimpleIndex(),
+                                     threadCount,
+                                     queries,
+                                     m_queriesPerSecond,
+                                     m_duration,
+                                     QueryRunner::PoissonArrivals,
+                                     c_queueCapacity,
+                                     environment.GetCompilerMode(),
+                                     documentCount + maxDocumentCount);
+
+        // Rates are measured over the query window. Documents that were
+        // already past the filter when it closed are ingested afterwards
+        // and only appear in the totals below.
+        const double windowTime = window.ElapsedTime();
+        const size_t documentsInWindow =
+            ingestor.GetDocumentCount() - documentCount;
+        stopped = true;
+
+        const double ingestionTime = ingestion.get();
+        const size_t deleteCount = deletion.get();
+
+        const size_t documentsIngested =
+            ingestor.GetDocumentCount() - documentCount;
+        const double documentsPerSecond = documentsInWindow / windowTime;
+
+        output << "Response times in microseconds:" << std::endl;
+        const int c_width = 12;
+        output << std::setw(c_width) << "phase"
+               << std::setw(c_width) << "docs/s"
+               << std::setw(c_width) << "deletes/s";
+        QueryRunner::LoadStatistics::PrintHeader(output);
+
+        output << std::setw(c_width) << "queries"
+               << std::setw(c_width) << 0
+               << std::setw(c_width) << 0;
+        baseline.PrintRow(output);
+
+        output << std::setw(c_width) << "mixed"
+               << std::setw(c_width) << documentsPerSecond
+               << std::setw(c_width) << deleteCount / windowTime;
+        mixed.PrintRow(output);
+
+        output
+            << std::endl
+            << "Ingested " << documentsIngested << " documents ("
+            << ingestor.GetPostingCount() - postingCount << " postings, "
+            << ingestor.GetTotalSouceBytesIngested() - byteCount << " bytes) in "
+            << ingestionTime << " seconds." << std::endl
+            << "Deleted " << deleteCount << " documents." << std::endl;
+    }
+
+
+    ICommand::Documentation StressCommand::GetDocumentation()
+    {
+        return Documentation(
+            "stress",
+            "Measures query latency under concurrent ingestion.",
+            "stress <manifest> <query log> <seconds> <docs/s> <QPS> [deletes <deletes/s>]\n"
+            "  Runs the query log open loop at <QPS> for <seconds>, as\n"
+            "  'query load' does, first against the static index and then\n"
+            "  while documents from the chunk files in <manifest> are\n"
+            "  ingested at up to <docs/s> on another thread. The deletes\n"
+            "  option also deletes documents that were in the index before\n"
+            "  the run at <deletes/s> on a third thread. Ingestion and\n"
+            "  deletion stop when the second query run ends.\n"
+            "  Prints the response time percentiles of both runs beside the\n"
+            "  achieved ingestion and deletion rates. Queries use the\n"
+            "  number of threads set by the 'threads' command.\n"
+            "  Ingesting a manifest that is already in the index adds a\n"
+            "  second copy of each of its documents."
+        );
+    }
+}
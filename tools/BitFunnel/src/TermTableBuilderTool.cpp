@@ -21,23 +21,121 @@
 // THE SOFTWARE.
 
 
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
+#include "BitFunnel/Allocators/IAllocator.h"
 #include "BitFunnel/BitFunnelTypes.h"
 #include "BitFunnel/Configuration/Factories.h"
 #include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Configuration/IStreamConfiguration.h"
 #include "BitFunnel/Exceptions.h"
 #include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IConfiguration.h"
 #include "BitFunnel/Index/IDocumentFrequencyTable.h"
+#include "BitFunnel/Index/IFactSet.h"
+#include "BitFunnel/Index/IQueryAdaptiveTreatment.h"
+#include "BitFunnel/Index/IQueryProfile.h"
 #include "BitFunnel/Index/ITermTable.h"
 #include "BitFunnel/Index/ITermTableBuilder.h"
 #include "BitFunnel/Index/ITermTreatmentFactory.h"
+#include "BitFunnel/Plan/QueryParser.h"
+#include "BitFunnel/Plan/QueryRows.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "BitFunnel/Utilities/ITaskDistributor.h"
+#include "BitFunnel/Utilities/ITaskProcessor.h"
 #include "CmdLineParser/CmdLineParser.h"
 #include "TermTableBuilderTool.h"
 
 
 namespace BitFunnel
 {
+    class TermTableBuilderTool::ShardProcessor : public ITaskProcessor
+    {
+    public:
+        ShardProcessor(TermTableBuilderTool const & tool,
+                       IFileManager& fileManager,
+                       IFileManager* previousFileManager,
+                       char const * treatmentName,
+                       double density,
+                       double snr,
+                       double adhocFrequency,
+                       IQueryProfile const * queries,
+                       double memoryBudget,
+                       size_t threadCount,
+                       std::vector<std::string>& outputs,
+                       std::vector<std::string>& errors)
+          : m_tool(tool),
+            m_fileManager(fileManager),
+            m_previousFileManager(previousFileManager),
+            m_treatmentName(treatmentName),
+            m_density(density),
+            m_snr(snr),
+            m_adhocFrequency(adhocFrequency),
+            m_queries(queries),
+            m_memoryBudget(memoryBudget),
+            m_threadCount(threadCount),
+            m_outputs(outputs),
+            m_errors(errors)
+        {
+        }
+
+        //
+        // ITaskProcessor methods
+        //
+
+        virtual void ProcessTask(size_t taskId) override
+        {
+            // Each task writes only its own slot in m_outputs and m_errors.
+            std::stringstream output;
+            try
+            {
+                m_tool.BuildTermTable(output,
+                                      m_fileManager,
+                                      m_previousFileManager,
+                                      m_treatmentName,
+                                      static_cast<ShardId>(taskId),
+                                      m_density,
+                                      m_snr,
+                                      m_adhocFrequency,
+                                      m_queries,
+                                      m_memoryBudget,
+                                      m_threadCount);
+            }
+            catch (RecoverableError e)
+            {
+                m_errors[taskId] = e.what();
+            }
+            catch (...)
+            {
+                m_errors[taskId] = "Unexpected error.";
+            }
+            m_outputs[taskId] = output.str();
+        }
+
+        virtual void Finished() override
+        {
+        }
+
+    private:
+        TermTableBuilderTool const & m_tool;
+        IFileManager& m_fileManager;
+        IFileManager* m_previousFileManager;
+        char const * m_treatmentName;
+        double m_density;
+        double m_snr;
+        double m_adhocFrequency;
+        IQueryProfile const * m_queries;
+        double m_memoryBudget;
+        size_t m_threadCount;
+        std::vector<std::string>& m_outputs;
+        std::vector<std::string>& m_errors;
+    };
+
+
     TermTableBuilderTool::TermTableBuilderTool(IFileSystem& fileSystem)
       : m_fileSystem(fileSystem)
     {
@@ -73,10 +171,56 @@ namespace BitFunnel
             CmdLine::GreaterThan(0.0));
 
 
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> threads(
+            "threads",
+            "Number of threads. Shards are built concurrently and the "
+            "remaining threads assign rows for different ranks concurrently.",
+            1u,
+            CmdLine::GreaterThan(0));
+
+        CmdLine::OptionalParameter<char const *> incremental(
+            "incremental",
+            "Path to a configuration directory holding TermTables built "
+            "earlier with the same density and treatment. Terms whose "
+            "treatment did not change keep their rows; only new and changed "
+            "terms are assigned new rows.",
+            nullptr);
+
+        CmdLine::OptionalParameter<char const *> queryLog(
+            "querylog",
+            "Path to a query log, one query per line. When supplied, the "
+            "treatment is adjusted by query frequency: frequently queried "
+            "terms may get extra rows and unqueried terms with shared rows "
+            "become adhoc.",
+            nullptr);
+
+        CmdLine::OptionalParameter<double> budget(
+            "budget",
+            "Extra bits per document that -querylog may give to frequently "
+            "queried terms, as a fraction of the bits the treatment uses for "
+            "all terms.",
+            0.05,
+            CmdLine::GreaterThanOrEqual(0.0));
+
+        // TODO: This parameter should be unsigned, but it doesn't seem to work
+        // with CmdLineParser.
+        CmdLine::OptionalParameter<int> gramSize(
+            "gramsize",
+            "Maximum ngram size used to hash the terms in -querylog.",
+            1u,
+            CmdLine::GreaterThan(0));
+
         parser.AddParameter(config);
         parser.AddParameter(density);
         parser.AddParameter(treatment);
         parser.AddParameter(snr);
+        parser.AddParameter(threads);
+        parser.AddParameter(incremental);
+        parser.AddParameter(queryLog);
+        parser.AddParameter(budget);
+        parser.AddParameter(gramSize);
 
         int returnCode = 1;
 
@@ -120,19 +264,82 @@ namespace BitFunnel
                 }
 
 
-                for (ShardId shard = 0; shard < shardCount; ++shard)
+                std::unique_ptr<IFileManager> previousFileManager;
+                if (static_cast<char const *>(incremental) != nullptr)
                 {
+                    previousFileManager =
+                        Factories::CreateFileManager(incremental,
+                                                     incremental,
+                                                     incremental,
+                                                     m_fileSystem);
+                }
+
+                std::unique_ptr<IQueryProfile> queries;
+                if (static_cast<char const *>(queryLog) != nullptr)
+                {
+                    queries = Factories::CreateQueryProfile();
+                    size_t skipped = 0;
+                    LoadQueryProfile(queryLog,
+                                     static_cast<size_t>(gramSize),
+                                     *queries,
+                                     skipped);
+                    output << "Loaded " << queries->GetQueryCount()
+                           << " queries." << std::endl;
+                    if (skipped > 0)
+                    {
+                        output << "Skipped " << skipped
+                               << " unparsable queries." << std::endl;
+                    }
+                }
 
-                    BuildTermTable(output,
-                                   *fileManager,
-                                   treatment,
-                                   shard,
-                                   density,
-                                   snr,
-                                   adhocFrequency);
+                // Give each concurrent shard build an equal share of the
+                // threads for its per-rank row assignment.
+                const size_t threadCount = static_cast<size_t>(threads);
+                const size_t shardThreads =
+                    (std::min)(threadCount, static_cast<size_t>(shardCount));
+                const size_t rankThreads =
+                    (std::max)(static_cast<size_t>(1),
+                               threadCount / (std::max)(shardThreads,
+                                                        static_cast<size_t>(1)));
+
+                std::vector<std::string> outputs(shardCount);
+                std::vector<std::string> errors(shardCount);
+                std::vector<std::unique_ptr<ITaskProcessor>> processors;
+                for (size_t i = 0; i < shardThreads; ++i)
+                {
+                    processors.push_back(
+                        std::unique_ptr<ITaskProcessor>(
+                            new ShardProcessor(*this,
+                                               *fileManager,
+                                               previousFileManager.get(),
+                                               treatment,
+                                               density,
+                                               snr,
+                                               adhocFrequency,
+                                               queries.get(),
+                                               budget,
+                                               rankThreads,
+                                               outputs,
+                                               errors)));
+                }
+
+                {
+                    auto distributor =
+                        Factories::CreateTaskDistributor(processors, shardCount);
+                    distributor->WaitForCompletion();
                 }
 
                 returnCode = 0;
+                for (ShardId shard = 0; shard < shardCount; ++shard)
+                {
+                    output << outputs[shard];
+                    if (!errors[shard].empty())
+                    {
+                        output << "Error: shard " << shard << ": "
+                               << errors[shard] << std::endl;
+                        returnCode = 1;
+                    }
+                }
             }
             catch (RecoverableError e)
             {
@@ -163,11 +370,15 @@ namespace BitFunnel
     void TermTableBuilderTool::BuildTermTable(
         std::ostream& output,
         IFileManager& fileManager,
+        IFileManager* previousFileManager,
         char const * treatmentName,
         ShardId shard,
         double density,
         double snr,
-        double adhocFrequency) const
+        double adhocFrequency,
+        IQueryProfile const * queries,
+        double memoryBudget,
+        size_t threadCount) const
     {
         output << "Loading files for TermTable build: "
                << shard << std::endl;
@@ -178,19 +389,39 @@ namespace BitFunnel
         auto treatments = Factories::CreateTreatmentFactory();
         auto treatment(treatments->CreateTreatment(treatmentName, density, snr));
 
+        std::unique_ptr<IQueryAdaptiveTreatment> adaptive;
+        if (queries != nullptr)
+        {
+            adaptive = Factories::CreateQueryAdaptiveTreatment(*treatment,
+                                                               *queries,
+                                                               *terms,
+                                                               density,
+                                                               memoryBudget);
+        }
+
         auto facts(Factories::CreateFactSet());
 
         auto termTable(Factories::CreateTermTable());
 
+        std::unique_ptr<ITermTable> previous;
+        if (previousFileManager != nullptr)
+        {
+            previous = Factories::CreateTermTable(
+                *previousFileManager->TermTable(shard).OpenForRead());
+        }
+
         output << "Starting TermTable build." << std::endl;
 
         auto termTableBuilderTool(
             Factories::CreateTermTableBuilder(density,
                                               adhocFrequency,
-                                              *treatment,
+                                              (adaptive != nullptr) ?
+                                                  *adaptive : *treatment,
                                               *terms,
                                               *facts,
-                                              *termTable));
+                                              previous.get(),
+                                              *termTable,
+                                              threadCount));
 
         termTableBuilderTool->Print(output);
         termTableBuilderTool->Print(*fileManager.TermTableStatistics(shard).OpenForWrite());
@@ -201,4 +432,63 @@ namespace BitFunnel
 
         output << "Done." << std::endl;
     }
+
+
+    void TermTableBuilderTool::LoadQueryProfile(char const * path,
+                                                size_t gramSize,
+                                                IQueryProfile& queries,
+                                                size_t& skipped) const
+    {
+        auto facts(Factories::CreateFactSet());
+        auto configuration(Factories::CreateConfiguration(gramSize, false, *facts));
+        auto streamConfiguration(Factories::CreateStreamConfiguration());
+
+        const size_t c_allocatorSize = 1ull << 16;
+        auto allocator(Factories::CreateAllocator(c_allocatorSize));
+
+        auto log = m_fileSystem.OpenForRead(path, std::ios::in);
+        if (log->fail())
+        {
+            std::stringstream message;
+            message << "Failed to open query log '" << path << "'";
+            RecoverableError error(message.str());
+            throw error;
+        }
+
+        std::vector<Term> terms;
+        std::vector<Term::Hash> hashes;
+        std::string query;
+        while (std::getline(*log, query))
+        {
+            if (query.find_first_not_of(" \t\r") == std::string::npos)
+            {
+                continue;
+            }
+
+            allocator->Reset();
+            try
+            {
+                QueryParser queryParser(query.c_str(),
+                                        *streamConfiguration,
+                                        *allocator);
+                TermMatchNode const * tree = queryParser.Parse();
+                if (tree != nullptr)
+                {
+                    terms.clear();
+                    GetQueryTerms(*tree, *configuration, terms);
+
+                    hashes.clear();
+                    for (auto const & term : terms)
+                    {
+                        hashes.push_back(term.GetRawHash());
+                    }
+                    queries.AddQuery(hashes);
+                }
+            }
+            catch (RecoverableError)
+            {
+                ++skipped;
+            }
+        }
+    }
 }
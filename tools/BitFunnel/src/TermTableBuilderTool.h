@@ -27,6 +27,7 @@
 namespace BitFunnel
 {
     class IFileSystem;
+    class IQueryProfile;
 
     class TermTableBuilderTool : public IExecutable
     {
@@ -45,11 +46,27 @@ namespace BitFunnel
         void BuildTermTable(
             std::ostream& output,
             IFileManager& fileManager,
+            IFileManager* previousFileManager,
             char const * treatmentName,
             ShardId shard,
             double density,
             double snr,
-            double adhocFrequency) const;
+            double adhocFrequency,
+            IQueryProfile const * queries,
+            double memoryBudget,
+            size_t threadCount) const;
+
+        // Records the terms of each query in the file at (path). Blank
+        // lines are ignored and unparsable queries are counted in
+        // (skipped).
+        void LoadQueryProfile(char const * path,
+                              size_t gramSize,
+                              IQueryProfile& queries,
+                              size_t& skipped) const;
+
+        // Builds one shard's TermTable per task, buffering each shard's
+        // console output so that it can be printed in shard order.
+        class ShardProcessor;
 
         //
         // Constructor parameters.
@@ -0,0 +1,120 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <iostream>
+
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Exceptions.h"
+#include "BitFunnel/Utilities/TraceLog.h"
+#include "Environment.h"
+#include "TraceCommand.h"
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // TraceCommand
+    //
+    //*************************************************************************
+    TraceCommand::TraceCommand(Environment & environment,
+                               Id id,
+                               char const * parameters)
+        : TaskBase(environment, id, Type::Synchronous)
+    {
+        auto tokens = TaskFactory::Tokenize(parameters);
+        if (tokens.size() == 1 && tokens[0].compare("on") == 0)
+        {
+            m_mode = On;
+        }
+        else if (tokens.size() == 1 && tokens[0].compare("off") == 0)
+        {
+            m_mode = Off;
+        }
+        else if (tokens.size() == 1 && tokens[0].compare("clear") == 0)
+        {
+            m_mode = Clear;
+        }
+        else if (tokens.size() == 2 && tokens[0].compare("save") == 0)
+        {
+            m_mode = Save;
+            m_fileName = tokens[1];
+        }
+        else
+        {
+            RecoverableError error("trace expects on, off, clear, or save <file>.");
+            throw error;
+        }
+    }
+
+
+    void TraceCommand::Execute()
+    {
+        switch (m_mode)
+        {
+        case On:
+            TraceLog::Enable();
+            std::cout << "Tracing enabled." << std::endl;
+            break;
+        case Off:
+            TraceLog::Disable();
+            std::cout << "Tracing disabled." << std::endl;
+            break;
+        case Clear:
+            TraceLog::Clear();
+            std::cout << "Trace cleared." << std::endl;
+            break;
+        case Save:
+            {
+                auto output =
+                    GetEnvironment().GetFileSystem().OpenForWrite(m_fileName.c_str());
+                TraceLog::WriteChromeTrace(*output);
+                std::cout
+                    << "Wrote "
+                    << TraceLog::GetEventCount()
+                    << " trace events to "
+                    << m_fileName
+                    << "." << std::endl;
+            }
+            break;
+        }
+        std::cout << std::endl;
+    }
+
+
+    ICommand::Documentation TraceCommand::GetDocumentation()
+    {
+        return Documentation(
+            "trace",
+            "Records a timeline of ingestion and query processing.",
+            "trace (on | off | clear | save <file>)\n"
+            "  'on' starts recording begin and end events for chunk load and\n"
+            "  parse, document ingestion, slice creation and recycling, and the\n"
+            "  parse, plan, compile and match stages of each query.\n"
+            "  Each thread keeps its most recent events.\n"
+            "  'off' stops recording. 'clear' discards recorded events.\n"
+            "  'save' writes the events as Chrome trace event JSON, which can\n"
+            "  be viewed in chrome://tracing or https://ui.perfetto.dev."
+        );
+    }
+}
@@ -20,6 +20,7 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
 #include <limits>
 #include <sstream>
 #include <vector>
@@ -120,6 +121,99 @@ namespace BitFunnel
         }
 
 
+        //
+        // Rebuild the TermTable incrementally from the one just written.
+        //
+        {
+            std::vector<char const *> argv = {
+                "BitFunnel",
+                "termtable",
+                "config",
+                "0.1",
+                "PrivateSharedRank0And3",
+                "-threads",
+                "2",
+                "-incremental",
+                "config"
+            };
+
+            EXPECT_EQ(0, tool.Main(std::cin,
+                                   std::cout,
+                                   static_cast<int>(argv.size()),
+                                   argv.data()));
+        }
+
+
+        //
+        // Rebuild the TermTable with treatments adapted to a small query
+        // log, and then reorder its rows to match the same log. The REPL
+        // below verifies queries against the resulting TermTable.
+        //
+        {
+            auto log = fileSystem->OpenForWrite("config/QueryLog.txt");
+            *log << "1 64" << std::endl
+                 << "2 63" << std::endl
+                 << "3 62" << std::endl
+                 << "1 64" << std::endl
+                 << "\"4 5\"" << std::endl;
+        }
+
+        {
+            std::vector<char const *> argv = {
+                "BitFunnel",
+                "termtable",
+                "config",
+                "0.1",
+                "PrivateSharedRank0And3",
+                "-querylog",
+                "config/QueryLog.txt",
+                "-budget",
+                "0.5"
+            };
+
+            EXPECT_EQ(0, tool.Main(std::cin,
+                                   std::cout,
+                                   static_cast<int>(argv.size()),
+                                   argv.data()));
+        }
+
+        {
+            std::vector<char const *> argv = {
+                "BitFunnel",
+                "rowplacement",
+                "config"
+            };
+
+            EXPECT_EQ(0, tool.Main(std::cin,
+                                   std::cout,
+                                   static_cast<int>(argv.size()),
+                                   argv.data()));
+        }
+
+
+        //
+        // Choose slice capacities for the query log. Two candidates keep the
+        // test fast while still exercising the benchmark.
+        //
+        {
+            std::vector<char const *> argv = {
+                "BitFunnel",
+                "slicecapacity",
+                "config",
+                "manifest.txt",
+                "-memory",
+                "65536",
+                "-candidates",
+                "2"
+            };
+
+            EXPECT_EQ(0, tool.Main(std::cin,
+                                   std::cout,
+                                   static_cast<int>(argv.size()),
+                                   argv.data()));
+        }
+
+
         //
         // Use the tool to run the REPL.
         //
@@ -128,11 +222,19 @@ namespace BitFunnel
                 auto script = fileSystem->OpenForWrite("testScript");
                 *script
                     << "failOnException" << std::endl
-                    << "cache manifest manifest.txt" << std::endl
+                    << "trace on" << std::endl
+                    << "cache manifest manifest.txt reorder" << std::endl
                     //<< "cache chunk chunk0" << std::endl
                     << "verify one 1" << std::endl
                     << "verify one 32" << std::endl
                     << "verify one 64" << std::endl
+                    << "counters" << std::endl
+                    << "query one 32" << std::endl
+                    << "query explain 32" << std::endl
+                    << "stress manifest.txt config/QueryLog.txt 0.5 1000 200 deletes 50" << std::endl
+                    << "metrics" << std::endl
+                    << "trace off" << std::endl
+                    << "trace save trace.json" << std::endl
                     << "quit" << std::endl;
             }
 
@@ -161,4 +263,85 @@ namespace BitFunnel
                       argv.data());
         }
     }
+
+
+    std::string ReadFile(IFileSystem& fileSystem, char const * path)
+    {
+        auto in = fileSystem.OpenForRead(path, std::ios::in | std::ios::binary);
+        std::stringstream contents;
+        contents << in->rdbuf();
+        return contents.str();
+    }
+
+
+    TEST(BitFunnelTool, CorpusGenerator)
+    {
+        auto fileSystem = BitFunnel::Factories::CreateRAMFileSystem();
+        BitFunnel::BitFunnelTool tool(*fileSystem);
+
+        // Generate the same corpus with one and with three threads.
+        char const * directories[] = { "serial", "parallel" };
+        char const * threads[] = { "1", "3" };
+        for (size_t i = 0; i < 2; ++i)
+        {
+            std::vector<char const *> argv = {
+                "BitFunnel",
+                "corpus",
+                directories[i],
+                "200",
+                "-chunks",
+                "5",
+                "-threads",
+                threads[i],
+                "-seed",
+                "7",
+                "-vocabulary",
+                "1000",
+                "-streams",
+                "2",
+                "-terms",
+                "20",
+                "-deviation",
+                "10",
+                "-queries",
+                "50"
+            };
+
+            ASSERT_EQ(0, tool.Main(std::cin,
+                                   std::cout,
+                                   static_cast<int>(argv.size()),
+                                   argv.data()));
+        }
+
+        // Output must not depend on the number of threads.
+        for (size_t i = 0; i < 5; ++i)
+        {
+            std::stringstream serial;
+            serial << "serial/zipf" << i << ".chunk";
+            std::stringstream parallel;
+            parallel << "parallel/zipf" << i << ".chunk";
+
+            std::string contents = ReadFile(*fileSystem, serial.str().c_str());
+            EXPECT_GT(contents.size(), 0u);
+            EXPECT_EQ(contents,
+                      ReadFile(*fileSystem, parallel.str().c_str()));
+        }
+
+        std::string queries = ReadFile(*fileSystem, "serial/QueryLog.txt");
+        EXPECT_EQ(queries, ReadFile(*fileSystem, "parallel/QueryLog.txt"));
+        EXPECT_EQ(50, std::count(queries.begin(), queries.end(), '\n'));
+
+        // The corpus must be ingestible.
+        std::vector<char const *> argv = {
+            "BitFunnel",
+            "statistics",
+            "serial/manifest.txt",
+            "serial"
+        };
+
+        EXPECT_EQ(0, tool.Main(std::cin,
+                               std::cout,
+                               static_cast<int>(argv.size()),
+                               argv.data()));
+    }
 }
@@ -0,0 +1,203 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <iomanip>
+#include <ostream>
+#include <string.h>
+
+#include "BenchmarkRunner.h"
+#include "BitFunnel/Utilities/Stopwatch.h"
+
+
+namespace BitFunnel
+{
+    static volatile uint64_t s_sink;
+
+
+    BenchmarkRunner::BenchmarkRunner(std::ostream& output,
+                                     Format format,
+                                     char const * filter,
+                                     double minSeconds)
+      : m_output(output),
+        m_format(format),
+        m_filter(filter),
+        m_minSeconds(minSeconds)
+    {
+    }
+
+
+    void BenchmarkRunner::Run(char const * name,
+                              size_t itemsPerCall,
+                              Benchmark const & benchmark)
+    {
+        if (!IsSelected(name))
+        {
+            return;
+        }
+
+        // Warm up.
+        benchmark();
+
+        size_t calls = 0;
+        double elapsed = 0;
+        Stopwatch stopwatch;
+        do
+        {
+            benchmark();
+            ++calls;
+            elapsed = stopwatch.ElapsedTime();
+        } while (elapsed < m_minSeconds);
+
+        Report(name, calls, itemsPerCall, elapsed);
+    }
+
+
+    void BenchmarkRunner::RunTimed(char const * name,
+                                   size_t itemsPerCall,
+                                   TimedBenchmark const & benchmark)
+    {
+        if (!IsSelected(name))
+        {
+            return;
+        }
+
+        // Warm up.
+        benchmark();
+
+        // Bound the wall clock time in case setup dominates each call.
+        const double c_maxOverhead = 20.0;
+        size_t calls = 0;
+        double measured = 0;
+        Stopwatch stopwatch;
+        do
+        {
+            measured += benchmark();
+            ++calls;
+        } while (measured < m_minSeconds &&
+                 stopwatch.ElapsedTime() < m_minSeconds * c_maxOverhead);
+
+        Report(name, calls, itemsPerCall, measured);
+    }
+
+
+    bool BenchmarkRunner::IsSelected(char const * name) const
+    {
+        return m_filter == nullptr || strstr(name, m_filter) != nullptr;
+    }
+
+
+    void BenchmarkRunner::Report(char const * name,
+                                 size_t calls,
+                                 size_t itemsPerCall,
+                                 double seconds)
+    {
+        Result result = {
+            name,
+            calls,
+            static_cast<double>(calls * itemsPerCall),
+            seconds
+        };
+        m_results.push_back(result);
+
+        if (m_format == Text)
+        {
+            WriteText(result);
+        }
+        else if (m_format == Csv)
+        {
+            WriteCsv(result);
+        }
+    }
+
+
+    void BenchmarkRunner::Finish()
+    {
+        if (m_format == Json)
+        {
+            WriteJson();
+        }
+    }
+
+
+    void BenchmarkRunner::WriteText(Result const & result)
+    {
+        m_output << std::left << std::setw(40) << result.m_name
+                 << std::right << std::setw(12) << std::fixed
+                 << std::setprecision(2) << (result.m_seconds * 1e9 / result.m_items)
+                 << " ns/item"
+                 << std::setw(14) << std::setprecision(0) << (result.m_items / result.m_seconds)
+                 << " items/s" << std::endl;
+    }
+
+
+    void BenchmarkRunner::WriteCsv(Result const & result)
+    {
+        if (m_results.size() == 1)
+        {
+            m_output << "name,calls,items,seconds,nsPerItem,itemsPerSecond" << std::endl;
+        }
+
+        // Benchmark names never contain commas or quotes, so no escaping
+        // is needed.
+        m_output << result.m_name << ","
+                 << result.m_calls << ","
+                 << std::fixed << std::setprecision(0) << result.m_items << ","
+                 << std::setprecision(6) << result.m_seconds << ","
+                 << std::setprecision(3) << (result.m_seconds * 1e9 / result.m_items) << ","
+                 << std::setprecision(0) << (result.m_items / result.m_seconds)
+                 << std::endl;
+    }
+
+
+    void BenchmarkRunner::WriteJson()
+    {
+        m_output << "{" << std::endl
+                 << "  \"benchmarks\": [";
+        for (size_t i = 0; i < m_results.size(); ++i)
+        {
+            Result const & result = m_results[i];
+            m_output << ((i == 0) ? "" : ",") << std::endl
+                     << "    {"
+                     << "\"name\": \"" << result.m_name << "\", "
+                     << "\"calls\": " << result.m_calls << ", "
+                     << std::fixed << std::setprecision(0)
+                     << "\"items\": " << result.m_items << ", "
+                     << std::setprecision(6)
+                     << "\"seconds\": " << result.m_seconds << ", "
+                     << std::setprecision(3)
+                     << "\"nsPerItem\": " << (result.m_seconds * 1e9 / result.m_items) << ", "
+                     << std::setprecision(0)
+                     << "\"itemsPerSecond\": " << (result.m_items / result.m_seconds)
+                     << "}";
+        }
+        m_output << std::endl
+                 << "  ]" << std::endl
+                 << "}" << std::endl;
+    }
+
+
+    void BenchmarkRunner::Consume(uint64_t value)
+    {
+        s_sink = s_sink + value;
+    }
+}
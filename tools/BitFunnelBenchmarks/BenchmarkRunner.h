@@ -0,0 +1,116 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+#include <functional>                   // std::function parameter.
+#include <iosfwd>                       // std::ostream member.
+#include <stddef.h>                     // size_t parameter.
+#include <stdint.h>                     // uint64_t parameter.
+#include <string>                       // std::string member.
+#include <vector>                       // std::vector member.
+
+#include "BitFunnel/NonCopyable.h"      // Base class.
+
+
+namespace BitFunnel
+{
+    //*************************************************************************
+    //
+    // BenchmarkRunner times microbenchmarks of BitFunnel's hot kernels.
+    //
+    // Each benchmark is a function that processes a fixed number of items.
+    // The runner calls it once to warm caches, then repeatedly until at least
+    // the minimum time has elapsed, and reports the mean time per item.
+    // Benchmarks whose names do not contain the filter string are skipped.
+    //
+    // Results can be written as aligned text for people, or as CSV or JSON
+    // for tracking across commits. Text and CSV rows are written as each
+    // benchmark finishes; JSON is written by Finish().
+    //
+    //*************************************************************************
+    class BenchmarkRunner : NonCopyable
+    {
+    public:
+        typedef std::function<void()> Benchmark;
+
+        // A benchmark that returns the number of seconds spent in the code
+        // under test, for kernels that cannot be called without setup.
+        typedef std::function<double()> TimedBenchmark;
+
+        enum Format
+        {
+            Text,
+            Csv,
+            Json
+        };
+
+        BenchmarkRunner(std::ostream& output,
+                        Format format,
+                        char const * filter,
+                        double minSeconds);
+
+        void Run(char const * name,
+                 size_t itemsPerCall,
+                 Benchmark const & benchmark);
+
+        // Like Run(), but only the time reported by the benchmark is
+        // counted.
+        void RunTimed(char const * name,
+                      size_t itemsPerCall,
+                      TimedBenchmark const & benchmark);
+
+        // Writes any output deferred until all benchmarks have run.
+        void Finish();
+
+        // Consumes a value computed by a benchmark so that the compiler
+        // cannot optimize the computation away.
+        static void Consume(uint64_t value);
+
+    private:
+        struct Result
+        {
+            std::string m_name;
+            size_t m_calls;
+            double m_items;
+            double m_seconds;
+        };
+
+        bool IsSelected(char const * name) const;
+        void Report(char const * name,
+                    size_t calls,
+                    size_t itemsPerCall,
+                    double seconds);
+
+        void WriteText(Result const & result);
+        void WriteCsv(Result const & result);
+        void WriteJson();
+
+        std::ostream& m_output;
+        Format m_format;
+        char const * m_filter;
+        double m_minSeconds;
+
+        std::vector<Result> m_results;
+    };
+}
@@ -0,0 +1,46 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#pragma once
+
+
+namespace BitFunnel
+{
+    class BenchmarkRunner;
+
+    // Term hashing and ngram construction on the Document ingestion path.
+    void RunTermHashingBenchmarks(BenchmarkRunner& runner);
+
+    // RowTableDescriptor bit access, Shard::AddPosting() and
+    // ITermTable::GetRows().
+    void RunIndexBenchmarks(BenchmarkRunner& runner);
+
+    // ChunkReader parsing of an in-memory chunk.
+    void RunChunkBenchmarks(BenchmarkRunner& runner);
+
+    // ByteCodeInterpreter versus NativeJIT matching over the same index.
+    void RunMatcherBenchmarks(BenchmarkRunner& runner);
+
+    // Recycler and TokenManager throughput.
+    void RunConcurrencyBenchmarks(BenchmarkRunner& runner);
+}
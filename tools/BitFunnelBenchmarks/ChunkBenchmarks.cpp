@@ -0,0 +1,124 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cstdio>       // snprintf.
+#include <random>
+#include <vector>
+
+#include "BenchmarkRunner.h"
+#include "Benchmarks.h"
+#include "BitFunnel/Chunks/IChunkProcessor.h"
+#include "ChunkReader.h"
+
+
+namespace BitFunnel
+{
+    // Counts terms so that parsing cannot be optimized away, without doing
+    // any of the work of ingestion.
+    class CountingChunkProcessor : public IChunkProcessor
+    {
+    public:
+        CountingChunkProcessor()
+          : m_termCount(0)
+        {
+        }
+
+        virtual void OnFileEnter() override {}
+        virtual void OnDocumentEnter(DocId /*id*/) override {}
+        virtual void OnStreamEnter(Term::StreamId /*id*/) override {}
+
+        virtual void OnTerm(char const * /*term*/) override
+        {
+            ++m_termCount;
+        }
+
+        virtual void OnStreamExit() override {}
+        virtual void OnDocumentExit(char const * /*start*/, size_t /*length*/) override {}
+        virtual void OnFileExit() override {}
+
+        uint64_t GetTermCount() const
+        {
+            return m_termCount;
+        }
+
+    private:
+        uint64_t m_termCount;
+    };
+
+
+    // Builds a chunk in the BitFunnel chunk format: for each document a
+    // 16 digit hex id, then streams of a 2 digit hex id followed by terms,
+    // with every field and list terminated by '\0'.
+    static std::vector<char> GenerateChunk(size_t documentCount,
+                                           size_t termsPerStream)
+    {
+        std::mt19937 random(12345);
+        std::vector<char> chunk;
+        char field[32];
+
+        for (size_t d = 0; d < documentCount; ++d)
+        {
+            snprintf(field, sizeof(field), "%016zx", d);
+            chunk.insert(chunk.end(), field, field + 16);
+            chunk.push_back(0);
+
+            for (unsigned stream = 0; stream < 2; ++stream)
+            {
+                snprintf(field, sizeof(field), "%02x", stream);
+                chunk.insert(chunk.end(), field, field + 2);
+                chunk.push_back(0);
+
+                for (size_t t = 0; t < termsPerStream; ++t)
+                {
+                    const size_t length = 2 + random() % 11;
+                    for (size_t c = 0; c < length; ++c)
+                    {
+                        chunk.push_back(static_cast<char>('a' + random() % 26));
+                    }
+                    chunk.push_back(0);
+                }
+                chunk.push_back(0);
+            }
+            chunk.push_back(0);
+        }
+        chunk.push_back(0);
+
+        return chunk;
+    }
+
+
+    void RunChunkBenchmarks(BenchmarkRunner& runner)
+    {
+        const size_t c_documentCount = 1000;
+        const size_t c_termsPerStream = 100;
+        const std::vector<char> chunk = GenerateChunk(c_documentCount,
+                                                      c_termsPerStream);
+
+        runner.Run("ChunkReader/Parse", c_documentCount * 2 * c_termsPerStream, [&]()
+        {
+            CountingChunkProcessor processor;
+            ChunkReader reader(chunk.data(), chunk.data() + chunk.size(), processor);
+            BenchmarkRunner::Consume(processor.GetTermCount());
+        });
+    }
+}
@@ -0,0 +1,126 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BenchmarkRunner.h"
+#include "Benchmarks.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IRecycler.h"
+#include "BitFunnel/Index/Token.h"
+#include "BitFunnel/Utilities/Factories.h"
+#include "IRecyclable.h"
+
+
+namespace BitFunnel
+{
+    // Mirrors DeferredSliceListDelete: waits for the tokens outstanding at
+    // construction to drain, then releases its (here, empty) resources.
+    class TrackedRecyclable : public IRecyclable
+    {
+    public:
+        TrackedRecyclable(ITokenManager& tokenManager,
+                          std::atomic<size_t>& recycledCount)
+          : m_tokenTracker(tokenManager.StartTracker()),
+            m_recycledCount(recycledCount)
+        {
+        }
+
+        virtual void Recycle() override
+        {
+            m_tokenTracker->WaitForCompletion();
+            ++m_recycledCount;
+        }
+
+    private:
+        std::shared_ptr<ITokenTracker> m_tokenTracker;
+        std::atomic<size_t>& m_recycledCount;
+    };
+
+
+    void RunConcurrencyBenchmarks(BenchmarkRunner& runner)
+    {
+        auto tokenManager = Factories::CreateTokenManager();
+        auto recycler = Factories::CreateRecycler();
+        auto background = std::async(std::launch::async, &IRecycler::Run, recycler.get());
+
+        const size_t c_tokenCount = 100000;
+        runner.Run("TokenManager/RequestToken", c_tokenCount, [&]()
+        {
+            for (size_t i = 0; i < c_tokenCount; ++i)
+            {
+                auto token = tokenManager->RequestToken();
+            }
+        });
+
+        // Query threads contend on the token manager's lock.
+        const size_t c_threadCount = 4;
+        runner.Run("TokenManager/RequestToken/threads=4",
+                   c_threadCount * c_tokenCount,
+                   [&]()
+        {
+            std::vector<std::thread> threads;
+            for (size_t t = 0; t < c_threadCount; ++t)
+            {
+                threads.push_back(std::thread([&]()
+                {
+                    for (size_t i = 0; i < c_tokenCount; ++i)
+                    {
+                        auto token = tokenManager->RequestToken();
+                    }
+                }));
+            }
+            for (auto & thread : threads)
+            {
+                thread.join();
+            }
+        });
+
+        // Round trip from scheduling a recyclable to its recycling, with no
+        // tokens outstanding.
+        const size_t c_recyclableCount = 1000;
+        std::atomic<size_t> recycledCount(0);
+        runner.Run("Recycler/ScheduleRecycling", c_recyclableCount, [&]()
+        {
+            const size_t target = recycledCount + c_recyclableCount;
+            for (size_t i = 0; i < c_recyclableCount; ++i)
+            {
+                std::unique_ptr<IRecyclable>
+                    recyclable(new TrackedRecyclable(*tokenManager, recycledCount));
+                recycler->ScheduleRecyling(recyclable);
+            }
+            while (recycledCount < target)
+            {
+                std::this_thread::yield();
+            }
+        });
+
+        tokenManager->Shutdown();
+        recycler->Shutdown();
+        background.wait();
+    }
+}
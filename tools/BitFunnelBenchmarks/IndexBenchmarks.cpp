@@ -0,0 +1,124 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchmarkRunner.h"
+#include "Benchmarks.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Index/ITermTable.h"
+#include "BitFunnel/Index/RowIdSequence.h"
+#include "BitFunnel/Mocks/Factories.h"
+#include "BitFunnel/Term.h"
+#include "RowTableDescriptor.h"
+#include "Shard.h"
+
+
+namespace BitFunnel
+{
+    void RunIndexBenchmarks(BenchmarkRunner& runner)
+    {
+        // The prime factors corpus has one term per prime, so terms for
+        // composite numbers exercise the adhoc row path. Its mock slice
+        // buffers only have room for the rows of primes up to about 2000.
+        auto fileSystem = Factories::CreateRAMFileSystem();
+        const DocId c_maxDocId = 2000;
+        auto index = Factories::CreatePrimeFactorsIndex(*fileSystem,
+                                                        c_maxDocId,
+                                                        0,
+                                                        1);
+        Shard & shard = dynamic_cast<Shard &>(index->GetIngestor().GetShard(0));
+        ITermTable const & termTable = index->GetTermTable(0);
+
+        // Benchmarks write to a private buffer so that the index itself is
+        // not modified.
+        std::vector<uint64_t> buffer(shard.GetSliceBufferSize() / sizeof(uint64_t), 0);
+        void* sliceBuffer = buffer.data();
+
+        const DocIndex capacity = shard.GetSliceCapacity();
+        RowTableDescriptor const & rowTable = shard.GetRowTable(0);
+        const RowIndex rowCount = static_cast<RowIndex>(rowTable.GetRowCount());
+
+        std::mt19937 random(12345);
+        const size_t c_accessCount = 4096;
+        std::vector<RowIndex> rows;
+        std::vector<DocIndex> columns;
+        for (size_t i = 0; i < c_accessCount; ++i)
+        {
+            rows.push_back(static_cast<RowIndex>(random() % rowCount));
+            columns.push_back(static_cast<DocIndex>(random() % capacity));
+        }
+
+        runner.Run("RowTable/SetBit", c_accessCount, [&]()
+        {
+            for (size_t i = 0; i < c_accessCount; ++i)
+            {
+                rowTable.SetBit(sliceBuffer, rows[i], columns[i]);
+            }
+        });
+
+        runner.Run("RowTable/GetBit", c_accessCount, [&]()
+        {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < c_accessCount; ++i)
+            {
+                sum += rowTable.GetBit(sliceBuffer, rows[i], columns[i]);
+            }
+            BenchmarkRunner::Consume(sum);
+        });
+
+        const size_t c_termCount = 1000;
+        std::vector<Term> terms;
+        for (size_t i = 2; i < c_termCount + 2; ++i)
+        {
+            terms.push_back(Term(Term::ComputeRawHash(std::to_string(i).c_str()), 0, 0));
+        }
+
+        runner.Run("Shard/AddPosting", c_termCount, [&]()
+        {
+            for (size_t i = 0; i < c_termCount; ++i)
+            {
+                shard.AddPosting(terms[i], columns[i], sliceBuffer);
+            }
+        });
+
+        runner.Run("TermTable/GetRows", c_termCount, [&]()
+        {
+            uint64_t sum = 0;
+            for (auto const & term : terms)
+            {
+                RowIdSequence sequence(term, termTable);
+                for (auto const row : sequence)
+                {
+                    sum += row.GetIndex();
+                }
+            }
+            BenchmarkRunner::Consume(sum);
+        });
+    }
+}
@@ -0,0 +1,115 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <memory>
+#include <string>
+
+#include "BenchmarkRunner.h"
+#include "Benchmarks.h"
+#include "BitFunnel/Allocators/IAllocator.h"
+#include "BitFunnel/Configuration/Factories.h"
+#include "BitFunnel/Configuration/IFileSystem.h"
+#include "BitFunnel/Configuration/IStreamConfiguration.h"
+#include "BitFunnel/Index/IDocument.h"
+#include "BitFunnel/Index/IIngestor.h"
+#include "BitFunnel/Index/ISimpleIndex.h"
+#include "BitFunnel/Mocks/Factories.h"
+#include "BitFunnel/Plan/IQueryEngine.h"
+#include "BitFunnel/Plan/QueryInstrumentation.h"
+#include "BitFunnel/Plan/ResultsBuffer.h"
+#include "ByteCodeQueryEngine.h"
+#include "NativeJITQueryEngine.h"
+
+
+namespace BitFunnel
+{
+    // Runs query against engine and returns the time spent in the matching
+    // phase, which excludes parsing, planning and code generation.
+    static double MatchOnce(IQueryEngine& engine,
+                            char const * query,
+                            ResultsBuffer& results)
+    {
+        auto tree = engine.Parse(query);
+
+        // FinishMatching() counts the parsing time as matching time, so
+        // start the instrumentation's stopwatch after parsing.
+        QueryInstrumentation instrumentation;
+        instrumentation.FinishParsing();
+        engine.Run(tree, instrumentation, results);
+        BenchmarkRunner::Consume(results.size());
+        return instrumentation.GetData().GetMatchingTime();
+    }
+
+
+    void RunMatcherBenchmarks(BenchmarkRunner& runner)
+    {
+        // The prime factors index only has rows for primes up to about 2000,
+        // which makes for too few slices to time the matcher. Ingest extra
+        // copies of its documents under new ids so that each query scans
+        // many slices.
+        auto fileSystem = Factories::CreateRAMFileSystem();
+        const DocId c_maxDocId = 2000;
+        const size_t c_copyCount = 32;
+        auto index = Factories::CreatePrimeFactorsIndex(*fileSystem,
+                                                        c_maxDocId,
+                                                        0,
+                                                        1);
+        for (size_t copy = 1; copy < c_copyCount; ++copy)
+        {
+            for (DocId docId = 0; docId <= c_maxDocId; ++docId)
+            {
+                auto document =
+                    Factories::CreatePrimeFactorsDocument(index->GetConfiguration(),
+                                                          docId,
+                                                          c_maxDocId,
+                                                          0);
+                index->GetIngestor().Add(copy * (c_maxDocId + 1) + docId,
+                                         *document);
+            }
+        }
+        const size_t documentCount = index->GetIngestor().GetDocumentCount();
+
+        auto config = Factories::CreateStreamConfiguration();
+        const size_t c_allocatorSize = 1ull << 17;
+        ByteCodeQueryEngine byteCode(*index, *config, c_allocatorSize);
+        NativeJITQueryEngine nativeJIT(*index, *config, c_allocatorSize, c_allocatorSize);
+        ResultsBuffer results(documentCount);
+
+        // A single row, a conjunction, and a disjunction.
+        char const * c_queries[] = { "2", "2 3 5", "3 | 7" };
+        for (auto query : c_queries)
+        {
+            std::string name = std::string("Match/ByteCode/") + query;
+            runner.RunTimed(name.c_str(), documentCount, [&]()
+            {
+                return MatchOnce(byteCode, query, results);
+            });
+
+            name = std::string("Match/NativeJIT/") + query;
+            runner.RunTimed(name.c_str(), documentCount, [&]()
+            {
+                return MatchOnce(nativeJIT, query, results);
+            });
+        }
+    }
+}
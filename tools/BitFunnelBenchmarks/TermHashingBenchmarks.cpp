@@ -0,0 +1,167 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchmarkRunner.h"
+#include "Benchmarks.h"
+#include "BitFunnel/Chunks/Factories.h"
+#include "BitFunnel/Index/Factories.h"
+#include "BitFunnel/Index/IConfiguration.h"
+#include "BitFunnel/Index/IDocument.h"
+#include "BitFunnel/Index/IFactSet.h"
+#include "BitFunnel/Term.h"
+
+
+namespace BitFunnel
+{
+    // Generates a stream of tokens drawn from a vocabulary with a skewed
+    // frequency distribution and English-like word lengths.
+    static std::vector<std::string> GenerateTokens(size_t tokenCount)
+    {
+        std::mt19937 random(12345);
+
+        const size_t vocabularySize = 5000;
+        std::vector<std::string> vocabulary;
+        for (size_t i = 0; i < vocabularySize; ++i)
+        {
+            std::string word;
+            const size_t length = 2 + random() % 11;
+            for (size_t c = 0; c < length; ++c)
+            {
+                word.push_back(static_cast<char>('a' + random() % 26));
+            }
+            vocabulary.push_back(word);
+        }
+
+        // Squaring a uniform variate favors low vocabulary indices.
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::vector<std::string> tokens;
+        for (size_t i = 0; i < tokenCount; ++i)
+        {
+            const double u = uniform(random);
+            tokens.push_back(vocabulary[static_cast<size_t>(u * u * (vocabularySize - 1))]);
+        }
+
+        return tokens;
+    }
+
+
+    void RunTermHashingBenchmarks(BenchmarkRunner& runner)
+    {
+        const std::vector<std::string> tokens = GenerateTokens(10000);
+        const Term::StreamId stream = 0;
+
+        std::vector<char const *> texts;
+        std::vector<size_t> lengths;
+        for (auto const & token : tokens)
+        {
+            texts.push_back(token.c_str());
+            lengths.push_back(token.size());
+        }
+        std::vector<Term::Hash> hashes(tokens.size());
+
+        auto facts = Factories::CreateFactSet();
+
+        for (size_t gramSize : { 1, 3, 5 })
+        {
+            auto config = Factories::CreateConfiguration(gramSize, false, *facts);
+
+            // Hash each token as it arrives and form ngrams with
+            // Term::AddTerm(), as Document did before batching.
+            std::string name = "TermHash/PerToken/gram=" + std::to_string(gramSize);
+            runner.Run(name.c_str(), tokens.size(), [&]()
+            {
+                std::vector<Term> unigrams;
+                unigrams.reserve(tokens.size());
+                uint64_t sum = 0;
+                for (size_t i = 0; i < tokens.size(); ++i)
+                {
+                    unigrams.push_back(Term(texts[i], stream, *config));
+                    const size_t first = (i + 1 >= gramSize) ? i + 1 - gramSize : 0;
+                    Term term(unigrams[first]);
+                    sum += term.GetRawHash();
+                    for (size_t j = first + 1; j <= i; ++j)
+                    {
+                        term.AddTerm(unigrams[j], *config);
+                        sum += term.GetRawHash();
+                    }
+                }
+                BenchmarkRunner::Consume(sum);
+            });
+
+            // Hash all tokens in a batch, then build ngram hashes
+            // incrementally from the unigram hashes. Compares the default
+            // hash function with the alternatives that configurations may
+            // select.
+            const std::pair<char const *, Term::HashFunction> functions[] = {
+                { "", Term::HashFunction::MurmurHash64A },
+                { "XXHash64/", Term::HashFunction::XXHash64 }
+            };
+            for (auto const & function : functions)
+            {
+                name = std::string("TermHash/Batched/") + function.first +
+                    "gram=" + std::to_string(gramSize);
+                runner.Run(name.c_str(), tokens.size(), [&]()
+                {
+                    Term::ComputeRawHashes(texts.data(),
+                                           lengths.data(),
+                                           texts.size(),
+                                           function.second,
+                                           hashes.data());
+                    uint64_t sum = 0;
+                    for (size_t i = 0; i < hashes.size(); ++i)
+                    {
+                        Term::Hash hash = hashes[i];
+                        sum += hash;
+                        const size_t end = (std::min)(hashes.size(), i + gramSize);
+                        for (size_t j = i + 1; j < end; ++j)
+                        {
+                            hash = Term::ExtendNGramHash(hash, hashes[j]);
+                            sum += hash;
+                        }
+                    }
+                    BenchmarkRunner::Consume(sum);
+                });
+            }
+
+            // Full Document ingestion path, including the posting set.
+            name = "Document/AddTerm/gram=" + std::to_string(gramSize);
+            runner.Run(name.c_str(), tokens.size(), [&]()
+            {
+                auto document = Factories::CreateDocument(*config, 0);
+                document->OpenStream(stream);
+                for (auto text : texts)
+                {
+                    document->AddTerm(text);
+                }
+                document->CloseStream();
+                document->CloseDocument(0);
+                BenchmarkRunner::Consume(document->GetPostingCount());
+            });
+        }
+    }
+}
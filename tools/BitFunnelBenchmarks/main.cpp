@@ -0,0 +1,77 @@
+// The MIT License (MIT)
+
+// Copyright (c) 2016, Microsoft
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+
+#include "BenchmarkRunner.h"
+#include "Benchmarks.h"
+
+
+int main(int argc, char** argv)
+{
+    BitFunnel::BenchmarkRunner::Format format = BitFunnel::BenchmarkRunner::Text;
+    int arg = 1;
+    if (arg < argc && strcmp(argv[arg], "-csv") == 0)
+    {
+        format = BitFunnel::BenchmarkRunner::Csv;
+        ++arg;
+    }
+    else if (arg < argc && strcmp(argv[arg], "-json") == 0)
+    {
+        format = BitFunnel::BenchmarkRunner::Json;
+        ++arg;
+    }
+
+    if (argc - arg > 2 || (arg < argc && argv[arg][0] == '-'))
+    {
+        std::cout
+            << "Usage: BitFunnelBenchmarks [-csv | -json] [filter [minSeconds]]" << std::endl
+            << "Runs the microbenchmarks whose names contain filter, "
+            << "each for at least minSeconds (default 1)." << std::endl
+            << "Results are written as text, or as CSV or JSON for "
+            << "tracking across commits." << std::endl;
+        return 1;
+    }
+
+    char const * filter = (arg < argc) ? argv[arg] : nullptr;
+    const double minSeconds = (arg + 1 < argc) ? atof(argv[arg + 1]) : 1.0;
+
+    // Library code reports progress on std::cout. Send that to std::cerr
+    // so that standard output carries only results and stays parseable.
+    std::ostream results(std::cout.rdbuf());
+    std::streambuf* coutBuffer = std::cout.rdbuf(std::cerr.rdbuf());
+
+    BitFunnel::BenchmarkRunner runner(results, format, filter, minSeconds);
+    BitFunnel::RunTermHashingBenchmarks(runner);
+    BitFunnel::RunIndexBenchmarks(runner);
+    BitFunnel::RunChunkBenchmarks(runner);
+    BitFunnel::RunMatcherBenchmarks(runner);
+    BitFunnel::RunConcurrencyBenchmarks(runner);
+    runner.Finish();
+
+    std::cout.rdbuf(coutBuffer);
+
+    return 0;
+}